@@ -7,12 +7,28 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/adc.h>
+#ifdef CONFIG_COO_HEATER_PWM
+#include <zephyr/drivers/pwm.h>
+#endif
+#ifdef CONFIG_REGULATOR_TPS55287Q1
+#include "../../drivers/regulator/tps55287q1/tps55287q1.h"
+#endif
 
 /* Application modules */
 #include "../../lib/config/config.h"
 #include "../../lib/sensors/sensor_manager.h"
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+#include "../../lib/sensors/sensor_interlock.h"
+#endif
 #include "../../lib/heaters/heater_manager.h"
 #include "../../lib/control/control_loop.h"
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+#include <zephyr/storage/flash_map.h>
+#include "../../lib/control/flight_recorder.h"
+#endif
+#include "../../lib/supervisor/supervisor.h"
 
 LOG_MODULE_REGISTER(main_app, LOG_LEVEL_INF);
 
@@ -28,12 +44,188 @@ struct k_thread sensor_thread;
 struct k_thread control_thread;
 
 /* Global configuration */
-static thermal_config_t *g_config = NULL;
+static const thermal_config_t *g_config = NULL;
+
+/*
+ * ADC channel of the built-in sensor-1, from the zephyr,user node's
+ * io-channels. A devicetree config takes each sensor's from its own node.
+ */
+#ifndef CONFIG_COO_CONFIG_DEVICETREE
+#if DT_NODE_HAS_PROP(DT_PATH(zephyr_user), io_channels)
+static const struct adc_dt_spec sensor_1_adc = ADC_DT_SPEC_GET(DT_PATH(zephyr_user));
+
+static void bind_adc_sensors(thermal_config_t *config)
+{
+    sensor_config_t *sensor = config_find_sensor(config, "sensor-1");
+
+    if (sensor == NULL) {
+        LOG_WRN("io-channels for unknown sensor sensor-1");
+        return;
+    }
+    sensor->driver_data = &sensor_1_adc;
+}
+#else
+static void bind_adc_sensors(thermal_config_t *config)
+{
+    ARG_UNUSED(config);
+}
+#endif
+#endif /* !CONFIG_COO_CONFIG_DEVICETREE */
+
+/*
+ * PWM outputs for low-power heaters, one "coo,pwm-heater" node each,
+ * matched to the configuration by heater-id.
+ */
+#ifndef CONFIG_COO_CONFIG_DEVICETREE
+#if defined(CONFIG_COO_HEATER_PWM) && DT_HAS_COMPAT_STATUS_OKAY(coo_pwm_heater)
+#define PWM_HEATER_SPEC(node) PWM_DT_SPEC_GET(node),
+#define PWM_HEATER_ID(node) DT_PROP(node, heater_id),
+
+static const struct pwm_dt_spec pwm_heater_specs[] = {
+    DT_FOREACH_STATUS_OKAY(coo_pwm_heater, PWM_HEATER_SPEC)
+};
+static const char *const pwm_heater_ids[] = {
+    DT_FOREACH_STATUS_OKAY(coo_pwm_heater, PWM_HEATER_ID)
+};
+
+static void bind_pwm_heaters(thermal_config_t *config)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(pwm_heater_specs); i++) {
+        heater_config_t *heater = config_find_heater(config, pwm_heater_ids[i]);
+
+        if (heater == NULL) {
+            LOG_WRN("PWM heater node for unknown heater %s", pwm_heater_ids[i]);
+            continue;
+        }
+        heater->pwm = &pwm_heater_specs[i];
+    }
+}
+#else
+static void bind_pwm_heaters(thermal_config_t *config)
+{
+    ARG_UNUSED(config);
+}
+#endif
+#endif /* !CONFIG_COO_CONFIG_DEVICETREE */
+
+/*
+ * Regulator supplies for high-power heaters, one "coo,regulator-heater"
+ * node each. TPS55287-Q1 supplies also get their fault line wired to the
+ * heater manager, so a short is flagged from the INT edge rather than
+ * from the temperature alarm later on.
+ */
+#if DT_HAS_COMPAT_STATUS_OKAY(coo_regulator_heater)
+#define REG_HEATER_DEV(node) DEVICE_DT_GET(DT_PHANDLE(node, regulator)),
+#define REG_HEATER_ID(node) DT_PROP(node, heater_id),
+#define REG_HEATER_IS_TPS(node) DT_NODE_HAS_COMPAT(DT_PHANDLE(node, regulator), ti_tps55287q1),
+
+static const struct device *const reg_heater_devs[] = {
+    DT_FOREACH_STATUS_OKAY(coo_regulator_heater, REG_HEATER_DEV)
+};
+static const char *const reg_heater_ids[] = {
+    DT_FOREACH_STATUS_OKAY(coo_regulator_heater, REG_HEATER_ID)
+};
+static const bool reg_heater_is_tps[] = {
+    DT_FOREACH_STATUS_OKAY(coo_regulator_heater, REG_HEATER_IS_TPS)
+};
+#ifdef CONFIG_REGULATOR_TPS55287Q1
+#define REG_HEATER_FORCE_OFF(node) TPS55287Q1_DT_FORCE_OFF_OR_NULL(DT_PHANDLE(node, regulator)),
+
+/* Lock-free cut for supplies with an EN line, so a fault never waits on a bus lock */
+static int (*const reg_heater_force_off[])(const struct device *dev) = {
+    DT_FOREACH_STATUS_OKAY(coo_regulator_heater, REG_HEATER_FORCE_OFF)
+};
+#endif
+
+#ifndef CONFIG_COO_CONFIG_DEVICETREE
+static void bind_regulator_heaters(thermal_config_t *config)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(reg_heater_devs); i++) {
+        heater_config_t *heater = config_find_heater(config, reg_heater_ids[i]);
+
+        if (heater == NULL) {
+            LOG_WRN("Regulator heater node for unknown heater %s", reg_heater_ids[i]);
+            continue;
+        }
+        heater->regulator_dev = reg_heater_devs[i];
+#ifdef CONFIG_REGULATOR_TPS55287Q1
+        heater->force_off = reg_heater_force_off[i];
+#endif
+    }
+}
+#endif
+
+#ifdef CONFIG_REGULATOR_TPS55287Q1
+static void on_regulator_fault(const struct device *dev, uint8_t status, void *user_data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(status);
+
+    heater_manager_report_fault((int)(uintptr_t)user_data);
+}
+#endif
+
+/* Call after heater_manager_init() so the handles are valid */
+static void bind_regulator_faults(void)
+{
+#ifdef CONFIG_REGULATOR_TPS55287Q1
+    for (size_t i = 0; i < ARRAY_SIZE(reg_heater_devs); i++) {
+        int handle = heater_manager_find_handle(reg_heater_ids[i]);
+
+        if (!reg_heater_is_tps[i] || handle < 0) {
+            continue;
+        }
+        int ret = tps55287q1_set_fault_handler(reg_heater_devs[i], on_regulator_fault,
+                                               (void *)(uintptr_t)handle);
+        if (ret == -ENOTSUP) {
+            LOG_WRN("Heater %s: regulator has no int-gpios, faults not monitored",
+                    reg_heater_ids[i]);
+        }
+        if (reg_heater_force_off[i] == NULL) {
+            LOG_WRN("Heater %s: regulator has no enable-gpios, fault cut goes over I2C",
+                    reg_heater_ids[i]);
+        }
+    }
+#endif
+}
+#else
+#ifndef CONFIG_COO_CONFIG_DEVICETREE
+static void bind_regulator_heaters(thermal_config_t *config)
+{
+    ARG_UNUSED(config);
+}
+#endif
+
+static void bind_regulator_faults(void)
+{
+}
+#endif
 
 /* Thread synchronization */
 static bool system_running = true;
 static bool alarm_triggered = false;
 
+/* Given to end the supervisor wait and shut down */
+K_SEM_DEFINE(shutdown_sem, 0, 1);
+
+/*
+ * Sample -> control pipeline. The timer releases one sensor sweep per period;
+ * a finished sweep releases one control update. Both semaphores are capped at
+ * one so a stage that falls behind skips ticks instead of queueing them.
+ */
+static void sample_timer_expiry(struct k_timer *timer);
+
+K_TIMER_DEFINE(sample_timer, sample_timer_expiry, NULL);
+K_SEM_DEFINE(sample_sem, 0, 1);
+K_SEM_DEFINE(control_sem, 0, 1);
+
+static void sample_timer_expiry(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+
+    k_sem_give(&sample_sem);
+}
+
 /* ========== Sensor Thread ========== */
 
 void sensor_thread_entry(void *p1, void *p2, void *p3)
@@ -42,20 +234,30 @@ void sensor_thread_entry(void *p1, void *p2, void *p3)
     ARG_UNUSED(p2);
     ARG_UNUSED(p3);
 
-    LOG_INF("Sensor thread started (period: 500ms)");
+    LOG_INF("Sensor thread started (timer driven)");
 
     while (system_running) {
+        k_sem_take(&sample_sem, K_FOREVER);
+        if (!system_running) {
+            break;
+        }
+
         int ret = sensor_manager_read_all();
         if (ret != 0) {
             LOG_WRN("Sensor read errors: %d", -ret);
         }
+        supervisor_checkin(SUPERVISOR_STAGE_SENSOR);
 
-        k_sleep(K_MSEC(500));  /* 2 Hz - matches control loop */
+        /* Fresh readings are in the cache: hand off to the control stage */
+        k_sem_give(&control_sem);
     }
 
     LOG_INF("Sensor thread exiting");
 }
 
+static void monitor_system_health(void);
+static void handle_mode_changes(void);
+
 /* ========== Control Thread ========== */
 
 void control_thread_entry(void *p1, void *p2, void *p3)
@@ -64,22 +266,45 @@ void control_thread_entry(void *p1, void *p2, void *p3)
     ARG_UNUSED(p2);
     ARG_UNUSED(p3);
 
-    LOG_INF("Control thread started (period: 500ms)");
+    LOG_INF("Control thread started (woken per sweep)");
 
-    const float dt = 0.5f;  /* 500ms = 0.5 seconds */
+    int64_t last_ticks = 0;
 
     while (system_running) {
+        k_sem_take(&control_sem, K_FOREVER);
+        if (!system_running) {
+            break;
+        }
+
+        /*
+         * dt is the measured time since the previous update, not the nominal
+         * period: skipped ticks and sweep jitter show up in the integrator.
+         */
+        int64_t now_ticks = k_uptime_ticks();
+        float dt;
+
+        if (last_ticks == 0) {
+            dt = CONFIG_APP_CONTROL_PERIOD_MS / 1000.0f;
+        } else {
+            dt = (float)k_ticks_to_us_near64(now_ticks - last_ticks) / 1000000.0f;
+        }
+        last_ticks = now_ticks;
+
+        handle_mode_changes();
+
         if (!alarm_triggered) {
             int ret = control_loop_update_all(dt);
             if (ret != 0) {
                 LOG_WRN("Control loop errors: %d", -ret);
+                /* Alarms only show up as pass errors, so check only then */
+                monitor_system_health();
             }
         } else {
             /* In alarm state, keep loops suspended */
             LOG_DBG("Control loops suspended due to alarm");
         }
-
-        k_sleep(K_MSEC(500));  /* 2 Hz */
+        /* A held alarm still counts as a live control stage */
+        supervisor_checkin(SUPERVISOR_STAGE_CONTROL);
     }
 
     LOG_INF("Control thread exiting");
@@ -98,7 +323,8 @@ static void monitor_system_health(void)
             continue;
         }
 
-        loop_status_t status = control_loop_get_status(g_config->control_loops[i].id);
+        /* Config loop index is the loop handle */
+        loop_status_t status = control_loop_get_status_by_handle(i);
 
         if (status == LOOP_STATUS_ALARM && !alarm_triggered) {
             LOG_ERR("ALARM: Loop %s in alarm state!", g_config->control_loops[i].id);
@@ -112,9 +338,86 @@ static void monitor_system_health(void)
             }
         }
     }
+}
 
-    /* TODO: Add watchdog timer monitoring */
-    /* TODO: Add timeout handling */
+static void stop_all(void)
+{
+    alarm_triggered = true;
+    heater_manager_emergency_stop();
+    control_loop_suspend_all();
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+    /* Get the run-up to the stop into flash before anything else happens */
+    (void)flight_recorder_flush();
+#endif
+}
+
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+#if FIXED_PARTITION_EXISTS(recorder_partition)
+static void start_flight_recorder(void)
+{
+    int ret = flight_recorder_init(FIXED_PARTITION_ID(recorder_partition));
+
+    if (ret != 0) {
+        LOG_WRN("Flight recorder unavailable: %d", ret);
+    }
+}
+#else
+static void start_flight_recorder(void)
+{
+    LOG_WRN("No recorder_partition, flight recorder disabled");
+}
+#endif
+#endif /* CONFIG_COO_FLIGHT_RECORDER */
+
+/* Runs from the system workqueue */
+static void on_supervisor_fault(supervisor_fault_t fault, int stage)
+{
+    if (fault == SUPERVISOR_FAULT_STAGE_MISSED) {
+        LOG_ERR("EMERGENCY STOP: %s stage stalled",
+                stage == SUPERVISOR_STAGE_SENSOR ? "sensor" : "control");
+        stop_all();
+        return;
+    }
+
+    if (fault == SUPERVISOR_FAULT_INTERLOCK) {
+        /* Its heaters were cut in the sweep; hold the loops off them */
+        LOG_ERR("EMERGENCY STOP: interlock %d tripped", stage);
+        stop_all();
+        return;
+    }
+
+    switch (g_config->timeout_error_condition) {
+    case ERROR_CONDITION_STOP:
+        LOG_ERR("EMERGENCY STOP: command timeout (%u s)", g_config->timeout_seconds);
+        stop_all();
+        break;
+    case ERROR_CONDITION_ALARM:
+        LOG_ERR("ALARM: command timeout (%u s)", g_config->timeout_seconds);
+        break;
+    default:
+        LOG_WRN("Command timeout (%u s) ignored", g_config->timeout_seconds);
+        break;
+    }
+}
+
+/*
+ * A stage is late after CONFIG_APP_SUPERVISOR_MISSED_PERIODS pipeline
+ * periods without a check-in; the watchdog then starves and resets.
+ */
+static int start_supervisor(uint32_t period_ms)
+{
+    supervisor_config_t sup = {
+        .watchdog = DEVICE_DT_GET_OR_NULL(DT_ALIAS(watchdog0)),
+        .watchdog_timeout_ms = CONFIG_APP_WATCHDOG_TIMEOUT_MS,
+        .command_timeout_ms = g_config->timeout_seconds * 1000U,
+        .on_fault = on_supervisor_fault,
+    };
+    uint32_t deadline = period_ms * CONFIG_APP_SUPERVISOR_MISSED_PERIODS;
+
+    sup.stage_deadline_ms[SUPERVISOR_STAGE_SENSOR] = deadline;
+    sup.stage_deadline_ms[SUPERVISOR_STAGE_CONTROL] = deadline;
+
+    return supervisor_init(&sup);
 }
 
 /**
@@ -134,20 +437,36 @@ int main(void)
     LOG_INF("====================================");
 
     /* ========== 1. Load Configuration ========== */
-    g_config = config_load_defaults();
-    if (g_config == NULL) {
+#ifdef CONFIG_COO_CONFIG_DEVICETREE
+    /* Generated from devicetree, mostly checked at build time */
+    g_config = config_devicetree();
+#else
+    thermal_config_t *config = config_load_defaults();
+    if (config == NULL) {
         LOG_ERR("Failed to load configuration");
         return -1;
     }
 
+    bind_adc_sensors(config);
+    bind_pwm_heaters(config);
+    bind_regulator_heaters(config);
+    g_config = config;
+#endif
+
     LOG_INF("Configuration loaded:");
     LOG_INF("  Controller ID: %s", g_config->id);
     LOG_INF("  Sensors: %d", g_config->number_of_sensors);
     LOG_INF("  Heaters: %d", g_config->number_of_heaters);
     LOG_INF("  Control Loops: %d", g_config->number_of_control_loops);
 
-    /* ========== 2. Validate Configuration ========== */
-    int ret = config_validate(g_config);
+    int ret;
+
+    /*
+     * ========== 2. Validate Configuration ==========
+     * Devicetree tables too: a follow cycle through several loops is only
+     * caught here.
+     */
+    ret = config_validate(g_config);
     if (ret != 0) {
         LOG_ERR("Configuration validation failed: %d", ret);
         return ret;
@@ -163,6 +482,10 @@ int main(void)
         LOG_ERR("Sensor manager initialization failed: %d", ret);
         return ret;
     }
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+    /* Trips are handled with supervisor faults, on the system workqueue */
+    sensor_interlock_set_handler(supervisor_report_interlock);
+#endif
 
     LOG_INF("Initializing heater manager...");
     ret = heater_manager_init(g_config);
@@ -170,6 +493,7 @@ int main(void)
         LOG_ERR("Heater manager initialization failed: %d", ret);
         return ret;
     }
+    bind_regulator_faults();
 
     /* ========== 4. Initialize Control Loops ========== */
 
@@ -179,6 +503,10 @@ int main(void)
         LOG_ERR("Control loop initialization failed: %d", ret);
         return ret;
     }
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+    /* Needs the sensor, heater and loop counts; records from the first pass */
+    start_flight_recorder();
+#endif
 
     /* ========== 5. Create Worker Threads ========== */
 
@@ -200,6 +528,28 @@ int main(void)
 
     k_thread_name_set(&control_thread, "control");
 
+    /*
+     * Tick at least as fast as the fastest loop; each loop's own deadline
+     * decides whether a given pass actually runs it.
+     */
+    uint32_t period_ms = CONFIG_APP_CONTROL_PERIOD_MS;
+    uint32_t fastest_loop_ms = control_loop_get_min_period_ms();
+
+    if (fastest_loop_ms > 0 && fastest_loop_ms < period_ms) {
+        period_ms = fastest_loop_ms;
+    }
+    LOG_INF("Pipeline period: %u ms", period_ms);
+
+    /* First sweep immediately, then one per period */
+    k_timer_start(&sample_timer, K_NO_WAIT, K_MSEC(period_ms));
+
+    ret = start_supervisor(period_ms);
+    if (ret != 0) {
+        LOG_ERR("Supervisor start failed: %d", ret);
+        heater_manager_emergency_stop();
+        return ret;
+    }
+
     LOG_INF("All threads started");
 
     /* ========== 6. Optional: Network and Telemetry ========== */
@@ -216,16 +566,12 @@ int main(void)
     LOG_INF("System initialized - entering supervisor loop");
     LOG_INF("====================================");
 
-    while (system_running) {
-        /* Monitor system health */
-        monitor_system_health();
-
-        /* Handle mode changes */
-        handle_mode_changes();
-
-        /* Sleep 100ms */
-        k_sleep(K_MSEC(100));
-    }
+    /*
+     * Nothing to poll: alarms are checked by the control thread as they
+     * happen and deadlines by the supervisor work item.
+     */
+    k_sem_take(&shutdown_sem, K_FOREVER);
+    system_running = false;
 
     /* ========== 8. Cleanup on Exit ========== */
 
@@ -234,6 +580,11 @@ int main(void)
     /* Stop all heaters */
     heater_manager_emergency_stop();
 
+    /* Stop the pipeline and release both stages so they see !system_running */
+    k_timer_stop(&sample_timer);
+    k_sem_give(&sample_sem);
+    k_sem_give(&control_sem);
+
     /* Wait for threads to exit */
     k_thread_join(&sensor_thread, K_FOREVER);
     k_thread_join(&control_thread, K_FOREVER);
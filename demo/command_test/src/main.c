@@ -42,11 +42,13 @@ int main(void)
 	control_loop_init(config);
 	sensor_manager_init(config);
 	heater_manager_init(config);
+	thermal_commands_init();
 
 	printf("=== thermal command dispatch ===\n");
 	run("loops", NULL);
 	run("sensors", NULL);
 	run("heaters", NULL);
+	run("snapshot", NULL);
 	run("loop/loop-1/target", "{\"value\":25.0}");
 	run("loop/loop-1/target", NULL);
 	run("loop/loop-1/gains", "{\"kp\":8.0,\"ki\":0.2,\"kd\":1.5}");
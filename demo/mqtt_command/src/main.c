@@ -1,6 +1,8 @@
 /* MQTT command demo: run the coo_commons dispatcher against the thermal command
  * table over a live broker. Publish cmd/hstempctrl/req/<key>, get the response
- * on cmd/hstempctrl/resp/<key>. */
+ * on cmd/hstempctrl/resp/<key>. A control thread runs the loops the commands
+ * drive; with CONFIG_COO_CONTROL_TELEMETRY every pass is streamed on
+ * dt/hstempctrl/stream. */
 
 #include <string.h>
 #include <stdlib.h>
@@ -9,6 +11,9 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/net/net_if.h>
 #include <zephyr/net/dhcpv4.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kvss/nvs.h>
+#include <zephyr/storage/flash_map.h>
 
 #include <config.h>
 #include <control_loop.h>
@@ -17,15 +22,27 @@
 #include <thermal_commands.h>
 #include <coo_commons/mqtt_client.h>
 #include <coo_commons/command_dispatch.h>
+#ifdef CONFIG_COO_CONTROL_PERSIST
+#include <loop_persist.h>
+#endif
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+#include <flight_recorder.h>
+#endif
 
 LOG_MODULE_REGISTER(mqtt_command, LOG_LEVEL_INF);
 
 #define DEVICE_ID          "hstempctrl"
 #define MAX_PENDING_COMMANDS 8
+#define MAX_PENDING_RESPONSES 8
 #define EXEC_STACK_SIZE    4096
+#define CONTROL_STACK_SIZE 4096
+#define CONTROL_PERIOD_MS  500
 
-K_MSGQ_DEFINE(inbound_queue, sizeof(struct coo_cmd_request), MAX_PENDING_COMMANDS, 4);
-K_MSGQ_DEFINE(outbound_queue, sizeof(struct coo_cmd_response), 8, 4);
+/* Entry IDs in the storage partition's NVS */
+#define NVS_ID_LASTCOMMAND 1
+#define NVS_ID_LOOP_STATE  2
+
+COO_CMD_POOL_DEFINE(cmd_pool, MAX_PENDING_COMMANDS, MAX_PENDING_RESPONSES);
 
 static struct coo_cmd_runtime runtime;
 static struct mqtt_client client;
@@ -33,6 +50,74 @@ static uint16_t mqtt_msg_id = 1;
 
 static K_THREAD_STACK_DEFINE(exec_stack, EXEC_STACK_SIZE);
 static struct k_thread exec_thread;
+static K_THREAD_STACK_DEFINE(control_stack, CONTROL_STACK_SIZE);
+static struct k_thread control_thread;
+
+#ifdef CONFIG_COO_SUBSCRIPTIONS
+/* Publications are built here, on the main thread, then copied into the pool */
+static struct coo_cmd_response sub_scratch;
+#endif
+
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+/* Stream frames are built here, on the main thread, then copied into the pool */
+static struct coo_cmd_response stream_scratch;
+#endif
+
+#if FIXED_PARTITION_EXISTS(storage_partition)
+static struct nvs_fs storage;
+
+/* NVS over the board's storage partition, or NULL if it will not mount */
+static struct nvs_fs *storage_mount(void)
+{
+	struct flash_pages_info info;
+	int rc;
+
+	storage.flash_device = FIXED_PARTITION_DEVICE(storage_partition);
+	storage.offset = FIXED_PARTITION_OFFSET(storage_partition);
+	if (!device_is_ready(storage.flash_device) ||
+	    flash_get_page_info_by_offs(storage.flash_device, storage.offset, &info) != 0) {
+		LOG_WRN("Storage flash unavailable, settings will not persist");
+		return NULL;
+	}
+	storage.sector_size = info.size;
+	storage.sector_count = FIXED_PARTITION_SIZE(storage_partition) / info.size;
+
+	rc = nvs_mount(&storage);
+	if (rc != 0) {
+		LOG_WRN("NVS mount failed (%d), settings will not persist", rc);
+		return NULL;
+	}
+	return &storage;
+}
+#else
+static struct nvs_fs *storage_mount(void)
+{
+	LOG_WRN("No storage_partition, settings will not persist");
+	return NULL;
+}
+#endif
+
+/* One sensor sweep and control pass every CONTROL_PERIOD_MS, whatever the broker does */
+static void control_thread_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	int64_t next_ms = k_uptime_get();
+
+	while (true) {
+		if (sensor_manager_read_all() != 0) {
+			LOG_DBG("Sensor sweep had errors");
+		}
+		if (control_loop_update_all(CONTROL_PERIOD_MS / 1000.0f) != 0) {
+			LOG_DBG("Control pass had errors");
+		}
+
+		next_ms += CONTROL_PERIOD_MS;
+		k_sleep(K_TIMEOUT_ABS_MS(next_ms));
+	}
+}
 
 static void wait_for_network(void)
 {
@@ -70,17 +155,39 @@ int main(void)
 	control_loop_init(config);
 	sensor_manager_init(config);
 	heater_manager_init(config);
+	thermal_commands_init();
+
+	struct nvs_fs *nvs = storage_mount();
+
+#ifdef CONFIG_COO_CONTROL_PERSIST
+	/* Saved targets and gains replace the defaults before anything runs */
+	if (nvs != NULL) {
+		loop_persist_init(nvs, NVS_ID_LOOP_STATE);
+	}
+#endif
+
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+#if FIXED_PARTITION_EXISTS(recorder_partition)
+	/* Serves recorder/dump of what earlier boots recorded */
+	if (flight_recorder_init(FIXED_PARTITION_ID(recorder_partition)) != 0) {
+		LOG_WRN("Flight recorder unavailable");
+	}
+#else
+	LOG_WRN("No recorder_partition, flight recorder disabled");
+#endif
+#endif
 
 	size_t spec_count;
 	const struct coo_cmd_spec *specs = thermal_commands_specs(&spec_count);
 	const struct coo_cmd_runtime_config cfg = {
 		.device_id = DEVICE_ID,
-		.inbound_queue = &inbound_queue,
-		.outbound_queue = &outbound_queue,
+		COO_CMD_POOL_CONFIG(cmd_pool),
 		.mqtt_msg_id = &mqtt_msg_id,
 		.serial_wrap_column = COO_CMD_SERIAL_WRAP_COLUMN,
 		.command_specs = specs,
 		.command_spec_count = spec_count,
+		.lastcommand_nvs = nvs,
+		.lastcommand_nvs_id = nvs != NULL ? NVS_ID_LASTCOMMAND : 0U,
 	};
 
 	if (coo_cmd_runtime_configure(&runtime, &cfg) != 0) {
@@ -93,6 +200,11 @@ int main(void)
 			8, 0, K_NO_WAIT);
 	k_thread_name_set(&exec_thread, "cmd_exec");
 
+	k_thread_create(&control_thread, control_stack, K_THREAD_STACK_SIZEOF(control_stack),
+			control_thread_entry, NULL, NULL, NULL,
+			7, 0, K_NO_WAIT);
+	k_thread_name_set(&control_thread, "control");
+
 	wait_for_network();
 
 	if (coo_mqtt_init(&client, DEVICE_ID) != 0) {
@@ -110,7 +222,7 @@ int main(void)
 	}
 	LOG_INF("Broker %s:%u", broker.host, broker.port);
 
-	coo_mqtt_set_message_callback(coo_cmd_runtime_mqtt_callback, &runtime);
+	coo_mqtt_set_publish_reader(coo_cmd_runtime_mqtt_reader, &runtime);
 
 	/* Subscribe to every request under this device: cmd/<device>/req/# */
 	char subscription[COO_CMD_TOPIC_MAX];
@@ -119,23 +231,24 @@ int main(void)
 	coo_mqtt_add_subscription(subscription, MQTT_QOS_1_AT_LEAST_ONCE);
 	LOG_INF("Subscribing to %s", subscription);
 
-	bool subscribed = false;
-
 	while (true) {
 		coo_cmd_runtime_serial_poll(&runtime);
 
-		if (!coo_mqtt_is_connected()) {
-			subscribed = false;
-			if (coo_mqtt_connect(&client) != 0) {
-				k_msleep(2000);
-				continue;
-			}
-		}
-		if (!subscribed) {
-			coo_mqtt_subscribe(&client);
-			subscribed = true;
+		/* Connects with jittered backoff and restores the subscription */
+		if (coo_mqtt_maintain(&client) != 0) {
+			coo_cmd_runtime_drain_outbound(&runtime, &client, false);
+			k_msleep(20);
+			continue;
 		}
 
+#ifdef CONFIG_COO_SUBSCRIPTIONS
+		thermal_commands_poll_subscriptions(&runtime, &sub_scratch);
+#endif
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+		/* One frame per iteration; the ring holds the passes in between */
+		(void)coo_telemetry_publish(control_loop_get_telemetry(), &runtime, "stream",
+					    &stream_scratch);
+#endif
 		coo_cmd_runtime_drain_outbound(&runtime, &client, coo_mqtt_is_connected());
 		coo_mqtt_process(&client);
 		k_msleep(20);
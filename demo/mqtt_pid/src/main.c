@@ -4,6 +4,7 @@
  *
  * MQTT Topics:
  *   coo/pid/telemetry  (publish)  - periodic status
+ *   coo/pid/stream     (publish)  - every tick, binary batches
  *   coo/pid/cmd        (subscribe) - incoming commands
  *   coo/pid/resp       (publish)  - command responses
  *
@@ -13,6 +14,11 @@
  *   {"cmd":"set_gains","kp":5.0,"ki":0.1,"kd":1.0}
  *   {"cmd":"get_gains"}
  *   {"cmd":"enable","value":1}
+ *   {"cmd":"get_pub_stats"}
+ *   {"cmd":"get_conn_stats"}
+ *
+ * Every publish goes through the MQTT client's outbound queue, so the
+ * control loop below never blocks on the broker.
  */
 
 #include <zephyr/kernel.h>
@@ -69,10 +75,10 @@ LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 #define TOPIC_TELEMETRY  "coo/pid/telemetry"
 #define TOPIC_CMD        "coo/pid/cmd"
 #define TOPIC_RESP       "coo/pid/resp"
+#define TOPIC_STREAM     "coo/pid/stream"
 
 /* MQTT client instance */
 static struct mqtt_client client;
-static uint16_t pub_msg_id = 1;
 
 /* MQTT thread */
 #define MQTT_THREAD_STACK_SIZE 4096
@@ -89,22 +95,28 @@ static const struct adc_dt_spec sensor_adc_spec = ADC_DT_SPEC_GET(DT_ALIAS(senso
 #endif
 
 /*
- * Publish message to an MQTT topic
+ * Queue a publish for the MQTT thread. The payload is copied and
+ * coo_mqtt_process() sends it, so the control loop never waits on the
+ * socket.
+ */
+static int publish_bytes(const char *topic, const uint8_t *data, size_t len,
+			 uint8_t qos, uint32_t flags)
+{
+	int rc = coo_mqtt_publish_queued(topic, data, len, qos, flags);
+
+	if (rc != 0) {
+		LOG_DBG("Publish on %s not queued [%d]", topic, rc);
+	}
+	return rc;
+}
+
+/*
+ * Publish a command response; QoS 1, held until the broker acknowledges it
  */
 static int publish(const char *topic, const char *payload)
 {
-	struct mqtt_publish_param param;
-
-	param.message.topic.qos = MQTT_QOS_0_AT_MOST_ONCE;
-	param.message.topic.topic.utf8 = topic;
-	param.message.topic.topic.size = strlen(topic);
-	param.message.payload.data = (uint8_t *)payload;
-	param.message.payload.len = strlen(payload);
-	param.message_id = pub_msg_id++;
-	param.dup_flag = 0;
-	param.retain_flag = 0;
-
-	return mqtt_publish(&client, &param);
+	return publish_bytes(topic, (const uint8_t *)payload, strlen(payload),
+			     MQTT_QOS_1_AT_LEAST_ONCE, 0U);
 }
 
 /*
@@ -239,6 +251,38 @@ static void handle_enable(float value)
 	publish(TOPIC_RESP, resp);
 }
 
+/*
+ * Handle "get_pub_stats" command: {"cmd":"get_pub_stats"}
+ */
+static void handle_get_pub_stats(void)
+{
+	struct coo_mqtt_publish_stats stats;
+	char resp[512];
+
+	coo_mqtt_get_publish_stats(&stats);
+	if (coo_mqtt_format_publish_stats(&stats, resp, sizeof(resp)) != 0) {
+		publish(TOPIC_RESP, "{\"status\":\"ERROR\",\"code\":-28}");
+		return;
+	}
+	publish(TOPIC_RESP, resp);
+}
+
+/*
+ * Handle "get_conn_stats" command: {"cmd":"get_conn_stats"}
+ */
+static void handle_get_conn_stats(void)
+{
+	struct coo_mqtt_connection_stats stats;
+	char resp[256];
+
+	coo_mqtt_get_connection_stats(&stats);
+	if (coo_mqtt_format_connection_stats(&stats, resp, sizeof(resp)) != 0) {
+		publish(TOPIC_RESP, "{\"status\":\"ERROR\",\"code\":-28}");
+		return;
+	}
+	publish(TOPIC_RESP, resp);
+}
+
 /*
  * MQTT message callback
  */
@@ -294,6 +338,10 @@ static void on_message(const struct mqtt_publish_param *pub, void *user_data)
 		handle_get_gains();
 	} else if (strcmp(cmd, "enable") == 0) {
 		handle_enable(value);
+	} else if (strcmp(cmd, "get_pub_stats") == 0) {
+		handle_get_pub_stats();
+	} else if (strcmp(cmd, "get_conn_stats") == 0) {
+		handle_get_conn_stats();
 	} else {
 		char resp[128];
 
@@ -310,10 +358,17 @@ static void mqtt_thread_entry(void *p1, void *p2, void *p3)
 	ARG_UNUSED(p3);
 
 	LOG_INF("MQTT thread started");
-	mqtt_ready = true;
-	coo_mqtt_run(&client);
-	mqtt_ready = false;
-	LOG_WRN("MQTT thread exiting (disconnected)");
+
+	while (true) {
+		/* Connects with jittered backoff and restores the subscription */
+		if (coo_mqtt_maintain(&client) != 0) {
+			mqtt_ready = false;
+			k_msleep(100);
+			continue;
+		}
+		mqtt_ready = true;
+		coo_mqtt_process(&client);
+	}
 }
 
 /*
@@ -402,9 +457,32 @@ static void publish_telemetry(int iteration)
 		 (double)temp_c, (double)setpoint_c,
 		 (double)error_c, (double)heater_power, iteration);
 
-	publish(TOPIC_TELEMETRY, payload);
+	/* Only the latest status matters: a newer one replaces a queued one */
+	publish_bytes(TOPIC_TELEMETRY, (const uint8_t *)payload, strlen(payload),
+		      MQTT_QOS_0_AT_MOST_ONCE, COO_MQTT_PUBLISH_COALESCE);
 }
 
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+/*
+ * Flush every tick recorded since the last call as binary frames.
+ * See coo_telemetry_encode() for the frame layout.
+ */
+static void publish_stream(void)
+{
+	static uint8_t frame[COO_TELEMETRY_FRAME_SIZE(CONFIG_COO_TELEMETRY_BATCH_RECORDS)];
+	struct coo_telemetry *tm = control_loop_get_telemetry();
+	int len;
+
+	while ((len = coo_telemetry_encode(tm, frame, sizeof(frame),
+					   CONFIG_COO_TELEMETRY_BATCH_RECORDS)) > 0) {
+		if (publish_bytes(TOPIC_STREAM, frame, (size_t)len,
+				  MQTT_QOS_0_AT_MOST_ONCE, 0U) != 0) {
+			break;
+		}
+	}
+}
+#endif
+
 int main(void)
 {
 	int ret;
@@ -516,9 +594,6 @@ int main(void)
 	coo_mqtt_add_subscription(TOPIC_CMD, MQTT_QOS_1_AT_LEAST_ONCE);
 	coo_mqtt_set_message_callback(on_message, NULL);
 
-	LOG_INF("Connecting to MQTT broker...");
-	coo_mqtt_connect(&client);
-
 	/*
 	 * Start MQTT thread
 	 */
@@ -583,6 +658,9 @@ int main(void)
 
 			if (mqtt_ready) {
 				publish_telemetry(iteration);
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+				publish_stream();
+#endif
 			}
 		}
 
@@ -0,0 +1,560 @@
+/**
+ * @file main.c
+ * @brief Plant simulator and control-loop benchmarks
+ *
+ * Runs the sensor, heater and control managers against simulated
+ * hardware: a 24-bit ADC whose codes come from an RC thermal network,
+ * and heater supplies whose voltage drives power back into it.
+ *
+ * The demo:
+ * 1. Times sensor_manager_read_all() for 1..max sensors
+ * 2. Times control_loop_update_all() for 1..max loops
+ * 3. Times command dispatch (with commands.conf)
+ * 4. Steps one loop's setpoint, runs the closed loop in simulated time,
+ *    and reports overshoot and settling against the Kconfig limits
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/drivers/regulator.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <config.h>
+#include <sensor_manager.h>
+#include <heater_manager.h>
+#include <control_loop.h>
+#ifdef CONFIG_COO_COMMANDS_LIB
+#include <thermal_commands.h>
+#endif
+
+#include "plant.h"
+#include "sim_hw.h"
+
+LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
+
+#define AMBIENT_K        293.15f
+#define SIM_DT_SECONDS   (CONFIG_APP_SIM_PERIOD_MS / 1000.0f)
+#define MK_TO_K(mk)      ((mk) / 1000.0f)
+
+/* Step response loop gains, for the plant in run_step_response() */
+#define STEP_KP  6.0f
+#define STEP_KI  0.3f
+#define STEP_KD  0.0f
+
+/* Simulated hardware from app.overlay */
+#define SIM_USER_NODE DT_PATH(zephyr_user)
+#define SIM_CHANNEL_SPEC(node, prop, idx) ADC_DT_SPEC_GET_BY_IDX(node, idx)
+#define SIM_REG_DEV(node) DEVICE_DT_GET(node),
+
+static const struct device *const sim_adc = DEVICE_DT_GET(DT_NODELABEL(sim_adc));
+
+static const struct adc_dt_spec sim_channels[] = {
+    DT_FOREACH_PROP_ELEM_SEP(SIM_USER_NODE, io_channels, SIM_CHANNEL_SPEC, (,))
+};
+
+static const struct device *const sim_regulators[] = {
+    DT_FOREACH_STATUS_OKAY(coo_sim_regulator, SIM_REG_DEV)
+};
+
+#define NUM_CHANNELS   ARRAY_SIZE(sim_channels)
+#define NUM_SUPPLIES   ARRAY_SIZE(sim_regulators)
+
+#define BENCH_MAX_SENSORS MIN(MIN(MAX_MANAGED_SENSORS, MAX_SENSORS), (int)NUM_CHANNELS)
+#define BENCH_MAX_LOOPS   MIN(MIN(MAX_CONTROL_LOOPS, MAX_HEATERS), \
+                              MIN(MAX_MANAGED_HEATERS, BENCH_MAX_SENSORS))
+
+/*
+ * Plant wiring: which node each ADC channel measures and which node each
+ * supply heats (-1 = unconnected), and the heater resistance on each
+ * supply for P = V^2 / R.
+ */
+static plant_t plant;
+static int channel_node[NUM_CHANNELS];
+static int supply_node[NUM_SUPPLIES];
+static float supply_ohms[NUM_SUPPLIES];
+static uint32_t noise_state = 1;
+
+/**
+ * Min/avg/max of one benchmark point, in cycles
+ */
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t count;
+} bench_stats_t;
+
+static void bench_reset(bench_stats_t *s)
+{
+    s->min = UINT32_MAX;
+    s->max = 0;
+    s->total = 0;
+    s->count = 0;
+}
+
+static void bench_add(bench_stats_t *s, uint32_t cycles)
+{
+    s->min = MIN(s->min, cycles);
+    s->max = MAX(s->max, cycles);
+    s->total += cycles;
+    s->count++;
+}
+
+static double cycles_to_us(uint64_t cycles)
+{
+    return (double)k_cyc_to_ns_floor64(cycles) / 1000.0;
+}
+
+static void bench_print(const char *what, int n, const bench_stats_t *s)
+{
+    if (s->count == 0) {
+        printf("  %-22s n=%-3d no samples\n", what, n);
+        return;
+    }
+
+    printf("  %-22s n=%-3d min %8.2f  avg %8.2f  max %8.2f us\n", what, n,
+           cycles_to_us(s->min), cycles_to_us(s->total) / s->count, cycles_to_us(s->max));
+}
+
+/* Deterministic uniform noise in [-amplitude, amplitude] */
+static float sim_noise(float amplitude)
+{
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return amplitude * ((float)(noise_state >> 8) / (float)(1u << 23) - 1.0f);
+}
+
+/* Inverse of the sensor manager's linear P_RTD conversion */
+static int32_t rtd_code(const sensor_config_t *sensor, float temp_k)
+{
+    int32_t max_count = (int32_t)((1ULL << (sensor->adc_resolution - 1)) - 1);
+    float ohms = sensor->nominal_resistance +
+                 (temp_k - 273.15f) * sensor->temperature_coefficient / sensor->nominal_resistance;
+    float counts = ohms * (float)sensor->adc_gain * (float)max_count / sensor->reference_resistance;
+
+    return max_count + (int32_t)lroundf(counts);
+}
+
+static int32_t plant_adc_source(const struct device *dev, uint8_t channel, void *user_data)
+{
+    const sensor_config_t *sensor = user_data;
+    float temp_k = AMBIENT_K;
+
+    ARG_UNUSED(dev);
+
+    if (channel < NUM_CHANNELS && channel_node[channel] >= 0) {
+        temp_k = plant_temperature(&plant, channel_node[channel]);
+    }
+    return rtd_code(sensor, temp_k + sim_noise(MK_TO_K((float)CONFIG_APP_SIM_NOISE_MK)));
+}
+
+/* Feed the supplies' current output into the plant */
+static void apply_heater_power(void)
+{
+    for (size_t i = 0; i < NUM_SUPPLIES; i++) {
+        int32_t uv = 0;
+        float watts = 0.0f;
+
+        if (supply_node[i] < 0) {
+            continue;
+        }
+        if (regulator_is_enabled(sim_regulators[i]) &&
+            regulator_get_voltage(sim_regulators[i], &uv) == 0) {
+            float volts = (float)uv / 1000000.0f;
+
+            watts = volts * volts / supply_ohms[i];
+        }
+        plant_set_power(&plant, supply_node[i], watts);
+    }
+}
+
+/*
+ * Build a configuration with num_sensors RTDs on consecutive ADC channels
+ * and num_loops PID loops, each with its own heater and the sensors dealt
+ * round-robin. Sensor, heater and loop settings start from the defaults.
+ */
+static thermal_config_t *build_config(int num_sensors, int num_loops)
+{
+    thermal_config_t *config = config_load_defaults();
+
+    if (config == NULL) {
+        return NULL;
+    }
+
+    const sensor_config_t sensor_template = config->sensors[0];
+    const heater_config_t heater_template = config->heaters[0];
+    const control_loop_config_t loop_template = config->control_loops[1];
+
+    config->number_of_sensors = num_sensors;
+    for (int i = 0; i < num_sensors; i++) {
+        sensor_config_t *sensor = &config->sensors[i];
+
+        *sensor = sensor_template;
+        snprintf(sensor->id, MAX_ID_LENGTH, "sim-s%d", i);
+        sensor->extrapolate_method = EXTRAP_NONE;
+        sensor->driver_data = &sim_channels[i];
+    }
+
+    config->number_of_heaters = num_loops;
+    for (int i = 0; i < num_loops; i++) {
+        heater_config_t *heater = &config->heaters[i];
+
+        *heater = heater_template;
+        snprintf(heater->id, MAX_ID_LENGTH, "sim-h%d", i);
+        heater->type = HEATER_TYPE_HIGH_POWER;
+        heater->regulator_dev = sim_regulators[i % NUM_SUPPLIES];
+    }
+
+    config->number_of_control_loops = num_loops;
+    for (int i = 0; i < num_loops; i++) {
+        control_loop_config_t *loop = &config->control_loops[i];
+
+        *loop = loop_template;
+        snprintf(loop->id, MAX_ID_LENGTH, "sim-l%d", i);
+
+        loop->num_sensors = 0;
+        for (int s = i; s < num_sensors && loop->num_sensors < MAX_SENSORS_PER_LOOP;
+             s += num_loops) {
+            strncpy(loop->sensor_ids[loop->num_sensors++], config->sensors[s].id,
+                    MAX_ID_LENGTH - 1);
+        }
+        loop->num_heaters = 1;
+        strncpy(loop->heater_ids[0], config->heaters[i].id, MAX_ID_LENGTH - 1);
+
+        /* Stepped by the caller's dt, with nothing rejected as stale */
+        loop->update_period_ms = 0;
+        loop->max_sensor_age_ms = 0;
+        loop->default_target_temperature = AMBIENT_K + 5.0f;
+        loop->valid_setpoint_range_min = 0.0f;
+        loop->valid_setpoint_range_max = 1000.0f;
+        loop->setpoint_change_rate_limit = 0.0f;
+        loop->heater_power_limit_max = heater_template.max_power_w;
+    }
+    return config;
+}
+
+/* Point the simulated hardware at a sensor table and a plant */
+static void wire_plant(const thermal_config_t *config, int sensor_node_count)
+{
+    for (size_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        channel_node[ch] = -1;
+        if ((int)ch < config->number_of_sensors) {
+            channel_node[ch] = (int)ch % sensor_node_count;
+        }
+    }
+    for (size_t i = 0; i < NUM_SUPPLIES; i++) {
+        supply_node[i] = -1;
+    }
+    for (int h = 0; h < config->number_of_heaters && h < (int)NUM_SUPPLIES; h++) {
+        supply_node[h] = h % plant.num_nodes;
+        supply_ohms[h] = config->heaters[h].resistance_ohms;
+    }
+
+    /* Every sensor shares one conversion model, so one template serves all */
+    sim_adc_set_source(sim_adc, plant_adc_source, (void *)&config->sensors[0]);
+}
+
+static int init_managers(const thermal_config_t *config)
+{
+    int ret;
+
+    ret = heater_manager_init(config);
+    if (ret < 0) {
+        LOG_ERR("Heater manager init failed: %d", ret);
+        return ret;
+    }
+    ret = sensor_manager_init(config);
+    if (ret != 0) {
+        LOG_ERR("Sensor manager init failed: %d", ret);
+        return ret;
+    }
+    ret = control_loop_init(config);
+    if (ret != 0) {
+        LOG_ERR("Control loop init failed: %d", ret);
+        return ret;
+    }
+    return 0;
+}
+
+/* 1, 2, 4, ... up to and including max */
+static int next_count(int n, int max)
+{
+    if (n >= max) {
+        return max + 1;
+    }
+    return MIN(n * 2, max);
+}
+
+static int bench_read_all(void)
+{
+    static const plant_node_params_t node = {
+        .heat_capacity = 100.0f, .loss_conductance = 0.2f,
+    };
+    bench_stats_t stats;
+
+    printf("sensor_manager_read_all:\n");
+    for (int n = 1; n <= BENCH_MAX_SENSORS; n = next_count(n, BENCH_MAX_SENSORS)) {
+        thermal_config_t *config = build_config(n, 1);
+
+        if (config == NULL || plant_init(&plant, &node, 1, AMBIENT_K) != 0 ||
+            init_managers(config) != 0) {
+            return -1;
+        }
+        wire_plant(config, 1);
+
+        bench_reset(&stats);
+        for (int it = 0; it < CONFIG_APP_BENCH_ITERATIONS; it++) {
+            uint32_t start = k_cycle_get_32();
+            int ret = sensor_manager_read_all();
+
+            bench_add(&stats, k_cycle_get_32() - start);
+            if (ret != 0) {
+                LOG_ERR("read_all failed: %d", ret);
+                return -1;
+            }
+        }
+        bench_print("read_all", n, &stats);
+    }
+    return 0;
+}
+
+static int bench_update_all(void)
+{
+    plant_node_params_t nodes[PLANT_MAX_NODES];
+    bench_stats_t stats;
+
+    for (int i = 0; i < PLANT_MAX_NODES; i++) {
+        nodes[i] = (plant_node_params_t){ .heat_capacity = 100.0f, .loss_conductance = 0.2f };
+    }
+
+    printf("control_loop_update_all:\n");
+    for (int n = 1; n <= BENCH_MAX_LOOPS; n = next_count(n, BENCH_MAX_LOOPS)) {
+        /* Twice as many sensors as loops where there is room, to exercise fusion */
+        int num_sensors = MIN(2 * n, BENCH_MAX_SENSORS);
+        thermal_config_t *config = build_config(num_sensors, n);
+
+        if (config == NULL || plant_init(&plant, nodes, MIN(n, PLANT_MAX_NODES), AMBIENT_K) != 0 ||
+            init_managers(config) != 0) {
+            return -1;
+        }
+        wire_plant(config, MIN(n, PLANT_MAX_NODES));
+
+        /* Fresh readings for every loop; the timed calls only run the loops */
+        if (sensor_manager_read_all() != 0) {
+            return -1;
+        }
+
+        bench_reset(&stats);
+        for (int it = 0; it < CONFIG_APP_BENCH_ITERATIONS; it++) {
+            uint32_t start = k_cycle_get_32();
+            int ret = control_loop_update_all(SIM_DT_SECONDS);
+
+            bench_add(&stats, k_cycle_get_32() - start);
+            if (ret != 0) {
+                LOG_ERR("update_all failed: %d", ret);
+                return -1;
+            }
+        }
+        bench_print("update_all", n, &stats);
+    }
+    return 0;
+}
+
+#ifdef CONFIG_COO_COMMANDS_LIB
+static void bench_command(const char *key, const char *payload)
+{
+    static struct coo_cmd_request cmd;
+    static struct coo_cmd_response out;
+    bench_stats_t stats;
+    char label[48];
+
+    memset(&cmd, 0, sizeof(cmd));
+    strncpy(cmd.key, key, sizeof(cmd.key) - 1);
+    if (payload != NULL) {
+        strncpy(cmd.payload, payload, sizeof(cmd.payload) - 1);
+        cmd.payload_len = strlen(cmd.payload);
+    }
+
+    bench_reset(&stats);
+    for (int it = 0; it < CONFIG_APP_BENCH_ITERATIONS; it++) {
+        uint32_t start = k_cycle_get_32();
+
+        (void)thermal_commands_dispatch(&cmd, &out);
+        bench_add(&stats, k_cycle_get_32() - start);
+    }
+    snprintf(label, sizeof(label), "%s%s", key, payload != NULL ? " (set)" : "");
+    bench_print(label, BENCH_MAX_LOOPS, &stats);
+    if (out.msg_type == COO_CMD_RESP_ERROR) {
+        printf("    error: %.*s\n", (int)out.payload_len, out.payload);
+    }
+}
+
+static int bench_dispatch(void)
+{
+    static const plant_node_params_t node = {
+        .heat_capacity = 100.0f, .loss_conductance = 0.2f,
+    };
+    thermal_config_t *config = build_config(BENCH_MAX_SENSORS, BENCH_MAX_LOOPS);
+
+    if (config == NULL || plant_init(&plant, &node, 1, AMBIENT_K) != 0 ||
+        init_managers(config) != 0 || thermal_commands_init() != 0) {
+        return -1;
+    }
+    wire_plant(config, 1);
+    if (sensor_manager_read_all() != 0) {
+        return -1;
+    }
+
+    printf("thermal_commands_dispatch:\n");
+    bench_command("loops", NULL);
+    bench_command("snapshot", NULL);
+    bench_command("loop/sim-l0/target", NULL);
+    bench_command("loop/sim-l0/target", "{\"value\":30.0}");
+    bench_command("loop/sim-l0/gains", "{\"kp\":6.0,\"ki\":0.3,\"kd\":0.0}");
+    return 0;
+}
+#endif /* CONFIG_COO_COMMANDS_LIB */
+
+/*
+ * Two-node plant: the heater and sensor sit on a 100 J/K block coupled
+ * at 1 W/K to a 400 J/K load, both losing heat to ambient. The loop starts
+ * settled at ambient and is stepped up by CONFIG_APP_SIM_STEP_MK.
+ */
+static int run_step_response(void)
+{
+    static const plant_node_params_t nodes[] = {
+        { .heat_capacity = 100.0f, .loss_conductance = 0.2f, .coupling_conductance = 1.0f },
+        { .heat_capacity = 400.0f, .loss_conductance = 0.3f },
+    };
+    const float step_k = MK_TO_K((float)CONFIG_APP_SIM_STEP_MK);
+    const float band_k = MK_TO_K((float)CONFIG_APP_SIM_SETTLE_BAND_MK);
+    const float target_k = AMBIENT_K + step_k;
+    const int ticks = (int)((float)CONFIG_APP_SIM_DURATION_S / SIM_DT_SECONDS);
+    const int log_every = MAX((int)(60.0f / SIM_DT_SECONDS), 1);
+    thermal_config_t *config = build_config(1, 1);
+
+    if (config == NULL || plant_init(&plant, nodes, ARRAY_SIZE(nodes), AMBIENT_K) != 0) {
+        return -1;
+    }
+
+    control_loop_config_t *loop = &config->control_loops[0];
+
+    loop->p_gain = STEP_KP;
+    loop->i_gain = STEP_KI;
+    loop->d_gain = STEP_KD;
+    loop->anti_windup = ANTI_WINDUP_CONDITIONAL;
+    loop->default_target_temperature = AMBIENT_K;
+
+    if (init_managers(config) != 0) {
+        return -1;
+    }
+    wire_plant(config, 1);
+
+    printf("Step response: %.2f K -> %.2f K, Kp=%.2f Ki=%.3f Kd=%.2f, dt=%.3f s\n",
+           (double)AMBIENT_K, (double)target_k, (double)STEP_KP, (double)STEP_KI,
+           (double)STEP_KD, (double)SIM_DT_SECONDS);
+
+    if (control_loop_set_target(loop->id, target_k) != 0) {
+        return -1;
+    }
+
+    float peak_k = AMBIENT_K;
+    float rise_s = -1.0f;
+    float settle_s = 0.0f;
+    float temp_k = AMBIENT_K;
+    float sim_time_s = 0.0f;
+
+    for (int tick = 1; tick <= ticks; tick++) {
+        (void)sensor_manager_read_all();
+        (void)control_loop_update_all(SIM_DT_SECONDS);
+        apply_heater_power();
+        plant_step(&plant, SIM_DT_SECONDS);
+
+        sim_time_s = tick * SIM_DT_SECONDS;
+        temp_k = plant_temperature(&plant, 0);
+        peak_k = MAX(peak_k, temp_k);
+        if (rise_s < 0.0f && temp_k >= AMBIENT_K + 0.9f * step_k) {
+            rise_s = sim_time_s;
+        }
+        if (fabsf(temp_k - target_k) > band_k) {
+            settle_s = sim_time_s;
+        }
+
+        if (tick % log_every == 0) {
+            float power = 0.0f;
+
+            heater_manager_get_power(config->heaters[0].id, &power);
+            printf("  t=%6.0f s  T=%.3f K  err=%+.3f K  P=%.1f%%\n", (double)sim_time_s,
+                   (double)temp_k, (double)(target_k - temp_k), (double)power);
+        }
+    }
+
+    float overshoot_k = MAX(peak_k - target_k, 0.0f);
+    bool settled = fabsf(temp_k - target_k) <= band_k;
+    bool pass = settled &&
+                overshoot_k <= MK_TO_K((float)CONFIG_APP_SIM_MAX_OVERSHOOT_MK) &&
+                settle_s <= (float)CONFIG_APP_SIM_MAX_SETTLE_S;
+
+    printf("  overshoot     %.3f K (limit %.3f K)\n", (double)overshoot_k,
+           (double)MK_TO_K((float)CONFIG_APP_SIM_MAX_OVERSHOOT_MK));
+    if (rise_s >= 0.0f) {
+        printf("  rise (90%%)    %.1f s\n", (double)rise_s);
+    } else {
+        printf("  rise (90%%)    not reached\n");
+    }
+    if (settled) {
+        printf("  settle (+/-%.3f K) %.1f s (limit %d s)\n", (double)band_k,
+               (double)settle_s, CONFIG_APP_SIM_MAX_SETTLE_S);
+    } else {
+        printf("  not settled within +/-%.3f K after %.0f s\n", (double)band_k,
+               (double)sim_time_s);
+    }
+    printf("  final error   %+.4f K\n", (double)(target_k - temp_k));
+
+    return pass ? 0 : 1;
+}
+
+int main(void)
+{
+    int ret;
+
+    printf("===========================================\n");
+    printf("Plant Simulator and Control-Loop Benchmarks\n");
+    printf("===========================================\n");
+
+    if (!device_is_ready(sim_adc)) {
+        LOG_ERR("Simulated ADC not ready");
+        return -1;
+    }
+    for (size_t i = 0; i < NUM_SUPPLIES; i++) {
+        if (!device_is_ready(sim_regulators[i])) {
+            LOG_ERR("Simulated supply %u not ready", (unsigned int)i);
+            return -1;
+        }
+    }
+
+    printf("%d iterations per point, %u Hz cycle counter\n", CONFIG_APP_BENCH_ITERATIONS,
+           (unsigned int)sys_clock_hw_cycles_per_sec());
+
+    if (bench_read_all() != 0 || bench_update_all() != 0) {
+        printf("RESULT: ERROR (benchmark setup failed)\n");
+        return -1;
+    }
+#ifdef CONFIG_COO_COMMANDS_LIB
+    if (bench_dispatch() != 0) {
+        printf("RESULT: ERROR (dispatch setup failed)\n");
+        return -1;
+    }
+#endif
+
+    ret = run_step_response();
+    if (ret < 0) {
+        printf("RESULT: ERROR (step response setup failed)\n");
+        return -1;
+    }
+
+    printf("RESULT: %s\n", ret == 0 ? "PASS" : "FAIL");
+    return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file plant.c
+ * @brief Lumped RC thermal network for the plant simulator
+ */
+
+#include "plant.h"
+#include <math.h>
+#include <string.h>
+
+int plant_init(plant_t *plant, const plant_node_params_t params[], int num_nodes,
+               float ambient_kelvin)
+{
+    if (plant == NULL || params == NULL || num_nodes < 1 || num_nodes > PLANT_MAX_NODES) {
+        return -1;
+    }
+
+    memset(plant, 0, sizeof(*plant));
+    plant->num_nodes = num_nodes;
+    plant->ambient_kelvin = ambient_kelvin;
+    plant->max_step_s = INFINITY;
+
+    for (int i = 0; i < num_nodes; i++) {
+        const plant_node_params_t *p = &params[i];
+        float g = p->loss_conductance;
+
+        if (p->heat_capacity <= 0.0f || p->loss_conductance < 0.0f ||
+            p->coupling_conductance < 0.0f) {
+            return -1;
+        }
+
+        /* Every conductance touching the node */
+        if (i < num_nodes - 1) {
+            g += p->coupling_conductance;
+        }
+        if (i > 0) {
+            g += params[i - 1].coupling_conductance;
+        }
+
+        /* Explicit Euler is stable below 2*C/G; keep well inside that */
+        if (g > 0.0f) {
+            plant->max_step_s = fminf(plant->max_step_s, 0.5f * p->heat_capacity / g);
+        }
+        plant->params[i] = *p;
+    }
+    return 0;
+}
+
+int plant_set_power(plant_t *plant, int node, float watts)
+{
+    if (plant == NULL || node < 0 || node >= plant->num_nodes) {
+        return -1;
+    }
+
+    plant->power[node] = watts;
+    return 0;
+}
+
+static void plant_substep(plant_t *plant, float h)
+{
+    float flow[PLANT_MAX_NODES];   /* Heat from node i to node i+1, W */
+    int n = plant->num_nodes;
+
+    for (int i = 0; i < n - 1; i++) {
+        flow[i] = plant->params[i].coupling_conductance * (plant->temp[i] - plant->temp[i + 1]);
+    }
+
+    for (int i = 0; i < n; i++) {
+        float q = plant->power[i] - plant->params[i].loss_conductance * plant->temp[i];
+
+        if (i < n - 1) {
+            q -= flow[i];
+        }
+        if (i > 0) {
+            q += flow[i - 1];
+        }
+        plant->temp[i] += q * h / plant->params[i].heat_capacity;
+    }
+}
+
+void plant_step(plant_t *plant, float dt_seconds)
+{
+    if (plant == NULL || dt_seconds <= 0.0f) {
+        return;
+    }
+
+    int steps = (int)ceilf(dt_seconds / plant->max_step_s);
+
+    if (steps < 1) {
+        steps = 1;
+    }
+
+    float h = dt_seconds / (float)steps;
+
+    for (int s = 0; s < steps; s++) {
+        plant_substep(plant, h);
+    }
+}
+
+float plant_temperature(const plant_t *plant, int node)
+{
+    if (plant == NULL || node < 0 || node >= plant->num_nodes) {
+        return plant != NULL ? plant->ambient_kelvin : 0.0f;
+    }
+
+    return plant->ambient_kelvin + plant->temp[node];
+}
@@ -0,0 +1,61 @@
+/**
+ * @file plant.h
+ * @brief Lumped RC thermal network for the plant simulator
+ *
+ * Nodes form a chain: each node has a heat capacity, a loss conductance
+ * to ambient and a coupling conductance to the next node. Temperatures
+ * are held as offsets from ambient, in Kelvin.
+ */
+
+#ifndef PLANT_H
+#define PLANT_H
+
+#include <stdint.h>
+
+#define PLANT_MAX_NODES 16
+
+typedef struct {
+    float heat_capacity;          /* J/K */
+    float loss_conductance;       /* W/K to ambient */
+    float coupling_conductance;   /* W/K to the next node (ignored on the last) */
+} plant_node_params_t;
+
+typedef struct {
+    int num_nodes;
+    float ambient_kelvin;
+    float max_step_s;             /* Stable explicit Euler step, set by plant_init() */
+    plant_node_params_t params[PLANT_MAX_NODES];
+    float temp[PLANT_MAX_NODES];  /* Kelvin above ambient */
+    float power[PLANT_MAX_NODES]; /* Watts into each node */
+} plant_t;
+
+/**
+ * Set up a plant at ambient temperature with no power applied
+ * @param plant Plant to initialize
+ * @param params Per-node parameters
+ * @param num_nodes Number of nodes (1..PLANT_MAX_NODES)
+ * @param ambient_kelvin Ambient temperature
+ * @return 0 on success, -1 on invalid parameters
+ */
+int plant_init(plant_t *plant, const plant_node_params_t params[], int num_nodes,
+               float ambient_kelvin);
+
+/**
+ * Set the heater power into one node
+ * @return 0 on success, -1 on invalid node
+ */
+int plant_set_power(plant_t *plant, int node, float watts);
+
+/**
+ * Advance the plant by dt seconds
+ * Splits dt into substeps short enough for explicit Euler to stay stable.
+ */
+void plant_step(plant_t *plant, float dt_seconds);
+
+/**
+ * Get a node's absolute temperature
+ * @return temperature in Kelvin, ambient for an invalid node
+ */
+float plant_temperature(const plant_t *plant, int node);
+
+#endif /* PLANT_H */
@@ -0,0 +1,100 @@
+/**
+ * @file sim_adc.c
+ * @brief Simulated AD7124 for the plant simulator
+ *
+ * Behavioral, not register-level: a conversion returns whatever code the
+ * application's source computes for the channel, in the same signed
+ * 24-bit bipolar format the AD7124 driver produces.
+ */
+
+#define DT_DRV_COMPAT coo_sim_adc
+
+#include "sim_hw.h"
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/logging/log.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(sim_adc, LOG_LEVEL_INF);
+
+#define SIM_ADC_MAX_CHANNELS 16
+#define SIM_ADC_RESOLUTION   24
+
+struct sim_adc_data {
+    sim_adc_source_t source;
+    void *user_data;
+    uint32_t configured;      /* Bit per set-up channel */
+    uint32_t conversions;
+};
+
+static int sim_adc_channel_setup(const struct device *dev,
+                                 const struct adc_channel_cfg *channel_cfg)
+{
+    struct sim_adc_data *data = dev->data;
+
+    if (channel_cfg->channel_id >= SIM_ADC_MAX_CHANNELS) {
+        return -EINVAL;
+    }
+
+    data->configured |= BIT(channel_cfg->channel_id);
+    return 0;
+}
+
+static int sim_adc_read(const struct device *dev, const struct adc_sequence *sequence)
+{
+    struct sim_adc_data *data = dev->data;
+    int32_t *out = sequence->buffer;
+    size_t needed = 0;
+
+    if (sequence->resolution != 0 && sequence->resolution != SIM_ADC_RESOLUTION) {
+        return -EINVAL;
+    }
+    if (sequence->channels == 0 || (sequence->channels & ~data->configured) != 0) {
+        return -EINVAL;
+    }
+    if (data->source == NULL) {
+        return -EIO;
+    }
+
+    needed = (size_t)POPCOUNT(sequence->channels) * sizeof(int32_t);
+    if (sequence->buffer_size < needed) {
+        return -ENOMEM;
+    }
+
+    for (uint8_t ch = 0; ch < SIM_ADC_MAX_CHANNELS; ch++) {
+        if ((sequence->channels & BIT(ch)) != 0) {
+            *out++ = data->source(dev, ch, data->user_data);
+            data->conversions++;
+        }
+    }
+    return 0;
+}
+
+void sim_adc_set_source(const struct device *dev, sim_adc_source_t source, void *user_data)
+{
+    struct sim_adc_data *data = dev->data;
+
+    data->source = source;
+    data->user_data = user_data;
+}
+
+uint32_t sim_adc_conversions(const struct device *dev)
+{
+    const struct sim_adc_data *data = dev->data;
+
+    return data->conversions;
+}
+
+static const struct adc_driver_api sim_adc_api = {
+    .channel_setup = sim_adc_channel_setup,
+    .read = sim_adc_read,
+    .ref_internal = 2500,
+};
+
+#define SIM_ADC_DEFINE(inst)                                                \
+    static struct sim_adc_data sim_adc_data_##inst;                         \
+    DEVICE_DT_INST_DEFINE(inst, NULL, NULL, &sim_adc_data_##inst, NULL,     \
+                          POST_KERNEL, CONFIG_ADC_INIT_PRIORITY,            \
+                          &sim_adc_api);
+
+DT_INST_FOREACH_STATUS_OKAY(SIM_ADC_DEFINE)
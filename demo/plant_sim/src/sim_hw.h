@@ -0,0 +1,35 @@
+/**
+ * @file sim_hw.h
+ * @brief Simulated ADC and heater supply drivers for the plant simulator
+ *
+ * The drivers implement the Zephyr ADC and regulator APIs, so the sensor
+ * and heater managers run against them unchanged.
+ */
+
+#ifndef SIM_HW_H
+#define SIM_HW_H
+
+#include <stdint.h>
+#include <zephyr/device.h>
+
+/**
+ * Produce the raw code for one ADC channel
+ * Called from adc_read() on the reading thread.
+ */
+typedef int32_t (*sim_adc_source_t)(const struct device *dev, uint8_t channel, void *user_data);
+
+/**
+ * Route a simulated ADC's conversions to a code source
+ * Without a source every conversion fails with -EIO.
+ * @param dev coo,sim-adc device
+ * @param source Code source, NULL to detach
+ * @param user_data Passed to source
+ */
+void sim_adc_set_source(const struct device *dev, sim_adc_source_t source, void *user_data);
+
+/**
+ * Count of conversions since boot, for checking that reads hit the ADC
+ */
+uint32_t sim_adc_conversions(const struct device *dev);
+
+#endif /* SIM_HW_H */
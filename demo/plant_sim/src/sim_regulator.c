@@ -0,0 +1,86 @@
+/**
+ * @file sim_regulator.c
+ * @brief Simulated TPS55287-Q1 heater supply for the plant simulator
+ *
+ * Behavioral: holds the commanded voltage and enable state for the plant
+ * model to read back through regulator_get_voltage() and
+ * regulator_is_enabled(). Voltage limits come from the common regulator
+ * properties, as on the real part.
+ */
+
+#define DT_DRV_COMPAT coo_sim_regulator
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/regulator.h>
+#include <zephyr/logging/log.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(sim_regulator, LOG_LEVEL_INF);
+
+struct sim_regulator_config {
+    struct regulator_common_config common;
+};
+
+struct sim_regulator_data {
+    struct regulator_common_data common;
+    int32_t volt_uv;
+};
+
+static int sim_regulator_enable(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+    return 0;
+}
+
+static int sim_regulator_disable(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+    return 0;
+}
+
+static int sim_regulator_set_voltage(const struct device *dev, int32_t min_uv, int32_t max_uv)
+{
+    struct sim_regulator_data *data = dev->data;
+
+    if (min_uv > max_uv) {
+        return -EINVAL;
+    }
+
+    data->volt_uv = min_uv;
+    return 0;
+}
+
+static int sim_regulator_get_voltage(const struct device *dev, int32_t *volt_uv)
+{
+    const struct sim_regulator_data *data = dev->data;
+
+    *volt_uv = data->volt_uv;
+    return 0;
+}
+
+static const struct regulator_driver_api sim_regulator_api = {
+    .enable = sim_regulator_enable,
+    .disable = sim_regulator_disable,
+    .set_voltage = sim_regulator_set_voltage,
+    .get_voltage = sim_regulator_get_voltage,
+};
+
+static int sim_regulator_init(const struct device *dev)
+{
+    regulator_common_data_init(dev);
+
+    return regulator_common_init(dev, false);
+}
+
+#define SIM_REGULATOR_DEFINE(inst)                                          \
+    static struct sim_regulator_data sim_regulator_data_##inst;             \
+    static const struct sim_regulator_config sim_regulator_config_##inst = { \
+        .common = REGULATOR_DT_INST_COMMON_CONFIG_INIT(inst),               \
+    };                                                                      \
+    DEVICE_DT_INST_DEFINE(inst, sim_regulator_init, NULL,                   \
+                          &sim_regulator_data_##inst,                       \
+                          &sim_regulator_config_##inst,                     \
+                          POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,  \
+                          &sim_regulator_api);
+
+DT_INST_FOREACH_STATUS_OKAY(SIM_REGULATOR_DEFINE)
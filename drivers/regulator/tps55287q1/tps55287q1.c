@@ -11,22 +11,294 @@
 
 LOG_MODULE_REGISTER(tps55287q1, CONFIG_REGULATOR_TPS55287Q1_LOG_LEVEL);
 
+/*
+ * Register shadow cache. Every register below STATUS is written only by
+ * this driver, so once a value is known it is served from data->shadow
+ * and writes go straight to the bus without a read first. STATUS is
+ * volatile and always read from the chip. The cache is dropped on a bus
+ * error and by tps55287q1_invalidate_cache() (fault handling), after
+ * which the next access re-reads the chip. The helpers take data->lock
+ * (recursive), so a caller can hold it across several of them.
+ *
+ * While tps55287q1_force_off() holds the chip powered down, writes land
+ * in the shadow only and reads of uncached registers fail with -EAGAIN;
+ * tps55287q1_power_up() replays the shadow when the chip comes back.
+ */
+static inline bool tps55287q1_cacheable(uint8_t reg) {
+	return reg < TPS55287Q1_REG_STATUS;
+}
+
 static int tps55287q1_reg_read(const struct device *dev, uint8_t reg, uint8_t *val) {
 	const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
+	int ret;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	if (tps55287q1_cacheable(reg) && atomic_test_bit(&data->shadow_valid, reg)) {
+		*val = data->shadow[reg];
+		k_mutex_unlock(&data->lock);
+		return 0;
+	}
+
+	if (atomic_get(&data->forced_off)) {
+		k_mutex_unlock(&data->lock);
+		return -EAGAIN;
+	}
+
+	ret = i2c_reg_read_byte_dt(&cfg->i2c, reg, val);
+	if (ret == 0 && tps55287q1_cacheable(reg)) {
+		data->shadow[reg] = *val;
+		atomic_set_bit(&data->shadow_valid, reg);
+	}
+
+	k_mutex_unlock(&data->lock);
 
-	return i2c_reg_read_byte_dt(&cfg->i2c, reg, val);
+	return ret;
 }
 
 static int tps55287q1_reg_write(const struct device *dev, uint8_t reg, uint8_t val){
 	const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
+	int ret;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	if (tps55287q1_cacheable(reg) && atomic_get(&data->forced_off)) {
+		/* Replayed by tps55287q1_power_up() */
+		data->shadow[reg] = val;
+		atomic_set_bit(&data->shadow_valid, reg);
+		k_mutex_unlock(&data->lock);
+		return 0;
+	}
 
-	return i2c_reg_write_byte_dt(&cfg->i2c, reg, val);
+	ret = i2c_reg_write_byte_dt(&cfg->i2c, reg, val);
+	if (ret < 0) {
+		/* The chip may or may not have taken it */
+		atomic_clear_bit(&data->shadow_valid, reg);
+	} else if (tps55287q1_cacheable(reg)) {
+		data->shadow[reg] = val;
+		atomic_set_bit(&data->shadow_valid, reg);
+	}
+
+	k_mutex_unlock(&data->lock);
+
+	return ret;
 }
 
 static int tps55287q1_update_bits(const struct device *dev, uint8_t reg, uint8_t mask, uint8_t value) {
-    const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
+	uint8_t old;
+	int ret;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	/* Cached after the first access, so this is normally a write-only update */
+	ret = tps55287q1_reg_read(dev, reg, &old);
+	if (ret == 0) {
+		uint8_t new_val = (old & ~mask) | (value & mask);
+
+		if (new_val != old || !tps55287q1_cacheable(reg)) {
+			ret = tps55287q1_reg_write(dev, reg, new_val);
+		}
+	}
+
+	k_mutex_unlock(&data->lock);
+
+	return ret;
+}
+
+void tps55287q1_invalidate_cache(const struct device *dev) {
+	struct tps55287q1_data *data = dev->data;
+
+	/* Lock-free so it can be called from the fault ISR */
+	atomic_clear(&data->shadow_valid);
+}
+
+int tps55287q1_force_off(const struct device *dev) {
+	const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
+
+	if (cfg->en_gpio.port == NULL) {
+		return -ENOTSUP;
+	}
+
+	/* Flag first, so a power-up racing this sees it and drops EN again */
+	atomic_set(&data->forced_off, 1);
+
+	return gpio_pin_set_dt(&cfg->en_gpio, 0);
+}
+
+/*
+ * Chip setup that does not come from the regulator API: feedback ratio,
+ * output off, and SCP/OCP/OVP routed to INT when it is wired. Written at
+ * init and again after a forced power-down, in case the shadow lost it.
+ */
+static int tps55287q1_setup(const struct device *dev) {
+	const struct tps55287q1_config *cfg = dev->config;
+	uint8_t fs_val = cfg->intfb & TPS55287Q1_VOUT_FS_INTFB;
+	int ret;
+
+	ret = tps55287q1_update_bits(dev, TPS55287Q1_REG_VOUT_FS, TPS55287Q1_VOUT_FS_FB | TPS55287Q1_VOUT_FS_INTFB, fs_val);
+	if (ret < 0) {
+		LOG_ERR("%s: Failed to configure VOUT_FS register: %d", dev->name, ret);
+		return ret;
+	}
+
+	ret = tps55287q1_update_bits(dev, TPS55287Q1_REG_MODE, TPS55287Q1_MODE_OE, 0);
+	if (ret < 0) {
+		LOG_ERR("%s: Failed to disable regulator: %d", dev->name, ret);
+		return ret;
+	}
+
+	if (cfg->int_gpio.port == NULL) {
+		return 0;
+	}
+
+	ret = tps55287q1_update_bits(dev, TPS55287Q1_REG_CDC,
+				     TPS55287Q1_CDC_SC_MASK | TPS55287Q1_CDC_OCP_MASK | TPS55287Q1_CDC_OVP_MASK,
+				     TPS55287Q1_CDC_SC_MASK | TPS55287Q1_CDC_OCP_MASK | TPS55287Q1_CDC_OVP_MASK);
+	if (ret < 0) {
+		LOG_ERR("%s: Failed to enable fault indication: %d", dev->name, ret);
+	}
+
+	return ret;
+}
+
+/*
+ * Undo tps55287q1_force_off(): raise EN, then replay every register the
+ * shadow knows with OE clear, so the chip is back as the driver left it
+ * before the caller sets OE. On failure, or if another cut lands while
+ * this runs, EN goes low again and the next enable retries from scratch.
+ * Caller holds data->lock.
+ */
+static int tps55287q1_power_up(const struct device *dev) {
+	const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
+	int ret;
+
+	if (!atomic_cas(&data->forced_off, 1, 0)) {
+		return 0;
+	}
+
+	ret = gpio_pin_set_dt(&cfg->en_gpio, 1);
+	if (ret == 0) {
+		k_usleep(TPS55287Q1_EN_STARTUP_US);
+	}
+
+	data->shadow[TPS55287Q1_REG_MODE] &= ~TPS55287Q1_MODE_OE;
+	for (uint8_t reg = 0; ret == 0 && reg < TPS55287Q1_REG_STATUS; reg++) {
+		if (atomic_test_bit(&data->shadow_valid, reg)) {
+			ret = i2c_reg_write_byte_dt(&cfg->i2c, reg, data->shadow[reg]);
+		}
+	}
+	if (ret == 0) {
+		ret = tps55287q1_setup(dev);
+	}
+
+	if (ret < 0 || atomic_get(&data->forced_off)) {
+		atomic_set(&data->forced_off, 1);
+		(void)gpio_pin_set_dt(&cfg->en_gpio, 0);
+		LOG_ERR("%s: Failed to power up after forced cut: %d", dev->name, ret);
+		return (ret < 0) ? ret : -EAGAIN;
+	}
+
+	return 0;
+}
+
+/* INT asserted: registers may have been reset, and STATUS needs I2C, so defer */
+static void tps55287q1_int_isr(const struct device *port, struct gpio_callback *cb,
+			       gpio_port_pins_t pins) {
+	struct tps55287q1_data *data = CONTAINER_OF(cb, struct tps55287q1_data, int_cb);
+
+	ARG_UNUSED(port);
+	ARG_UNUSED(pins);
+
+	tps55287q1_invalidate_cache(data->dev);
+	k_work_submit(&data->fault_work);
+}
+
+static void tps55287q1_fault_work(struct k_work *work) {
+	struct tps55287q1_data *data = CONTAINER_OF(work, struct tps55287q1_data, fault_work);
+	const struct device *dev = data->dev;
+	uint8_t status;
+	int ret;
+
+	/* Reading STATUS clears the latched fault bits and releases INT */
+	ret = tps55287q1_reg_read(dev, TPS55287Q1_REG_STATUS, &status);
+	if (ret < 0) {
+		LOG_ERR("%s: Failed to read STATUS after fault: %d", dev->name, ret);
+		return;
+	}
+
+	data->last_status = status;
+
+	if ((status & TPS55287Q1_STATUS_FAULTS) == 0U) {
+		return;
+	}
+
+	LOG_WRN("%s: fault%s%s%s", dev->name,
+		(status & TPS55287Q1_STATUS_SCP) ? " SCP" : "",
+		(status & TPS55287Q1_STATUS_OCP) ? " OCP" : "",
+		(status & TPS55287Q1_STATUS_OVP) ? " OVP" : "");
+
+	tps55287q1_fault_handler_t handler = data->fault_handler;
+
+	if (handler != NULL) {
+		handler(dev, status, data->fault_user_data);
+	}
+}
+
+int tps55287q1_set_fault_handler(const struct device *dev, tps55287q1_fault_handler_t handler,
+				 void *user_data) {
+	const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
+
+	if (cfg->int_gpio.port == NULL) {
+		return -ENOTSUP;
+	}
+
+	unsigned int key = irq_lock();
+
+	data->fault_handler = handler;
+	data->fault_user_data = user_data;
+	irq_unlock(key);
+
+	return 0;
+}
+
+static int tps55287q1_init_int(const struct device *dev) {
+	const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
+	int ret;
+
+	if (cfg->int_gpio.port == NULL) {
+		return 0;
+	}
+
+	if (!gpio_is_ready_dt(&cfg->int_gpio)) {
+		LOG_ERR("%s: INT GPIO not ready", dev->name);
+		return -ENODEV;
+	}
+
+	/* SCP, OCP and OVP were routed to the pin by tps55287q1_setup() */
+	k_work_init(&data->fault_work, tps55287q1_fault_work);
+
+	ret = gpio_pin_configure_dt(&cfg->int_gpio, GPIO_INPUT);
+	if (ret < 0) {
+		return ret;
+	}
+
+	gpio_init_callback(&data->int_cb, tps55287q1_int_isr, BIT(cfg->int_gpio.pin));
+	ret = gpio_add_callback_dt(&cfg->int_gpio, &data->int_cb);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* Clear anything latched before we were listening */
+	(void)tps55287q1_reg_read(dev, TPS55287Q1_REG_STATUS, &data->last_status);
 
-    return i2c_reg_update_byte_dt(&cfg->i2c, reg, mask, value);
+	return gpio_pin_interrupt_configure_dt(&cfg->int_gpio, GPIO_INT_EDGE_TO_ACTIVE);
 }
 
 static int tps55287q1_voltage_to_adc(const struct tps55287q1_config *cfg, int32_t vout_uv, uint16_t *adc) {
@@ -76,9 +348,15 @@ static int tps55287q1_adc_to_voltage(const struct tps55287q1_config *cfg, uint16
 
 /* --- regulator API callbacks --- */
 static int regulator_tps55287q1_enable(const struct device *dev) {
+    struct tps55287q1_data *data = dev->data;
     int ret;
 
-    ret = tps55287q1_update_bits(dev, TPS55287Q1_REG_MODE, TPS55287Q1_MODE_OE, TPS55287Q1_MODE_OE);
+    k_mutex_lock(&data->lock, K_FOREVER);
+    ret = tps55287q1_power_up(dev);
+    if (ret == 0) {
+        ret = tps55287q1_update_bits(dev, TPS55287Q1_REG_MODE, TPS55287Q1_MODE_OE, TPS55287Q1_MODE_OE);
+    }
+    k_mutex_unlock(&data->lock);
     if (ret < 0) {
         LOG_ERR("Failed to enable regulator: %d", ret);
 		return ret;
@@ -88,9 +366,15 @@ static int regulator_tps55287q1_enable(const struct device *dev) {
 }
 
 static int regulator_tps55287q1_disable(const struct device *dev) {	
-    int ret;
+    struct tps55287q1_data *data = dev->data;
+    int ret = 0;
 
-    ret = tps55287q1_update_bits(dev, TPS55287Q1_REG_MODE, TPS55287Q1_MODE_OE, 0);
+    k_mutex_lock(&data->lock, K_FOREVER);
+    /* After a forced cut the output is already off, and power-up clears OE */
+    if (!atomic_get(&data->forced_off)) {
+        ret = tps55287q1_update_bits(dev, TPS55287Q1_REG_MODE, TPS55287Q1_MODE_OE, 0);
+    }
+    k_mutex_unlock(&data->lock);
     if (ret < 0) {
 		LOG_ERR("Failed to disable regulator: %d", ret);
         return ret;
@@ -101,6 +385,7 @@ static int regulator_tps55287q1_disable(const struct device *dev) {
 
 static int regulator_tps55287q1_set_voltage(const struct device *dev, int32_t min_uv, int32_t max_uv) {
 	const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
 
 	uint16_t adc;
 	int ret;
@@ -111,39 +396,56 @@ static int regulator_tps55287q1_set_voltage(const struct device *dev, int32_t mi
 		return ret;
 	}
 
-	uint8_t lsb = adc & 0xFF;
-	uint8_t msb = (adc >> 8) & 0x07;
+	uint8_t buf[2] = { adc & 0xFF, (adc >> 8) & 0x07 };
+	const atomic_val_t vref_bits = BIT(TPS55287Q1_REG_VREF_LSB) | BIT(TPS55287Q1_REG_VREF_MSB);
 
-	ret = tps55287q1_reg_write(dev, TPS55287Q1_REG_VREF_LSB, lsb);
-	if (ret < 0) {
-		LOG_ERR("Failed to write LSB: %d", ret);
-		return ret;
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	/* Same DAC code as last programmed: nothing to send */
+	if ((atomic_get(&data->shadow_valid) & vref_bits) == vref_bits &&
+	    data->shadow[TPS55287Q1_REG_VREF_LSB] == buf[0] &&
+	    data->shadow[TPS55287Q1_REG_VREF_MSB] == buf[1]) {
+		k_mutex_unlock(&data->lock);
+		return 0;
 	}
 
-	ret = tps55287q1_reg_write(dev, TPS55287Q1_REG_VREF_MSB, msb);
+	/* LSB then MSB in one auto-increment burst; the DAC latches on the MSB */
+	ret = atomic_get(&data->forced_off) ? 0 :
+	      i2c_burst_write_dt(&cfg->i2c, TPS55287Q1_REG_VREF_LSB, buf, sizeof(buf));
 	if (ret < 0) {
-		LOG_ERR("Failed to write MSB: %d", ret);
+		atomic_and(&data->shadow_valid, ~vref_bits);
+		k_mutex_unlock(&data->lock);
+		LOG_ERR("Failed to write VREF: %d", ret);
 		return ret;
 	}
 
+	data->shadow[TPS55287Q1_REG_VREF_LSB] = buf[0];
+	data->shadow[TPS55287Q1_REG_VREF_MSB] = buf[1];
+	atomic_or(&data->shadow_valid, vref_bits);
+
+	k_mutex_unlock(&data->lock);
+
 	return 0;
 }
 
 static int regulator_tps55287q1_get_voltage(const struct device *dev, int32_t *volt_uv) {
 	const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
 
 	uint8_t lsb, msb;
 	uint16_t code;
 	int ret;
 
+	/* Both halves under one lock so a concurrent set_voltage can't tear them */
+	k_mutex_lock(&data->lock, K_FOREVER);
 	ret = tps55287q1_reg_read(dev, TPS55287Q1_REG_VREF_LSB, &lsb);
-	if (ret < 0) {
-		LOG_ERR("Failed to read LSB: %d", ret);
-		return ret;
+	if (ret == 0) {
+		ret = tps55287q1_reg_read(dev, TPS55287Q1_REG_VREF_MSB, &msb);
 	}
-	ret = tps55287q1_reg_read(dev, TPS55287Q1_REG_VREF_MSB, &msb);
+	k_mutex_unlock(&data->lock);
+
 	if (ret < 0) {
-		LOG_ERR("Failed to read MSB: %d", ret);
+		LOG_ERR("Failed to read VREF: %d", ret);
 		return ret;
 	}
 
@@ -259,6 +561,34 @@ static int regulator_tps55287q1_get_active_discharge(const struct device *dev, b
 	return 0;
 }
 
+static int regulator_tps55287q1_get_error_flags(const struct device *dev,
+						regulator_error_flags_t *flags) {
+	struct tps55287q1_data *data = dev->data;
+	const struct tps55287q1_config *cfg = dev->config;
+	uint8_t status;
+	int ret;
+
+	/* With INT wired, the fault work keeps last_status current */
+	if (cfg->int_gpio.port != NULL) {
+		status = data->last_status;
+	} else {
+		ret = tps55287q1_reg_read(dev, TPS55287Q1_REG_STATUS, &status);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	*flags = 0;
+	if (status & (TPS55287Q1_STATUS_SCP | TPS55287Q1_STATUS_OCP)) {
+		*flags |= REGULATOR_ERROR_OVER_CURRENT;
+	}
+	if (status & TPS55287Q1_STATUS_OVP) {
+		*flags |= REGULATOR_ERROR_OVER_VOLTAGE;
+	}
+
+	return 0;
+}
+
 static const struct regulator_driver_api tps55287q1_regulator_api = {
 	.enable              = regulator_tps55287q1_enable,
 	.disable             = regulator_tps55287q1_disable,
@@ -268,10 +598,12 @@ static const struct regulator_driver_api tps55287q1_regulator_api = {
 	.get_current_limit   = regulator_tps55287q1_get_current_limit,
 	.set_active_discharge = regulator_tps55287q1_set_active_discharge,
 	.get_active_discharge = regulator_tps55287q1_get_active_discharge,
+	.get_error_flags     = regulator_tps55287q1_get_error_flags,
 };
 
 static int tps55287q1_init(const struct device *dev) {
 	const struct tps55287q1_config *cfg = dev->config;
+	struct tps55287q1_data *data = dev->data;
 
 	int ret;
 
@@ -281,20 +613,43 @@ static int tps55287q1_init(const struct device *dev) {
 	}
 
 	regulator_common_data_init(dev);
+	k_mutex_init(&data->lock);
+	data->dev = dev;
 
-	uint8_t fs_val = cfg->intfb & TPS55287Q1_VOUT_FS_INTFB;
-	ret = tps55287q1_update_bits(dev, TPS55287Q1_REG_VOUT_FS, TPS55287Q1_VOUT_FS_FB | TPS55287Q1_VOUT_FS_INTFB, fs_val);
+	if (cfg->en_gpio.port != NULL) {
+		if (!gpio_is_ready_dt(&cfg->en_gpio)) {
+			LOG_ERR("%s: EN GPIO not ready", dev->name);
+			return -ENODEV;
+		}
+		/* EN high powers the chip up; the output stays off until OE is set */
+		ret = gpio_pin_configure_dt(&cfg->en_gpio, GPIO_OUTPUT_ACTIVE);
+		if (ret < 0) {
+			LOG_ERR("%s: Failed to configure EN GPIO: %d", dev->name, ret);
+			return ret;
+		}
+		k_busy_wait(TPS55287Q1_EN_STARTUP_US);
+	}
+
+	/* Prime the shadow cache with one burst read of every cacheable register */
+	ret = i2c_burst_read_dt(&cfg->i2c, TPS55287Q1_REG_VREF_LSB, data->shadow,
+				sizeof(data->shadow));
 	if (ret < 0) {
-		LOG_ERR("%s: Failed to configure VOUT_FS register: %d", dev->name, ret);
+		LOG_ERR("%s: Failed to read registers: %d", dev->name, ret);
 		return ret;
 	}
+	atomic_set(&data->shadow_valid, BIT_MASK(TPS55287Q1_REG_STATUS));
 
-    /* Disable regulator by default */
-    ret = tps55287q1_update_bits(dev, TPS55287Q1_REG_MODE, TPS55287Q1_MODE_OE, 0);
-    if (ret < 0) {
-        LOG_ERR("%s: Failed to disable regulator: %d", dev->name, ret);
-        return ret;
-    }
+	/* Output disabled by default */
+	ret = tps55287q1_setup(dev);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = tps55287q1_init_int(dev);
+	if (ret < 0) {
+		LOG_ERR("%s: Failed to set up fault interrupt: %d", dev->name, ret);
+		return ret;
+	}
 
 	ret = regulator_common_init(dev, false);
 	if (ret < 0) {
@@ -314,6 +669,8 @@ static int tps55287q1_init(const struct device *dev) {
         .intfb       = DT_INST_PROP_OR(inst, intfb, 3),                       		\
         .force_discharge = DT_INST_PROP_OR(inst, force_discharge, false),       	\
 		.r_sense_uohm = DT_INST_PROP_OR(inst, r_sense_uohm, 0),                   	\
+		.int_gpio    = GPIO_DT_SPEC_INST_GET_OR(inst, int_gpios, {0}),             	\
+		.en_gpio     = GPIO_DT_SPEC_INST_GET_OR(inst, enable_gpios, {0}),          	\
     };                                                                            	\
                                                                                   	\
     DEVICE_DT_INST_DEFINE(inst,                                                   	\
@@ -6,6 +6,7 @@
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/regulator.h>
+#include <zephyr/sys/atomic.h>
 
 /* TPS55287-Q1 register maps */
 #define TPS55287Q1_REG_VREF_LSB             0x00
@@ -62,16 +63,106 @@
 #define TPS55287Q1_STATUS_OVP		    	BIT(5)
 #define TPS55287Q1_STATUS_STATUS		    GENMASK(1, 0)
 
+/* EN high to the I2C interface answering */
+#define TPS55287Q1_EN_STARTUP_US	1000
+
+/* STATUS bits that the INT pin reports */
+#define TPS55287Q1_STATUS_FAULTS	(TPS55287Q1_STATUS_SCP | TPS55287Q1_STATUS_OCP | TPS55287Q1_STATUS_OVP)
+
+/**
+ * @brief Fault notification callback.
+ *
+ * Runs in the system workqueue after the INT line asserted and STATUS
+ * was read (which also clears the latched fault bits in the chip).
+ *
+ * @param dev TPS55287-Q1 regulator device.
+ * @param status STATUS register value (TPS55287Q1_STATUS_* bits).
+ * @param user_data Pointer given to tps55287q1_set_fault_handler().
+ */
+typedef void (*tps55287q1_fault_handler_t)(const struct device *dev, uint8_t status,
+					   void *user_data);
+
 struct tps55287q1_config {
 	struct regulator_common_config common;
 	struct i2c_dt_spec i2c;
 	uint8_t intfb;
 	bool force_discharge;
 	uint32_t r_sense_uohm;
+	struct gpio_dt_spec int_gpio;
+	struct gpio_dt_spec en_gpio;
 };
 
 struct tps55287q1_data {
 	struct regulator_common_data common;
+	/* Serializes register access and shadow updates */
+	struct k_mutex lock;
+	/* Last known value of each register below STATUS */
+	uint8_t shadow[TPS55287Q1_REG_STATUS];
+	/* Bit n set: shadow[n] matches the chip */
+	atomic_t shadow_valid;
+	/* Fault INT handling */
+	const struct device *dev;
+	struct gpio_callback int_cb;
+	struct k_work fault_work;
+	tps55287q1_fault_handler_t fault_handler;
+	void *fault_user_data;
+	uint8_t last_status;
+	/* 1: EN pulled low by tps55287q1_force_off(), chip powered down */
+	atomic_t forced_off;
 };
 
+/**
+ * @brief Drop the register shadow cache.
+ *
+ * The next access to each register reads it back from the chip. Call this
+ * when the chip may have reset its registers behind the driver's back (a
+ * fault, an undervoltage). Safe from ISR context.
+ *
+ * @param dev TPS55287-Q1 regulator device.
+ */
+void tps55287q1_invalidate_cache(const struct device *dev);
+
+/**
+ * @brief Cut the output at once, outside the regulator API.
+ *
+ * Pulls the EN pin (enable-gpios) low. This takes no lock, does no I2C
+ * transfer and leaves the regulator enable count alone, so it is safe from
+ * ISR context and while another thread is inside the driver. The chip
+ * stays off until the next regulator_enable(), which powers it back up and
+ * replays the registers the driver last wrote. Until then, register writes
+ * only update the driver's copy, and regulator_disable() succeeds without
+ * touching the bus.
+ *
+ * @param dev TPS55287-Q1 regulator device.
+ * @retval 0 Success.
+ * @retval -ENOTSUP The device has no enable-gpios.
+ * @retval -errno GPIO error.
+ */
+int tps55287q1_force_off(const struct device *dev);
+
+/**
+ * @brief tps55287q1_force_off for a TPS55287-Q1 node with enable-gpios,
+ *        NULL for any other regulator node.
+ */
+#define TPS55287Q1_DT_FORCE_OFF_OR_NULL(node)                                           \
+	COND_CODE_1(UTIL_AND(DT_NODE_HAS_COMPAT(node, ti_tps55287q1),                     \
+			     DT_NODE_HAS_PROP(node, enable_gpios)),                       \
+		    (tps55287q1_force_off), (NULL))
+
+/**
+ * @brief Register a callback for SCP/OCP/OVP faults.
+ *
+ * Faults are reported through the chip's INT pin (int-gpios in the
+ * devicetree), so nothing polls STATUS. Only one handler per device;
+ * a later call replaces it, and NULL removes it.
+ *
+ * @param dev TPS55287-Q1 regulator device.
+ * @param handler Callback, or NULL.
+ * @param user_data Passed back to the callback.
+ * @retval 0 Success.
+ * @retval -ENOTSUP The device has no int-gpios.
+ */
+int tps55287q1_set_fault_handler(const struct device *dev, tps55287q1_fault_handler_t handler,
+				 void *user_data);
+
 #endif /* ZEPHYR_DRIVERS_REGULATOR_TPS55287Q1_H_ */
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COO_COMMONS_BACKOFF_H
+#define COO_COMMONS_BACKOFF_H
+
+#include <stdint.h>
+#include <zephyr/random/random.h>
+
+/**
+ * @file backoff.h
+ * @brief Jittered exponential retry delay.
+ *
+ * Each failed attempt doubles the delay ceiling, up to a cap, and the delay
+ * actually used is drawn uniformly from the upper half of the ceiling. The
+ * jitter keeps a fleet of devices that lost the same broker or link at the
+ * same moment from retrying in lockstep.
+ */
+
+struct coo_backoff {
+	uint32_t min_ms;
+	uint32_t max_ms;
+	/* Ceiling for the next delay */
+	uint32_t next_ms;
+};
+
+/** Initializer for a backoff starting at @p _min_ms and capped at @p _max_ms */
+#define COO_BACKOFF_INIT(_min_ms, _max_ms)                                        \
+	{ .min_ms = (_min_ms), .max_ms = (_max_ms), .next_ms = (_min_ms) }
+
+/** Start over from the shortest delay, normally after a success. */
+static inline void coo_backoff_reset(struct coo_backoff *b)
+{
+	b->next_ms = b->min_ms;
+}
+
+/** Delay before the next attempt, in [ceiling / 2, ceiling]; doubles the ceiling. */
+static inline uint32_t coo_backoff_next(struct coo_backoff *b)
+{
+	uint32_t ceiling = b->next_ms;
+	uint32_t half = ceiling / 2U;
+
+	b->next_ms = (ceiling >= b->max_ms / 2U) ? b->max_ms : ceiling * 2U;
+
+	return half + sys_rand32_get() % (ceiling - half + 1U);
+}
+
+#endif /* COO_COMMONS_BACKOFF_H */
@@ -47,6 +47,12 @@ struct nvs_fs;
 #define COO_CMD_SERIAL_LINE_MAX 128
 #endif
 
+#if defined(CONFIG_COO_CMD_SPEC_INDEX_SIZE)
+#define COO_CMD_SPEC_INDEX_MAX CONFIG_COO_CMD_SPEC_INDEX_SIZE
+#else
+#define COO_CMD_SPEC_INDEX_MAX 32
+#endif
+
 #if defined(CONFIG_COO_CMD_PAYLOAD_SIZE)
 #define COO_CMD_PAYLOAD_MAX CONFIG_COO_CMD_PAYLOAD_SIZE
 #else
@@ -100,9 +106,17 @@ enum coo_cmd_class_policy {
 	COO_CMD_CLASS_CUSTOM,
 };
 
+struct coo_cmd_spec;
+
 struct coo_cmd_request {
 	enum coo_cmd_msg_type msg_type;
 	enum coo_cmd_source source;
+	/*
+	 * Spec matched by key, resolved once by the runtime at ingress so
+	 * classification, validation and execution do not search again.
+	 * NULL for built-ins, unknown keys and requests built by hand.
+	 */
+	const struct coo_cmd_spec *spec;
 	char key[COO_CMD_KEY_MAX];
 	char session_id[COO_CMD_SESSION_ID_MAX];
 	char response_topic[COO_CMD_TOPIC_MAX];
@@ -123,6 +137,39 @@ struct coo_cmd_response {
 	size_t corr_len;
 };
 
+/**
+ * @brief Statically define the request/response pools for one runtime
+ *
+ * Requests and responses live in fixed-block slabs; the inbound and
+ * outbound queues carry pointers to the blocks, so a command is written
+ * once at ingress and once by its handler and never copied in between.
+ * Each queue is as deep as its slab has blocks, so a queue put after a
+ * successful block allocation cannot fail.
+ *
+ * Pass the pool to coo_cmd_runtime_configure() with COO_CMD_POOL_CONFIG().
+ *
+ * @param _name Prefix for the generated slabs and queues
+ * @param _requests Commands that can be pending execution at once
+ * @param _responses Responses, warnings and data publications that can
+ *        wait for the outbound drain at once
+ */
+#define COO_CMD_POOL_DEFINE(_name, _requests, _responses)                         \
+	K_MEM_SLAB_DEFINE_STATIC(_name##_request_slab,                            \
+				 sizeof(struct coo_cmd_request), _requests, 4);   \
+	K_MEM_SLAB_DEFINE_STATIC(_name##_response_slab,                           \
+				 sizeof(struct coo_cmd_response), _responses, 4); \
+	K_MSGQ_DEFINE(_name##_inbound_queue, sizeof(struct coo_cmd_request *),    \
+		      _requests, 4);                                              \
+	K_MSGQ_DEFINE(_name##_outbound_queue, sizeof(struct coo_cmd_response *),  \
+		      _responses, 4)
+
+/** Designated initializers wiring a COO_CMD_POOL_DEFINE() pool into a runtime config. */
+#define COO_CMD_POOL_CONFIG(_name)                                                \
+	.request_slab = &_name##_request_slab,                                    \
+	.response_slab = &_name##_response_slab,                                  \
+	.inbound_queue = &_name##_inbound_queue,                                  \
+	.outbound_queue = &_name##_outbound_queue
+
 struct coo_cmd_work {
 	struct k_work work;
 	struct coo_cmd_request cmd;
@@ -138,8 +185,6 @@ struct coo_cmd_runtime_emit_args {
 	const char *context;
 };
 
-struct coo_cmd_spec;
-
 typedef int (*coo_cmd_handler_fn)(const struct coo_cmd_request *cmd,
 				  struct coo_cmd_response *out);
 
@@ -215,15 +260,20 @@ struct coo_cmd_spec {
 /**
  * @brief Runtime wiring for a simple command executor and output drain.
  *
- * The application owns the queues, optional app-command execute callback, and
- * MQTT message-id storage. The runtime owns the copied device identity, topic
- * formatting derived from it, library built-ins, and scratch buffers used to
- * keep large command payload storage off thread stacks. The runtime helpers do
- * not allocate memory; they block only in the executor queue wait, optional NVS
- * lastcommand persistence, reboot prepare callback, and MQTT publish path used
- * by the outbound drain.
+ * The application owns the request/response pools (COO_CMD_POOL_DEFINE()),
+ * optional app-command execute callback, and MQTT message-id storage. The
+ * runtime owns the copied device identity, topic formatting derived from it,
+ * and library built-ins. Requests and responses are taken from the fixed
+ * slabs and passed by pointer, so no full payload buffer sits on a thread
+ * stack or is copied between queues. The runtime helpers never block on a
+ * slab; they block only in the executor queue wait, optional NVS lastcommand
+ * persistence, reboot prepare callback, and MQTT publish path used by the
+ * outbound drain.
  */
 struct coo_cmd_runtime {
+	struct k_mem_slab *request_slab;
+	struct k_mem_slab *response_slab;
+	/* Queues of struct coo_cmd_request * and struct coo_cmd_response * */
 	struct k_msgq *inbound_queue;
 	struct k_msgq *outbound_queue;
 	char device_id[32];
@@ -235,6 +285,9 @@ struct coo_cmd_runtime {
 	void *user_data;
 	const struct coo_cmd_spec *command_specs;
 	size_t command_spec_count;
+	/* command_specs sorted by key; spec_index_count == 0 means unindexed */
+	const struct coo_cmd_spec *spec_index[COO_CMD_SPEC_INDEX_MAX];
+	size_t spec_index_count;
 	struct nvs_fs *lastcommand_nvs;
 	uint16_t lastcommand_nvs_id;
 	struct coo_cmd_lastcommand lastcommand;
@@ -255,23 +308,17 @@ struct coo_cmd_runtime {
 	bool serial_line_overflow;
 	size_t serial_line_len;
 	char serial_line[COO_CMD_SERIAL_LINE_MAX];
-	struct coo_cmd_request ingress_cmd;
-	/* Executor-owned buffers keep large request/response payload storage off
-	 * the command thread stack.
+	/* Executor-owned fallback for when every response block is queued: the
+	 * command still runs and only its response is dropped.
 	 */
-	struct coo_cmd_request executor_cmd;
-	struct coo_cmd_response executor_out;
-	struct coo_cmd_response outbound_scratch;
-	/* Runtime warning builders can share one buffer; if it is busy,
-	 * best-effort warnings stay local rather than allocating another full
-	 * response on a producer thread stack.
-	 */
-	atomic_t emit_scratch_busy;
-	struct coo_cmd_response emit_scratch;
+	struct coo_cmd_response executor_overflow;
 };
 
 struct coo_cmd_runtime_config {
 	const char *device_id;
+	/* Normally filled in with COO_CMD_POOL_CONFIG() */
+	struct k_mem_slab *request_slab;
+	struct k_mem_slab *response_slab;
 	struct k_msgq *inbound_queue;
 	struct k_msgq *outbound_queue;
 	coo_cmd_handler_fn execute_handler;
@@ -299,7 +346,14 @@ struct coo_cmd_runtime_config {
 int coo_cmd_runtime_configure(struct coo_cmd_runtime *runtime,
 			      const struct coo_cmd_runtime_config *cfg);
 
-/** Find the longest exact-or-slash-prefix command spec for @p key. */
+/**
+ * Find the longest exact-or-slash-prefix command spec for @p key.
+ *
+ * Binary search over the index built by coo_cmd_runtime_configure(): one
+ * search for the whole key, then one per '/'-separated prefix, longest
+ * first. The runtime does this once per request and caches the result in
+ * coo_cmd_request.spec.
+ */
 const struct coo_cmd_spec *
 coo_cmd_runtime_find_spec(const struct coo_cmd_runtime *runtime,
 			  const char *key);
@@ -498,6 +552,17 @@ void coo_cmd_runtime_handle_mqtt_publish(struct coo_cmd_runtime *runtime,
 void coo_cmd_runtime_mqtt_callback(const struct mqtt_publish_param *pub,
 				   void *user_data);
 
+/**
+ * MQTT wrapper publish-reader adapter; @p user_data must be a coo_cmd_runtime.
+ *
+ * Reads the payload from the client straight into a pooled request, skipping
+ * the wrapper's intermediate payload buffer. Register it with
+ * coo_mqtt_set_publish_reader() instead of coo_cmd_runtime_mqtt_callback().
+ */
+void coo_cmd_runtime_mqtt_reader(struct mqtt_client *client,
+				 const struct mqtt_publish_param *pub,
+				 void *user_data);
+
 /** Parse one console line and queue a normalized serial command request. */
 void coo_cmd_runtime_handle_serial_line(struct coo_cmd_runtime *runtime,
 					char *line);
@@ -511,12 +576,13 @@ void coo_cmd_runtime_drain_outbound(struct coo_cmd_runtime *runtime,
  * Queue one runtime data or warning publication.
  *
  * DATA requires args->suffix and args->out with payload/payload_len already
- * populated. WARNING builds the compact warning JSON into args->out, or into a
- * guarded runtime scratch response when args->out is NULL. The helper owns
- * topic formatting, delivery target, QoS, and outbound queue insertion; it
- * never publishes MQTT directly and never allocates a full response on its
- * stack. REQUIRED delivery means the outbound drain will retry after successful
- * enqueue; enqueue can still fail if the bounded queue is full.
+ * populated; the first payload_len bytes are copied into a pooled response.
+ * WARNING builds the compact warning JSON straight into a pooled response;
+ * args->out is not used. The helper owns topic formatting, delivery target,
+ * QoS, and outbound queue insertion; it never publishes MQTT directly and
+ * never allocates a full response on its stack. REQUIRED delivery means the
+ * outbound drain will retry after successful enqueue; enqueue fails with
+ * -ENOSPC when every response block is already queued.
  */
 int coo_cmd_runtime_emit(struct coo_cmd_runtime *runtime,
 			 const struct coo_cmd_runtime_emit_args *args);
@@ -31,6 +31,46 @@ struct coo_json_string_choice {
 	int value;
 };
 
+/* Top-level members held by struct coo_json_doc. */
+#define COO_JSON_DOC_FIELDS_MAX 16U
+/* Longest top-level member name the scanner accepts. */
+#define COO_JSON_KEY_MAX 63U
+
+enum coo_json_value_type {
+	COO_JSON_VALUE_STRING,
+	COO_JSON_VALUE_NUMBER,
+	COO_JSON_VALUE_OBJECT,
+	COO_JSON_VALUE_ARRAY,
+	COO_JSON_VALUE_TRUE,
+	COO_JSON_VALUE_FALSE,
+	COO_JSON_VALUE_NULL,
+};
+
+/**
+ * One top-level member of a tokenized object. Both spans point into the
+ * source text; string values include their quotes.
+ */
+struct coo_json_field {
+	const char *key;
+	const char *value;
+	uint16_t value_len;
+	uint8_t key_len;
+	uint8_t type;
+};
+
+/**
+ * @brief Top-level members of one JSON object, found in a single scan.
+ *
+ * Fill with coo_json_doc_parse(), then read fields with the
+ * coo_json_doc_get_*() accessors. Accessors look only at the span table,
+ * never back through the whole payload. The source text must outlive the
+ * doc.
+ */
+struct coo_json_doc {
+	struct coo_json_field fields[COO_JSON_DOC_FIELDS_MAX];
+	size_t count;
+};
+
 /** Return @p text advanced past ASCII JSON whitespace. */
 const char *coo_json_skip_ws(const char *text);
 
@@ -129,6 +169,63 @@ int coo_json_extract_string_choice(const char *json,
  * The copied string includes the surrounding braces.
  */
 int coo_json_extract_object(const char *json, const char *key, char *out, size_t out_len);
+/**
+ * @brief Tokenize the top-level members of a JSON object in one pass.
+ *
+ * Nested objects and arrays are kept as single spans. When @p allowed_keys
+ * is non-NULL every member name is checked against it in the same pass,
+ * with the same rules as coo_json_validate_top_level_keys(); NULL skips
+ * the check.
+ *
+ * @retval 0 @p doc holds every top-level member.
+ * @retval -ENOENT A key is not allowed; @p unknown_key receives it when a
+ *                 destination buffer is supplied.
+ * @retval -EINVAL Input is not a valid JSON object for this lightweight check.
+ * @retval -ENOSPC A key is longer than COO_JSON_KEY_MAX or does not fit in
+ *                 @p unknown_key.
+ * @retval -E2BIG The object has more than COO_JSON_DOC_FIELDS_MAX members.
+ */
+int coo_json_doc_parse(struct coo_json_doc *doc, const char *json,
+		       const char *allowed_keys, char *unknown_key,
+		       size_t unknown_key_len);
+
+/** Return the first member named @p key, or NULL. */
+const struct coo_json_field *coo_json_doc_find(const struct coo_json_doc *doc,
+					       const char *key);
+
+/*
+ * Typed accessors over a parsed doc. Return values use enum
+ * coo_json_extract_status and match the coo_json_extract_*() helpers.
+ */
+int coo_json_doc_get_bool(const struct coo_json_doc *doc, const char *key, bool *value);
+int coo_json_doc_get_u32(const struct coo_json_doc *doc, const char *key, uint32_t *value);
+int coo_json_doc_get_u64(const struct coo_json_doc *doc, const char *key, uint64_t *value);
+int coo_json_doc_get_double(const struct coo_json_doc *doc, const char *key, double *value);
+int coo_json_doc_get_double_array(const struct coo_json_doc *doc, const char *key,
+				  double *values, size_t max_values,
+				  size_t *parsed_len);
+/** Copy a string value without its quotes. Escapes are copied as is. */
+int coo_json_doc_get_string(const struct coo_json_doc *doc, const char *key,
+			    char *out, size_t out_len);
+int coo_json_doc_get_string_choice(const struct coo_json_doc *doc, const char *key,
+				   const struct coo_json_string_choice *choices,
+				   size_t choice_count, int *value);
+/** Copy a nested object value, braces included. */
+int coo_json_doc_get_object(const struct coo_json_doc *doc, const char *key,
+			    char *out, size_t out_len);
+
+/*
+ * Optional-field accessors; same contract as the coo_json_extract_optional_*()
+ * helpers: 0 when missing or parsed, -EINVAL when malformed.
+ */
+int coo_json_doc_optional_bool(const struct coo_json_doc *doc, const char *key,
+			       bool *value, bool *changed);
+int coo_json_doc_optional_u32(const struct coo_json_doc *doc, const char *key,
+			      uint32_t *value, bool *changed);
+int coo_json_doc_optional_double_range(const struct coo_json_doc *doc, const char *key,
+				       double *value, bool *changed,
+				       double min_value, double max_value);
+
 /**
  * @brief Append formatted JSON text to a fixed buffer.
  *
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COO_COMMONS_LOG_LIMIT_H
+#define COO_COMMONS_LOG_LIMIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+/**
+ * @file log_limit.h
+ * @brief Edge-triggered, rate-limited logging for hot paths.
+ *
+ * A struct coo_log_limit tracks one condition at one log site, e.g. "loop
+ * i is in alarm". The first occurrence logs at once; while the condition
+ * persists it logs again at most once per CONFIG_COO_LOG_LIMIT_PERIOD_MS
+ * with the number of occurrences dropped since the last line, and the
+ * clear macros log once when it goes away.
+ *
+ * The macros paste a suffix onto the caller's literal format string and
+ * hand it straight to LOG_<level>() in the caller's log module, so the
+ * format stays a compile-time constant and works with dictionary logging.
+ *
+ * A limit is plain data with no lock. Callers serialize updates to one
+ * limit; a race between sites sharing one only skews its counts.
+ */
+
+struct coo_log_limit {
+	uint32_t next_ms;	/* Uptime of the next allowed repeat */
+	uint32_t dropped;	/* Occurrences not logged since the last line */
+	uint32_t total;		/* Occurrences since the condition was raised */
+	bool active;
+};
+
+/**
+ * @brief Record one occurrence of the condition.
+ *
+ * @param limit Limit for this site.
+ * @param period_ms Minimum spacing of lines while the condition persists.
+ * @param dropped Set to the occurrences dropped since the last line.
+ * @retval true The caller should log this occurrence.
+ * @retval false Suppressed; counted for the next line.
+ */
+static inline bool coo_log_limit_hit(struct coo_log_limit *limit, uint32_t period_ms,
+				     uint32_t *dropped)
+{
+	uint32_t now_ms = k_uptime_get_32();
+
+	if (!limit->active) {
+		limit->active = true;
+		limit->total = 0U;
+		limit->dropped = 0U;
+	} else if ((int32_t)(now_ms - limit->next_ms) < 0) {
+		limit->total++;
+		limit->dropped++;
+		return false;
+	}
+
+	limit->total++;
+	*dropped = limit->dropped;
+	limit->dropped = 0U;
+	limit->next_ms = now_ms + period_ms;
+	return true;
+}
+
+/**
+ * @brief Record that the condition is no longer present.
+ *
+ * @param limit Limit for this site.
+ * @param total Set to the occurrences seen while it was raised.
+ * @retval true Falling edge; the caller should log the recovery.
+ * @retval false The condition was not raised.
+ */
+static inline bool coo_log_limit_clear(struct coo_log_limit *limit, uint32_t *total)
+{
+	if (!limit->active) {
+		return false;
+	}
+
+	limit->active = false;
+	*total = limit->total;
+	return true;
+}
+
+/**
+ * @brief Log _fmt on the first occurrence and then at most once a period.
+ *
+ * Repeats carry the number of occurrences dropped since the previous line.
+ * _level is ERR, WRN, INF or DBG.
+ */
+#define COO_LOG_LIMITED(_level, _limit, _fmt, ...)					\
+	do {										\
+		uint32_t _coo_dropped;							\
+											\
+		if (coo_log_limit_hit((_limit), CONFIG_COO_LOG_LIMIT_PERIOD_MS,		\
+				      &_coo_dropped)) {					\
+			if (_coo_dropped == 0U) {					\
+				LOG_##_level(_fmt, ##__VA_ARGS__);			\
+			} else {							\
+				LOG_##_level(_fmt " (%u more suppressed)",		\
+					     ##__VA_ARGS__, _coo_dropped);		\
+			}								\
+		}									\
+	} while (0)
+
+/**
+ * @brief Log _fmt once when a limited condition clears.
+ *
+ * The line ends with the number of occurrences while it was raised.
+ * Does nothing if the condition was not raised.
+ */
+#define COO_LOG_LIMITED_CLEAR(_level, _limit, _fmt, ...)				\
+	do {										\
+		uint32_t _coo_total;							\
+											\
+		if (coo_log_limit_clear((_limit), &_coo_total)) {			\
+			LOG_##_level(_fmt " (after %u occurrences)",			\
+				     ##__VA_ARGS__, _coo_total);			\
+		}									\
+	} while (0)
+
+#endif /* COO_COMMONS_LOG_LIMIT_H */
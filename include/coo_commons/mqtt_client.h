@@ -16,6 +16,13 @@
  * The wrapper owns one global broker config, subscription table, RX/TX buffers,
  * and connection flag. The application still owns when to connect, subscribe,
  * process, publish responses, and disconnect.
+ *
+ * With CONFIG_COO_MQTT_PUBLISH_QUEUE the wrapper also owns an outbound
+ * publish queue: any thread copies a message in with
+ * coo_mqtt_publish_queued() and returns at once, and coo_mqtt_process()
+ * writes it to the socket from the MQTT thread. QoS 1 messages are held
+ * until their PUBACK, at most CONFIG_COO_MQTT_INFLIGHT_WINDOW at a time,
+ * and retransmitted when the ack is late.
  */
 
 #define COO_MQTT_BROKER_HOST_MAX 128
@@ -64,6 +71,23 @@ int coo_mqtt_resolve_broker_config(const struct coo_mqtt_broker_config *cfg,
 typedef void (*mqtt_message_cb_t)(const struct mqtt_publish_param *pub,
 				  void *user_data);
 
+/**
+ * @brief Publish reader callback type
+ *
+ * Like mqtt_message_cb_t, but runs before the payload has been read: the
+ * callback must consume exactly pub->message.payload.len bytes with
+ * mqtt_read_publish_payload() or mqtt_readall_publish_payload(), so it can
+ * read them straight into its own storage. Zephyr processes no further
+ * input until the payload is drained.
+ *
+ * @param client MQTT client to read the payload from
+ * @param pub Publish parameters; message.payload.data is not valid
+ * @param user_data Caller-supplied callback context.
+ */
+typedef void (*mqtt_publish_reader_cb_t)(struct mqtt_client *client,
+					 const struct mqtt_publish_param *pub,
+					 void *user_data);
+
 /**
  * @brief Initialize the MQTT client
  *
@@ -79,6 +103,8 @@ int coo_mqtt_init(struct mqtt_client *client, const char *client_id);
 /**
  * @brief Set broker endpoint for subsequent MQTT connect attempts.
  *
+ * Drops the cached broker address, so the next connect resolves it again.
+ *
  * @param cfg Broker hostname or numeric IPv4 and TCP port.
  * @return 0 on success, negative errno on invalid config.
  */
@@ -87,7 +113,10 @@ int coo_mqtt_set_broker_config(const struct coo_mqtt_broker_config *cfg);
 /**
  * @brief Connect to the MQTT broker
  *
- * Attempts a single connect/handshake sequence.
+ * Attempts a single connect/handshake sequence. The broker address is
+ * resolved once and cached for CONFIG_COO_MQTT_DNS_CACHE_TTL_S; it is
+ * resolved again early after repeated failed connects, and the cached
+ * address is kept if a lookup fails.
  *
  * @param client Pointer to initialized MQTT client
  * @return 0 on success, negative error code on failure
@@ -128,17 +157,78 @@ int coo_mqtt_subscribe(struct mqtt_client *client);
  */
 void coo_mqtt_set_message_callback(mqtt_message_cb_t cb, void *user_data);
 
+/**
+ * @brief Set a publish reader instead of a message callback
+ *
+ * While a reader is set, received payloads are left in the client for the
+ * reader to consume and the message callback is not called. This skips
+ * the wrapper's own payload buffer and one copy of every payload.
+ *
+ * @param cb Reader, or NULL to go back to the message callback
+ * @param user_data Caller-owned pointer passed to cb, or NULL if unused
+ */
+void coo_mqtt_set_publish_reader(mqtt_publish_reader_cb_t cb, void *user_data);
+
 /**
  * @brief Process MQTT events
  *
  * Must be called regularly in the main loop. Polls the MQTT socket,
- * handles incoming messages, and sends keep-alive packets.
+ * handles incoming messages, and sends keep-alive packets. With
+ * CONFIG_COO_MQTT_PUBLISH_QUEUE it also sends queued publishes and
+ * retransmits unacknowledged QoS 1 messages.
  *
  * @param client Pointer to connected MQTT client
  * @return 0 on success, negative error code on failure (e.g., disconnection)
  */
 int coo_mqtt_process(struct mqtt_client *client);
 
+/** Connection manager counters, since boot */
+struct coo_mqtt_connection_stats {
+	/** Successful connects, each ending in a CONNACK */
+	uint32_t connects;
+	/** Connect attempts that failed */
+	uint32_t connect_failures;
+	/** Connections lost after a successful connect */
+	uint32_t disconnects;
+	/** Broker hostname lookups, and connects that reused a cached address */
+	uint32_t dns_lookups;
+	uint32_t dns_cache_hits;
+	/** Backoff before the next attempt, 0 while connected */
+	uint32_t retry_in_ms;
+	/** Time from losing the connection to being subscribed again */
+	uint32_t last_reconnect_ms;
+	uint32_t max_reconnect_ms;
+};
+
+/**
+ * @brief Keep the client connected and subscribed; call from the MQTT loop
+ *
+ * While disconnected, each call either returns at once because the backoff
+ * has not expired, or makes one connect attempt. Failed attempts back off
+ * exponentially from CONFIG_COO_MQTT_RECONNECT_MIN_MS to
+ * CONFIG_COO_MQTT_RECONNECT_MAX_MS with random jitter, so devices that lost
+ * the same broker do not retry in lockstep. After a connect, every topic
+ * registered with coo_mqtt_add_subscription() is restored in one
+ * subscribe request, unless the broker kept the session.
+ *
+ * @param client Pointer to initialized MQTT client
+ * @retval 0 Connected and subscribed; call coo_mqtt_process().
+ * @retval -EAGAIN Waiting for the backoff to expire.
+ * @retval <0 The connect or subscribe attempt just made failed.
+ */
+int coo_mqtt_maintain(struct mqtt_client *client);
+
+/** Copy the connection manager counters. */
+void coo_mqtt_get_connection_stats(struct coo_mqtt_connection_stats *stats);
+
+/**
+ * @brief Format connection counters as one JSON object.
+ *
+ * @return 0 on success, -ENOSPC if @p out is too small.
+ */
+int coo_mqtt_format_connection_stats(const struct coo_mqtt_connection_stats *stats,
+				     char *out, size_t out_len);
+
 /**
  * @brief Main MQTT event loop
  *
@@ -155,6 +245,89 @@ int coo_mqtt_process(struct mqtt_client *client);
  */
 void coo_mqtt_run(struct mqtt_client *client);
 
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+/** Longest topic coo_mqtt_publish_queued() accepts, including the NUL */
+#define COO_MQTT_PUBLISH_TOPIC_MAX 96
+
+/**
+ * Drop this message if a newer one for the same topic, also flagged
+ * COO_MQTT_PUBLISH_COALESCE, is queued behind it before it is sent. Use it
+ * for state where only the latest value matters, not for a stream of
+ * samples.
+ */
+#define COO_MQTT_PUBLISH_COALESCE BIT(0)
+
+/** Outbound publish queue counters, since boot or the last reset */
+struct coo_mqtt_publish_stats {
+	/** Accepted by coo_mqtt_publish_queued() */
+	uint32_t queued;
+	/** Written to the socket for the first time */
+	uint32_t published;
+	/** QoS 1 messages released by a PUBACK */
+	uint32_t acked;
+	/** PUBACKs carrying an error reason code; the message is still released */
+	uint32_t rejected;
+	/** QoS 1 messages sent again after CONFIG_COO_MQTT_ACK_TIMEOUT_MS */
+	uint32_t retransmits;
+	/** Dropped because a newer message for the same topic was queued */
+	uint32_t coalesced;
+	/** Rejected because every queue slot was in use */
+	uint32_t dropped_full;
+	/** QoS 0 messages rejected while disconnected */
+	uint32_t dropped_offline;
+	/** QoS 0 messages the socket refused */
+	uint32_t dropped_error;
+	/** Times a QoS 1 message waited for a full inflight window */
+	uint32_t window_stalls;
+	/** Messages waiting now, and the most that have waited at once */
+	uint32_t depth;
+	uint32_t depth_max;
+	/** QoS 1 messages awaiting a PUBACK now */
+	uint32_t inflight;
+	/** Time from coo_mqtt_publish_queued() to the first send */
+	uint32_t latency_avg_ms;
+	uint32_t latency_max_ms;
+	/** Longest time from a send to its PUBACK */
+	uint32_t ack_max_ms;
+};
+
+/**
+ * @brief Queue one publish for the MQTT thread; never blocks
+ *
+ * The topic and payload are copied, so both may be reused as soon as this
+ * returns. Messages are sent in order from coo_mqtt_process(). QoS 0
+ * messages are refused while disconnected rather than sent stale later;
+ * QoS 1 messages wait for the connection.
+ *
+ * @param topic Topic, shorter than COO_MQTT_PUBLISH_TOPIC_MAX
+ * @param payload Payload bytes, may be binary
+ * @param len Payload length, at most CONFIG_COO_MQTT_PUBLISH_PAYLOAD_SIZE
+ * @param qos MQTT_QOS_0_AT_MOST_ONCE or MQTT_QOS_1_AT_LEAST_ONCE
+ * @param flags COO_MQTT_PUBLISH_* flags
+ * @retval 0 Queued.
+ * @retval -EINVAL Bad arguments or QoS 2.
+ * @retval -EMSGSIZE Topic or payload too long.
+ * @retval -ENOTCONN QoS 0 while disconnected.
+ * @retval -ENOSPC Queue full.
+ */
+int coo_mqtt_publish_queued(const char *topic, const void *payload, size_t len,
+			    uint8_t qos, uint32_t flags);
+
+/** Copy the publish queue counters; safe from any thread. */
+void coo_mqtt_get_publish_stats(struct coo_mqtt_publish_stats *stats);
+
+/** Zero the publish queue counters; depth and inflight are left alone. */
+void coo_mqtt_reset_publish_stats(void);
+
+/**
+ * @brief Format publish queue counters as one JSON object.
+ *
+ * @return 0 on success, -ENOSPC if @p out is too small.
+ */
+int coo_mqtt_format_publish_stats(const struct coo_mqtt_publish_stats *stats,
+				  char *out, size_t out_len);
+#endif
+
 /**
  * @brief Check if MQTT client is currently connected
  *
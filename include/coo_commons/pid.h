@@ -6,6 +6,7 @@
 #ifndef APP_LIB_PID_H_
 #define APP_LIB_PID_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /**
@@ -17,6 +18,39 @@
  * motion control, and other closed-loop applications.
  */
 
+/**
+ * @brief Integral anti-windup strategy
+ */
+enum coo_pid_anti_windup {
+	/** Clamp the integral to [integral_min, integral_max] (default) */
+	COO_PID_ANTI_WINDUP_CLAMP,
+	/** Also stop integrating while the output is saturated and the
+	 *  error would drive it further into saturation
+	 */
+	COO_PID_ANTI_WINDUP_CONDITIONAL,
+	/** Also bleed the integral by (clamped - unclamped output) / Tt */
+	COO_PID_ANTI_WINDUP_BACK_CALC,
+};
+
+/**
+ * @brief Optional PID behaviour, selectable per instance
+ *
+ * The defaults set by coo_pid_init() reproduce the classic law:
+ * derivative of error, unfiltered, integral clamp, no setpoint weighting.
+ */
+struct coo_pid_options {
+	/** Setpoint weight b for the P term: P = kp * (b * r - y). 1 = classic */
+	float setpoint_weight;
+	/** Differentiate -measurement instead of error (no setpoint kick) */
+	bool derivative_on_measurement;
+	/** First-order low-pass time constant on the D term (s), 0 = off */
+	float derivative_filter_tau;
+	/** Integral anti-windup strategy */
+	enum coo_pid_anti_windup anti_windup;
+	/** Back-calculation tracking time Tt (s), 0 = use Ti = kp / ki */
+	float tracking_time;
+};
+
 /**
  * @brief PID controller state structure
  */
@@ -40,6 +74,16 @@ struct coo_pid {
 	/** Anti-windup: limit integral accumulation */
 	float integral_min;
 	float integral_max;
+
+	/** Optional behaviour, see coo_pid_set_options() */
+	struct coo_pid_options options;
+
+	/** Previous measurement, for derivative on measurement */
+	float prev_measured;
+	/** Filtered derivative term state */
+	float d_filtered;
+	/** prev_measured holds a real sample */
+	bool primed;
 };
 
 /**
@@ -72,6 +116,24 @@ void coo_pid_reset(struct coo_pid *pid);
  */
 void coo_pid_set_gains(struct coo_pid *pid, float kp, float ki, float kd);
 
+/**
+ * @brief Fill in the default options (classic PID law)
+ *
+ * @param opts Options to initialize
+ */
+void coo_pid_options_default(struct coo_pid_options *opts);
+
+/**
+ * @brief Select optional PID behaviour
+ *
+ * Takes effect on the next update; the integral is kept, the derivative
+ * history is cleared so switching modes causes no kick.
+ *
+ * @param pid Pointer to PID controller structure
+ * @param opts Options, copied
+ */
+void coo_pid_set_options(struct coo_pid *pid, const struct coo_pid_options *opts);
+
 /**
  * @brief Compute PID output
  *
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2024 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_PID_BANK_H_
+#define APP_LIB_PID_BANK_H_
+
+#include <stdint.h>
+#include <coo_commons/pid.h>
+
+/**
+ * @file pid_bank.h
+ * @brief Bank of PID controllers stored structure-of-arrays
+ *
+ * Same control law as struct coo_pid, but each field of every channel
+ * lives in its own contiguous array, and one call steps the whole bank.
+ * A multi-loop controller then walks a handful of dense float arrays per
+ * tick instead of one large per-loop record per controller, so the cost
+ * per channel stays flat as the number of loops grows.
+ *
+ * Use COO_PID_BANK_DEFINE() to allocate a bank statically.
+ */
+
+/**
+ * @brief PID bank. All arrays hold @ref size entries.
+ */
+struct coo_pid_bank {
+	/** Number of channels */
+	uint16_t size;
+
+	/** Gains */
+	float *kp;
+	float *ki;
+	float *kd;
+
+	/** Integral accumulator and previous error, per channel */
+	float *integral;
+	float *prev_error;
+
+	/** Output limits */
+	float *output_min;
+	float *output_max;
+
+	/** Anti-windup: limit integral accumulation */
+	float *integral_min;
+	float *integral_max;
+
+	/** Optional behaviour per channel, as struct coo_pid options */
+	struct coo_pid_options *options;
+
+	/** Derivative-on-measurement and D filter state, per channel */
+	float *prev_measured;
+	float *d_filtered;
+	bool *primed;
+
+	/** Last P, I and D contributions per channel, for telemetry */
+	float *p_term;
+	float *i_term;
+	float *d_term;
+};
+
+/**
+ * @brief Statically define a PID bank
+ *
+ * @param _name Name of the struct coo_pid_bank variable
+ * @param _size Number of channels
+ */
+#define COO_PID_BANK_DEFINE(_name, _size)                                        \
+	static float _name##_kp[_size];                                          \
+	static float _name##_ki[_size];                                          \
+	static float _name##_kd[_size];                                          \
+	static float _name##_integral[_size];                                    \
+	static float _name##_prev_error[_size];                                  \
+	static float _name##_output_min[_size];                                  \
+	static float _name##_output_max[_size];                                  \
+	static float _name##_integral_min[_size];                                \
+	static float _name##_integral_max[_size];                                \
+	static struct coo_pid_options _name##_options[_size];                    \
+	static float _name##_prev_measured[_size];                               \
+	static float _name##_d_filtered[_size];                                  \
+	static bool _name##_primed[_size];                                       \
+	static float _name##_p_term[_size];                                      \
+	static float _name##_i_term[_size];                                      \
+	static float _name##_d_term[_size];                                      \
+	static struct coo_pid_bank _name = {                                     \
+		.size = (_size),                                                 \
+		.kp = _name##_kp,                                                \
+		.ki = _name##_ki,                                                \
+		.kd = _name##_kd,                                                \
+		.integral = _name##_integral,                                    \
+		.prev_error = _name##_prev_error,                                \
+		.output_min = _name##_output_min,                                \
+		.output_max = _name##_output_max,                                \
+		.integral_min = _name##_integral_min,                            \
+		.integral_max = _name##_integral_max,                            \
+		.options = _name##_options,                                      \
+		.prev_measured = _name##_prev_measured,                          \
+		.d_filtered = _name##_d_filtered,                                \
+		.primed = _name##_primed,                                        \
+		.p_term = _name##_p_term,                                        \
+		.i_term = _name##_i_term,                                        \
+		.d_term = _name##_d_term,                                        \
+	}
+
+/**
+ * @brief Initialize one channel, as coo_pid_init() does for one controller
+ *
+ * Options are reset to the defaults of coo_pid_options_default().
+ *
+ * @param bank PID bank
+ * @param ch Channel index
+ * @param kp Proportional gain
+ * @param ki Integral gain
+ * @param kd Derivative gain
+ * @param output_min Minimum output value
+ * @param output_max Maximum output value
+ * @return 0 on success, -EINVAL if @p ch is out of range
+ */
+int coo_pid_bank_init_channel(struct coo_pid_bank *bank, int ch, float kp, float ki,
+			      float kd, float output_min, float output_max);
+
+/**
+ * @brief Clear one channel's integral and error history
+ *
+ * @param bank PID bank
+ * @param ch Channel index
+ * @return 0 on success, -EINVAL if @p ch is out of range
+ */
+int coo_pid_bank_reset(struct coo_pid_bank *bank, int ch);
+
+/**
+ * @brief Update one channel's gains
+ *
+ * @param bank PID bank
+ * @param ch Channel index
+ * @param kp Proportional gain
+ * @param ki Integral gain
+ * @param kd Derivative gain
+ * @return 0 on success, -EINVAL if @p ch is out of range
+ */
+int coo_pid_bank_set_gains(struct coo_pid_bank *bank, int ch, float kp, float ki, float kd);
+
+/**
+ * @brief Select optional behaviour for one channel
+ *
+ * Same semantics as coo_pid_set_options().
+ *
+ * @param bank PID bank
+ * @param ch Channel index
+ * @param opts Options, copied
+ * @return 0 on success, -EINVAL if @p ch is out of range
+ */
+int coo_pid_bank_set_options(struct coo_pid_bank *bank, int ch,
+			     const struct coo_pid_options *opts);
+
+/**
+ * @brief Step channels 0..count-1 in one pass
+ *
+ * Channel i computes exactly what coo_pid_update() would for the same
+ * inputs. Channels with run[i] == 0 keep their state and output[i] is
+ * left untouched, so a caller can run every loop that is due this tick
+ * without packing them first. Each channel that runs also stores its
+ * P, I and D contributions in p_term[i], i_term[i] and d_term[i].
+ *
+ * The arrays are restrict-qualified: they must not overlap each other or
+ * the bank's own storage, so the compiler need not reload the inputs
+ * after each output store.
+ *
+ * @param bank PID bank
+ * @param count Number of channels to consider (clamped to the bank size)
+ * @param setpoint Desired target value per channel
+ * @param measured Current measured value per channel
+ * @param dt Time delta per channel (seconds)
+ * @param run Per-channel run flag, or NULL to run all channels
+ * @param output Computed control output per channel (clamped to limits)
+ */
+void coo_pid_bank_update(struct coo_pid_bank *restrict bank, int count,
+			 const float *restrict setpoint, const float *restrict measured,
+			 const float *restrict dt, const uint8_t *restrict run,
+			 float *restrict output);
+
+#endif /* APP_LIB_PID_BANK_H_ */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COO_COMMONS_SERIAL_UART_H
+#define COO_COMMONS_SERIAL_UART_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file serial_uart.h
+ * @brief Line-oriented serial command port on the UART async (DMA) API.
+ *
+ * Receive runs on double-buffered DMA with idle-line detection: the UART
+ * driver hands over bytes as soon as the line goes quiet, and the event
+ * callback assembles them into whole lines and queues each one. Nothing
+ * polls the UART per character.
+ *
+ * Transmit goes through a ring buffer drained by DMA. A writer copies its
+ * bytes in and returns; it waits only while the ring is full, and then
+ * sleeps rather than spins. A large help or snapshot dump therefore costs
+ * the caller a memcpy, not the time the UART takes to shift it out.
+ *
+ * The UART is the devicetree chosen node `coo,command-uart`, or the console
+ * UART when that is not set. Its driver must support the async API; on
+ * STM32 that means `dmas` and `dma-names` on the UART node.
+ */
+
+/** Receive and transmit counters, since boot */
+struct coo_serial_uart_stats {
+	/** Complete lines queued for the reader */
+	uint32_t lines;
+	/** Lines lost because the reader was behind */
+	uint32_t lines_dropped;
+	/** Lines longer than CONFIG_COO_SERIAL_UART_LINE_MAX */
+	uint32_t lines_too_long;
+	/** Receiver stops on framing, parity or overrun errors */
+	uint32_t rx_errors;
+	/** Bytes accepted for transmit, and bytes dropped on a full ring */
+	uint32_t tx_bytes;
+	uint32_t tx_dropped;
+	/** Most bytes waiting in the transmit ring at once */
+	uint32_t tx_pending_max;
+};
+
+/**
+ * @brief Start DMA receive on the serial command UART.
+ *
+ * @retval 0 Receiving.
+ * @retval -ENODEV The UART is not ready.
+ * @retval <0 Error from uart_callback_set() or uart_rx_enable().
+ */
+int coo_serial_uart_init(void);
+
+/**
+ * @brief Take the next complete input line, without its terminator.
+ *
+ * Lines end at CR or LF. Backspace and DEL edit the line being assembled,
+ * other control characters except tab are dropped, and empty lines are
+ * skipped.
+ *
+ * @param line Destination, NUL-terminated
+ * @param line_size Size of @p line
+ * @return line length, -EAGAIN if no line is waiting, or -EMSGSIZE if the
+ *         line did not fit the receive buffer or @p line (it is discarded)
+ */
+int coo_serial_uart_read_line(char *line, size_t line_size);
+
+/**
+ * @brief Queue bytes for DMA transmit.
+ *
+ * From a thread, waits up to CONFIG_COO_SERIAL_UART_TX_WAIT_MS each time
+ * the ring fills and drops what still does not fit. From an ISR, never
+ * waits.
+ *
+ * @return bytes accepted
+ */
+size_t coo_serial_uart_write(const void *data, size_t len);
+
+/** Copy the receive and transmit counters. */
+void coo_serial_uart_get_stats(struct coo_serial_uart_stats *stats);
+
+#endif /* COO_COMMONS_SERIAL_UART_H */
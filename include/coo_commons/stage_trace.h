@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COO_COMMONS_STAGE_TRACE_H
+#define COO_COMMONS_STAGE_TRACE_H
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#if defined(CONFIG_COO_STAGE_TRACE) && defined(CONFIG_CPU_CORTEX_M_HAS_DWT)
+#include <cmsis_core.h>
+#endif
+
+/**
+ * @file stage_trace.h
+ * @brief Cycle-counter timing of the controller's pipeline stages.
+ *
+ * Each stage keeps a count, min, max, running total and a log2 histogram
+ * of its durations in one fixed table. Stamps come from the DWT cycle
+ * counter where the core has one, otherwise from k_cycle_get_32().
+ *
+ * Without CONFIG_COO_STAGE_TRACE the BEGIN/END macros expand to nothing
+ * and no table is linked, so instrumented code costs nothing.
+ */
+
+enum coo_trace_stage {
+	COO_TRACE_ADC_SWEEP = 0,	/* sensor_manager_read_all(), whole sweep */
+	COO_TRACE_SENSOR_CONVERT,	/* One raw code to Kelvin */
+	COO_TRACE_FUSION,		/* One loop's sensor fusion */
+	COO_TRACE_PID,			/* PID bank step for every due loop */
+	COO_TRACE_HEATER_APPLY,		/* One tick's heater commands */
+	COO_TRACE_COMMAND,		/* One command handler, dispatch included */
+	COO_TRACE_MQTT_PUBLISH,		/* One mqtt_publish() call */
+	COO_TRACE_STAGE_COUNT,
+};
+
+/** hist[i] counts durations in [2^i, 2^(i+1)) cycles; hist[0] also holds 0. */
+#define COO_TRACE_HIST_BUCKETS 32
+
+struct coo_trace_stage_stats {
+	uint32_t count;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+	uint64_t total_cycles;
+	uint32_t hist[COO_TRACE_HIST_BUCKETS];
+};
+
+#ifdef CONFIG_COO_STAGE_TRACE
+
+static inline uint32_t coo_trace_cycles(void)
+{
+#ifdef CONFIG_CPU_CORTEX_M_HAS_DWT
+	return DWT->CYCCNT;
+#else
+	return k_cycle_get_32();
+#endif
+}
+
+/** Add one duration to a stage. Safe from any thread or ISR. */
+void coo_trace_record(enum coo_trace_stage stage, uint32_t cycles);
+
+/** Copy one stage's statistics. @return 0, or -EINVAL for an unknown stage */
+int coo_trace_get(enum coo_trace_stage stage, struct coo_trace_stage_stats *out);
+
+/** Clear every stage. */
+void coo_trace_reset(void);
+
+/** Rate of the trace cycle counter, for converting to time. */
+uint32_t coo_trace_cycles_per_sec(void);
+
+/** Short wire name of a stage, or NULL for an unknown one. */
+const char *coo_trace_stage_name(enum coo_trace_stage stage);
+
+/** Look a stage up by wire name. @return stage, or -ENOENT */
+int coo_trace_stage_find(const char *name);
+
+/** Start timing; declares @p stamp in the current scope. */
+#define COO_TRACE_BEGIN(stamp) const uint32_t stamp = coo_trace_cycles()
+
+/** Record the time since COO_TRACE_BEGIN(@p stamp) against @p stage. */
+#define COO_TRACE_END(stage, stamp) coo_trace_record((stage), coo_trace_cycles() - (stamp))
+
+#else
+
+#define COO_TRACE_BEGIN(stamp) do { } while (0)
+#define COO_TRACE_END(stage, stamp) do { } while (0)
+
+#endif /* CONFIG_COO_STAGE_TRACE */
+
+#endif /* COO_COMMONS_STAGE_TRACE_H */
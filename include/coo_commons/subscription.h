@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COO_COMMONS_SUBSCRIPTION_H
+#define COO_COMMONS_SUBSCRIPTION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#include <coo_commons/command_dispatch.h>
+
+/**
+ * @file subscription.h
+ * @brief Fixed table of change-driven data publications.
+ *
+ * A client subscribes to a value key with a deadband and two intervals. Each
+ * poll reads every subscribed value and queues a data publication on
+ * `dt/<device_id>/<key>` only when the value has moved more than the
+ * deadband since the last publication, or when max_interval has passed
+ * with no publication. min_interval rate-limits a noisy value.
+ *
+ * The application owns what a key means: a resolve callback turns a key
+ * into an opaque reference once, at subscribe time, and a read callback
+ * turns that reference into the current value on every poll. The table
+ * never allocates; use COO_SUBSCRIPTIONS_DEFINE() to size it statically.
+ */
+
+/** Resolve @p key to a reference for the read callback; -ENOENT if unknown. */
+typedef int (*coo_subscription_resolve_fn)(const char *key, uint32_t *ref,
+					   void *user_data);
+
+/** Read the current value for a resolved reference. */
+typedef int (*coo_subscription_read_fn)(uint32_t ref, double *value,
+					void *user_data);
+
+struct coo_subscription_params {
+	/** Publish once the value moves more than this; 0 = on any change */
+	double deadband;
+	/** Shortest time between two publications, 0 = no limit */
+	uint32_t min_interval_ms;
+	/** Republish an unchanged value after this long, 0 = never */
+	uint32_t max_interval_ms;
+};
+
+struct coo_subscription {
+	char key[COO_CMD_KEY_MAX];
+	uint32_t ref;
+	struct coo_subscription_params params;
+	double last_value;
+	int64_t last_publish_ms;
+	bool active;
+	/* False until the first publication after subscribing */
+	bool published;
+};
+
+/**
+ * @brief Subscription table. Fields are private; use the functions below.
+ */
+struct coo_subscriptions {
+	struct coo_subscription *table;
+	size_t count;
+	coo_subscription_resolve_fn resolve;
+	coo_subscription_read_fn read;
+	void *user_data;
+	struct k_mutex lock;
+};
+
+/**
+ * @brief Statically define a subscription table
+ *
+ * Call coo_subscriptions_init() before use.
+ *
+ * @param _name Name of the struct coo_subscriptions variable
+ * @param _count Number of concurrent subscriptions
+ */
+#define COO_SUBSCRIPTIONS_DEFINE(_name, _count)                                   \
+	static struct coo_subscription _name##_table[_count];                     \
+	static struct coo_subscriptions _name = {                                 \
+		.table = _name##_table,                                           \
+		.count = (_count),                                                \
+	}
+
+/** Attach the key callbacks and drop every subscription. */
+int coo_subscriptions_init(struct coo_subscriptions *subs,
+			   coo_subscription_resolve_fn resolve,
+			   coo_subscription_read_fn read,
+			   void *user_data);
+
+/**
+ * @brief Subscribe to @p key, or update the parameters of an existing one.
+ *
+ * The first poll after subscribing always publishes the current value.
+ *
+ * @retval 0 Subscribed.
+ * @retval -EINVAL Bad arguments, or max_interval is shorter than min_interval.
+ * @retval -ENOENT The resolve callback does not know @p key.
+ * @retval -ENOSPC Every slot is in use.
+ */
+int coo_subscription_add(struct coo_subscriptions *subs, const char *key,
+			 const struct coo_subscription_params *params);
+
+/** Unsubscribe @p key; -ENOENT if it was not subscribed. */
+int coo_subscription_remove(struct coo_subscriptions *subs, const char *key);
+
+/** Drop every subscription. */
+void coo_subscription_clear(struct coo_subscriptions *subs);
+
+/**
+ * @brief Read every subscribed value and queue the ones that are due.
+ *
+ * Publications are best effort: one that does not fit in the outbound
+ * queue is retried on the next poll. A failed read publishes null once.
+ *
+ * @param subs Subscription table
+ * @param runtime Command runtime that owns the outbound queue
+ * @param out Scratch response to build each publication in
+ * @return publications queued, or -EINVAL on bad arguments
+ */
+int coo_subscription_poll(struct coo_subscriptions *subs,
+			  struct coo_cmd_runtime *runtime,
+			  struct coo_cmd_response *out);
+
+/*
+ * Command handlers for an application spec table; each wraps one table.
+ *   subscribe   effect {"key":k,"deadband":d,"min_interval":ms,"max_interval":ms}
+ *   unsubscribe effect {"key":k}
+ *   subscriptions query, lists the active subscriptions
+ */
+int coo_subscription_subscribe_cmd(struct coo_subscriptions *subs,
+				   const struct coo_cmd_request *cmd,
+				   struct coo_cmd_response *out);
+int coo_subscription_unsubscribe_cmd(struct coo_subscriptions *subs,
+				     const struct coo_cmd_request *cmd,
+				     struct coo_cmd_response *out);
+int coo_subscription_list_cmd(struct coo_subscriptions *subs,
+			      const struct coo_cmd_request *cmd,
+			      struct coo_cmd_response *out);
+
+#endif /* COO_COMMONS_SUBSCRIPTION_H */
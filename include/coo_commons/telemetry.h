@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2024 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_TELEMETRY_H_
+#define APP_LIB_TELEMETRY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @file telemetry.h
+ * @brief Fixed ring of per-tick control samples, flushed as binary batches
+ *
+ * The producer (a control loop) records one sample per channel per tick
+ * into a statically sized ring; recording never blocks and never
+ * allocates. A consumer drains the ring in batches and encodes each batch
+ * as one packed little-endian frame: a short header carrying a schema ID,
+ * then fixed-size records. One frame of N ticks replaces N formatted JSON
+ * publishes.
+ *
+ * When the ring is full the oldest sample is overwritten and counted as
+ * dropped; the next frame header reports the count.
+ *
+ * Use COO_TELEMETRY_DEFINE() to allocate a ring statically.
+ */
+
+/** Schema ID in every frame header, "CT" little-endian */
+#define COO_TELEMETRY_SCHEMA_ID 0x5443U
+/** Schema version; bumped whenever the record layout changes */
+#define COO_TELEMETRY_SCHEMA_VERSION 2U
+
+/** Encoded frame header size in bytes */
+#define COO_TELEMETRY_HEADER_SIZE 12U
+/** Encoded record size in bytes */
+#define COO_TELEMETRY_RECORD_SIZE 32U
+
+/** Bytes needed to encode @p _records records */
+#define COO_TELEMETRY_FRAME_SIZE(_records)                                        \
+	(COO_TELEMETRY_HEADER_SIZE + (size_t)(_records) * COO_TELEMETRY_RECORD_SIZE)
+
+/** Sample flags */
+#define COO_TELEMETRY_FLAG_ALARM    BIT(0)
+#define COO_TELEMETRY_FLAG_SATURATED BIT(1)
+#define COO_TELEMETRY_FLAG_AUTOTUNE BIT(2)
+#define COO_TELEMETRY_FLAG_PID      BIT(3)
+
+/**
+ * @brief One channel's data for one tick
+ *
+ * PID terms are the contributions to the output, so output is
+ * p + i + d + feed-forward before clamping. Channels not run by a PID
+ * leave the terms at zero. A producer that records several kinds of
+ * channel into one ring tells them apart by kind, and defines what each
+ * field means for each kind.
+ */
+struct coo_telemetry_sample {
+	/** Uptime of the tick, milliseconds (wraps after ~49 days) */
+	uint32_t timestamp_ms;
+	/** Channel index, e.g. the loop handle */
+	uint8_t channel;
+	/** Channel kind, defined by the producer; 0 for a single-kind ring */
+	uint8_t kind;
+	/** COO_TELEMETRY_FLAG_* */
+	uint8_t flags;
+	/** Status code of the channel */
+	int8_t status;
+
+	float measured;
+	float setpoint;
+	float p_term;
+	float i_term;
+	float d_term;
+	float output;
+};
+
+/**
+ * @brief Telemetry ring. Fields are private; use the functions below.
+ */
+struct coo_telemetry {
+	struct coo_telemetry_sample *ring;
+	uint16_t depth;
+	uint16_t head;
+	uint16_t count;
+	/** Samples overwritten since the last frame */
+	uint16_t dropped;
+	/** Frame sequence number, for loss detection on the receiving side */
+	uint32_t seq;
+	struct k_spinlock lock;
+};
+
+/**
+ * @brief Statically define a telemetry ring
+ *
+ * @param _name Name of the struct coo_telemetry variable
+ * @param _depth Number of samples the ring holds
+ */
+#define COO_TELEMETRY_DEFINE(_name, _depth)                                       \
+	static struct coo_telemetry_sample _name##_ring[_depth];                  \
+	static struct coo_telemetry _name = {                                     \
+		.ring = _name##_ring,                                             \
+		.depth = (_depth),                                                \
+	}
+
+/**
+ * @brief Record one sample; safe from any thread or ISR
+ *
+ * @param tm Telemetry ring
+ * @param sample Sample, copied
+ */
+void coo_telemetry_record(struct coo_telemetry *tm,
+			  const struct coo_telemetry_sample *sample);
+
+/** Number of samples waiting to be encoded */
+size_t coo_telemetry_pending(struct coo_telemetry *tm);
+
+/** Drop every pending sample and the dropped count */
+void coo_telemetry_clear(struct coo_telemetry *tm);
+
+/**
+ * @brief Drain up to @p max_records samples into one binary frame
+ *
+ * Frame header, little-endian:
+ *   u16 schema ID, u8 schema version, u8 record size,
+ *   u16 record count, u16 samples dropped before this frame, u32 sequence
+ * Record, little-endian:
+ *   u32 timestamp_ms, u8 channel, u8 flags, i8 status, u8 kind,
+ *   f32 measured, setpoint, p_term, i_term, d_term, output
+ *
+ * Samples are removed from the ring as they are encoded. An empty ring
+ * produces nothing and leaves the sequence number alone.
+ *
+ * @param tm Telemetry ring
+ * @param buf Output buffer
+ * @param buf_len Size of @p buf; caps the batch at what fits
+ * @param max_records Largest batch to encode
+ * @return bytes written, 0 if nothing was pending, -EINVAL on bad
+ *         arguments, -ENOSPC if @p buf cannot hold a single record
+ */
+int coo_telemetry_encode(struct coo_telemetry *tm, uint8_t *buf, size_t buf_len,
+			 size_t max_records);
+
+#if defined(CONFIG_COO_MQTT)
+struct coo_cmd_runtime;
+struct coo_cmd_response;
+
+/**
+ * @brief Encode one batch and queue it on `dt/<device_id>/<suffix>`
+ *
+ * The batch size is CONFIG_COO_TELEMETRY_BATCH_RECORDS, capped at what
+ * fits in a command response payload. Published best effort at QoS 0.
+ *
+ * @param tm Telemetry ring
+ * @param runtime Command runtime that owns the outbound queue
+ * @param suffix Data topic suffix
+ * @param out Scratch response to build the publish in
+ * @return records sent (0 if nothing was pending) or a negative errno
+ */
+int coo_telemetry_publish(struct coo_telemetry *tm, struct coo_cmd_runtime *runtime,
+			  const char *suffix, struct coo_cmd_response *out);
+#endif
+
+#endif /* APP_LIB_TELEMETRY_H_ */
@@ -4,6 +4,9 @@
  * conversions happen at this boundary. Per-loop commands arrive as
  * loop/<loop_id>/<key>; system commands are single keys. */
 
+#include <errno.h>
+#include <float.h>
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -16,9 +19,62 @@
 #include <sensor_manager.h>
 #include <heater_manager.h>
 #include <coo_commons/json_utils.h>
+#include <coo_commons/stage_trace.h>
+#ifdef CONFIG_COO_SUBSCRIPTIONS
+#include <coo_commons/subscription.h>
+#endif
+#ifdef CONFIG_COO_SUPERVISOR_LIB
+#include <supervisor.h>
+#endif
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+#include <sensor_interlock.h>
+#endif
+#ifdef CONFIG_COO_CONTROL_PERSIST
+#include <loop_persist.h>
+#endif
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+#include <zephyr/sys/base64.h>
+#include <flight_recorder.h>
+#endif
 
 #define KELVIN_OFFSET 273.15f
 
+/* Autotune defaults for fields the request leaves out */
+#define AUTOTUNE_DEFAULT_HYSTERESIS 0.2
+#define AUTOTUNE_DEFAULT_DEVIATION 10.0
+#define AUTOTUNE_DEFAULT_CYCLES 3U
+#define AUTOTUNE_DEFAULT_TIMEOUT_S 14400U
+
+/* Room a snapshot reply keeps for its header, array brackets and trailer */
+#define SNAPSHOT_PAGE_RESERVE 128U
+#define SNAPSHOT_ITEM_MAX (COO_CMD_PAYLOAD_MAX - SNAPSHOT_PAGE_RESERVE)
+
+/* Recorder bytes per recorder/dump reply: what fits base64-encoded beside the cursor fields */
+#define RECORDER_DUMP_RESERVE 192U
+#define RECORDER_DUMP_CHUNK (((COO_CMD_PAYLOAD_MAX - RECORDER_DUMP_RESERVE) / 4U) * 3U)
+
+static const char *const autotune_state_names[] = {
+	[AUTOTUNE_IDLE] = "idle",
+	[AUTOTUNE_RUNNING] = "running",
+	[AUTOTUNE_DONE] = "done",
+	[AUTOTUNE_FAILED] = "failed",
+};
+
+static const struct coo_json_string_choice autotune_rules[] = {
+	{ "tyreus_luyben", AUTOTUNE_RULE_TYREUS_LUYBEN },
+	{ "ziegler_nichols", AUTOTUNE_RULE_ZIEGLER_NICHOLS },
+};
+
+/*
+ * A parsed number the float-valued managers can take. NaN or inf would
+ * reach sqrtf() and integer casts in the heater path, and a finite double
+ * beyond FLT_MAX has no float value at all.
+ */
+static bool float_ok(double value)
+{
+	return isfinite(value) && fabs(value) <= FLT_MAX;
+}
+
 static int parse_loop_key(const struct coo_cmd_request *cmd, char *loop_id,
 			  size_t loop_id_len, char *sub, size_t sub_len)
 {
@@ -26,116 +82,375 @@ static int parse_loop_key(const struct coo_cmd_request *cmd, char *loop_id,
 					    sub, sub_len);
 }
 
-static int loop_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+typedef int (*loop_query_fn)(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			     const char *loop_id);
+typedef int (*loop_effect_fn)(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			      const char *loop_id, const struct coo_json_doc *doc);
+
+static int loop_target_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			     const char *loop_id)
 {
-	char loop_id[MAX_ID_LENGTH];
-	char sub[COO_CMD_KEY_MAX];
-	char payload[128];
+	char payload[192];
+	ramp_progress_t ramp;
 
-	if (parse_loop_key(cmd, loop_id, sizeof(loop_id), sub, sizeof(sub)) != 0) {
-		return coo_cmd_invalid_response(out, cmd);
+	if (control_loop_get_ramp_progress(loop_id, &ramp) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
 	}
+	snprintf(payload, sizeof(payload), "{\"target\":%.2f,\"ramp_rate\":%.2f}",
+		 (double)(ramp.target - KELVIN_OFFSET), (double)ramp.rate_k_per_min);
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
 
-	if (strcmp(sub, "target") == 0) {
-		float target_k;
+static int loop_target_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			      const char *loop_id, const struct coo_json_doc *doc)
+{
+	double celsius;
 
-		if (control_loop_get_target(loop_id, &target_k) != 0) {
-			return coo_cmd_error(out, cmd, "unknown loop");
-		}
-		snprintf(payload, sizeof(payload), "{\"target\":%.2f}",
-			 (double)(target_k - KELVIN_OFFSET));
-		return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+	if (coo_json_doc_get_double(doc, "value", &celsius) !=
+	    COO_JSON_EXTRACT_OK || !float_ok(celsius)) {
+		return coo_cmd_error(out, cmd, "value required");
 	}
+	if (control_loop_set_target(loop_id, (float)celsius + KELVIN_OFFSET) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
+	}
+	return coo_cmd_ok(out, cmd);
+}
 
-	if (strcmp(sub, "gains") == 0) {
-		float kp, ki, kd;
+static int loop_ramp_rate_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+				const char *loop_id)
+{
+	char payload[192];
+	ramp_progress_t ramp;
 
-		if (control_loop_get_gains(loop_id, &kp, &ki, &kd) != 0) {
-			return coo_cmd_error(out, cmd, "unknown loop");
-		}
-		snprintf(payload, sizeof(payload),
-			 "{\"kp\":%.3f,\"ki\":%.3f,\"kd\":%.3f}",
-			 (double)kp, (double)ki, (double)kd);
-		return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+	if (control_loop_get_ramp_progress(loop_id, &ramp) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
 	}
+	snprintf(payload, sizeof(payload), "{\"ramp_rate\":%.2f}", (double)ramp.rate_k_per_min);
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
 
-	if (strcmp(sub, "enable") == 0) {
-		bool enabled;
+static int loop_ramp_rate_effect(const struct coo_cmd_request *cmd,
+				 struct coo_cmd_response *out, const char *loop_id,
+				 const struct coo_json_doc *doc)
+{
+	double rate;
 
-		if (control_loop_get_enabled(loop_id, &enabled) != 0) {
-			return coo_cmd_error(out, cmd, "unknown loop");
-		}
-		snprintf(payload, sizeof(payload), "{\"enabled\":%s}",
-			 enabled ? "true" : "false");
-		return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+	if (coo_json_doc_get_double(doc, "value", &rate) !=
+	    COO_JSON_EXTRACT_OK || !float_ok(rate)) {
+		return coo_cmd_error(out, cmd, "value required");
+	}
+	if (rate < 0.0) {
+		return coo_cmd_error(out, cmd, "value must be >= 0");
+	}
+	/* A Celsius interval is a Kelvin interval, so no offset here */
+	if (control_loop_set_ramp_rate(loop_id, (float)rate) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
+	}
+	return coo_cmd_ok(out, cmd);
+}
+
+static int loop_profile_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			      const char *loop_id)
+{
+	char payload[192];
+	ramp_progress_t ramp;
+
+	if (control_loop_get_ramp_progress(loop_id, &ramp) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
 	}
+	snprintf(payload, sizeof(payload),
+		 "{\"active\":%s,\"segment\":%d,\"segments\":%d,"
+		 "\"soak_remaining\":%.1f,\"setpoint\":%.2f,\"target\":%.2f}",
+		 ramp.profile_active ? "true" : "false", ramp.segment,
+		 ramp.num_segments, (double)ramp.soak_remaining_s,
+		 (double)(ramp.setpoint - KELVIN_OFFSET),
+		 (double)(ramp.target - KELVIN_OFFSET));
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
 
-	if (strcmp(sub, "status") == 0) {
-		float target_k;
-		loop_status_t status = control_loop_get_status(loop_id);
+static int loop_profile_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			       const char *loop_id, const struct coo_json_doc *doc)
+{
+	double values[RAMP_MAX_SEGMENTS * 3];
+	ramp_segment_t segments[RAMP_MAX_SEGMENTS];
+	size_t count;
 
-		if (status == LOOP_STATUS_NOT_INITIALIZED ||
-		    control_loop_get_target(loop_id, &target_k) != 0) {
+	if (coo_json_doc_get_double_array(doc, "segments", values,
+					  ARRAY_SIZE(values), &count) !=
+	    COO_JSON_EXTRACT_OK || (count % 3) != 0) {
+		return coo_cmd_error(out, cmd, "segments: [target, rate, soak, ...] required");
+	}
+	/* An empty list cancels the running profile */
+	if (count == 0) {
+		if (control_loop_stop_profile(loop_id) != 0) {
 			return coo_cmd_error(out, cmd, "unknown loop");
 		}
-		snprintf(payload, sizeof(payload),
-			 "{\"setpoint\":%.2f,\"status\":%d}",
-			 (double)(target_k - KELVIN_OFFSET), (int)status);
-		return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+		return coo_cmd_ok(out, cmd);
 	}
-
-	return coo_cmd_unknown_response(out, cmd);
+	for (size_t i = 0; i < count; i++) {
+		if (!float_ok(values[i])) {
+			return coo_cmd_error(out, cmd, "segments must be finite");
+		}
+	}
+	for (size_t i = 0; i < count / 3; i++) {
+		if (values[i * 3 + 1] < 0.0 || values[i * 3 + 2] < 0.0) {
+			return coo_cmd_error(out, cmd, "rate and soak must be >= 0");
+		}
+		segments[i].target_kelvin = (float)values[i * 3] + KELVIN_OFFSET;
+		segments[i].rate_k_per_min = (float)values[i * 3 + 1];
+		segments[i].soak_seconds = (float)values[i * 3 + 2];
+	}
+	if (control_loop_start_profile(loop_id, segments, (int)(count / 3)) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
+	}
+	return coo_cmd_ok(out, cmd);
 }
 
-static int loop_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+static int loop_autotune_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			       const char *loop_id)
 {
-	char loop_id[MAX_ID_LENGTH];
-	char sub[COO_CMD_KEY_MAX];
+	char payload[192];
+	autotune_progress_t tune;
 
-	if (parse_loop_key(cmd, loop_id, sizeof(loop_id), sub, sizeof(sub)) != 0) {
-		return coo_cmd_invalid_response(out, cmd);
+	if (control_loop_get_autotune_progress(loop_id, &tune) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
 	}
+	snprintf(payload, sizeof(payload),
+		 "{\"state\":\"%s\",\"error\":%d,\"cycle\":%d,\"cycles\":%d,"
+		 "\"elapsed\":%.0f,\"output\":%.2f,\"ku\":%.4f,\"pu\":%.1f,"
+		 "\"kp\":%.3f,\"ki\":%.4f,\"kd\":%.3f}",
+		 autotune_state_names[tune.state], (int)tune.error, tune.cycles_done,
+		 tune.cycles, (double)tune.elapsed_s, (double)tune.output,
+		 (double)tune.ku, (double)tune.pu, (double)tune.kp, (double)tune.ki,
+		 (double)tune.kd);
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
 
-	if (strcmp(sub, "target") == 0) {
-		double celsius;
+static int loop_autotune_effect(const struct coo_cmd_request *cmd,
+				struct coo_cmd_response *out, const char *loop_id,
+				const struct coo_json_doc *doc)
+{
+	double power;
+	double hysteresis = AUTOTUNE_DEFAULT_HYSTERESIS;
+	double deviation = AUTOTUNE_DEFAULT_DEVIATION;
+	uint32_t cycles = AUTOTUNE_DEFAULT_CYCLES;
+	uint32_t timeout = AUTOTUNE_DEFAULT_TIMEOUT_S;
+	bool apply = false;
+	int rule = AUTOTUNE_RULE_TYREUS_LUYBEN;
+	bool has_hysteresis = false;
+	bool has_deviation = false;
+	bool has_cycles = false;
+	bool has_timeout = false;
+	bool has_apply = false;
+	ramp_progress_t ramp;
 
-		if (coo_json_extract_double(cmd->payload, "value", &celsius) !=
-		    COO_JSON_EXTRACT_OK) {
-			return coo_cmd_error(out, cmd, "value required");
-		}
-		if (control_loop_set_target(loop_id, (float)celsius + KELVIN_OFFSET) != 0) {
+	if (coo_json_doc_get_double(doc, "power", &power) !=
+	    COO_JSON_EXTRACT_OK || !float_ok(power) || power < 0.0) {
+		return coo_cmd_error(out, cmd, "power >= 0 required");
+	}
+	/* Zero power cancels a running tune */
+	if (power == 0.0) {
+		if (control_loop_autotune_abort(loop_id) != 0) {
 			return coo_cmd_error(out, cmd, "unknown loop");
 		}
 		return coo_cmd_ok(out, cmd);
 	}
+	if (coo_json_doc_optional_double_range(doc, "hysteresis", &hysteresis,
+					       &has_hysteresis, 0.0, 10.0) != 0 ||
+	    coo_json_doc_optional_double_range(doc, "deviation", &deviation,
+					       &has_deviation, 0.0, 100.0) != 0 ||
+	    coo_json_doc_optional_u32(doc, "cycles", &cycles, &has_cycles) != 0 ||
+	    coo_json_doc_optional_u32(doc, "timeout", &timeout, &has_timeout) != 0 ||
+	    coo_json_doc_optional_bool(doc, "apply", &apply, &has_apply) != 0 ||
+	    coo_json_doc_get_string_choice(doc, "rule", autotune_rules,
+					   ARRAY_SIZE(autotune_rules), &rule) ==
+		    COO_JSON_EXTRACT_ERR) {
+		return coo_cmd_error(out, cmd, "invalid autotune parameters");
+	}
+	if (has_cycles && (cycles == 0U || cycles > UINT8_MAX)) {
+		return coo_cmd_error(out, cmd, "cycles must be 1..255");
+	}
+	/* The relay switches around the loop's current working setpoint */
+	if (control_loop_get_ramp_progress(loop_id, &ramp) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
+	}
 
-	if (strcmp(sub, "gains") == 0) {
-		double kp, ki, kd;
+	autotune_params_t params = {
+		.setpoint = ramp.setpoint,
+		.output_high = (float)power,
+		.output_low = 0.0f,
+		.hysteresis = (float)hysteresis,
+		.max_deviation = (float)deviation,
+		.timeout_s = (float)timeout,
+		.cycles = (uint8_t)cycles,
+		.rule = (autotune_rule_t)rule,
+	};
 
-		if (coo_json_extract_double(cmd->payload, "kp", &kp) != COO_JSON_EXTRACT_OK ||
-		    coo_json_extract_double(cmd->payload, "ki", &ki) != COO_JSON_EXTRACT_OK ||
-		    coo_json_extract_double(cmd->payload, "kd", &kd) != COO_JSON_EXTRACT_OK) {
-			return coo_cmd_error(out, cmd, "kp, ki, kd required");
-		}
-		if (control_loop_set_gains(loop_id, (float)kp, (float)ki, (float)kd) != 0) {
-			return coo_cmd_error(out, cmd, "unknown loop");
-		}
-		return coo_cmd_ok(out, cmd);
+	if (control_loop_autotune_start(loop_id, &params, apply) != 0) {
+		return coo_cmd_error(out, cmd, "autotune rejected");
 	}
+	return coo_cmd_ok(out, cmd);
+}
 
-	if (strcmp(sub, "enable") == 0) {
-		bool enable;
+static int loop_gains_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			    const char *loop_id)
+{
+	char payload[192];
+	float kp, ki, kd;
 
-		if (coo_json_extract_bool(cmd->payload, "value", &enable) != COO_JSON_EXTRACT_OK) {
-			return coo_cmd_error(out, cmd, "value required");
-		}
-		if (control_loop_enable(loop_id, enable) != 0) {
-			return coo_cmd_error(out, cmd, "unknown loop");
+	if (control_loop_get_gains(loop_id, &kp, &ki, &kd) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
+	}
+	snprintf(payload, sizeof(payload), "{\"kp\":%.3f,\"ki\":%.3f,\"kd\":%.3f}",
+		 (double)kp, (double)ki, (double)kd);
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
+
+static int loop_gains_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			     const char *loop_id, const struct coo_json_doc *doc)
+{
+	double kp, ki, kd;
+
+	if (coo_json_doc_get_double(doc, "kp", &kp) != COO_JSON_EXTRACT_OK ||
+	    coo_json_doc_get_double(doc, "ki", &ki) != COO_JSON_EXTRACT_OK ||
+	    coo_json_doc_get_double(doc, "kd", &kd) != COO_JSON_EXTRACT_OK) {
+		return coo_cmd_error(out, cmd, "kp, ki, kd required");
+	}
+	if (!float_ok(kp) || !float_ok(ki) || !float_ok(kd)) {
+		return coo_cmd_error(out, cmd, "kp, ki, kd must be finite");
+	}
+	if (control_loop_set_gains(loop_id, (float)kp, (float)ki, (float)kd) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
+	}
+	return coo_cmd_ok(out, cmd);
+}
+
+static int loop_enable_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			     const char *loop_id)
+{
+	char payload[192];
+	bool enabled;
+
+	if (control_loop_get_enabled(loop_id, &enabled) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
+	}
+	snprintf(payload, sizeof(payload), "{\"enabled\":%s}", enabled ? "true" : "false");
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
+
+static int loop_enable_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			      const char *loop_id, const struct coo_json_doc *doc)
+{
+	bool enable;
+
+	if (coo_json_doc_get_bool(doc, "value", &enable) != COO_JSON_EXTRACT_OK) {
+		return coo_cmd_error(out, cmd, "value required");
+	}
+	if (control_loop_enable(loop_id, enable) != 0) {
+		return coo_cmd_error(out, cmd, "unknown loop");
+	}
+	return coo_cmd_ok(out, cmd);
+}
+
+static int loop_status_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out,
+			     const char *loop_id)
+{
+	char payload[192];
+	loop_reading_t r;
+	int handle = control_loop_find_handle(loop_id);
+
+	if (handle < 0 || control_loop_get_reading_by_handle(handle, &r) != 0 ||
+	    r.status == LOOP_STATUS_NOT_INITIALIZED) {
+		return coo_cmd_error(out, cmd, "unknown loop");
+	}
+	snprintf(payload, sizeof(payload),
+		 "{\"setpoint\":%.2f,\"target_setpoint\":%.2f,\"ramp_active\":%s,"
+		 "\"ramp_rate\":%.2f,\"status\":%d,\"overruns\":%u,\"skipped\":%u}",
+		 (double)(r.ramp.setpoint - KELVIN_OFFSET),
+		 (double)(r.ramp.target - KELVIN_OFFSET),
+		 r.ramp.ramping ? "true" : "false", (double)r.ramp.rate_k_per_min,
+		 (int)r.status, (unsigned int)r.overruns, (unsigned int)r.skipped);
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
+
+/*
+ * loop/<loop_id>/<sub> endpoints. The loop spec below accepts the union of
+ * these payload keys at ingress; each effect is held to its own list here.
+ */
+static const struct loop_spec {
+	const char *sub;
+	loop_query_fn query_handler;
+	loop_effect_fn effect_handler;
+	const char *allowed_payload_keys;
+} loop_specs[] = {
+	{ "target", loop_target_query, loop_target_effect, "value" },
+	{ "ramp_rate", loop_ramp_rate_query, loop_ramp_rate_effect, "value" },
+	{ "profile", loop_profile_query, loop_profile_effect, "segments" },
+	{ "autotune", loop_autotune_query, loop_autotune_effect,
+	  "power,hysteresis,deviation,cycles,timeout,apply,rule" },
+	{ "gains", loop_gains_query, loop_gains_effect, "kp,ki,kd" },
+	{ "enable", loop_enable_query, loop_enable_effect, "value" },
+	{ "status", loop_status_query, NULL, NULL },
+};
+
+static const struct loop_spec *loop_find_spec(const char *sub)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(loop_specs); i++) {
+		if (strcmp(sub, loop_specs[i].sub) == 0) {
+			return &loop_specs[i];
 		}
-		return coo_cmd_ok(out, cmd);
 	}
+	return NULL;
+}
+
+static int loop_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	char loop_id[MAX_ID_LENGTH];
+	char sub[COO_CMD_KEY_MAX];
+	const struct loop_spec *spec;
 
-	return coo_cmd_unknown_response(out, cmd);
+	if (parse_loop_key(cmd, loop_id, sizeof(loop_id), sub, sizeof(sub)) != 0) {
+		return coo_cmd_invalid_response(out, cmd);
+	}
+	spec = loop_find_spec(sub);
+	if (spec == NULL) {
+		return coo_cmd_unknown_response(out, cmd);
+	}
+	return spec->query_handler(cmd, out, loop_id);
+}
+
+static int loop_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	char loop_id[MAX_ID_LENGTH];
+	char sub[COO_CMD_KEY_MAX];
+	char unknown_key[COO_JSON_KEY_MAX + 1];
+	char payload[COO_JSON_KEY_MAX + 48];
+	const struct loop_spec *spec;
+	struct coo_json_doc doc;
+	int rc;
+
+	if (parse_loop_key(cmd, loop_id, sizeof(loop_id), sub, sizeof(sub)) != 0) {
+		return coo_cmd_invalid_response(out, cmd);
+	}
+	spec = loop_find_spec(sub);
+	if (spec == NULL) {
+		return coo_cmd_unknown_response(out, cmd);
+	}
+	if (spec->effect_handler == NULL) {
+		return coo_cmd_unsupported_response(out, cmd);
+	}
+	/* One scan of the payload checks its keys and fills the span table */
+	rc = coo_json_doc_parse(&doc, cmd->payload, spec->allowed_payload_keys,
+				unknown_key, sizeof(unknown_key));
+	if (rc == -ENOENT) {
+		snprintf(payload, sizeof(payload),
+			 "{\"error\":\"unknown argument\",\"arg\":\"%s\"}", unknown_key);
+		return coo_cmd_reply(out, cmd, COO_CMD_RESP_ERROR, payload);
+	}
+	if (rc != 0) {
+		return coo_cmd_error(out, cmd, "invalid payload");
+	}
+	return spec->effect_handler(cmd, out, loop_id, &doc);
 }
 
 /* Append {"<field>":[ "id0","id1",... ]} for an indexed id accessor */
@@ -175,23 +490,762 @@ static int heaters_list(const struct coo_cmd_request *cmd, struct coo_cmd_respon
 			     heater_manager_get_id_at);
 }
 
+enum snapshot_section {
+	SNAPSHOT_LOOPS,
+	SNAPSHOT_SENSORS,
+	SNAPSHOT_HEATERS,
+	SNAPSHOT_SECTIONS,
+};
+
+static const char *const snapshot_section_names[] = {
+	[SNAPSHOT_LOOPS] = "loops",
+	[SNAPSHOT_SENSORS] = "sensors",
+	[SNAPSHOT_HEATERS] = "heaters",
+};
+
+/*
+ * Handlers run on the single executor thread, so the snapshot copies can be
+ * static rather than a couple of kilobytes of executor stack.
+ */
+static struct {
+	loop_snapshot_t loops;
+	sensor_snapshot_t sensors;
+	heater_snapshot_t heaters;
+	char item[SNAPSHOT_ITEM_MAX];
+} snap;
+
+/* Format one snapshot entry into snap.item; returns its length or -ENOSPC */
+static int snapshot_item(enum snapshot_section section, int i)
+{
+	size_t off = 0;
+	int rc;
+
+	switch (section) {
+	case SNAPSHOT_LOOPS: {
+		const loop_reading_t *r = &snap.loops.loops[i];
+
+		rc = coo_json_append(snap.item, sizeof(snap.item), &off,
+				     "{\"id\":\"%s\",\"enabled\":%s,\"status\":%d,"
+				     "\"autotune\":%s,\"temperature\":",
+				     control_loop_get_id_at(i), r->enabled ? "true" : "false",
+				     (int)r->status, r->autotune ? "true" : "false");
+		if (rc == 0) {
+			rc = coo_json_append_float_or_null(snap.item, sizeof(snap.item), &off,
+							   (double)(r->measured - KELVIN_OFFSET), 3);
+		}
+		if (rc == 0) {
+			rc = coo_json_append(snap.item, sizeof(snap.item), &off,
+					     ",\"setpoint\":%.2f,\"target\":%.2f,\"ramp_rate\":%.2f,"
+					     "\"ramp_active\":%s,\"profile_active\":%s,"
+					     "\"power\":%.2f,\"kp\":%.3f,\"ki\":%.3f,\"kd\":%.3f,"
+					     "\"overruns\":%u,\"skipped\":%u}",
+					     (double)(r->ramp.setpoint - KELVIN_OFFSET),
+					     (double)(r->ramp.target - KELVIN_OFFSET),
+					     (double)r->ramp.rate_k_per_min,
+					     r->ramp.ramping ? "true" : "false",
+					     r->ramp.profile_active ? "true" : "false",
+					     (double)r->output, (double)r->kp, (double)r->ki,
+					     (double)r->kd, (unsigned int)r->overruns,
+					     (unsigned int)r->skipped);
+		}
+		break;
+	}
+	case SNAPSHOT_SENSORS: {
+		const sensor_reading_t *r = &snap.sensors.readings[i];
+		bool valid = snap.sensors.valid[i];
+
+		rc = coo_json_append(snap.item, sizeof(snap.item), &off,
+				     "{\"id\":\"%s\",\"temperature\":",
+				     sensor_manager_get_id_at(i));
+		if (rc == 0) {
+			rc = coo_json_append_float_or_null(snap.item, sizeof(snap.item), &off,
+							   valid ? (double)(r->temperature_kelvin -
+									    KELVIN_OFFSET)
+								 : (double)NAN, 3);
+		}
+		if (rc == 0) {
+			rc = coo_json_append(snap.item, sizeof(snap.item), &off,
+					     ",\"status\":%d,\"time_ms\":%lld}",
+					     (int)r->status, (long long)r->timestamp_ms);
+		}
+		break;
+	}
+	case SNAPSHOT_HEATERS: {
+		const heater_reading_t *r = &snap.heaters.heaters[i];
+
+		rc = coo_json_append(snap.item, sizeof(snap.item), &off,
+				     "{\"id\":\"%s\",\"power\":%.2f,\"status\":%d}",
+				     heater_manager_get_id_at(i), (double)r->power_percent,
+				     (int)r->status);
+		break;
+	}
+	default:
+		rc = -EINVAL;
+		break;
+	}
+
+	return rc == 0 ? (int)off : rc;
+}
+
+/*
+ * snapshot: every loop, sensor and heater in one reply. Each manager is
+ * read once under its own lock. Entries are numbered across the three
+ * lists (loops, then sensors, then heaters) and packed greedily into a
+ * reply of COO_CMD_PAYLOAD_MAX from {"start":n}; "next" is the first
+ * entry left out, absent on the last reply. The numbering depends only on
+ * the configured counts, not on how wide this read's values printed, so
+ * a host walking start = next neither skips nor repeats an entry.
+ */
+static int snapshot_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	char payload[COO_CMD_PAYLOAD_MAX];
+	uint32_t start = 0U;
+	uint32_t next = 0U;
+	uint32_t index = 0U;
+	size_t used = 0;
+	size_t off = 0;
+	int rc;
+
+	if (!coo_cmd_payload_empty(cmd)) {
+		struct coo_json_doc doc;
+
+		if (coo_json_doc_parse(&doc, cmd->payload, NULL, NULL, 0) != 0 ||
+		    coo_json_doc_optional_u32(&doc, "start", &start, NULL) != 0) {
+			return coo_cmd_error(out, cmd, "invalid start");
+		}
+	}
+
+	if (sensor_manager_get_snapshot(&snap.sensors) != 0 ||
+	    control_loop_get_snapshot(&snap.loops) != 0 ||
+	    heater_manager_get_snapshot(&snap.heaters) != 0) {
+		return coo_cmd_error(out, cmd, "snapshot unavailable");
+	}
+
+	const int counts[SNAPSHOT_SECTIONS] = {
+		[SNAPSHOT_LOOPS] = snap.loops.count,
+		[SNAPSHOT_SENSORS] = snap.sensors.count,
+		[SNAPSHOT_HEATERS] = snap.heaters.count,
+	};
+	const uint32_t total = (uint32_t)(counts[SNAPSHOT_LOOPS] + counts[SNAPSHOT_SENSORS] +
+					  counts[SNAPSHOT_HEATERS]);
+
+	if (start > 0U && start >= total) {
+		return coo_cmd_error(out, cmd, "start out of range");
+	}
+
+	rc = coo_json_append(payload, sizeof(payload), &off,
+			     "{\"start\":%u,\"sweep\":%u,\"sweep_ms\":%lld",
+			     (unsigned int)start, (unsigned int)snap.sensors.sweep,
+			     (long long)snap.sensors.timestamp_ms);
+
+	for (int section = 0; section < SNAPSHOT_SECTIONS && rc == 0; section++) {
+		bool first = true;
+
+		rc = coo_json_append(payload, sizeof(payload), &off, ",\"%s\":[",
+				     snapshot_section_names[section]);
+		for (int i = 0; i < counts[section] && rc == 0; i++, index++) {
+			if (index < start || next != 0U) {
+				continue;
+			}
+
+			int len = snapshot_item((enum snapshot_section)section, i);
+
+			if (len < 0) {
+				rc = len;
+				break;
+			}
+			/* Stop before the entry that would overflow; the first always fits */
+			if (used > 0 && used + (size_t)len + 1 > SNAPSHOT_ITEM_MAX) {
+				next = index;
+				continue;
+			}
+			used += (size_t)len + 1;
+			rc = coo_json_append(payload, sizeof(payload), &off, "%s%s",
+					     first ? "" : ",", snap.item);
+			first = false;
+		}
+		if (rc == 0) {
+			rc = coo_json_append(payload, sizeof(payload), &off, "]");
+		}
+	}
+	if (rc == 0 && next != 0U) {
+		rc = coo_json_append(payload, sizeof(payload), &off, ",\"next\":%u",
+				     (unsigned int)next);
+	}
+	if (rc == 0) {
+		rc = coo_json_append(payload, sizeof(payload), &off, ",\"total\":%u}",
+				     (unsigned int)total);
+	}
+	if (rc != 0) {
+		return coo_cmd_error(out, cmd, "response too large");
+	}
+
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
+
+#ifdef CONFIG_COO_SUBSCRIPTIONS
+/*
+ * Subscribable values, Celsius / percent as on the wire:
+ *   loop/<id>/temperature|setpoint|target|power
+ *   sensor/<id>/temperature
+ *   heater/<id>/power
+ * A key resolves to (source << 16 | field << 8 | handle) once, so a poll
+ * never parses it again.
+ */
+enum sub_source {
+	SUB_LOOP,
+	SUB_SENSOR,
+	SUB_HEATER,
+};
+
+enum sub_field {
+	SUB_TEMPERATURE,
+	SUB_SETPOINT,
+	SUB_TARGET,
+	SUB_POWER,
+};
+
+static const struct coo_json_string_choice sub_fields[] = {
+	{ "temperature", SUB_TEMPERATURE },
+	{ "setpoint", SUB_SETPOINT },
+	{ "target", SUB_TARGET },
+	{ "power", SUB_POWER },
+};
+
+COO_SUBSCRIPTIONS_DEFINE(thermal_subs, CONFIG_COO_COMMANDS_SUBSCRIPTIONS);
+
+static int sub_resolve(const char *key, uint32_t *ref, void *user_data)
+{
+	static const char *const prefixes[] = {
+		[SUB_LOOP] = "loop",
+		[SUB_SENSOR] = "sensor",
+		[SUB_HEATER] = "heater",
+	};
+	char id[MAX_ID_LENGTH];
+	char sub[COO_CMD_KEY_MAX];
+	int field;
+	int handle;
+
+	ARG_UNUSED(user_data);
+
+	for (int source = 0; source < (int)ARRAY_SIZE(prefixes); source++) {
+		if (coo_cmd_key_suffix_pair_copy(key, prefixes[source], id, sizeof(id),
+						 sub, sizeof(sub)) != 0 ||
+		    coo_json_match_string_choice(sub, sub_fields, ARRAY_SIZE(sub_fields),
+						 &field) != 0) {
+			continue;
+		}
+
+		switch (source) {
+		case SUB_LOOP:
+			handle = control_loop_find_handle(id);
+			break;
+		case SUB_SENSOR:
+			handle = (field == SUB_TEMPERATURE) ? sensor_manager_find_handle(id) : -1;
+			break;
+		default:
+			handle = (field == SUB_POWER) ? heater_manager_find_handle(id) : -1;
+			break;
+		}
+		if (handle < 0) {
+			return -ENOENT;
+		}
+
+		*ref = ((uint32_t)source << 16) | ((uint32_t)field << 8) | (uint32_t)handle;
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+static int sub_read(uint32_t ref, double *value, void *user_data)
+{
+	int handle = (int)(ref & 0xFFU);
+	int field = (int)((ref >> 8) & 0xFFU);
+	loop_reading_t loop;
+	sensor_reading_t reading;
+	float power;
+
+	ARG_UNUSED(user_data);
+
+	switch (ref >> 16) {
+	case SUB_LOOP:
+		if (control_loop_get_reading_by_handle(handle, &loop) != 0) {
+			return -ENOENT;
+		}
+		switch (field) {
+		case SUB_TEMPERATURE:
+			*value = (double)(loop.measured - KELVIN_OFFSET);
+			break;
+		case SUB_SETPOINT:
+			*value = (double)(loop.ramp.setpoint - KELVIN_OFFSET);
+			break;
+		case SUB_TARGET:
+			*value = (double)(loop.ramp.target - KELVIN_OFFSET);
+			break;
+		default:
+			*value = (double)loop.output;
+			break;
+		}
+		return 0;
+	case SUB_SENSOR:
+		if (sensor_manager_get_reading_by_handle(handle, &reading) != 0) {
+			return -EIO;
+		}
+		*value = (double)(reading.temperature_kelvin - KELVIN_OFFSET);
+		return 0;
+	case SUB_HEATER:
+		if (heater_manager_get_power_by_handle(handle, &power) != 0) {
+			return -EIO;
+		}
+		*value = (double)power;
+		return 0;
+	default:
+		return -ENOENT;
+	}
+}
+
+static int subscribe_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	return coo_subscription_subscribe_cmd(&thermal_subs, cmd, out);
+}
+
+static int unsubscribe_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	return coo_subscription_unsubscribe_cmd(&thermal_subs, cmd, out);
+}
+
+static int subscriptions_list(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	return coo_subscription_list_cmd(&thermal_subs, cmd, out);
+}
+
+int thermal_commands_poll_subscriptions(struct coo_cmd_runtime *runtime,
+					struct coo_cmd_response *scratch)
+{
+	return coo_subscription_poll(&thermal_subs, runtime, scratch);
+}
+#endif
+
+int thermal_commands_init(void)
+{
+#ifdef CONFIG_COO_SUBSCRIPTIONS
+	return coo_subscriptions_init(&thermal_subs, sub_resolve, sub_read, NULL);
+#else
+	return 0;
+#endif
+}
+
 static int estop_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
 {
-	heater_manager_emergency_stop();
+	int rc = heater_manager_emergency_stop();
+
+	/* Suspend the loops even if an output would not cut */
 	control_loop_suspend_all();
+	if (rc != 0) {
+		return coo_cmd_error(out, cmd, "heater output cut failed");
+	}
+	return coo_cmd_ok(out, cmd);
+}
+
+/*
+ * heater/<id>/clear_fault: drop a latched fault. The heater comes back
+ * off and follows the next command. Refused while a tripped interlock
+ * still holds the heater, since that interlock would not cut it again.
+ */
+static int heater_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	char heater_id[MAX_ID_LENGTH];
+	char sub[COO_CMD_KEY_MAX];
+	int handle;
+
+	if (coo_cmd_key_suffix_pair_copy(cmd->key, "heater", heater_id, sizeof(heater_id),
+					 sub, sizeof(sub)) != 0) {
+		return coo_cmd_invalid_response(out, cmd);
+	}
+	if (strcmp(sub, "clear_fault") != 0) {
+		return coo_cmd_unknown_response(out, cmd);
+	}
+
+	handle = heater_manager_find_handle(heater_id);
+	if (handle < 0) {
+		return coo_cmd_error(out, cmd, "unknown heater");
+	}
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+	if (sensor_interlock_holds_heater(handle)) {
+		return coo_cmd_error(out, cmd, "interlock tripped, rearm first");
+	}
+#endif
+	if (heater_manager_clear_fault(handle) != 0) {
+		return coo_cmd_error(out, cmd, "unknown heater");
+	}
+	return coo_cmd_ok(out, cmd);
+}
+
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+static int interlock_handle(const struct coo_cmd_request *cmd)
+{
+	char interlock_id[MAX_ID_LENGTH];
+
+	if (coo_cmd_key_suffix_segment_copy(cmd->key, "interlock", interlock_id,
+					    sizeof(interlock_id)) != 0) {
+		return -EINVAL;
+	}
+
+	int handle = sensor_interlock_find_handle(interlock_id);
+
+	return handle < 0 ? -ENOENT : handle;
+}
+
+static int interlock_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	sensor_interlock_status_t st;
+	char payload[128];
+	size_t off = 0;
+	int handle = interlock_handle(cmd);
+	int rc;
+
+	if (handle == -EINVAL) {
+		return coo_cmd_invalid_response(out, cmd);
+	}
+	if (handle < 0 || sensor_interlock_get_status(handle, &st) != 0) {
+		return coo_cmd_error(out, cmd, "unknown interlock");
+	}
+
+	rc = coo_json_append(payload, sizeof(payload), &off, "{\"tripped\":%s",
+			     st.tripped ? "true" : "false");
+	/* A read-failure trip has no sample: trip_temperature is null */
+	if (rc == 0 && st.tripped) {
+		rc = coo_json_append(payload, sizeof(payload), &off, ",\"trip_temperature\":");
+		if (rc == 0) {
+			rc = coo_json_append_float_or_null(payload, sizeof(payload), &off,
+							   (double)(st.trip_temperature -
+								    KELVIN_OFFSET), 2);
+		}
+		if (rc == 0) {
+			rc = coo_json_append(payload, sizeof(payload), &off, ",\"trip_ms\":%lld",
+					     (long long)st.trip_time_ms);
+		}
+	}
+	if (rc == 0) {
+		rc = coo_json_append(payload, sizeof(payload), &off, "}");
+	}
+	if (rc != 0) {
+		return coo_cmd_error(out, cmd, "response too large");
+	}
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
+
+/* {"rearm":true} re-arms the interlock; its heaters stay latched until cleared */
+static int interlock_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	struct coo_json_doc doc;
+	bool rearm = false;
+	int handle = interlock_handle(cmd);
+
+	if (handle == -EINVAL) {
+		return coo_cmd_invalid_response(out, cmd);
+	}
+	if (handle < 0) {
+		return coo_cmd_error(out, cmd, "unknown interlock");
+	}
+	if (coo_json_doc_parse(&doc, cmd->payload, NULL, NULL, 0U) != 0 ||
+	    coo_json_doc_optional_bool(&doc, "rearm", &rearm, NULL) != 0 || !rearm) {
+		return coo_cmd_error(out, cmd, "rearm required");
+	}
+	if (sensor_interlock_rearm(handle) != 0) {
+		return coo_cmd_error(out, cmd, "unknown interlock");
+	}
+	return coo_cmd_ok(out, cmd);
+}
+#endif /* CONFIG_COO_SENSOR_INTERLOCK */
+
+#ifdef CONFIG_COO_CONTROL_PERSIST
+static int persist_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	loop_persist_stats_t stats;
+	char payload[COO_CMD_PAYLOAD_MAX];
+
+	if (loop_persist_get_stats(&stats) != 0) {
+		return coo_cmd_error(out, cmd, "persistence unavailable");
+	}
+	snprintf(payload, sizeof(payload),
+		 "{\"changes\":%u,\"writes\":%u,\"unchanged\":%u,\"write_errors\":%u,"
+		 "\"restored\":%d,\"pending\":%s,\"last_write_ms\":%lld}",
+		 (unsigned int)stats.changes, (unsigned int)stats.writes,
+		 (unsigned int)stats.unchanged, (unsigned int)stats.write_errors,
+		 stats.restored, stats.pending ? "true" : "false",
+		 (long long)stats.last_write_ms);
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
+
+/* {"flush":true} saves now; {"clear":true} drops the saved state */
+static int persist_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	struct coo_json_doc doc;
+	bool flush = false;
+	bool clear = false;
+
+	if (coo_json_doc_parse(&doc, cmd->payload, NULL, NULL, 0U) != 0 ||
+	    coo_json_doc_optional_bool(&doc, "flush", &flush, NULL) != 0 ||
+	    coo_json_doc_optional_bool(&doc, "clear", &clear, NULL) != 0 ||
+	    flush == clear) {
+		return coo_cmd_error(out, cmd, "flush or clear required");
+	}
+	if ((flush ? loop_persist_flush() : loop_persist_clear()) != 0) {
+		return coo_cmd_error(out, cmd, "flash write failed");
+	}
 	return coo_cmd_ok(out, cmd);
 }
+#endif
+
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+static int recorder_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	flight_recorder_stats_t st;
+	char payload[COO_CMD_PAYLOAD_MAX];
+
+	if (flight_recorder_get_stats(&st) != 0) {
+		return coo_cmd_error(out, cmd, "recorder unavailable");
+	}
+	snprintf(payload, sizeof(payload),
+		 "{\"page_size\":%u,\"capacity\":%u,\"stored\":%u,\"oldest\":%u,"
+		 "\"newest\":%u,\"boot\":%u,\"ticks\":%u,\"dropped\":%u,"
+		 "\"pages_written\":%u,\"write_errors\":%u,\"bits_per_tick\":%.2f}",
+		 (unsigned int)st.page_size, (unsigned int)st.capacity,
+		 (unsigned int)st.stored, (unsigned int)st.oldest_seq,
+		 (unsigned int)st.newest_seq, (unsigned int)st.boot, (unsigned int)st.ticks,
+		 (unsigned int)st.dropped, (unsigned int)st.pages_written,
+		 (unsigned int)st.write_errors,
+		 st.page_ticks > 0U ? (double)st.payload_bits / st.page_ticks : 0.0);
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
+
+/* {"flush":true} queues the page being filled for flash */
+static int recorder_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	struct coo_json_doc doc;
+	bool flush = false;
+
+	if (coo_json_doc_parse(&doc, cmd->payload, NULL, NULL, 0U) != 0 ||
+	    coo_json_doc_optional_bool(&doc, "flush", &flush, NULL) != 0 || !flush) {
+		return coo_cmd_error(out, cmd, "flush required");
+	}
+	if (flight_recorder_flush() != 0) {
+		return coo_cmd_error(out, cmd, "recorder unavailable");
+	}
+	return coo_cmd_ok(out, cmd);
+}
+
+/*
+ * recorder/dump: one chunk of one stored page per reply, base64 in "data".
+ * {"seq":s,"offset":o} picks the chunk; without a seq, or with one the
+ * ring has already recycled, the dump starts at the oldest page. The host
+ * repeats with next_seq / next_offset until "end" is true.
+ */
+static int recorder_dump(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	static uint8_t raw[RECORDER_DUMP_CHUNK];
+	char payload[COO_CMD_PAYLOAD_MAX];
+	flight_recorder_stats_t st;
+	uint32_t seq = 0U;
+	uint32_t offset = 0U;
+	bool have_seq = false;
+	size_t off = 0;
+	size_t b64_len = 0;
+	int len = 0;
+	int rc;
+
+	if (!coo_cmd_payload_empty(cmd)) {
+		struct coo_json_doc doc;
+
+		if (coo_json_doc_parse(&doc, cmd->payload, NULL, NULL, 0) != 0 ||
+		    coo_json_doc_optional_u32(&doc, "seq", &seq, &have_seq) != 0 ||
+		    coo_json_doc_optional_u32(&doc, "offset", &offset, NULL) != 0) {
+			return coo_cmd_error(out, cmd, "invalid cursor");
+		}
+	}
+	if (flight_recorder_get_stats(&st) != 0) {
+		return coo_cmd_error(out, cmd, "recorder unavailable");
+	}
+
+	/* Sequence numbers wrap, so compare by signed distance */
+	if (!have_seq || (int32_t)(seq - st.oldest_seq) < 0) {
+		seq = st.oldest_seq;
+		offset = 0U;
+	}
+	if (st.stored > 0U && (int32_t)(seq - st.newest_seq) <= 0 && offset < st.page_size) {
+		len = flight_recorder_read(seq, offset, raw, sizeof(raw));
+		if (len == -2) {
+			return coo_cmd_error(out, cmd, "page recycled, retry");
+		}
+		if (len < 0) {
+			return coo_cmd_error(out, cmd, "flash read failed");
+		}
+	}
+
+	uint32_t next_seq = seq;
+	uint32_t next_offset = offset + (uint32_t)len;
+
+	if (next_offset >= st.page_size) {
+		next_seq++;
+		next_offset = 0U;
+	}
+	bool end = st.stored == 0U || (int32_t)(next_seq - st.newest_seq) > 0;
+
+	rc = coo_json_append(payload, sizeof(payload), &off,
+			     "{\"seq\":%u,\"offset\":%u,\"len\":%d,\"next_seq\":%u,"
+			     "\"next_offset\":%u,\"end\":%s,\"data\":\"",
+			     (unsigned int)seq, (unsigned int)offset, len,
+			     (unsigned int)next_seq, (unsigned int)next_offset,
+			     end ? "true" : "false");
+	if (rc == 0 && len > 0) {
+		rc = base64_encode((uint8_t *)&payload[off], sizeof(payload) - off, &b64_len,
+				   raw, (size_t)len);
+		off += b64_len;
+	}
+	if (rc == 0) {
+		rc = coo_json_append(payload, sizeof(payload), &off, "\"}");
+	}
+	if (rc != 0) {
+		return coo_cmd_error(out, cmd, "response too large");
+	}
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
+#endif /* CONFIG_COO_FLIGHT_RECORDER */
+
+#ifdef CONFIG_COO_STAGE_TRACE
+static double trace_us(uint64_t cycles, uint32_t hz)
+{
+	return hz > 0U ? (double)cycles * 1e6 / (double)hz : 0.0;
+}
+
+/*
+ * stats: {"hz":n,"<stage>":[count,min_us,mean_us,max_us],...} for every
+ * stage. stats/<stage> adds that stage's log2 histogram, where hist[i]
+ * counts durations of 2^i to 2^(i+1) trace cycles, up to the highest
+ * non-empty bucket.
+ */
+static int stats_query(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	char payload[COO_CMD_PAYLOAD_MAX];
+	struct coo_trace_stage_stats st;
+	const char *name = coo_cmd_key_suffix_after(cmd->key, "stats");
+	uint32_t hz = coo_trace_cycles_per_sec();
+	size_t off = 0;
+	int rc;
+
+	if (name[0] != '\0') {
+		int stage = coo_trace_stage_find(name);
+		int top = 0;
+
+		if (stage < 0) {
+			return coo_cmd_error(out, cmd, "unknown stage");
+		}
+		(void)coo_trace_get((enum coo_trace_stage)stage, &st);
+		for (int i = 0; i < COO_TRACE_HIST_BUCKETS; i++) {
+			if (st.hist[i] != 0U) {
+				top = i + 1;
+			}
+		}
+
+		rc = coo_json_append(payload, sizeof(payload), &off,
+				     "{\"stage\":\"%s\",\"hz\":%u,\"count\":%u,\"min_us\":%.2f,"
+				     "\"mean_us\":%.2f,\"max_us\":%.2f,\"hist\":[",
+				     name, (unsigned int)hz, (unsigned int)st.count,
+				     trace_us(st.min_cycles, hz),
+				     st.count > 0U ? trace_us(st.total_cycles, hz) / st.count : 0.0,
+				     trace_us(st.max_cycles, hz));
+		for (int i = 0; i < top && rc == 0; i++) {
+			rc = coo_json_append(payload, sizeof(payload), &off, "%s%u",
+					     i > 0 ? "," : "", (unsigned int)st.hist[i]);
+		}
+		if (rc == 0) {
+			rc = coo_json_append(payload, sizeof(payload), &off, "]}");
+		}
+	} else {
+		rc = coo_json_append(payload, sizeof(payload), &off, "{\"hz\":%u",
+				     (unsigned int)hz);
+		for (int i = 0; i < COO_TRACE_STAGE_COUNT && rc == 0; i++) {
+			(void)coo_trace_get((enum coo_trace_stage)i, &st);
+			rc = coo_json_append(payload, sizeof(payload), &off,
+					     ",\"%s\":[%u,%.2f,%.2f,%.2f]",
+					     coo_trace_stage_name((enum coo_trace_stage)i),
+					     (unsigned int)st.count, trace_us(st.min_cycles, hz),
+					     st.count > 0U ? trace_us(st.total_cycles, hz) / st.count
+							   : 0.0,
+					     trace_us(st.max_cycles, hz));
+		}
+		if (rc == 0) {
+			rc = coo_json_append(payload, sizeof(payload), &off, "}");
+		}
+	}
+
+	if (rc != 0) {
+		return coo_cmd_error(out, cmd, "stats too large");
+	}
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
+
+/* {"reset":true} clears every stage */
+static int stats_effect(const struct coo_cmd_request *cmd, struct coo_cmd_response *out)
+{
+	struct coo_json_doc doc;
+	bool reset = false;
+
+	if (coo_json_doc_parse(&doc, cmd->payload, NULL, NULL, 0U) != 0 ||
+	    coo_json_doc_optional_bool(&doc, "reset", &reset, NULL) != 0 || !reset) {
+		return coo_cmd_error(out, cmd, "reset required");
+	}
+	coo_trace_reset();
+	return coo_cmd_ok(out, cmd);
+}
+#endif /* CONFIG_COO_STAGE_TRACE */
 
 static const struct coo_cmd_spec thermal_specs[] = {
 	{ .key = "loop", .query_handler = loop_query, .effect_handler = loop_effect,
 	  .key_prefix_match = true, .class_policy = COO_CMD_CLASS_DEFAULT,
-	  .allowed_payload_keys = "value,kp,ki,kd" },
+	  .allowed_payload_keys = "value,kp,ki,kd,segments,power,hysteresis,deviation,"
+				  "cycles,timeout,apply,rule" },
 	{ .key = "loops", .query_handler = loops_list,
 	  .class_policy = COO_CMD_CLASS_ALWAYS_QUERY },
 	{ .key = "sensors", .query_handler = sensors_list,
 	  .class_policy = COO_CMD_CLASS_ALWAYS_QUERY },
 	{ .key = "heaters", .query_handler = heaters_list,
 	  .class_policy = COO_CMD_CLASS_ALWAYS_QUERY },
+	{ .key = "snapshot", .query_handler = snapshot_query,
+	  .class_policy = COO_CMD_CLASS_ALWAYS_QUERY, .allowed_payload_keys = "start" },
+	{ .key = "heater", .effect_handler = heater_effect,
+	  .key_prefix_match = true, .class_policy = COO_CMD_CLASS_ALWAYS_EFFECT },
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+	{ .key = "interlock", .query_handler = interlock_query,
+	  .effect_handler = interlock_effect, .key_prefix_match = true,
+	  .class_policy = COO_CMD_CLASS_DEFAULT, .allowed_payload_keys = "rearm" },
+#endif
+#ifdef CONFIG_COO_SUBSCRIPTIONS
+	{ .key = "subscribe", .effect_handler = subscribe_effect,
+	  .class_policy = COO_CMD_CLASS_ALWAYS_EFFECT,
+	  .allowed_payload_keys = "key,deadband,min_interval,max_interval" },
+	{ .key = "unsubscribe", .effect_handler = unsubscribe_effect,
+	  .class_policy = COO_CMD_CLASS_ALWAYS_EFFECT, .allowed_payload_keys = "key" },
+	{ .key = "subscriptions", .query_handler = subscriptions_list,
+	  .class_policy = COO_CMD_CLASS_ALWAYS_QUERY },
+#endif
+#ifdef CONFIG_COO_CONTROL_PERSIST
+	{ .key = "persist", .query_handler = persist_query, .effect_handler = persist_effect,
+	  .class_policy = COO_CMD_CLASS_DEFAULT, .allowed_payload_keys = "flush,clear" },
+#endif
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+	{ .key = "recorder", .query_handler = recorder_query, .effect_handler = recorder_effect,
+	  .class_policy = COO_CMD_CLASS_DEFAULT, .allowed_payload_keys = "flush" },
+	{ .key = "recorder/dump", .query_handler = recorder_dump,
+	  .class_policy = COO_CMD_CLASS_ALWAYS_QUERY, .allowed_payload_keys = "seq,offset" },
+#endif
+#ifdef CONFIG_COO_STAGE_TRACE
+	{ .key = "stats", .query_handler = stats_query, .effect_handler = stats_effect,
+	  .key_prefix_match = true, .class_policy = COO_CMD_CLASS_DEFAULT,
+	  .allowed_payload_keys = "reset" },
+#endif
 	{ .key = "estop", .effect_handler = estop_effect,
 	  .class_policy = COO_CMD_CLASS_ALWAYS_EFFECT },
 };
@@ -202,40 +1256,65 @@ const struct coo_cmd_spec *thermal_commands_specs(size_t *count)
 	return thermal_specs;
 }
 
-int thermal_commands_dispatch(const struct coo_cmd_request *cmd,
-			      struct coo_cmd_response *out)
+static const struct coo_cmd_spec *thermal_find_spec(const struct coo_cmd_request *cmd)
 {
+	/* The runtime already resolved the key at ingress; trust it if it is ours */
+	if (cmd->spec >= &thermal_specs[0] &&
+	    cmd->spec < &thermal_specs[ARRAY_SIZE(thermal_specs)]) {
+		return cmd->spec;
+	}
+
 	for (size_t i = 0; i < ARRAY_SIZE(thermal_specs); i++) {
 		const struct coo_cmd_spec *spec = &thermal_specs[i];
 		bool match = spec->key_prefix_match
 				     ? coo_cmd_key_matches_prefix(cmd->key, spec->key)
 				     : strcmp(cmd->key, spec->key) == 0;
 
-		if (!match) {
-			continue;
+		if (match) {
+			return spec;
 		}
+	}
 
-		bool is_query;
+	return NULL;
+}
 
-		switch (spec->class_policy) {
-		case COO_CMD_CLASS_ALWAYS_QUERY:
-			is_query = true;
-			break;
-		case COO_CMD_CLASS_ALWAYS_EFFECT:
-			is_query = false;
-			break;
-		default:
-			is_query = coo_cmd_payload_empty(cmd);
-			break;
-		}
+int thermal_commands_dispatch(const struct coo_cmd_request *cmd,
+			      struct coo_cmd_response *out)
+{
+	const struct coo_cmd_spec *spec;
+	bool is_query;
 
-		coo_cmd_handler_fn handler = is_query ? spec->query_handler
-						      : spec->effect_handler;
-		if (handler == NULL) {
-			return coo_cmd_unsupported_response(out, cmd);
-		}
-		return handler(cmd, out);
+#ifdef CONFIG_COO_SUPERVISOR_LIB
+	/* Any request, even a malformed one, shows the host is alive */
+	supervisor_note_command();
+#endif
+
+	spec = thermal_find_spec(cmd);
+	if (spec == NULL) {
+		return coo_cmd_unknown_response(out, cmd);
+	}
+
+	switch (spec->class_policy) {
+	case COO_CMD_CLASS_ALWAYS_QUERY:
+		is_query = true;
+		break;
+	case COO_CMD_CLASS_ALWAYS_EFFECT:
+		is_query = false;
+		break;
+	default:
+		is_query = coo_cmd_payload_empty(cmd);
+		break;
 	}
 
-	return coo_cmd_unknown_response(out, cmd);
+	coo_cmd_handler_fn handler = is_query ? spec->query_handler
+					      : spec->effect_handler;
+	if (handler == NULL) {
+		return coo_cmd_unsupported_response(out, cmd);
+	}
+
+	COO_TRACE_BEGIN(command_start);
+	int rc = handler(cmd, out);
+
+	COO_TRACE_END(COO_TRACE_COMMAND, command_start);
+	return rc;
 }
@@ -8,6 +8,14 @@
 
 #include <coo_commons/command_dispatch.h>
 
+/**
+ * Set up the command table's own state, e.g. the subscription table.
+ * Call once after the managers are initialized and before the runtime
+ * starts executing commands.
+ * @return 0 on success, negative errno on failure
+ */
+int thermal_commands_init(void);
+
 /** Command specs for coo_cmd_runtime_configure(). */
 const struct coo_cmd_spec *thermal_commands_specs(size_t *count);
 
@@ -20,4 +28,17 @@ const struct coo_cmd_spec *thermal_commands_specs(size_t *count);
 int thermal_commands_dispatch(const struct coo_cmd_request *cmd,
 			      struct coo_cmd_response *out);
 
+#ifdef CONFIG_COO_SUBSCRIPTIONS
+/**
+ * Publish every subscribed value that has moved past its deadband or hit
+ * its max interval. Call periodically from the thread that drains the
+ * runtime's outbound queue.
+ * @param runtime Command runtime that owns the outbound queue
+ * @param scratch Response used to build each publication
+ * @return publications queued, or a negative errno
+ */
+int thermal_commands_poll_subscriptions(struct coo_cmd_runtime *runtime,
+					struct coo_cmd_response *scratch);
+#endif
+
 #endif /* THERMAL_COMMANDS_H */
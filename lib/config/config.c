@@ -12,6 +12,15 @@ LOG_MODULE_REGISTER(config, LOG_LEVEL_INF);
 /* Static configuration instance */
 static thermal_config_t default_config;
 
+#ifdef CONFIG_COO_CONFIG_DEVICETREE
+thermal_config_t* config_load_defaults(void)
+{
+    memcpy(&default_config, config_devicetree(), sizeof(default_config));
+
+    LOG_INF("Loaded devicetree configuration");
+    return &default_config;
+}
+#else
 thermal_config_t* config_load_defaults(void)
 {
     memset(&default_config, 0, sizeof(thermal_config_t));
@@ -23,6 +32,7 @@ thermal_config_t* config_load_defaults(void)
     default_config.number_of_sensors = 1;
     default_config.number_of_heaters = 2;
     default_config.number_of_control_loops = 2;
+    default_config.number_of_interlocks = 1;
     default_config.timeout_seconds = 10;
     default_config.timeout_error_condition = ERROR_CONDITION_ALARM;
 
@@ -39,6 +49,9 @@ thermal_config_t* config_load_defaults(void)
     default_config.sensors[0].adc_resolution = 24;
     strncpy(default_config.sensors[0].calibration_file, "null", MAX_PATH_LENGTH - 1);
     default_config.sensors[0].extrapolate_method = EXTRAP_NONE;
+    default_config.sensors[0].median_filter_window = 3;
+    default_config.sensors[0].oversample = 1;
+    default_config.sensors[0].iir_alpha = 0.0f;
     default_config.sensors[0].driver_data = NULL;
     default_config.sensors[0].enabled = true;
 
@@ -67,11 +80,18 @@ thermal_config_t* config_load_defaults(void)
     default_config.control_loops[0].default_target_temperature = 308.15f;  // 35°C
     default_config.control_loops[0].default_state_on = true;
     default_config.control_loops[0].control_algorithm = CONTROL_ALGO_PID;
+    default_config.control_loops[0].update_period_ms = 500;  // 2 Hz
     default_config.control_loops[0].p_gain = 2.0f;
     default_config.control_loops[0].i_gain = 0.5f;
     default_config.control_loops[0].d_gain = 0.1f;
+    default_config.control_loops[0].setpoint_weight = 1.0f;
+    default_config.control_loops[0].derivative_on_measurement = true;
+    default_config.control_loops[0].derivative_filter_tau = 1.0f;  // 2 samples
+    default_config.control_loops[0].anti_windup = ANTI_WINDUP_BACK_CALC;
+    default_config.control_loops[0].anti_windup_tracking_time = 0.0f;  // Ti
     default_config.control_loops[0].error_condition = ERROR_CONDITION_STOP;
     default_config.control_loops[0].threshold_for_invalid_sensors = 50.0f;
+    default_config.control_loops[0].max_sensor_age_ms = 2000;  // 4 sensor periods
     default_config.control_loops[0].alarm_min_temp = 273.15f;  // 0°C
     default_config.control_loops[0].alarm_max_temp = 353.15f;  // 80°C
     default_config.control_loops[0].valid_setpoint_range_min = 293.15f;  // 20°C
@@ -92,11 +112,18 @@ thermal_config_t* config_load_defaults(void)
     default_config.control_loops[1].default_target_temperature = 313.15f;  // 40°C
     default_config.control_loops[1].default_state_on = true;
     default_config.control_loops[1].control_algorithm = CONTROL_ALGO_PID;
+    default_config.control_loops[1].update_period_ms = 500;  // 2 Hz
     default_config.control_loops[1].p_gain = 2.0f;
     default_config.control_loops[1].i_gain = 0.5f;
     default_config.control_loops[1].d_gain = 0.1f;
+    default_config.control_loops[1].setpoint_weight = 1.0f;
+    default_config.control_loops[1].derivative_on_measurement = true;
+    default_config.control_loops[1].derivative_filter_tau = 1.0f;  // 2 samples
+    default_config.control_loops[1].anti_windup = ANTI_WINDUP_BACK_CALC;
+    default_config.control_loops[1].anti_windup_tracking_time = 0.0f;  // Ti
     default_config.control_loops[1].error_condition = ERROR_CONDITION_STOP;
     default_config.control_loops[1].threshold_for_invalid_sensors = 50.0f;
+    default_config.control_loops[1].max_sensor_age_ms = 2000;  // 4 sensor periods
     default_config.control_loops[1].alarm_min_temp = 273.15f;  // 0°C
     default_config.control_loops[1].alarm_max_temp = 353.15f;  // 80°C
     default_config.control_loops[1].valid_setpoint_range_min = 293.15f;
@@ -108,9 +135,19 @@ thermal_config_t* config_load_defaults(void)
     default_config.control_loops[1].follows_loop_scalar = 1.0f;
     default_config.control_loops[1].enabled = true;
 
+    /* Interlock 1: hard limits on loop-2's sensor, outside its alarm band */
+    strncpy(default_config.interlocks[0].id, "interlock-1", MAX_ID_LENGTH - 1);
+    strncpy(default_config.interlocks[0].sensor_id, "sensor-1", MAX_ID_LENGTH - 1);
+    strncpy(default_config.interlocks[0].heater_ids[0], "heater-1", MAX_ID_LENGTH - 1);
+    default_config.interlocks[0].num_heaters = 1;
+    default_config.interlocks[0].min_temp = 263.15f;  // -10°C
+    default_config.interlocks[0].max_temp = 363.15f;  // 90°C
+    default_config.interlocks[0].enabled = true;
+
     LOG_INF("Loaded default configuration");
     return &default_config;
 }
+#endif /* CONFIG_COO_CONFIG_DEVICETREE */
 
 int config_validate(const thermal_config_t *config)
 {
@@ -138,6 +175,52 @@ int config_validate(const thermal_config_t *config)
         return -4;
     }
 
+    /* Validate interlock count */
+    if (config->number_of_interlocks < 0 || config->number_of_interlocks > MAX_INTERLOCKS) {
+        LOG_ERR("Too many interlocks: %d (max %d)", config->number_of_interlocks, MAX_INTERLOCKS);
+        return -10;
+    }
+
+    /* Interlocks must name a known sensor and heaters, with a real band */
+    for (int i = 0; i < config->number_of_interlocks; i++) {
+        const interlock_config_t *ilk = &config->interlocks[i];
+
+        if (!ilk->enabled) {
+            continue;
+        }
+        if (config_sensor_index(config, ilk->sensor_id) < 0) {
+            LOG_ERR("Interlock %s references unknown sensor %s", ilk->id, ilk->sensor_id);
+            return -10;
+        }
+        if (ilk->num_heaters <= 0 || ilk->num_heaters > MAX_HEATERS_PER_LOOP) {
+            LOG_ERR("Interlock %s needs 1 to %d heaters", ilk->id, MAX_HEATERS_PER_LOOP);
+            return -10;
+        }
+        for (int j = 0; j < ilk->num_heaters; j++) {
+            if (config_heater_index(config, ilk->heater_ids[j]) < 0) {
+                LOG_ERR("Interlock %s references unknown heater %s", ilk->id, ilk->heater_ids[j]);
+                return -10;
+            }
+        }
+        if (!(ilk->min_temp < ilk->max_temp)) {
+            LOG_ERR("Interlock %s has an empty temperature band", ilk->id);
+            return -10;
+        }
+    }
+
+    /* Every loop, enabled or not, takes its members from one arena */
+    int sensor_refs = 0;
+    int heater_refs = 0;
+    for (int i = 0; i < config->number_of_control_loops; i++) {
+        sensor_refs += config->control_loops[i].num_sensors;
+        heater_refs += config->control_loops[i].num_heaters;
+    }
+    if (sensor_refs > MAX_LOOP_SENSOR_REFS || heater_refs > MAX_LOOP_HEATER_REFS) {
+        LOG_ERR("Loops reference %d sensors and %d heaters (max %d and %d)",
+                sensor_refs, heater_refs, (int)MAX_LOOP_SENSOR_REFS, (int)MAX_LOOP_HEATER_REFS);
+        return -11;
+    }
+
     /* Validate that all loop sensor/heater IDs exist */
     for (int i = 0; i < config->number_of_control_loops; i++) {
         const control_loop_config_t *loop = &config->control_loops[i];
@@ -148,14 +231,7 @@ int config_validate(const thermal_config_t *config)
 
         /* Check sensor IDs */
         for (int j = 0; j < loop->num_sensors; j++) {
-            bool found = false;
-            for (int k = 0; k < config->number_of_sensors; k++) {
-                if (strcmp(loop->sensor_ids[j], config->sensors[k].id) == 0) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
+            if (config_sensor_index(config, loop->sensor_ids[j]) < 0) {
                 LOG_ERR("Loop %s references unknown sensor %s", loop->id, loop->sensor_ids[j]);
                 return -5;
             }
@@ -163,25 +239,54 @@ int config_validate(const thermal_config_t *config)
 
         /* Check heater IDs */
         for (int j = 0; j < loop->num_heaters; j++) {
-            bool found = false;
-            for (int k = 0; k < config->number_of_heaters; k++) {
-                if (strcmp(loop->heater_ids[j], config->heaters[k].id) == 0) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
+            if (config_heater_index(config, loop->heater_ids[j]) < 0) {
                 LOG_ERR("Loop %s references unknown heater %s", loop->id, loop->heater_ids[j]);
                 return -6;
             }
         }
 
-        /* Check for circular follows dependencies (simple check) */
-        if (strlen(loop->follows_loop_id) > 0) {
-            if (strcmp(loop->follows_loop_id, loop->id) == 0) {
-                LOG_ERR("Loop %s follows itself", loop->id);
+        /* Check PID options */
+        if (loop->setpoint_weight < 0.0f || loop->setpoint_weight > 1.0f ||
+            loop->derivative_filter_tau < 0.0f || loop->anti_windup_tracking_time < 0.0f) {
+            LOG_ERR("Loop %s has invalid PID options", loop->id);
+            return -8;
+        }
+
+        /* Model-based algorithms need a model */
+        bool needs_model = loop->control_algorithm == CONTROL_ALGO_MPC ||
+                           loop->control_algorithm == CONTROL_ALGO_POWER_LEVEL ||
+                           loop->feed_forward;
+        if (needs_model && loop->model_thermal_resistance <= 0.0f) {
+            LOG_ERR("Loop %s needs model_thermal_resistance", loop->id);
+            return -9;
+        }
+        if (loop->control_algorithm == CONTROL_ALGO_MPC &&
+            (loop->model_heat_capacity <= 0.0f || loop->mpc_horizon_steps == 0 ||
+             loop->mpc_reference_tau <= 0.0f)) {
+            LOG_ERR("Loop %s has invalid MPC parameters", loop->id);
+            return -9;
+        }
+
+        /* The follow graph must be a forest: known leaders, no cycles */
+        int hops = 0;
+        for (const control_loop_config_t *at = loop; at->follows_loop_id[0] != '\0';) {
+            const control_loop_config_t *leader = NULL;
+
+            for (int k = 0; k < config->number_of_control_loops; k++) {
+                if (strcmp(at->follows_loop_id, config->control_loops[k].id) == 0) {
+                    leader = &config->control_loops[k];
+                    break;
+                }
+            }
+            if (leader == NULL) {
+                LOG_ERR("Loop %s follows unknown loop %s", at->id, at->follows_loop_id);
+                return -7;
+            }
+            if (leader == loop || ++hops > config->number_of_control_loops) {
+                LOG_ERR("Loop %s is in a follow cycle", loop->id);
                 return -7;
             }
+            at = leader;
         }
     }
 
@@ -189,32 +294,53 @@ int config_validate(const thermal_config_t *config)
     return 0;
 }
 
-sensor_config_t* config_find_sensor(thermal_config_t *config, const char *id)
+int config_sensor_index(const thermal_config_t *config, const char *id)
 {
     for (int i = 0; i < config->number_of_sensors; i++) {
         if (strcmp(config->sensors[i].id, id) == 0) {
-            return &config->sensors[i];
+            return i;
         }
     }
-    return NULL;
+    return -1;
 }
 
-heater_config_t* config_find_heater(thermal_config_t *config, const char *id)
+int config_heater_index(const thermal_config_t *config, const char *id)
 {
     for (int i = 0; i < config->number_of_heaters; i++) {
         if (strcmp(config->heaters[i].id, id) == 0) {
-            return &config->heaters[i];
+            return i;
         }
     }
-    return NULL;
+    return -1;
 }
 
-control_loop_config_t* config_find_loop(thermal_config_t *config, const char *id)
+int config_loop_index(const thermal_config_t *config, const char *id)
 {
     for (int i = 0; i < config->number_of_control_loops; i++) {
         if (strcmp(config->control_loops[i].id, id) == 0) {
-            return &config->control_loops[i];
+            return i;
         }
     }
-    return NULL;
+    return -1;
+}
+
+sensor_config_t* config_find_sensor(thermal_config_t *config, const char *id)
+{
+    int i = config_sensor_index(config, id);
+
+    return (i < 0) ? NULL : &config->sensors[i];
+}
+
+heater_config_t* config_find_heater(thermal_config_t *config, const char *id)
+{
+    int i = config_heater_index(config, id);
+
+    return (i < 0) ? NULL : &config->heaters[i];
+}
+
+control_loop_config_t* config_find_loop(thermal_config_t *config, const char *id)
+{
+    int i = config_loop_index(config, id);
+
+    return (i < 0) ? NULL : &config->control_loops[i];
 }
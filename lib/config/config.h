@@ -11,6 +11,21 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifdef CONFIG_COO_CONFIG_DEVICETREE
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+
+/*
+ * System limits are the devicetree node counts, so every per-sensor,
+ * per-heater and per-loop table is sized to the topology actually built.
+ * At least one slot each keeps the arrays legal for an empty topology.
+ */
+#define MAX_SENSORS MAX(DT_NUM_INST_STATUS_OKAY(coo_thermal_sensor), 1)
+#define MAX_HEATERS MAX(DT_NUM_INST_STATUS_OKAY(coo_regulator_heater) + \
+                        DT_NUM_INST_STATUS_OKAY(coo_pwm_heater), 1)
+#define MAX_CONTROL_LOOPS MAX(DT_NUM_INST_STATUS_OKAY(coo_thermal_loop), 1)
+#define MAX_INTERLOCKS MAX(DT_NUM_INST_STATUS_OKAY(coo_thermal_interlock), 1)
+#else
 /* System limits - configurable via Kconfig (COO_MAX_SENSORS, etc.) */
 #ifdef CONFIG_COO_MAX_SENSORS
 #define MAX_SENSORS CONFIG_COO_MAX_SENSORS
@@ -30,6 +45,13 @@
 #define MAX_CONTROL_LOOPS 8
 #endif
 
+#ifdef CONFIG_COO_MAX_INTERLOCKS
+#define MAX_INTERLOCKS CONFIG_COO_MAX_INTERLOCKS
+#else
+#define MAX_INTERLOCKS 8
+#endif
+#endif /* CONFIG_COO_CONFIG_DEVICETREE */
+
 #ifdef CONFIG_COO_MAX_SENSORS_PER_LOOP
 #define MAX_SENSORS_PER_LOOP CONFIG_COO_MAX_SENSORS_PER_LOOP
 #else
@@ -41,6 +63,41 @@
 #else
 #define MAX_HEATERS_PER_LOOP 4
 #endif
+
+/*
+ * Sensor and heater references summed over all loops. The managers hold
+ * loop membership as index lists carved from one arena of this size:
+ * exact in devicetree mode, a Kconfig budget that config_validate()
+ * enforces otherwise.
+ */
+#ifdef CONFIG_COO_CONFIG_DEVICETREE
+#define LOOP_SENSOR_REFS_OF(node) DT_PROP_LEN(node, sensors) +
+#define LOOP_HEATER_REFS_OF(node) DT_PROP_LEN(node, heaters) +
+#define MAX_LOOP_SENSOR_REFS \
+    MAX(DT_FOREACH_STATUS_OKAY(coo_thermal_loop, LOOP_SENSOR_REFS_OF) 0, 1)
+#define MAX_LOOP_HEATER_REFS \
+    MAX(DT_FOREACH_STATUS_OKAY(coo_thermal_loop, LOOP_HEATER_REFS_OF) 0, 1)
+#else
+#ifdef CONFIG_COO_MAX_LOOP_SENSOR_REFS
+#define MAX_LOOP_SENSOR_REFS CONFIG_COO_MAX_LOOP_SENSOR_REFS
+#else
+#define MAX_LOOP_SENSOR_REFS (MAX_CONTROL_LOOPS * MAX_SENSORS_PER_LOOP)
+#endif
+
+#ifdef CONFIG_COO_MAX_LOOP_HEATER_REFS
+#define MAX_LOOP_HEATER_REFS CONFIG_COO_MAX_LOOP_HEATER_REFS
+#else
+#define MAX_LOOP_HEATER_REFS (MAX_CONTROL_LOOPS * MAX_HEATERS_PER_LOOP)
+#endif
+#endif
+
+/*
+ * Index of a sensor, heater or loop in its config table. Every manager
+ * mirrors the config tables one-to-one, so this is also the manager
+ * handle; IDs are only ever stored in the config.
+ */
+typedef uint8_t config_index_t;
+#define NO_CONFIG_INDEX UINT8_MAX  /* Unresolved ID */
 #define MAX_ID_LENGTH 32
 #define MAX_LOCATION_LENGTH 64
 #define MAX_PATH_LENGTH 128
@@ -95,16 +152,27 @@ typedef enum {
 typedef enum {
     CONTROL_ALGO_PID,
     CONTROL_ALGO_ON_OFF,
-    CONTROL_ALGO_POWER_LEVEL
+    CONTROL_ALGO_POWER_LEVEL,   // Open loop: model power for the setpoint
+    CONTROL_ALGO_MPC            // Fixed-horizon predictive control on the model
 } control_algo_t;
 
+/**
+ * PID integral anti-windup strategies
+ */
+typedef enum {
+    ANTI_WINDUP_CLAMP,          // Clamp integral to the power limits
+    ANTI_WINDUP_CONDITIONAL,    // Stop integrating while saturated
+    ANTI_WINDUP_BACK_CALC       // Bleed integral by the saturation excess
+} anti_windup_t;
+
 /**
  * Calibration extrapolation methods
  */
 typedef enum {
     EXTRAP_NONE,
     EXTRAP_POLY,
-    EXTRAP_LINEAR
+    EXTRAP_LINEAR,
+    EXTRAP_CVD_TABLE    // P_RTD: Callendar-Van Dusen table (rtd_table.h)
 } extrap_method_t;
 
 /**
@@ -123,6 +191,9 @@ typedef struct {
     int adc_resolution;
     char calibration_file[MAX_PATH_LENGTH];
     extrap_method_t extrapolate_method;
+    uint8_t median_filter_window;     // Median window in samples (0/1 = off, odd)
+    uint8_t oversample;               // Samples averaged per reading (0/1 = off)
+    float iir_alpha;                  // IIR weight of new sample (0 = off, 0..1)
     const void *driver_data;
     bool enabled;
 } sensor_config_t;
@@ -137,6 +208,8 @@ typedef struct {
     float max_power_w;
     float resistance_ohms;
     const struct device *regulator_dev;
+    int (*force_off)(const struct device *dev); // Lock-free cut of regulator_dev (NULL = none)
+    const struct pwm_dt_spec *pwm;    // Low-power heater output (NULL = none)
     bool enabled;
 } heater_config_t;
 
@@ -154,12 +227,29 @@ typedef struct {
     bool default_state_on;
 
     control_algo_t control_algorithm;
+    uint32_t update_period_ms;  // 0 = every control pass
     float p_gain;
     float i_gain;
     float d_gain;
+    float setpoint_weight;  // P-term weight on setpoint, 0..1 (1 = classic)
+    bool derivative_on_measurement;  // No derivative kick on setpoint changes
+    float derivative_filter_tau;  // D-term low-pass, seconds (0 = off)
+    anti_windup_t anti_windup;
+    float anti_windup_tracking_time;  // Back-calculation Tt, seconds (0 = Ti)
+    float on_off_hysteresis;  // ON_OFF band half-width, Kelvin
+
+    /* First-order heater -> sensor thermal model (MPC, POWER_LEVEL, feed-forward) */
+    float model_thermal_resistance;  // K/W, 0 = no model
+    float model_heat_capacity;  // J/K
+    float model_ambient_temp;  // Kelvin
+    bool feed_forward;  // Add the model's power for the setpoint to the PID/ON_OFF output
+    uint16_t mpc_horizon_steps;  // Prediction horizon in loop periods
+    float mpc_reference_tau;  // Desired closed-loop time constant, seconds
 
     error_condition_t error_condition;
-    float threshold_for_invalid_sensors;  // Degrees
+    float threshold_for_invalid_sensors;  // Degrees from the loop's sensor median
+    float sensor_weights[MAX_SENSORS_PER_LOOP];  // All 0 = equal weights
+    uint32_t max_sensor_age_ms;  // Reject older readings (0 = no limit)
 
     float alarm_min_temp;  // Kelvin
     float alarm_max_temp;  // Kelvin
@@ -177,6 +267,23 @@ typedef struct {
     bool enabled;
 } control_loop_config_t;
 
+/**
+ * Safety interlock: hard limits on one sensor's converted samples
+ * Checked on every sample in the sensor sweep, before any filtering or
+ * fusion. A sample outside the limits latches the listed heaters off.
+ */
+typedef struct {
+    char id[MAX_ID_LENGTH];
+    char sensor_id[MAX_ID_LENGTH];
+    char heater_ids[MAX_HEATERS_PER_LOOP][MAX_ID_LENGTH];
+    int num_heaters;
+
+    float min_temp;  // Kelvin
+    float max_temp;  // Kelvin
+
+    bool enabled;
+} interlock_config_t;
+
 /**
  * Main controller configuration
  */
@@ -188,6 +295,7 @@ typedef struct {
     int number_of_sensors;
     int number_of_heaters;
     int number_of_control_loops;
+    int number_of_interlocks;
 
     uint32_t timeout_seconds;
     error_condition_t timeout_error_condition;
@@ -195,14 +303,28 @@ typedef struct {
     sensor_config_t sensors[MAX_SENSORS];
     heater_config_t heaters[MAX_HEATERS];
     control_loop_config_t control_loops[MAX_CONTROL_LOOPS];
+    interlock_config_t interlocks[MAX_INTERLOCKS];
 } thermal_config_t;
 
 /**
  * Load default configuration
+ * With CONFIG_COO_CONFIG_DEVICETREE this is a RAM copy of
+ * config_devicetree(), for applications that patch it before init.
  * @return Pointer to static config structure
  */
 thermal_config_t* config_load_defaults(void);
 
+#ifdef CONFIG_COO_CONFIG_DEVICETREE
+/**
+ * Get the configuration generated from devicetree
+ * The table is const and lives in flash. Its cross-references were
+ * checked at build time, except follow cycles through more than one loop,
+ * so run config_validate() on it at boot as for any other config.
+ * @return Pointer to the devicetree configuration
+ */
+const thermal_config_t *config_devicetree(void);
+#endif
+
 /**
  * Validate configuration for consistency
  * @param config Configuration to validate
@@ -210,6 +332,30 @@ thermal_config_t* config_load_defaults(void);
  */
 int config_validate(const thermal_config_t *config);
 
+/**
+ * Look up a sensor's index by ID
+ * @param config Configuration
+ * @param id Sensor ID to find
+ * @return Index into config->sensors, or -1 if not found
+ */
+int config_sensor_index(const thermal_config_t *config, const char *id);
+
+/**
+ * Look up a heater's index by ID
+ * @param config Configuration
+ * @param id Heater ID to find
+ * @return Index into config->heaters, or -1 if not found
+ */
+int config_heater_index(const thermal_config_t *config, const char *id);
+
+/**
+ * Look up a control loop's index by ID
+ * @param config Configuration
+ * @param id Loop ID to find
+ * @return Index into config->control_loops, or -1 if not found
+ */
+int config_loop_index(const thermal_config_t *config, const char *id);
+
 /**
  * Find sensor by ID
  * @param config Configuration
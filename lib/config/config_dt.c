@@ -0,0 +1,306 @@
+/**
+ * @file config_dt.c
+ * @brief Thermal configuration generated from devicetree
+ *
+ * Every okay coo,thermal-sensor, heater output, coo,thermal-loop and
+ * coo,thermal-interlock node becomes one entry of a const
+ * thermal_config_t, so the topology lives in flash and the managers keep
+ * only their runtime state in RAM.
+ *
+ * Most of what config_validate() checks is checked here with BUILD_ASSERT,
+ * so a bad devicetree fails the build. A follow chain can only be checked
+ * a fixed number of hops in the preprocessor: two-loop cycles (A follows
+ * B follows A) fail the build, longer ones still build. config_validate()
+ * catches those at boot, and the app runs it on this table like any other.
+ *
+ * Heaters are listed regulator supplies first, then PWM outputs.
+ */
+
+#include "config.h"
+#include <zephyr/devicetree.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+#ifdef CONFIG_COO_HEATER_PWM
+#include <zephyr/drivers/pwm.h>
+#endif
+#ifdef CONFIG_REGULATOR_TPS55287Q1
+#include "../../drivers/regulator/tps55287q1/tps55287q1.h"
+#define REG_FORCE_OFF(reg) TPS55287Q1_DT_FORCE_OFF_OR_NULL(reg)
+#else
+#define REG_FORCE_OFF(reg) NULL
+#endif
+#include <zephyr/sys/util.h>
+
+/* Scaled devicetree integers back to the float units of config.h */
+#define DT_MILLI(node, prop) ((float)DT_PROP(node, prop) / 1000.0f)
+#define DT_MICRO(node, prop) ((float)DT_PROP(node, prop) / 1000000.0f)
+
+#define ID_FITS(node, prop) (sizeof(DT_PROP(node, prop)) <= MAX_ID_LENGTH)
+
+/* ========== Build-time checks ========== */
+
+#define CHECK_SENSOR(node)                                                       \
+    BUILD_ASSERT(ID_FITS(node, sensor_id), "sensor-id too long: " DT_NODE_PATH(node)); \
+    BUILD_ASSERT(sizeof(DT_PROP(node, location)) <= MAX_LOCATION_LENGTH,         \
+                 "location too long: " DT_NODE_PATH(node));                      \
+    BUILD_ASSERT(DT_PROP(node, adc_resolution) >= 2 &&                           \
+                 DT_PROP(node, adc_resolution) <= 31,                            \
+                 "adc-resolution must be 2..31: " DT_NODE_PATH(node));
+
+#define CHECK_HEATER(node)                                                       \
+    BUILD_ASSERT(ID_FITS(node, heater_id), "heater-id too long: " DT_NODE_PATH(node)); \
+    BUILD_ASSERT(sizeof(DT_PROP(node, location)) <= MAX_LOCATION_LENGTH,         \
+                 "location too long: " DT_NODE_PATH(node));
+
+#define IS_HEATER(node)                                                          \
+    (DT_NODE_HAS_COMPAT_STATUS(node, coo_regulator_heater, okay) ||              \
+     DT_NODE_HAS_COMPAT_STATUS(node, coo_pwm_heater, okay))
+
+#define CHECK_SENSOR_REF(node, prop, idx)                                        \
+    BUILD_ASSERT(DT_NODE_HAS_COMPAT_STATUS(DT_PHANDLE_BY_IDX(node, prop, idx),   \
+                                           coo_thermal_sensor, okay),            \
+                 DT_NODE_PATH(node) " sensors: not an okay coo,thermal-sensor");
+
+#define CHECK_HEATER_REF(node, prop, idx)                                        \
+    BUILD_ASSERT(IS_HEATER(DT_PHANDLE_BY_IDX(node, prop, idx)),                  \
+                 DT_NODE_PATH(node) " heaters: not an okay heater output");
+
+#define NEEDS_MODEL(node)                                                        \
+    (DT_ENUM_IDX(node, control_algorithm) == CONTROL_ALGO_MPC ||                 \
+     DT_ENUM_IDX(node, control_algorithm) == CONTROL_ALGO_POWER_LEVEL ||         \
+     DT_PROP(node, feed_forward))
+
+#define CHECK_FOLLOWS(node)                                                      \
+    BUILD_ASSERT(DT_NODE_HAS_COMPAT_STATUS(DT_PHANDLE(node, follows),            \
+                                           coo_thermal_loop, okay),              \
+                 DT_NODE_PATH(node) " follows: not an okay coo,thermal-loop");   \
+    BUILD_ASSERT(!DT_SAME_NODE(DT_PHANDLE(node, follows), node),                 \
+                 DT_NODE_PATH(node) ": follows itself");                         \
+    COND_CODE_1(DT_NODE_HAS_PROP(DT_PHANDLE(node, follows), follows),            \
+                (BUILD_ASSERT(!DT_SAME_NODE(DT_PHANDLE(DT_PHANDLE(node, follows), \
+                                                       follows), node),          \
+                              DT_NODE_PATH(node) ": follows its own follower");), \
+                ())
+
+#define CHECK_LOOP(node)                                                         \
+    BUILD_ASSERT(ID_FITS(node, loop_id), "loop-id too long: " DT_NODE_PATH(node)); \
+    BUILD_ASSERT(DT_PROP_LEN(node, sensors) <= MAX_SENSORS_PER_LOOP,             \
+                 DT_NODE_PATH(node) ": more sensors than COO_MAX_SENSORS_PER_LOOP"); \
+    BUILD_ASSERT(DT_PROP_LEN(node, heaters) <= MAX_HEATERS_PER_LOOP,             \
+                 DT_NODE_PATH(node) ": more heaters than COO_MAX_HEATERS_PER_LOOP"); \
+    DT_FOREACH_PROP_ELEM(node, sensors, CHECK_SENSOR_REF)                        \
+    DT_FOREACH_PROP_ELEM(node, heaters, CHECK_HEATER_REF)                        \
+    BUILD_ASSERT(DT_PROP_LEN_OR(node, sensor_weights_milli,                      \
+                                DT_PROP_LEN(node, sensors)) ==                   \
+                 DT_PROP_LEN(node, sensors),                                     \
+                 DT_NODE_PATH(node) ": one sensor-weights-milli entry per sensor"); \
+    BUILD_ASSERT(DT_PROP(node, setpoint_weight_milli) >= 0 &&                    \
+                 DT_PROP(node, setpoint_weight_milli) <= 1000 &&                 \
+                 DT_PROP(node, derivative_filter_tau_ms) >= 0 &&                 \
+                 DT_PROP(node, anti_windup_tracking_time_ms) >= 0,               \
+                 DT_NODE_PATH(node) ": invalid PID options");                    \
+    BUILD_ASSERT(!NEEDS_MODEL(node) ||                                           \
+                 DT_PROP(node, model_thermal_resistance_mk_per_w) > 0,           \
+                 DT_NODE_PATH(node) ": needs model-thermal-resistance-mk-per-w"); \
+    BUILD_ASSERT(DT_ENUM_IDX(node, control_algorithm) != CONTROL_ALGO_MPC ||     \
+                 (DT_PROP(node, model_heat_capacity_mj_per_k) > 0 &&             \
+                  DT_PROP(node, mpc_horizon_steps) > 0 &&                        \
+                  DT_PROP(node, mpc_reference_tau_ms) > 0),                      \
+                 DT_NODE_PATH(node) ": invalid MPC parameters");                 \
+    COND_CODE_1(DT_NODE_HAS_PROP(node, follows), (CHECK_FOLLOWS(node)), ())
+
+#define CHECK_INTERLOCK(node)                                                    \
+    BUILD_ASSERT(ID_FITS(node, interlock_id), "interlock-id too long: " DT_NODE_PATH(node)); \
+    BUILD_ASSERT(DT_NODE_HAS_COMPAT_STATUS(DT_PHANDLE(node, sensor),             \
+                                           coo_thermal_sensor, okay),            \
+                 DT_NODE_PATH(node) " sensor: not an okay coo,thermal-sensor");  \
+    BUILD_ASSERT(DT_PROP_LEN(node, heaters) <= MAX_HEATERS_PER_LOOP,             \
+                 DT_NODE_PATH(node) ": more heaters than COO_MAX_HEATERS_PER_LOOP"); \
+    DT_FOREACH_PROP_ELEM(node, heaters, CHECK_HEATER_REF)                        \
+    BUILD_ASSERT(DT_PROP(node, min_mk) < DT_PROP(node, max_mk),                  \
+                 DT_NODE_PATH(node) ": min-mk must be below max-mk");
+
+DT_FOREACH_STATUS_OKAY(coo_thermal_sensor, CHECK_SENSOR)
+DT_FOREACH_STATUS_OKAY(coo_regulator_heater, CHECK_HEATER)
+DT_FOREACH_STATUS_OKAY(coo_pwm_heater, CHECK_HEATER)
+DT_FOREACH_STATUS_OKAY(coo_thermal_loop, CHECK_LOOP)
+DT_FOREACH_STATUS_OKAY(coo_thermal_interlock, CHECK_INTERLOCK)
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(coo_thermal_interlock) <= 32,
+             "at most 32 coo,thermal-interlock nodes");
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(coo_thermal_controller) <= 1,
+             "at most one coo,thermal-controller node");
+
+/* ========== Driver bindings, const in flash ========== */
+
+#define SENSOR_ADC_NAME(node) _CONCAT(sensor_adc_, DT_DEP_ORD(node))
+
+#define SENSOR_ADC_SPEC(node)                                                    \
+    COND_CODE_1(DT_NODE_HAS_PROP(node, io_channels),                             \
+                (static const struct adc_dt_spec SENSOR_ADC_NAME(node) =         \
+                     ADC_DT_SPEC_GET(node);), ())
+
+DT_FOREACH_STATUS_OKAY(coo_thermal_sensor, SENSOR_ADC_SPEC)
+
+#ifdef CONFIG_COO_HEATER_PWM
+#define HEATER_PWM_NAME(node) _CONCAT(heater_pwm_, DT_DEP_ORD(node))
+#define HEATER_PWM_SPEC(node) static const struct pwm_dt_spec HEATER_PWM_NAME(node) = \
+    PWM_DT_SPEC_GET(node);
+
+DT_FOREACH_STATUS_OKAY(coo_pwm_heater, HEATER_PWM_SPEC)
+#define HEATER_PWM_PTR(node) (&HEATER_PWM_NAME(node))
+#else
+#define HEATER_PWM_PTR(node) NULL
+#endif
+
+/* ========== Table entries ========== */
+
+#define SENSOR_ENTRY(node)                                                       \
+    {                                                                            \
+        .id = DT_PROP(node, sensor_id),                                          \
+        .type = (sensor_type_t)DT_ENUM_IDX(node, sensor_type),                   \
+        .location = DT_PROP(node, location),                                     \
+        .default_value = DT_MILLI(node, default_value_milli),                    \
+        .temperature_at_default = DT_MILLI(node, temperature_at_default_mk),     \
+        .temperature_coefficient = DT_MILLI(node, temperature_coefficient_milli), \
+        .reference_resistance = DT_MILLI(node, reference_resistance_milliohm),   \
+        .nominal_resistance = DT_MILLI(node, nominal_resistance_milliohm),       \
+        .adc_gain = DT_PROP(node, adc_gain),                                     \
+        .adc_resolution = DT_PROP(node, adc_resolution),                         \
+        .extrapolate_method = (extrap_method_t)DT_ENUM_IDX(node, extrapolate_method), \
+        .median_filter_window = DT_PROP(node, median_filter_window),             \
+        .oversample = DT_PROP(node, oversample),                                 \
+        .iir_alpha = DT_MILLI(node, iir_alpha_milli),                            \
+        .driver_data = COND_CODE_1(DT_NODE_HAS_PROP(node, io_channels),          \
+                                   (&SENSOR_ADC_NAME(node)), (NULL)),            \
+        .enabled = true,                                                         \
+    },
+
+#define HEATER_COMMON(node)                                                      \
+        .id = DT_PROP(node, heater_id),                                          \
+        .location = DT_PROP(node, location),                                     \
+        .max_power_w = DT_MILLI(node, max_power_mw),                             \
+        .resistance_ohms = DT_MILLI(node, resistance_milliohm),                  \
+        .enabled = true,
+
+#define REG_HEATER_ENTRY(node)                                                   \
+    {                                                                            \
+        HEATER_COMMON(node)                                                      \
+        .type = HEATER_TYPE_HIGH_POWER,                                          \
+        .regulator_dev = DEVICE_DT_GET(DT_PHANDLE(node, regulator)),             \
+        .force_off = REG_FORCE_OFF(DT_PHANDLE(node, regulator)),                 \
+    },
+
+#define PWM_HEATER_ENTRY(node)                                                   \
+    {                                                                            \
+        HEATER_COMMON(node)                                                      \
+        .type = HEATER_TYPE_LOW_POWER,                                           \
+        .pwm = HEATER_PWM_PTR(node),                                             \
+    },
+
+#define REF_SENSOR_ID(node, prop, idx) DT_PROP(DT_PHANDLE_BY_IDX(node, prop, idx), sensor_id)
+#define REF_HEATER_ID(node, prop, idx) DT_PROP(DT_PHANDLE_BY_IDX(node, prop, idx), heater_id)
+#define WEIGHT_ELEM(node, prop, idx) ((float)DT_PROP_BY_IDX(node, prop, idx) / 1000.0f)
+
+#define LOOP_ENTRY(node)                                                         \
+    {                                                                            \
+        .id = DT_PROP(node, loop_id),                                            \
+        .sensor_ids = { DT_FOREACH_PROP_ELEM_SEP(node, sensors, REF_SENSOR_ID, (,)) }, \
+        .num_sensors = DT_PROP_LEN(node, sensors),                               \
+        .heater_ids = { DT_FOREACH_PROP_ELEM_SEP(node, heaters, REF_HEATER_ID, (,)) }, \
+        .num_heaters = DT_PROP_LEN(node, heaters),                               \
+        .default_target_temperature = DT_MILLI(node, target_mk),                 \
+        .default_state_on = !DT_PROP(node, default_off),                         \
+        .control_algorithm = (control_algo_t)DT_ENUM_IDX(node, control_algorithm), \
+        .update_period_ms = DT_PROP(node, update_period_ms),                     \
+        .p_gain = DT_MICRO(node, p_gain_micro),                                  \
+        .i_gain = DT_MICRO(node, i_gain_micro),                                  \
+        .d_gain = DT_MICRO(node, d_gain_micro),                                  \
+        .setpoint_weight = DT_MILLI(node, setpoint_weight_milli),                \
+        .derivative_on_measurement = DT_PROP(node, derivative_on_measurement),   \
+        .derivative_filter_tau = DT_MILLI(node, derivative_filter_tau_ms),       \
+        .anti_windup = (anti_windup_t)DT_ENUM_IDX(node, anti_windup),            \
+        .anti_windup_tracking_time = DT_MILLI(node, anti_windup_tracking_time_ms), \
+        .on_off_hysteresis = DT_MILLI(node, on_off_hysteresis_mk),               \
+        .model_thermal_resistance = DT_MILLI(node, model_thermal_resistance_mk_per_w), \
+        .model_heat_capacity = DT_MILLI(node, model_heat_capacity_mj_per_k),     \
+        .model_ambient_temp = DT_MILLI(node, model_ambient_mk),                  \
+        .feed_forward = DT_PROP(node, feed_forward),                             \
+        .mpc_horizon_steps = DT_PROP(node, mpc_horizon_steps),                   \
+        .mpc_reference_tau = DT_MILLI(node, mpc_reference_tau_ms),               \
+        .error_condition = (error_condition_t)DT_ENUM_IDX(node, error_condition), \
+        .threshold_for_invalid_sensors = DT_MILLI(node, invalid_sensor_threshold_mk), \
+        .sensor_weights = { COND_CODE_1(DT_NODE_HAS_PROP(node, sensor_weights_milli), \
+            (DT_FOREACH_PROP_ELEM_SEP(node, sensor_weights_milli, WEIGHT_ELEM, (,))), \
+            (0)) },                                                              \
+        .max_sensor_age_ms = DT_PROP(node, max_sensor_age_ms),                   \
+        .alarm_min_temp = DT_MILLI(node, alarm_min_mk),                          \
+        .alarm_max_temp = DT_MILLI(node, alarm_max_mk),                          \
+        .valid_setpoint_range_min = DT_MILLI(node, setpoint_min_mk),             \
+        .valid_setpoint_range_max = DT_MILLI(node, setpoint_max_mk),             \
+        .setpoint_change_rate_limit = DT_MILLI(node, ramp_rate_mk_per_min),      \
+        .heater_power_limit_min = DT_MILLI(node, power_limit_min_mw),            \
+        .heater_power_limit_max = DT_MILLI(node, power_limit_max_mw),            \
+        .follows_loop_id = COND_CODE_1(DT_NODE_HAS_PROP(node, follows),          \
+                                       (DT_PROP(DT_PHANDLE(node, follows), loop_id)), \
+                                       ("")),                                    \
+        .follows_loop_scalar = DT_MILLI(node, follows_scalar_milli),             \
+        .enabled = true,                                                         \
+    },
+
+#define INTERLOCK_ENTRY(node)                                                    \
+    {                                                                            \
+        .id = DT_PROP(node, interlock_id),                                       \
+        .sensor_id = DT_PROP(DT_PHANDLE(node, sensor), sensor_id),               \
+        .heater_ids = { DT_FOREACH_PROP_ELEM_SEP(node, heaters, REF_HEATER_ID, (,)) }, \
+        .num_heaters = DT_PROP_LEN(node, heaters),                               \
+        .min_temp = DT_MILLI(node, min_mk),                                      \
+        .max_temp = DT_MILLI(node, max_mk),                                      \
+        .enabled = true,                                                         \
+    },
+
+#if DT_HAS_COMPAT_STATUS_OKAY(coo_thermal_controller)
+#define CONTROLLER_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(coo_thermal_controller)
+#define CONTROLLER_ID DT_PROP(CONTROLLER_NODE, controller_id)
+#define CONTROLLER_TIMEOUT_S DT_PROP(CONTROLLER_NODE, timeout_seconds)
+#define CONTROLLER_TIMEOUT_CONDITION \
+    ((error_condition_t)DT_ENUM_IDX(CONTROLLER_NODE, timeout_error_condition))
+#else
+#define CONTROLLER_ID "tc-01"
+#define CONTROLLER_TIMEOUT_S 10
+#define CONTROLLER_TIMEOUT_CONDITION ERROR_CONDITION_ALARM
+#endif
+
+BUILD_ASSERT(sizeof(CONTROLLER_ID) <= MAX_ID_LENGTH, "controller-id too long");
+
+static const thermal_config_t dt_config = {
+    .id = CONTROLLER_ID,
+    .mode = CONTROLLER_MODE_AUTO,
+    .units = UNIT_KELVIN,
+    .number_of_sensors = DT_NUM_INST_STATUS_OKAY(coo_thermal_sensor),
+    .number_of_heaters = DT_NUM_INST_STATUS_OKAY(coo_regulator_heater) +
+                         DT_NUM_INST_STATUS_OKAY(coo_pwm_heater),
+    .number_of_control_loops = DT_NUM_INST_STATUS_OKAY(coo_thermal_loop),
+    .number_of_interlocks = DT_NUM_INST_STATUS_OKAY(coo_thermal_interlock),
+    .timeout_seconds = CONTROLLER_TIMEOUT_S,
+    .timeout_error_condition = CONTROLLER_TIMEOUT_CONDITION,
+    .sensors = {
+        DT_FOREACH_STATUS_OKAY(coo_thermal_sensor, SENSOR_ENTRY)
+    },
+    .heaters = {
+        DT_FOREACH_STATUS_OKAY(coo_regulator_heater, REG_HEATER_ENTRY)
+        DT_FOREACH_STATUS_OKAY(coo_pwm_heater, PWM_HEATER_ENTRY)
+    },
+    .control_loops = {
+        DT_FOREACH_STATUS_OKAY(coo_thermal_loop, LOOP_ENTRY)
+    },
+    .interlocks = {
+        DT_FOREACH_STATUS_OKAY(coo_thermal_interlock, INTERLOCK_ENTRY)
+    },
+};
+
+const thermal_config_t *config_devicetree(void)
+{
+    return &dt_config;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file autotune.c
+ * @brief Relay (Astrom-Hagglund) autotuner implementation
+ */
+
+#include "autotune.h"
+#include <math.h>
+#include <string.h>
+
+#define PI_F 3.14159265f
+
+/* The first rise ends a partial cycle from wherever the process started */
+#define SETTLING_RISES 2
+
+int autotune_start(autotune_t *tune, const autotune_params_t *params)
+{
+    if (params == NULL || params->output_high <= params->output_low ||
+        params->hysteresis < 0.0f || params->max_deviation < 0.0f ||
+        params->timeout_s < 0.0f || params->cycles == 0) {
+        return -1;
+    }
+
+    memset(tune, 0, sizeof(*tune));
+    tune->params = *params;
+    tune->state = AUTOTUNE_RUNNING;
+    tune->relay_high = true;
+    tune->pv_max = -INFINITY;
+    tune->pv_min = INFINITY;
+    return 0;
+}
+
+void autotune_abort(autotune_t *tune)
+{
+    if (tune->state == AUTOTUNE_RUNNING) {
+        tune->state = AUTOTUNE_FAILED;
+        tune->error = AUTOTUNE_ERR_ABORTED;
+    }
+}
+
+static void fail(autotune_t *tune, autotune_error_t error)
+{
+    tune->state = AUTOTUNE_FAILED;
+    tune->error = error;
+}
+
+static void finish(autotune_t *tune)
+{
+    const autotune_params_t *p = &tune->params;
+    float a = tune->amplitude_sum / (float)tune->periods;
+    float h = p->hysteresis;
+    float d = 0.5f * (p->output_high - p->output_low);
+
+    if (a <= h) {
+        fail(tune, AUTOTUNE_ERR_AMPLITUDE);
+        return;
+    }
+
+    tune->pu = tune->period_sum / (float)tune->periods;
+    tune->ku = 4.0f * d / (PI_F * sqrtf(a * a - h * h));
+
+    float ti, td;
+
+    if (p->rule == AUTOTUNE_RULE_ZIEGLER_NICHOLS) {
+        tune->kp = 0.6f * tune->ku;
+        ti = 0.5f * tune->pu;
+        td = 0.125f * tune->pu;
+    } else {
+        tune->kp = tune->ku / 2.2f;
+        ti = 2.2f * tune->pu;
+        td = tune->pu / 6.3f;
+    }
+    tune->ki = tune->kp / ti;
+    tune->kd = tune->kp * td;
+    tune->state = AUTOTUNE_DONE;
+}
+
+float autotune_step(autotune_t *tune, float measured, float dt_seconds)
+{
+    const autotune_params_t *p = &tune->params;
+
+    if (tune->state != AUTOTUNE_RUNNING) {
+        return p->output_low;
+    }
+
+    if (dt_seconds > 0.0f) {
+        tune->elapsed_s += dt_seconds;
+    }
+
+    if (p->timeout_s > 0.0f && tune->elapsed_s > p->timeout_s) {
+        fail(tune, AUTOTUNE_ERR_TIMEOUT);
+        return p->output_low;
+    }
+    if (p->max_deviation > 0.0f && fabsf(measured - p->setpoint) > p->max_deviation) {
+        fail(tune, AUTOTUNE_ERR_DEVIATION);
+        return p->output_low;
+    }
+
+    if (measured > tune->pv_max) {
+        tune->pv_max = measured;
+    }
+    if (measured < tune->pv_min) {
+        tune->pv_min = measured;
+    }
+
+    if (tune->relay_high && measured > p->setpoint + p->hysteresis) {
+        tune->relay_high = false;
+    } else if (!tune->relay_high && measured < p->setpoint - p->hysteresis) {
+        tune->relay_high = true;
+        tune->rises++;
+
+        /* One full period of the limit cycle ends at each rise */
+        if (tune->rises >= SETTLING_RISES) {
+            tune->period_sum += tune->elapsed_s - tune->last_rise_s;
+            tune->amplitude_sum += 0.5f * (tune->pv_max - tune->pv_min);
+            tune->periods++;
+        }
+        tune->last_rise_s = tune->elapsed_s;
+        tune->pv_max = measured;
+        tune->pv_min = measured;
+
+        if (tune->periods >= p->cycles) {
+            finish(tune);
+            return p->output_low;
+        }
+    }
+
+    return tune->relay_high ? p->output_high : p->output_low;
+}
+
+void autotune_get_progress(const autotune_t *tune, autotune_progress_t *progress)
+{
+    progress->state = tune->state;
+    progress->error = tune->error;
+    progress->cycles_done = tune->periods;
+    progress->cycles = tune->params.cycles;
+    progress->elapsed_s = tune->elapsed_s;
+    progress->output = (tune->state == AUTOTUNE_RUNNING && tune->relay_high)
+                       ? tune->params.output_high : tune->params.output_low;
+    progress->ku = tune->ku;
+    progress->pu = tune->pu;
+    progress->kp = tune->kp;
+    progress->ki = tune->ki;
+    progress->kd = tune->kd;
+}
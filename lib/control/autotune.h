@@ -0,0 +1,148 @@
+/**
+ * @file autotune.h
+ * @brief Relay (Astrom-Hagglund) autotuner
+ *
+ * While tuning, the loop's PID is bypassed and the heater output toggles
+ * between two bounded power levels around the setpoint. The process
+ * settles into a limit cycle whose period Pu and amplitude a give the
+ * ultimate gain Ku = 4d / (pi * sqrt(a^2 - h^2)), with d the relay
+ * half-swing and h the hysteresis. Gains follow from Ku and Pu by a
+ * tuning rule. Like the ramp engine, everything advances from the
+ * measured dt, so the tuner has no timers of its own.
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Tuner state
+ */
+typedef enum {
+    AUTOTUNE_IDLE = 0,
+    AUTOTUNE_RUNNING,
+    AUTOTUNE_DONE,
+    AUTOTUNE_FAILED
+} autotune_state_t;
+
+/**
+ * Why a tune failed
+ */
+typedef enum {
+    AUTOTUNE_ERR_NONE = 0,
+    AUTOTUNE_ERR_ABORTED,      // Stopped by command or loop alarm
+    AUTOTUNE_ERR_TIMEOUT,      // No settled limit cycle in time
+    AUTOTUNE_ERR_DEVIATION,    // Process left setpoint +/- max_deviation
+    AUTOTUNE_ERR_AMPLITUDE     // Oscillation not above the hysteresis band
+} autotune_error_t;
+
+/**
+ * Rule mapping (Ku, Pu) to PID gains
+ */
+typedef enum {
+    AUTOTUNE_RULE_TYREUS_LUYBEN = 0,  // Kp = Ku/2.2, Ti = 2.2 Pu, Td = Pu/6.3; mild overshoot
+    AUTOTUNE_RULE_ZIEGLER_NICHOLS     // Kp = 0.6 Ku, Ti = Pu/2, Td = Pu/8; faster, more overshoot
+} autotune_rule_t;
+
+/**
+ * Experiment parameters
+ */
+typedef struct {
+    float setpoint;         // Relay switching point (Kelvin)
+    float output_high;      // Heater power while below setpoint (W)
+    float output_low;       // Heater power while above setpoint (W)
+    float hysteresis;       // Relay band half-width (K), above sensor noise
+    float max_deviation;    // Abort if |PV - setpoint| exceeds this (K), 0 = no limit
+    float timeout_s;        // Abort if not done by then, 0 = no limit
+    uint8_t cycles;         // Limit-cycle periods to average
+    autotune_rule_t rule;
+} autotune_params_t;
+
+/**
+ * Tuner state block
+ */
+typedef struct {
+    autotune_params_t params;
+    autotune_state_t state;
+    autotune_error_t error;
+
+    bool relay_high;
+    float elapsed_s;
+    float last_rise_s;      // Time of the last low -> high switch
+    int rises;              // Low -> high switches so far
+    float pv_max;
+    float pv_min;
+
+    /* Accumulated over measured periods */
+    int periods;
+    float period_sum;
+    float amplitude_sum;
+
+    /* Results, valid in AUTOTUNE_DONE */
+    float ku;
+    float pu;
+    float kp;
+    float ki;
+    float kd;
+} autotune_t;
+
+/**
+ * Progress, for status queries
+ */
+typedef struct {
+    autotune_state_t state;
+    autotune_error_t error;
+    int cycles_done;
+    int cycles;
+    float elapsed_s;
+    float output;           // Relay output currently applied (W)
+    float ku;
+    float pu;
+    float kp;
+    float ki;
+    float kd;
+} autotune_progress_t;
+
+/**
+ * Start an experiment
+ * @param tune Tuner state
+ * @param params Experiment parameters, copied
+ * @return 0 on success, -1 on bad parameters
+ */
+int autotune_start(autotune_t *tune, const autotune_params_t *params);
+
+/**
+ * Stop a running experiment (state becomes FAILED / ABORTED)
+ * @param tune Tuner state
+ */
+void autotune_abort(autotune_t *tune);
+
+/**
+ * Advance one control tick
+ * @param tune Tuner state, must be RUNNING
+ * @param measured Process value (Kelvin)
+ * @param dt_seconds Time since the previous tick
+ * @return heater power to apply (W); output_low once the tune ends
+ */
+float autotune_step(autotune_t *tune, float measured, float dt_seconds);
+
+/**
+ * Check whether an experiment is in progress
+ * @param tune Tuner state
+ * @return true while RUNNING
+ */
+static inline bool autotune_running(const autotune_t *tune)
+{
+    return tune->state == AUTOTUNE_RUNNING;
+}
+
+/**
+ * Snapshot progress
+ * @param tune Tuner state
+ * @param progress Pointer to store progress
+ */
+void autotune_get_progress(const autotune_t *tune, autotune_progress_t *progress);
+
+#endif /* AUTOTUNE_H */
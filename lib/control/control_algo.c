@@ -0,0 +1,158 @@
+/**
+ * @file control_algo.c
+ * @brief Pluggable per-loop control algorithms implementation
+ */
+
+#include "control_algo.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+static float clampf(float v, float lo, float hi)
+{
+    return (v > hi) ? hi : (v < lo) ? lo : v;
+}
+
+float control_algo_feed_forward(const control_algo_model_t *model, float setpoint,
+                                float setpoint_rate)
+{
+    if (model->r_th <= 0.0f) {
+        return 0.0f;
+    }
+    return (setpoint - model->ambient) / model->r_th + model->c_th * setpoint_rate;
+}
+
+/* ---- ON_OFF: full power below the band, minimum above it ---- */
+
+static void on_off_reset(control_algo_state_t *state)
+{
+    state->on_off.on = false;
+}
+
+static float on_off_compute(control_algo_state_t *state, const control_algo_input_t *in)
+{
+    if (in->measured < in->setpoint - state->on_off.hysteresis) {
+        state->on_off.on = true;
+    } else if (in->measured > in->setpoint + state->on_off.hysteresis) {
+        state->on_off.on = false;
+    }
+    return state->on_off.on ? state->output_max : state->output_min;
+}
+
+/* ---- POWER_LEVEL: open loop, the model's steady-state power ---- */
+
+static void power_level_reset(control_algo_state_t *state)
+{
+    (void)state;
+}
+
+static float power_level_compute(control_algo_state_t *state, const control_algo_input_t *in)
+{
+    float power = control_algo_feed_forward(&state->model, in->setpoint, 0.0f);
+
+    return clampf(power, state->output_min, state->output_max);
+}
+
+/*
+ * ---- MPC: predictive functional control on the first-order model ----
+ *
+ * The input is held constant over a horizon of H ticks (one move), which
+ * makes the optimum closed-form: pick u so the prediction at H lands on
+ * a first-order reference trajectory from PV to the setpoint,
+ *   r_H = SP - exp(-H dt / tau_ref) * (SP - PV).
+ * The model runs alongside the plant and the difference PV - model is
+ * carried forward as a constant disturbance, which gives the controller
+ * integral action and absorbs slow coupling from neighbouring loops.
+ */
+
+static void mpc_reset(control_algo_state_t *state)
+{
+    state->mpc.primed = false;
+    state->mpc.last_output = 0.0f;
+}
+
+static float mpc_compute(control_algo_state_t *state, const control_algo_input_t *in)
+{
+    const control_algo_model_t *m = &state->model;
+    float rc = m->r_th * m->c_th;
+
+    if (!state->mpc.primed || in->dt <= 0.0f) {
+        state->mpc.model_temp = in->measured;
+        state->mpc.primed = true;
+    } else {
+        /* Advance the model over the last tick with the output actually applied */
+        float a = expf(-in->dt / rc);
+
+        state->mpc.model_temp = a * state->mpc.model_temp +
+                                (1.0f - a) * (m->ambient + m->r_th * state->mpc.last_output);
+    }
+
+    float dt = (in->dt > 0.0f) ? in->dt : 1.0f;
+    float horizon_s = (float)state->mpc.horizon * dt;
+    float a_h = expf(-horizon_s / rc);
+    float lambda_h = expf(-horizon_s / state->mpc.reference_tau);
+    float bias = in->measured - state->mpc.model_temp;
+    float r_h = in->setpoint - lambda_h * (in->setpoint - in->measured);
+
+    /* Solve r_H = a_H x + (1 - a_H)(T_amb + R u) + bias for u */
+    float u = ((r_h - bias - a_h * state->mpc.model_temp) / (1.0f - a_h) - m->ambient) /
+              m->r_th;
+
+    u = clampf(u, state->output_min, state->output_max);
+    state->mpc.last_output = u;
+    return u;
+}
+
+static const control_algo_ops_t algo_ops[] = {
+    [CONTROL_ALGO_PID] = { .name = "pid" },
+    [CONTROL_ALGO_ON_OFF] = { .name = "on_off", .reset = on_off_reset,
+                              .compute = on_off_compute },
+    [CONTROL_ALGO_POWER_LEVEL] = { .name = "power_level", .reset = power_level_reset,
+                                   .compute = power_level_compute, .model_based = true },
+    [CONTROL_ALGO_MPC] = { .name = "mpc", .reset = mpc_reset, .compute = mpc_compute,
+                           .model_based = true },
+};
+
+const control_algo_ops_t *control_algo_get(control_algo_t algo)
+{
+    if ((unsigned int)algo >= sizeof(algo_ops) / sizeof(algo_ops[0])) {
+        return NULL;
+    }
+    return &algo_ops[algo];
+}
+
+int control_algo_init(control_algo_state_t *state, const control_loop_config_t *cfg)
+{
+    memset(state, 0, sizeof(*state));
+    state->output_min = cfg->heater_power_limit_min;
+    state->output_max = cfg->heater_power_limit_max;
+    state->model.r_th = cfg->model_thermal_resistance;
+    state->model.c_th = cfg->model_heat_capacity;
+    state->model.ambient = cfg->model_ambient_temp;
+
+    switch (cfg->control_algorithm) {
+    case CONTROL_ALGO_ON_OFF:
+        state->on_off.hysteresis = cfg->on_off_hysteresis;
+        break;
+    case CONTROL_ALGO_POWER_LEVEL:
+        if (state->model.r_th <= 0.0f) {
+            return -1;
+        }
+        break;
+    case CONTROL_ALGO_MPC:
+        if (state->model.r_th <= 0.0f || state->model.c_th <= 0.0f ||
+            cfg->mpc_horizon_steps == 0 || cfg->mpc_reference_tau <= 0.0f) {
+            return -1;
+        }
+        state->mpc.horizon = cfg->mpc_horizon_steps;
+        state->mpc.reference_tau = cfg->mpc_reference_tau;
+        break;
+    default:
+        break;
+    }
+
+    if (cfg->feed_forward && state->model.r_th <= 0.0f) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file control_algo.h
+ * @brief Pluggable per-loop control algorithms
+ *
+ * Each control_algo_t has an ops table. control_loop_init() looks it up
+ * once, so a tick costs one indirect call and no switch. PID has no
+ * compute hook: those loops are stepped together by the PID bank.
+ *
+ * The model-based algorithms share a first-order heater -> sensor model:
+ *   C dT/dt = P - (T - T_amb) / R
+ * which also gives the feed-forward power for a setpoint trajectory.
+ */
+
+#ifndef CONTROL_ALGO_H
+#define CONTROL_ALGO_H
+
+#include "../config/config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * First-order thermal model
+ */
+typedef struct {
+    float r_th;             // K/W
+    float c_th;             // J/K, 0 = steady state only
+    float ambient;          // Kelvin
+} control_algo_model_t;
+
+/**
+ * Per-loop algorithm state
+ */
+typedef struct {
+    float output_min;
+    float output_max;
+    control_algo_model_t model;
+
+    union {
+        struct {
+            float hysteresis;
+            bool on;
+        } on_off;
+        struct {
+            uint16_t horizon;
+            float reference_tau;
+            float model_temp;   // Internal model output
+            float last_output;
+            bool primed;
+        } mpc;
+    };
+} control_algo_state_t;
+
+/**
+ * Inputs for one tick
+ */
+typedef struct {
+    float setpoint;         // Kelvin
+    float measured;         // Kelvin
+    float dt;               // Seconds since the last tick
+} control_algo_input_t;
+
+/**
+ * Algorithm operations
+ */
+typedef struct {
+    const char *name;
+    /* Move-free restart, e.g. after enable or resume */
+    void (*reset)(control_algo_state_t *state);
+    /* Heater power in W, within [output_min, output_max]; NULL = PID bank */
+    float (*compute)(control_algo_state_t *state, const control_algo_input_t *in);
+    /* compute() already accounts for the model, so no feed-forward on top */
+    bool model_based;
+} control_algo_ops_t;
+
+/**
+ * Look up the ops table for an algorithm
+ * @param algo Algorithm from the loop configuration
+ * @return ops table, or NULL if the algorithm is unknown
+ */
+const control_algo_ops_t *control_algo_get(control_algo_t algo);
+
+/**
+ * Initialize algorithm state from a loop configuration
+ * @param state State to initialize
+ * @param cfg Loop configuration
+ * @return 0 on success, -1 if the algorithm needs a model that is missing
+ */
+int control_algo_init(control_algo_state_t *state, const control_loop_config_t *cfg);
+
+/**
+ * Feed-forward power: what the model needs to hold the setpoint plus
+ * what it needs to move it at the current ramp rate
+ * @param model Thermal model
+ * @param setpoint Working setpoint (Kelvin)
+ * @param setpoint_rate Setpoint slope (K/s)
+ * @return power in W, unclamped
+ */
+float control_algo_feed_forward(const control_algo_model_t *model, float setpoint,
+                                float setpoint_rate);
+
+#endif /* CONTROL_ALGO_H */
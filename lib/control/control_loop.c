@@ -6,27 +6,46 @@
 #include "control_loop.h"
 #include "../sensors/sensor_manager.h"
 #include "../heaters/heater_manager.h"
-#include <coo_commons/pid.h>
+#include "setpoint_ramp.h"
+#include "autotune.h"
+#include "control_algo.h"
+#ifdef CONFIG_COO_CONTROL_PERSIST
+#include "loop_persist.h"
+#endif
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+#include "flight_recorder.h"
+#endif
+#include <coo_commons/log_limit.h>
+#include <coo_commons/pid_bank.h>
+#include <coo_commons/stage_trace.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <math.h>
 #include <string.h>
 
 LOG_MODULE_REGISTER(control_loop, LOG_LEVEL_INF);
 
-/* Control loop runtime state */
+/* Control loop runtime state; IDs and sensor weights stay in the config */
 static struct {
-    char id[MAX_ID_LENGTH];
-    struct coo_pid pid;  /* coo_commons PID controller */
-
-    /* Configuration */
-    char sensor_ids[MAX_SENSORS_PER_LOOP][MAX_ID_LENGTH];
-    int num_sensors;
-    char heater_ids[MAX_HEATERS_PER_LOOP][MAX_ID_LENGTH];
-    int num_heaters;
-
-    /* Setpoint management */
-    float target_temp_kelvin;
-    float current_setpoint;  /* For ramping */
+    /* Sensor/heater handles in member_arena, resolved once at init */
+    const config_index_t *sensor_handles;
+    const config_index_t *heater_handles;
+    uint8_t num_sensors;
+    uint8_t num_heaters;
+    sensor_fusion_params_t fusion;
+
+    /* Setpoint management: ramp.target is the commanded target */
+    setpoint_ramp_t ramp;
+
+    /* Algorithm, resolved at init; algo->compute == NULL runs the PID bank */
+    const control_algo_ops_t *algo;
+    control_algo_state_t algo_state;
+    bool feed_forward;
+    float prev_setpoint;       /* For the feed-forward setpoint slope */
+
+    /* Relay autotune; while running it replaces the PID for this loop */
+    autotune_t tune;
+    bool tune_apply;           /* Install the gains when the tune finishes */
 
     /* Alarm thresholds */
     float alarm_min_temp;
@@ -37,21 +56,188 @@ static struct {
     float power_limit_max;
 
     /* Loop following */
-    char follows_loop_id[MAX_ID_LENGTH];
+    int follows_handle;  /* -1 = not following */
     float follows_scalar;
 
+    /* Scheduling */
+    uint32_t period_ms;        /* 0 = run on every update_all() pass */
+    int64_t next_deadline_ms;
+    int64_t last_run_ms;
+    bool scheduled;            /* false until the first run after (re)start */
+    uint32_t overruns;         /* Whole periods missed since init */
+    uint32_t skipped;          /* Passes sat out waiting for the deadline */
+
     /* Status */
     bool enabled;
     bool suspended;
     loop_status_t status;
+    float last_measured;       /* Fused process value of the last pass, NAN before one */
+    float last_output;         /* Clamped power planned on the last pass */
+
+    /* Per-tick faults log on the edge, then as periodic counts */
+    struct {
+        struct coo_log_limit sensor;
+        struct coo_log_limit alarm;
+        struct coo_log_limit heater;
+    } log;
 } loop_state[MAX_CONTROL_LOOPS];
 
 static int num_loops = 0;
 static const thermal_config_t *config_ptr = NULL;
 
+/*
+ * Every loop's sensor handles then heater handles, carved in loop order
+ * at init, so a pass reads them front to back from a few cache lines.
+ * Unknown IDs stay as NO_CONFIG_INDEX to keep the sensor weights aligned.
+ */
+static config_index_t member_arena[MAX_LOOP_SENSOR_REFS + MAX_LOOP_HEATER_REFS];
+static size_t member_arena_used;
+
 /* Thread-safe mutex */
 K_MUTEX_DEFINE(control_mutex);
 
+/*
+ * PID state for every loop, channel i = loop i. Kept out of loop_state[]
+ * so one control pass steps all due loops over a few dense arrays.
+ * The pid_* arrays below are the bank's per-pass inputs and outputs.
+ * All guarded by control_mutex.
+ */
+COO_PID_BANK_DEFINE(loop_pids, MAX_CONTROL_LOOPS);
+static float pid_setpoint[MAX_CONTROL_LOOPS];
+static float pid_measured[MAX_CONTROL_LOOPS];
+static float pid_dt[MAX_CONTROL_LOOPS];
+static float pid_output[MAX_CONTROL_LOOPS];
+static uint8_t pid_run[MAX_CONTROL_LOOPS];
+static float tick_ff[MAX_CONTROL_LOOPS];   /* Feed-forward added to the output */
+/* Loops with an output to plan this pass: PID channels plus autotuning loops */
+static uint8_t tick_active[MAX_CONTROL_LOOPS];
+
+/*
+ * Heater commands gathered from every loop that runs in one update_all()
+ * pass and applied together at the end of it. Guarded by control_mutex.
+ */
+static heater_command_t tick_cmds[MAX_LOOP_HEATER_REFS];
+static int tick_num_cmds;
+static struct coo_log_limit apply_log;
+
+/*
+ * Loop indices with every leader ahead of its followers, built once at
+ * init. A pass walks this order, so a follower chain of any length picks
+ * up its leaders' setpoints from the same pass.
+ */
+static int follow_order[MAX_CONTROL_LOOPS];
+
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+/* Every loop's data for every pass it runs; the ring has its own lock */
+COO_TELEMETRY_DEFINE(loop_telemetry, CONFIG_COO_CONTROL_TELEMETRY_DEPTH);
+
+/* Device state behind each pass's sensor and heater samples; control thread only */
+static sensor_snapshot_t telemetry_sensors;
+static heater_snapshot_t telemetry_heaters;
+#endif
+
+/*
+ * A field control_loop_save_state() covers has changed. The persistence
+ * layer only schedules the write, so this is safe with control_mutex held.
+ */
+static void state_changed(void)
+{
+#ifdef CONFIG_COO_CONTROL_PERSIST
+    loop_persist_note_change();
+#endif
+}
+
+static inline const char *id_of(int i)
+{
+    return config_ptr->control_loops[i].id;
+}
+
+/*
+ * Sensor and heater handles are indices into the config tables, which the
+ * sensor and heater managers mirror one-to-one. Resolving against the config
+ * keeps control_loop_init independent of manager init order.
+ */
+static const config_index_t *resolve_members(const char ids[][MAX_ID_LENGTH], int count,
+                                             int (*lookup)(const thermal_config_t *,
+                                                           const char *),
+                                             const char *what, const char *loop)
+{
+    if (count < 0 || (size_t)count > ARRAY_SIZE(member_arena) - member_arena_used) {
+        return NULL;
+    }
+
+    config_index_t *list = &member_arena[member_arena_used];
+
+    member_arena_used += (size_t)count;
+    for (int j = 0; j < count; j++) {
+        int index = lookup(config_ptr, ids[j]);
+
+        if (index < 0) {
+            LOG_WRN("Loop %s: unknown %s %s", loop, what, ids[j]);
+        }
+        list[j] = (index < 0) ? NO_CONFIG_INDEX : (config_index_t)index;
+    }
+    return list;
+}
+
+static enum coo_pid_anti_windup to_pid_anti_windup(anti_windup_t mode)
+{
+    switch (mode) {
+    case ANTI_WINDUP_CONDITIONAL:
+        return COO_PID_ANTI_WINDUP_CONDITIONAL;
+    case ANTI_WINDUP_BACK_CALC:
+        return COO_PID_ANTI_WINDUP_BACK_CALC;
+    case ANTI_WINDUP_CLAMP:
+    default:
+        return COO_PID_ANTI_WINDUP_CLAMP;
+    }
+}
+
+/*
+ * Order loops by follow depth (leaders first, index order within a depth).
+ * config_validate() rejects cycles; any that get here anyway are broken
+ * by dropping the follow on the loop that closes them.
+ */
+static void build_follow_order(void)
+{
+    int depth[MAX_CONTROL_LOOPS];
+    int max_depth = 0;
+
+    for (int i = 0; i < num_loops; i++) {
+        int d = 0;
+
+        for (int j = loop_state[i].follows_handle; j >= 0; j = loop_state[j].follows_handle) {
+            if (++d > num_loops) {
+                LOG_ERR("Loop %s: follow cycle, not following", id_of(i));
+                loop_state[i].follows_handle = -1;
+                break;
+            }
+        }
+    }
+
+    /* Depths once the graph is acyclic */
+    for (int i = 0; i < num_loops; i++) {
+        int d = 0;
+
+        for (int j = loop_state[i].follows_handle; j >= 0; j = loop_state[j].follows_handle) {
+            d++;
+        }
+        depth[i] = d;
+        if (d > max_depth) {
+            max_depth = d;
+        }
+    }
+
+    int n = 0;
+    for (int d = 0; d <= max_depth; d++) {
+        for (int i = 0; i < num_loops; i++) {
+            if (depth[i] == d) {
+                follow_order[n++] = i;
+            }
+        }
+    }
+}
+
 int control_loop_init(const thermal_config_t *config)
 {
     if (config == NULL) {
@@ -68,29 +254,45 @@ int control_loop_init(const thermal_config_t *config)
     }
 
     /* Initialize each control loop */
+    member_arena_used = 0;
     for (int i = 0; i < num_loops; i++) {
         const control_loop_config_t *cfg = &config->control_loops[i];
 
-        /* Copy basic info */
-        strncpy(loop_state[i].id, cfg->id, MAX_ID_LENGTH - 1);
         loop_state[i].enabled = cfg->enabled && cfg->default_state_on;
         loop_state[i].suspended = false;
         loop_state[i].status = LOOP_STATUS_OK;
-
-        /* Copy sensor/heater IDs */
-        loop_state[i].num_sensors = cfg->num_sensors;
-        for (int j = 0; j < cfg->num_sensors; j++) {
-            strncpy(loop_state[i].sensor_ids[j], cfg->sensor_ids[j], MAX_ID_LENGTH - 1);
+        loop_state[i].last_measured = NAN;
+        loop_state[i].last_output = 0.0f;
+        memset(&loop_state[i].log, 0, sizeof(loop_state[i].log));
+
+        /* Resolve sensor/heater IDs to handles */
+        if (cfg->num_sensors > MAX_SENSORS_PER_LOOP || cfg->num_heaters > MAX_HEATERS_PER_LOOP) {
+            LOG_ERR("Loop %s: too many sensors or heaters", cfg->id);
+            return -3;
+        }
+        loop_state[i].sensor_handles = resolve_members(cfg->sensor_ids, cfg->num_sensors,
+                                                       config_sensor_index, "sensor", cfg->id);
+        loop_state[i].heater_handles = resolve_members(cfg->heater_ids, cfg->num_heaters,
+                                                       config_heater_index, "heater", cfg->id);
+        if (loop_state[i].sensor_handles == NULL || loop_state[i].heater_handles == NULL) {
+            LOG_ERR("Loop %s: member table full", cfg->id);
+            return -3;
         }
+        loop_state[i].num_sensors = (uint8_t)cfg->num_sensors;
+        loop_state[i].num_heaters = (uint8_t)cfg->num_heaters;
 
-        loop_state[i].num_heaters = cfg->num_heaters;
-        for (int j = 0; j < cfg->num_heaters; j++) {
-            strncpy(loop_state[i].heater_ids[j], cfg->heater_ids[j], MAX_ID_LENGTH - 1);
+        /* Sensor fusion; weights only apply if at least one is set */
+        bool weighted = false;
+        for (int j = 0; j < cfg->num_sensors; j++) {
+            weighted |= (cfg->sensor_weights[j] != 0.0f);
         }
+        loop_state[i].fusion.outlier_threshold = cfg->threshold_for_invalid_sensors;
+        loop_state[i].fusion.max_age_ms = cfg->max_sensor_age_ms;
+        loop_state[i].fusion.weights = weighted ? cfg->sensor_weights : NULL;
 
-        /* Setpoint */
-        loop_state[i].target_temp_kelvin = cfg->default_target_temperature;
-        loop_state[i].current_setpoint = cfg->default_target_temperature;
+        /* Setpoint starts settled at the default target */
+        setpoint_ramp_init(&loop_state[i].ramp, cfg->default_target_temperature,
+                           cfg->setpoint_change_rate_limit);
 
         /* Alarms */
         loop_state[i].alarm_min_temp = cfg->alarm_min_temp;
@@ -101,143 +303,512 @@ int control_loop_init(const thermal_config_t *config)
         loop_state[i].power_limit_max = cfg->heater_power_limit_max;
 
         /* Loop following */
-        strncpy(loop_state[i].follows_loop_id, cfg->follows_loop_id, MAX_ID_LENGTH - 1);
+        loop_state[i].follows_handle = (cfg->follows_loop_id[0] == '\0') ? -1 :
+                                       config_loop_index(config, cfg->follows_loop_id);
         loop_state[i].follows_scalar = cfg->follows_loop_scalar;
 
+        /* Scheduling */
+        loop_state[i].period_ms = cfg->update_period_ms;
+        loop_state[i].scheduled = false;
+        loop_state[i].overruns = 0;
+        loop_state[i].skipped = 0;
+
+        /* Resolve the algorithm once; the tick path only calls through it */
+        loop_state[i].algo = control_algo_get(cfg->control_algorithm);
+        if (loop_state[i].algo == NULL ||
+            control_algo_init(&loop_state[i].algo_state, cfg) != 0) {
+            LOG_ERR("Loop %s: invalid control algorithm %d or model, loop disabled",
+                    cfg->id, (int)cfg->control_algorithm);
+            loop_state[i].algo = control_algo_get(CONTROL_ALGO_PID);
+            loop_state[i].enabled = false;
+        }
+        loop_state[i].feed_forward = cfg->feed_forward && !loop_state[i].algo->model_based;
+        loop_state[i].prev_setpoint = cfg->default_target_temperature;
+
+        /*
+         * With feed-forward the PID only trims around the model power, so
+         * it must be able to pull the sum back down to the lower limit.
+         */
+        float pid_min = cfg->heater_power_limit_min;
+        if (loop_state[i].feed_forward) {
+            pid_min -= cfg->heater_power_limit_max;
+        }
+
         /* Initialize PID controller using coo_commons */
         if (cfg->control_algorithm == CONTROL_ALGO_PID) {
-            coo_pid_init(&loop_state[i].pid,
-                         cfg->p_gain,
-                         cfg->i_gain,
-                         cfg->d_gain,
-                         cfg->heater_power_limit_min,
-                         cfg->heater_power_limit_max);
+            coo_pid_bank_init_channel(&loop_pids, i,
+                                      cfg->p_gain,
+                                      cfg->i_gain,
+                                      cfg->d_gain,
+                                      pid_min,
+                                      cfg->heater_power_limit_max);
+
+            struct coo_pid_options opts;
+
+            coo_pid_options_default(&opts);
+            opts.setpoint_weight = cfg->setpoint_weight;
+            opts.derivative_on_measurement = cfg->derivative_on_measurement;
+            opts.derivative_filter_tau = cfg->derivative_filter_tau;
+            opts.anti_windup = to_pid_anti_windup(cfg->anti_windup);
+            opts.tracking_time = cfg->anti_windup_tracking_time;
+            coo_pid_bank_set_options(&loop_pids, i, &opts);
 
             LOG_INF("Loop %s: PID initialized (P=%.2f, I=%.2f, D=%.2f)",
                     cfg->id, (double)cfg->p_gain, (double)cfg->i_gain, (double)cfg->d_gain);
         } else {
-            LOG_WRN("Loop %s: Only PID algorithm supported currently", cfg->id);
+            coo_pid_bank_init_channel(&loop_pids, i, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+            LOG_INF("Loop %s: %s controller initialized%s", cfg->id,
+                    loop_state[i].algo->name,
+                    loop_state[i].feed_forward ? " with feed-forward" : "");
         }
     }
 
+    build_follow_order();
+
     LOG_INF("Control loop subsystem initialized with %d loops", num_loops);
     return 0;
 }
 
+/*
+ * Advance a periodic loop's deadline and return the dt it should integrate
+ * over. Periods missed entirely (the pass came late by more than one period)
+ * are counted as overruns and skipped rather than run back to back.
+ */
+static float schedule_advance(int i, int64_t now_ms)
+{
+    uint32_t period = loop_state[i].period_ms;
+
+    if (!loop_state[i].scheduled) {
+        loop_state[i].scheduled = true;
+        loop_state[i].last_run_ms = now_ms;
+        loop_state[i].next_deadline_ms = now_ms + period;
+        return period / 1000.0f;
+    }
+
+    float dt = (float)(now_ms - loop_state[i].last_run_ms) / 1000.0f;
+
+    loop_state[i].last_run_ms = now_ms;
+    loop_state[i].next_deadline_ms += period;
+    if (loop_state[i].next_deadline_ms <= now_ms) {
+        int64_t missed = (now_ms - loop_state[i].next_deadline_ms) / period + 1;
+
+        loop_state[i].overruns += (uint32_t)missed;
+        loop_state[i].next_deadline_ms += missed * period;
+    }
+
+    return dt;
+}
+
+/* Install a finished tune's gains and start the PID fresh from them */
+static void autotune_install(int i)
+{
+    const autotune_t *tune = &loop_state[i].tune;
+
+    LOG_INF("Loop %s: Autotune done (Ku=%.3f, Pu=%.1f s) -> P=%.3f, I=%.4f, D=%.3f%s",
+            id_of(i), (double)tune->ku, (double)tune->pu,
+            (double)tune->kp, (double)tune->ki, (double)tune->kd,
+            loop_state[i].tune_apply ? "" : " (not applied)");
+
+    if (loop_state[i].tune_apply) {
+        coo_pid_bank_set_gains(&loop_pids, i, tune->kp, tune->ki, tune->kd);
+        coo_pid_bank_reset(&loop_pids, i);
+        state_changed();
+    }
+}
+
+/*
+ * One relay step for an autotuning loop. The setpoint is held at the
+ * relay switching point and the PID channel is skipped; its state is
+ * reset when the tune ends so PID takes over without a bump.
+ */
+static void autotune_loop(int i, float measured_temp, float dt_seconds, bool alarm)
+{
+    autotune_t *tune = &loop_state[i].tune;
+
+    if (alarm) {
+        autotune_abort(tune);
+    }
+
+    pid_setpoint[i] = tune->params.setpoint;
+    pid_measured[i] = measured_temp;
+    pid_output[i] = autotune_step(tune, measured_temp, dt_seconds);
+    tick_ff[i] = 0.0f;
+    tick_active[i] = 1;
+
+    if (tune->state == AUTOTUNE_DONE) {
+        autotune_install(i);
+    } else if (tune->state == AUTOTUNE_FAILED) {
+        LOG_WRN("Loop %s: Autotune failed (%d)", id_of(i), (int)tune->error);
+        coo_pid_bank_reset(&loop_pids, i);
+    }
+    if (!autotune_running(tune) && loop_state[i].algo->reset != NULL) {
+        loop_state[i].algo->reset(&loop_state[i].algo_state);
+    }
+}
+
+/*
+ * Gather loop i's PID inputs into the bank arrays: fused process value,
+ * alarm check and the working setpoint. Caller holds control_mutex.
+ * Returns 0 if the loop should run the PID this pass, or a negative error
+ * count; a loop with an alarm still runs so it can shut down in control.
+ */
+static int prepare_loop(int i, float dt_seconds)
+{
+    int errors = 0;
+
+    /* Read sensors and fuse them into one process value */
+    float measured_temp = 0.0f;
+    int ret = sensor_manager_fuse_by_handle(loop_state[i].sensor_handles,
+                                            loop_state[i].num_sensors,
+                                            &loop_state[i].fusion,
+                                            &measured_temp, NULL);
+    if (ret != 0) {
+        loop_state[i].status = LOOP_STATUS_SENSOR_ERROR;
+        loop_state[i].last_measured = NAN;
+        COO_LOG_LIMITED(WRN, &loop_state[i].log.sensor, "Loop %s: Sensor read error",
+                        id_of(i));
+        return -1;
+    }
+    loop_state[i].last_measured = measured_temp;
+    COO_LOG_LIMITED_CLEAR(INF, &loop_state[i].log.sensor, "Loop %s: Sensors readable again",
+                          id_of(i));
+
+    /* Check alarm conditions */
+    if (measured_temp < loop_state[i].alarm_min_temp ||
+        measured_temp > loop_state[i].alarm_max_temp) {
+        loop_state[i].status = LOOP_STATUS_ALARM;
+        COO_LOG_LIMITED(ERR, &loop_state[i].log.alarm,
+                        "Loop %s: ALARM - Temperature %.2f K out of range (%.2f - %.2f)",
+                        id_of(i), (double)measured_temp,
+                        (double)loop_state[i].alarm_min_temp,
+                        (double)loop_state[i].alarm_max_temp);
+        errors++;
+        /* Continue to allow controlled shutdown */
+    } else {
+        loop_state[i].status = LOOP_STATUS_OK;
+        COO_LOG_LIMITED_CLEAR(WRN, &loop_state[i].log.alarm,
+                              "Loop %s: Alarm cleared at %.2f K", id_of(i),
+                              (double)measured_temp);
+    }
+
+    if (autotune_running(&loop_state[i].tune)) {
+        autotune_loop(i, measured_temp, dt_seconds, errors > 0);
+        return -errors;
+    }
+
+    /*
+     * Determine setpoint. A follower tracks its leader's working setpoint,
+     * which is already rate limited, so it does not ramp on its own.
+     */
+    float setpoint;
+
+    if (loop_state[i].follows_handle >= 0) {
+        int leader = loop_state[i].follows_handle;
+
+        setpoint = loop_state[leader].ramp.setpoint * loop_state[i].follows_scalar;
+        loop_state[i].ramp.setpoint = setpoint;
+        loop_state[i].ramp.target = setpoint;
+    } else {
+        setpoint = setpoint_ramp_advance(&loop_state[i].ramp, dt_seconds);
+    }
+
+    pid_setpoint[i] = setpoint;
+    pid_measured[i] = measured_temp;
+    pid_dt[i] = dt_seconds;
+    tick_active[i] = 1;
+
+    tick_ff[i] = 0.0f;
+    if (loop_state[i].feed_forward) {
+        float rate = (dt_seconds > 0.0f)
+                     ? (setpoint - loop_state[i].prev_setpoint) / dt_seconds : 0.0f;
+
+        tick_ff[i] = control_algo_feed_forward(&loop_state[i].algo_state.model,
+                                               setpoint, rate);
+    }
+    loop_state[i].prev_setpoint = setpoint;
+
+    if (loop_state[i].algo->compute != NULL) {
+        const control_algo_input_t in = {
+            .setpoint = setpoint,
+            .measured = measured_temp,
+            .dt = dt_seconds,
+        };
+
+        pid_output[i] = loop_state[i].algo->compute(&loop_state[i].algo_state, &in);
+    } else {
+        pid_run[i] = 1;
+    }
+
+    return -errors;
+}
+
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+/* Record loop i's pass; output is the clamped power being planned */
+static void record_telemetry(int i, float output, int64_t now_ms)
+{
+    struct coo_telemetry_sample sample = {
+        .timestamp_ms = (uint32_t)now_ms,
+        .channel = (uint8_t)i,
+        .kind = CONTROL_TELEMETRY_KIND_LOOP,
+        .status = (int8_t)loop_state[i].status,
+        .measured = pid_measured[i],
+        .setpoint = pid_setpoint[i],
+        .output = output,
+    };
+
+    if (pid_run[i]) {
+        sample.flags |= COO_TELEMETRY_FLAG_PID;
+        sample.p_term = loop_pids.p_term[i];
+        sample.i_term = loop_pids.i_term[i];
+        sample.d_term = loop_pids.d_term[i];
+    }
+    if (autotune_running(&loop_state[i].tune)) {
+        sample.flags |= COO_TELEMETRY_FLAG_AUTOTUNE;
+    }
+    if (loop_state[i].status == LOOP_STATUS_ALARM) {
+        sample.flags |= COO_TELEMETRY_FLAG_ALARM;
+    }
+    if (output != pid_output[i] + tick_ff[i]) {
+        sample.flags |= COO_TELEMETRY_FLAG_SATURATED;
+    }
+
+    coo_telemetry_record(&loop_telemetry, &sample);
+}
+
+/* Record every sensor and heater once per pass; takes each manager's lock */
+static void record_device_telemetry(int64_t now_ms)
+{
+    struct coo_telemetry_sample sample = {
+        .timestamp_ms = (uint32_t)now_ms,
+    };
+
+    if (sensor_manager_get_snapshot(&telemetry_sensors) == 0) {
+        sample.kind = CONTROL_TELEMETRY_KIND_SENSOR;
+        for (int s = 0; s < telemetry_sensors.count; s++) {
+            sample.channel = (uint8_t)s;
+            sample.status = (int8_t)telemetry_sensors.readings[s].status;
+            sample.measured = telemetry_sensors.valid[s] ?
+                              telemetry_sensors.readings[s].temperature_kelvin : NAN;
+            coo_telemetry_record(&loop_telemetry, &sample);
+        }
+    }
+
+    sample.measured = 0.0f;
+    if (heater_manager_get_snapshot(&telemetry_heaters) == 0) {
+        sample.kind = CONTROL_TELEMETRY_KIND_HEATER;
+        for (int h = 0; h < telemetry_heaters.count; h++) {
+            sample.channel = (uint8_t)h;
+            sample.status = (int8_t)telemetry_heaters.heaters[h].status;
+            sample.output = telemetry_heaters.heaters[h].power_percent;
+            coo_telemetry_record(&loop_telemetry, &sample);
+        }
+    }
+}
+
+struct coo_telemetry *control_loop_get_telemetry(void)
+{
+    return &loop_telemetry;
+}
+#endif
+
+/* Queue loop i's heater commands from the bank output. Caller holds control_mutex. */
+static int finish_loop(int i, int64_t now_ms)
+{
+    float output = pid_output[i] + tick_ff[i];
+
+    if (output > loop_state[i].power_limit_max) {
+        output = loop_state[i].power_limit_max;
+    } else if (output < loop_state[i].power_limit_min) {
+        output = loop_state[i].power_limit_min;
+    }
+    loop_state[i].last_output = output;
+
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+    record_telemetry(i, output, now_ms);
+#else
+    ARG_UNUSED(now_ms);
+#endif
+
+    /* Queue this loop's heater commands for the end of the pass */
+    int ret = heater_manager_plan_distribution(loop_state[i].heater_handles,
+                                               loop_state[i].num_heaters,
+                                               output,
+                                               &tick_cmds[tick_num_cmds],
+                                               ARRAY_SIZE(tick_cmds) - tick_num_cmds);
+    if (ret < 0) {
+        COO_LOG_LIMITED(ERR, &loop_state[i].log.heater, "Loop %s: Failed to set heater power",
+                        id_of(i));
+        return -1;
+    }
+    tick_num_cmds += ret;
+    COO_LOG_LIMITED_CLEAR(INF, &loop_state[i].log.heater, "Loop %s: Heater power set again",
+                          id_of(i));
+
+    /* Runs every pass, so debug only */
+    LOG_DBG("Loop %s: SP=%.2f, PV=%.2f, OUT=%.2f W",
+            id_of(i), (double)pid_setpoint[i], (double)pid_measured[i],
+            (double)output);
+
+    return 0;
+}
+
 int control_loop_update_all(float dt_seconds)
 {
     int errors = 0;
+    int64_t now_ms = k_uptime_get();
+    int due[MAX_CONTROL_LOOPS];
+    int num_due = 0;
+
+    /*
+     * Passes arrive with timer and sweep jitter, so a deadline a little
+     * ahead of now is due now: waiting for the next pass would stretch
+     * that period by a whole pass. Half the pass interval splits the
+     * difference; it is capped at half the loop's period below.
+     */
+    int64_t slack_ms = (dt_seconds > 0.0f) ? (int64_t)(dt_seconds * 500.0f) : 0;
 
     k_mutex_lock(&control_mutex, K_FOREVER);
 
-    for (int i = 0; i < num_loops; i++) {
+    /*
+     * Collect every loop whose deadline has passed, in follow order.
+     * Outputs are only applied at the end of the pass, so within a pass
+     * the leader-first order is the only one that matters. Unscheduled
+     * loops (period 0 or first run) are always due.
+     */
+    for (int n = 0; n < num_loops; n++) {
+        int i = follow_order[n];
+
         if (!loop_state[i].enabled || loop_state[i].suspended) {
             continue;
         }
+        if (loop_state[i].period_ms > 0 && loop_state[i].scheduled) {
+            int64_t slack = MIN(slack_ms, (int64_t)(loop_state[i].period_ms / 2U));
 
-        /* Read sensors and calculate average */
-        float measured_temp = 0.0f;
-        const char *sensor_ids_ptr[MAX_SENSORS_PER_LOOP];
-        for (int j = 0; j < loop_state[i].num_sensors; j++) {
-            sensor_ids_ptr[j] = loop_state[i].sensor_ids[j];
+            if (loop_state[i].next_deadline_ms - slack > now_ms) {
+                loop_state[i].skipped++;
+                continue;
+            }
         }
+        due[num_due++] = i;
+    }
 
-        int ret = sensor_manager_get_average(sensor_ids_ptr,
-                                              loop_state[i].num_sensors,
-                                              &measured_temp);
-        if (ret != 0) {
-            loop_state[i].status = LOOP_STATUS_SENSOR_ERROR;
-            LOG_WRN("Loop %s: Sensor read error", loop_state[i].id);
-            errors++;
-            continue;
+    /*
+     * Three phases: gather every due loop's inputs (leaders first, so a
+     * follower sees its leader's setpoint from this pass), step all PID
+     * channels in one bank call, then plan the heater commands. An
+     * autotuning loop sets its relay output in the first phase instead.
+     */
+    memset(pid_run, 0, sizeof(pid_run));
+    memset(tick_active, 0, sizeof(tick_active));
+    for (int n = 0; n < num_due; n++) {
+        int i = due[n];
+        float dt = dt_seconds;
+
+        if (loop_state[i].period_ms > 0) {
+            dt = schedule_advance(i, now_ms);
         }
 
-        /* Check alarm conditions */
-        if (measured_temp < loop_state[i].alarm_min_temp ||
-            measured_temp > loop_state[i].alarm_max_temp) {
-            loop_state[i].status = LOOP_STATUS_ALARM;
-            LOG_ERR("Loop %s: ALARM - Temperature %.2f K out of range (%.2f - %.2f)",
-                    loop_state[i].id, (double)measured_temp,
-                    (double)loop_state[i].alarm_min_temp, (double)loop_state[i].alarm_max_temp);
+        int ret = prepare_loop(i, dt);
+        if (ret != 0) {
             errors++;
-            /* Continue to allow controlled shutdown */
-        }
-
-        /* Determine setpoint (including loop following) */
-        float setpoint = loop_state[i].current_setpoint;
-
-        if (strlen(loop_state[i].follows_loop_id) > 0) {
-            /* Find followed loop */
-            for (int j = 0; j < num_loops; j++) {
-                if (strcmp(loop_state[j].id, loop_state[i].follows_loop_id) == 0) {
-                    setpoint = loop_state[j].current_setpoint * loop_state[i].follows_scalar;
-                    break;
-                }
-            }
         }
+    }
 
-        /* TODO: Apply setpoint ramping here */
-        loop_state[i].current_setpoint = setpoint;
+    COO_TRACE_BEGIN(pid_start);
+    coo_pid_bank_update(&loop_pids, num_loops, pid_setpoint, pid_measured, pid_dt,
+                        pid_run, pid_output);
+    COO_TRACE_END(COO_TRACE_PID, pid_start);
 
-        /* Run PID controller using coo_commons */
-        float output = coo_pid_update(&loop_state[i].pid,
-                                      setpoint,
-                                      measured_temp,
-                                      dt_seconds);
+    tick_num_cmds = 0;
+    for (int n = 0; n < num_due; n++) {
+        int i = due[n];
 
-        /* Distribute power to heaters */
-        const char *heater_ids_ptr[MAX_HEATERS_PER_LOOP];
-        for (int j = 0; j < loop_state[i].num_heaters; j++) {
-            heater_ids_ptr[j] = loop_state[i].heater_ids[j];
+        if (tick_active[i] && finish_loop(i, now_ms) != 0) {
+            errors++;
         }
+    }
 
-        ret = heater_manager_distribute_power(heater_ids_ptr,
-                                               loop_state[i].num_heaters,
-                                               output);
-        if (ret != 0) {
-            LOG_ERR("Loop %s: Failed to set heater power", loop_state[i].id);
+    /* One heater-manager lock and only the changed writes for the whole pass */
+    if (tick_num_cmds > 0) {
+        if (heater_manager_apply(tick_cmds, tick_num_cmds) != 0) {
+            COO_LOG_LIMITED(ERR, &apply_log, "Failed to apply %d heater commands",
+                            tick_num_cmds);
             errors++;
+        } else {
+            COO_LOG_LIMITED_CLEAR(INF, &apply_log, "Heater commands applying again");
         }
-
-        LOG_INF("Loop %s: SP=%.2f, PV=%.2f, OUT=%.2f W",
-                loop_state[i].id, (double)setpoint, (double)measured_temp, (double)output);
-
-        loop_state[i].status = LOOP_STATUS_OK;
     }
 
     k_mutex_unlock(&control_mutex);
 
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+    /* After the unlock, like the recorder: the snapshots take the managers' locks */
+    record_device_telemetry(now_ms);
+#endif
+
+#ifdef CONFIG_COO_FLIGHT_RECORDER
+    /* After the unlock: the recorder takes its own snapshot of the loops */
+    flight_recorder_record();
+#endif
+
     return (errors > 0) ? -errors : 0;
 }
 
-int control_loop_set_target(const char *loop_id, float target_kelvin)
+int control_loop_find_handle(const char *loop_id)
 {
     if (loop_id == NULL) {
         return -1;
     }
 
+    /* The config outlives the loops and its IDs never change, so no lock */
+    int index = (config_ptr != NULL) ? config_loop_index(config_ptr, loop_id) : -1;
+
+    return (index >= 0 && index < num_loops) ? index : -2;
+}
+
+int control_loop_set_target_by_handle(int handle, float target_kelvin)
+{
+    if (handle < 0 || handle >= num_loops) {
+        return -2;
+    }
+
     k_mutex_lock(&control_mutex, K_FOREVER);
 
-    int idx = -1;
-    for (int i = 0; i < num_loops; i++) {
-        if (strcmp(loop_state[i].id, loop_id) == 0) {
-            idx = i;
-            break;
-        }
+    /* TODO: Validate against valid_setpoint_range */
+
+    setpoint_ramp_set_target(&loop_state[handle].ramp, target_kelvin);
+    LOG_INF("Loop %s: Target set to %.2f K", id_of(handle), (double)target_kelvin);
+
+    k_mutex_unlock(&control_mutex);
+    state_changed();
+    return 0;
+}
+
+int control_loop_set_target(const char *loop_id, float target_kelvin)
+{
+    if (loop_id == NULL) {
+        return -1;
     }
 
-    if (idx < 0) {
-        k_mutex_unlock(&control_mutex);
+    int handle = control_loop_find_handle(loop_id);
+    if (handle < 0) {
         LOG_ERR("Loop %s not found", loop_id);
         return -2;
     }
 
-    /* TODO: Validate against valid_setpoint_range */
+    return control_loop_set_target_by_handle(handle, target_kelvin);
+}
 
-    loop_state[idx].target_temp_kelvin = target_kelvin;
-    LOG_INF("Loop %s: Target set to %.2f K", loop_id, (double)target_kelvin);
+int control_loop_get_target_by_handle(int handle, float *target_kelvin)
+{
+    if (handle < 0 || handle >= num_loops || target_kelvin == NULL) {
+        return -2;
+    }
 
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    *target_kelvin = loop_state[handle].ramp.target;
     k_mutex_unlock(&control_mutex);
+
     return 0;
 }
 
@@ -247,62 +818,244 @@ int control_loop_get_target(const char *loop_id, float *target_kelvin)
         return -1;
     }
 
+    return control_loop_get_target_by_handle(control_loop_find_handle(loop_id),
+                                             target_kelvin);
+}
+
+int control_loop_set_ramp_rate_by_handle(int handle, float rate_k_per_min)
+{
+    if (handle < 0 || handle >= num_loops) {
+        return -2;
+    }
+    if (rate_k_per_min < 0.0f) {
+        return -3;
+    }
+
     k_mutex_lock(&control_mutex, K_FOREVER);
+    setpoint_ramp_set_rate(&loop_state[handle].ramp, rate_k_per_min);
+    LOG_INF("Loop %s: Ramp rate set to %.2f K/min", id_of(handle),
+            (double)rate_k_per_min);
+    k_mutex_unlock(&control_mutex);
+    state_changed();
 
-    int idx = -1;
-    for (int i = 0; i < num_loops; i++) {
-        if (strcmp(loop_state[i].id, loop_id) == 0) {
-            idx = i;
-            break;
-        }
+    return 0;
+}
+
+int control_loop_set_ramp_rate(const char *loop_id, float rate_k_per_min)
+{
+    if (loop_id == NULL) {
+        return -1;
     }
 
-    if (idx < 0) {
-        k_mutex_unlock(&control_mutex);
+    return control_loop_set_ramp_rate_by_handle(control_loop_find_handle(loop_id),
+                                                rate_k_per_min);
+}
+
+int control_loop_start_profile_by_handle(int handle, const ramp_segment_t segments[],
+                                         int num_segments)
+{
+    if (handle < 0 || handle >= num_loops) {
         return -2;
     }
 
-    *target_kelvin = loop_state[idx].target_temp_kelvin;
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    int ret = setpoint_ramp_start_profile(&loop_state[handle].ramp, segments, num_segments);
+    k_mutex_unlock(&control_mutex);
+
+    if (ret != 0) {
+        return -3;
+    }
+
+    LOG_INF("Loop %s: Started %d-segment profile", id_of(handle), num_segments);
+    return 0;
+}
+
+int control_loop_start_profile(const char *loop_id, const ramp_segment_t segments[],
+                               int num_segments)
+{
+    if (loop_id == NULL) {
+        return -1;
+    }
 
+    return control_loop_start_profile_by_handle(control_loop_find_handle(loop_id),
+                                                segments, num_segments);
+}
+
+int control_loop_stop_profile(const char *loop_id)
+{
+    if (loop_id == NULL) {
+        return -1;
+    }
+
+    int handle = control_loop_find_handle(loop_id);
+    if (handle < 0) {
+        return -2;
+    }
+
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    setpoint_ramp_stop_profile(&loop_state[handle].ramp);
     k_mutex_unlock(&control_mutex);
+
+    LOG_INF("Loop %s: Profile stopped", id_of(handle));
     return 0;
 }
 
-int control_loop_enable(const char *loop_id, bool enable)
+int control_loop_autotune_start_by_handle(int handle, const autotune_params_t *params,
+                                          bool apply)
+{
+    if (params == NULL) {
+        return -1;
+    }
+    if (handle < 0 || handle >= num_loops) {
+        return -2;
+    }
+
+    k_mutex_lock(&control_mutex, K_FOREVER);
+
+    autotune_params_t p = *params;
+
+    /* Keep the relay inside the loop's power limits */
+    if (p.output_high > loop_state[handle].power_limit_max) {
+        p.output_high = loop_state[handle].power_limit_max;
+    }
+    if (p.output_low < loop_state[handle].power_limit_min) {
+        p.output_low = loop_state[handle].power_limit_min;
+    }
+
+    int ret = autotune_start(&loop_state[handle].tune, &p);
+    if (ret == 0) {
+        loop_state[handle].tune_apply = apply;
+        /* Hold the working setpoint where the experiment runs */
+        setpoint_ramp_init(&loop_state[handle].ramp, p.setpoint,
+                           loop_state[handle].ramp.rate_k_per_min);
+        LOG_INF("Loop %s: Autotune started at %.2f K, relay %.1f/%.1f W",
+                id_of(handle), (double)p.setpoint,
+                (double)p.output_low, (double)p.output_high);
+    }
+
+    k_mutex_unlock(&control_mutex);
+    return (ret == 0) ? 0 : -3;
+}
+
+int control_loop_autotune_start(const char *loop_id, const autotune_params_t *params,
+                                bool apply)
 {
     if (loop_id == NULL) {
         return -1;
     }
 
+    return control_loop_autotune_start_by_handle(control_loop_find_handle(loop_id),
+                                                 params, apply);
+}
+
+int control_loop_autotune_abort(const char *loop_id)
+{
+    if (loop_id == NULL) {
+        return -1;
+    }
+
+    int handle = control_loop_find_handle(loop_id);
+    if (handle < 0) {
+        return -2;
+    }
+
     k_mutex_lock(&control_mutex, K_FOREVER);
+    if (autotune_running(&loop_state[handle].tune)) {
+        autotune_abort(&loop_state[handle].tune);
+        coo_pid_bank_reset(&loop_pids, handle);
+        LOG_INF("Loop %s: Autotune aborted", id_of(handle));
+    }
+    k_mutex_unlock(&control_mutex);
 
-    int idx = -1;
-    for (int i = 0; i < num_loops; i++) {
-        if (strcmp(loop_state[i].id, loop_id) == 0) {
-            idx = i;
-            break;
-        }
+    return 0;
+}
+
+int control_loop_get_autotune_progress_by_handle(int handle, autotune_progress_t *progress)
+{
+    if (progress == NULL) {
+        return -1;
+    }
+    if (handle < 0 || handle >= num_loops) {
+        return -2;
     }
 
-    if (idx < 0) {
-        k_mutex_unlock(&control_mutex);
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    autotune_get_progress(&loop_state[handle].tune, progress);
+    k_mutex_unlock(&control_mutex);
+
+    return 0;
+}
+
+int control_loop_get_autotune_progress(const char *loop_id, autotune_progress_t *progress)
+{
+    if (loop_id == NULL) {
+        return -1;
+    }
+
+    return control_loop_get_autotune_progress_by_handle(control_loop_find_handle(loop_id),
+                                                        progress);
+}
+
+int control_loop_get_ramp_progress_by_handle(int handle, ramp_progress_t *progress)
+{
+    if (handle < 0 || handle >= num_loops || progress == NULL) {
         return -2;
     }
 
-    loop_state[idx].enabled = enable;
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    setpoint_ramp_get_progress(&loop_state[handle].ramp, progress);
+    k_mutex_unlock(&control_mutex);
+
+    return 0;
+}
+
+int control_loop_get_ramp_progress(const char *loop_id, ramp_progress_t *progress)
+{
+    if (loop_id == NULL || progress == NULL) {
+        return -1;
+    }
+
+    return control_loop_get_ramp_progress_by_handle(control_loop_find_handle(loop_id),
+                                                    progress);
+}
+
+int control_loop_enable_by_handle(int handle, bool enable)
+{
+    if (handle < 0 || handle >= num_loops) {
+        return -2;
+    }
+
+    k_mutex_lock(&control_mutex, K_FOREVER);
+
+    loop_state[handle].enabled = enable;
 
     if (enable) {
         /* Reset PID integral on re-enable */
-        coo_pid_reset(&loop_state[idx].pid);
-        LOG_INF("Loop %s enabled", loop_id);
+        coo_pid_bank_reset(&loop_pids, handle);
+        if (loop_state[handle].algo->reset != NULL) {
+            loop_state[handle].algo->reset(&loop_state[handle].algo_state);
+        }
+        /* Restart the schedule so time spent disabled is not an overrun */
+        loop_state[handle].scheduled = false;
+        LOG_INF("Loop %s enabled", id_of(handle));
     } else {
-        LOG_INF("Loop %s disabled", loop_id);
+        LOG_INF("Loop %s disabled", id_of(handle));
     }
 
     k_mutex_unlock(&control_mutex);
+    state_changed();
     return 0;
 }
 
+int control_loop_enable(const char *loop_id, bool enable)
+{
+    if (loop_id == NULL) {
+        return -1;
+    }
+
+    return control_loop_enable_by_handle(control_loop_find_handle(loop_id), enable);
+}
+
 int control_loop_suspend_all(void)
 {
     LOG_WRN("Suspending all control loops");
@@ -326,31 +1079,52 @@ int control_loop_resume_all(void)
     for (int i = 0; i < num_loops; i++) {
         loop_state[i].suspended = false;
         /* Reset PID to avoid integral windup */
-        coo_pid_reset(&loop_state[i].pid);
+        coo_pid_bank_reset(&loop_pids, i);
+        if (loop_state[i].algo->reset != NULL) {
+            loop_state[i].algo->reset(&loop_state[i].algo_state);
+        }
+        loop_state[i].scheduled = false;
     }
 
     k_mutex_unlock(&control_mutex);
     return 0;
 }
 
-loop_status_t control_loop_get_status(const char *loop_id)
+loop_status_t control_loop_get_status_by_handle(int handle)
 {
-    if (loop_id == NULL) {
+    if (handle < 0 || handle >= num_loops) {
         return LOOP_STATUS_NOT_INITIALIZED;
     }
 
     k_mutex_lock(&control_mutex, K_FOREVER);
+    loop_status_t status = loop_state[handle].status;
+    k_mutex_unlock(&control_mutex);
 
-    loop_status_t status = LOOP_STATUS_NOT_INITIALIZED;
-    for (int i = 0; i < num_loops; i++) {
-        if (strcmp(loop_state[i].id, loop_id) == 0) {
-            status = loop_state[i].status;
-            break;
-        }
+    return status;
+}
+
+loop_status_t control_loop_get_status(const char *loop_id)
+{
+    return control_loop_get_status_by_handle(control_loop_find_handle(loop_id));
+}
+
+int control_loop_set_gains_by_handle(int handle, float kp, float ki, float kd)
+{
+    if (handle < 0 || handle >= num_loops) {
+        return -2;
     }
 
+    k_mutex_lock(&control_mutex, K_FOREVER);
+
+    /* Update PID gains using coo_commons function */
+    coo_pid_bank_set_gains(&loop_pids, handle, kp, ki, kd);
+
+    LOG_INF("Loop %s: Gains updated to P=%.2f, I=%.2f, D=%.2f",
+            id_of(handle), (double)kp, (double)ki, (double)kd);
+
     k_mutex_unlock(&control_mutex);
-    return status;
+    state_changed();
+    return 0;
 }
 
 int control_loop_set_gains(const char *loop_id, float kp, float ki, float kd)
@@ -359,70 +1133,196 @@ int control_loop_set_gains(const char *loop_id, float kp, float ki, float kd)
         return -1;
     }
 
-    k_mutex_lock(&control_mutex, K_FOREVER);
+    return control_loop_set_gains_by_handle(control_loop_find_handle(loop_id), kp, ki, kd);
+}
 
-    int idx = -1;
-    for (int i = 0; i < num_loops; i++) {
-        if (strcmp(loop_state[i].id, loop_id) == 0) {
-            idx = i;
-            break;
-        }
+int control_loop_get_gains_by_handle(int handle, float *kp, float *ki, float *kd)
+{
+    if (kp == NULL || ki == NULL || kd == NULL) {
+        return -1;
     }
-
-    if (idx < 0) {
-        k_mutex_unlock(&control_mutex);
+    if (handle < 0 || handle >= num_loops) {
         return -2;
     }
 
-    /* Update PID gains using coo_commons function */
-    coo_pid_set_gains(&loop_state[idx].pid, kp, ki, kd);
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    *kp = loop_pids.kp[handle];
+    *ki = loop_pids.ki[handle];
+    *kd = loop_pids.kd[handle];
+    k_mutex_unlock(&control_mutex);
+
+    return 0;
+}
+
+int control_loop_get_gains(const char *loop_id, float *kp, float *ki, float *kd)
+{
+    if (loop_id == NULL) {
+        return -1;
+    }
 
-    LOG_INF("Loop %s: Gains updated to P=%.2f, I=%.2f, D=%.2f", loop_id, (double)kp, (double)ki, (double)kd);
+    return control_loop_get_gains_by_handle(control_loop_find_handle(loop_id), kp, ki, kd);
+}
+
+int control_loop_get_enabled(const char *loop_id, bool *enabled)
+{
+    if (loop_id == NULL || enabled == NULL) {
+        return -1;
+    }
 
+    int handle = control_loop_find_handle(loop_id);
+    if (handle < 0) {
+        return -2;
+    }
+
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    *enabled = loop_state[handle].enabled;
     k_mutex_unlock(&control_mutex);
+
     return 0;
 }
 
-int control_loop_get_gains(const char *loop_id, float *kp, float *ki, float *kd)
+int control_loop_get_overruns(const char *loop_id, uint32_t *overruns)
 {
-    if (loop_id == NULL || kp == NULL || ki == NULL || kd == NULL) {
+    if (loop_id == NULL || overruns == NULL) {
         return -1;
     }
 
+    int handle = control_loop_find_handle(loop_id);
+    if (handle < 0) {
+        return -2;
+    }
+
     k_mutex_lock(&control_mutex, K_FOREVER);
+    *overruns = loop_state[handle].overruns;
+    k_mutex_unlock(&control_mutex);
+
+    return 0;
+}
 
+uint32_t control_loop_get_min_period_ms(void)
+{
+    uint32_t min_period = 0;
+
+    /* Periods are set once at init, so no lock is needed here */
     for (int i = 0; i < num_loops; i++) {
-        if (strcmp(loop_state[i].id, loop_id) == 0) {
-            *kp = loop_state[i].pid.kp;
-            *ki = loop_state[i].pid.ki;
-            *kd = loop_state[i].pid.kd;
-            k_mutex_unlock(&control_mutex);
-            return 0;
+        uint32_t period = loop_state[i].period_ms;
+
+        if (period > 0 && (min_period == 0 || period < min_period)) {
+            min_period = period;
         }
     }
+    return min_period;
+}
+
+/* Caller holds control_mutex */
+static void read_loop(int i, loop_reading_t *r)
+{
+    r->status = loop_state[i].status;
+    r->enabled = loop_state[i].enabled;
+    setpoint_ramp_get_progress(&loop_state[i].ramp, &r->ramp);
+    r->measured = loop_state[i].last_measured;
+    r->output = loop_state[i].last_output;
+    r->kp = loop_pids.kp[i];
+    r->ki = loop_pids.ki[i];
+    r->kd = loop_pids.kd[i];
+    r->overruns = loop_state[i].overruns;
+    r->skipped = loop_state[i].skipped;
+    r->autotune = autotune_running(&loop_state[i].tune);
+}
 
+int control_loop_get_reading_by_handle(int handle, loop_reading_t *reading)
+{
+    if (handle < 0 || handle >= num_loops || reading == NULL) {
+        return -2;
+    }
+
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    read_loop(handle, reading);
     k_mutex_unlock(&control_mutex);
-    return -2;
+
+    return 0;
 }
 
-int control_loop_get_enabled(const char *loop_id, bool *enabled)
+int control_loop_get_snapshot(loop_snapshot_t *snapshot)
 {
-    if (loop_id == NULL || enabled == NULL) {
+    if (snapshot == NULL) {
         return -1;
     }
 
     k_mutex_lock(&control_mutex, K_FOREVER);
-
+    snapshot->count = num_loops;
     for (int i = 0; i < num_loops; i++) {
-        if (strcmp(loop_state[i].id, loop_id) == 0) {
-            *enabled = loop_state[i].enabled;
-            k_mutex_unlock(&control_mutex);
-            return 0;
-        }
+        read_loop(i, &snapshot->loops[i]);
     }
+    k_mutex_unlock(&control_mutex);
 
+    return 0;
+}
+
+int control_loop_save_state(loop_saved_state_t states[], int max_states)
+{
+    if (states == NULL || max_states < 0) {
+        return -1;
+    }
+
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    int count = MIN(num_loops, max_states);
+
+    for (int i = 0; i < count; i++) {
+        loop_saved_state_t *s = &states[i];
+
+        memset(s, 0, sizeof(*s));
+        strncpy(s->id, id_of(i), MAX_ID_LENGTH - 1);
+        s->target = loop_state[i].ramp.target;
+        s->ramp_rate = loop_state[i].ramp.rate_k_per_min;
+        s->kp = loop_pids.kp[i];
+        s->ki = loop_pids.ki[i];
+        s->kd = loop_pids.kd[i];
+        s->enabled = loop_state[i].enabled;
+    }
+    k_mutex_unlock(&control_mutex);
+
+    return count;
+}
+
+int control_loop_restore_state(const loop_saved_state_t states[], int num_states)
+{
+    if (states == NULL || num_states < 0 || config_ptr == NULL) {
+        return -1;
+    }
+
+    int restored = 0;
+
+    k_mutex_lock(&control_mutex, K_FOREVER);
+    for (int n = 0; n < num_states; n++) {
+        const loop_saved_state_t *s = &states[n];
+        int i = control_loop_find_handle(s->id);
+
+        if (i < 0) {
+            LOG_WRN("Saved state for unknown loop %s ignored", s->id);
+            continue;
+        }
+        if (!isfinite(s->target) || !isfinite(s->ramp_rate) || s->ramp_rate < 0.0f ||
+            !isfinite(s->kp) || !isfinite(s->ki) || !isfinite(s->kd)) {
+            LOG_WRN("Loop %s: invalid saved state ignored", id_of(i));
+            continue;
+        }
+
+        setpoint_ramp_init(&loop_state[i].ramp, s->target, s->ramp_rate);
+        loop_state[i].prev_setpoint = s->target;
+        coo_pid_bank_set_gains(&loop_pids, i, s->kp, s->ki, s->kd);
+        coo_pid_bank_reset(&loop_pids, i);
+        loop_state[i].enabled = s->enabled && config_ptr->control_loops[i].enabled;
+        loop_state[i].scheduled = false;
+
+        LOG_INF("Loop %s: restored target %.2f K, P=%.2f, I=%.2f, D=%.2f, %s",
+                id_of(i), (double)s->target, (double)s->kp, (double)s->ki,
+                (double)s->kd, loop_state[i].enabled ? "enabled" : "disabled");
+        restored++;
+    }
     k_mutex_unlock(&control_mutex);
-    return -2;
+
+    return restored;
 }
 
 int control_loop_get_count(void)
@@ -430,11 +1330,11 @@ int control_loop_get_count(void)
     return num_loops;
 }
 
-/* IDs are set once at init and never mutated, so no lock is needed here */
+/* IDs live in the config and never change, so no lock is needed here */
 const char *control_loop_get_id_at(int index)
 {
     if (index < 0 || index >= num_loops) {
         return NULL;
     }
-    return loop_state[index].id;
+    return id_of(index);
 }
@@ -7,7 +7,14 @@
 #define CONTROL_LOOP_H
 
 #include "../config/config.h"
+#include "setpoint_ramp.h"
+#include "autotune.h"
 #include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+#include <coo_commons/telemetry.h>
+#endif
 
 /**
  * Control loop status
@@ -20,23 +27,156 @@ typedef enum {
     LOOP_STATUS_NOT_INITIALIZED = -4
 } loop_status_t;
 
+/**
+ * One loop's state in a control_loop_get_snapshot()
+ */
+typedef struct {
+    loop_status_t status;
+    bool enabled;
+    bool autotune;           /* A relay autotune is driving the output */
+    ramp_progress_t ramp;
+    float measured;          /* Fused process value of the last pass, NAN if none */
+    float output;            /* Power planned on the last pass, after clamping */
+    float kp, ki, kd;
+    uint32_t overruns;       /* Whole update periods missed */
+    uint32_t skipped;        /* Passes sat out waiting for the next deadline */
+} loop_reading_t;
+
+/**
+ * Every loop read under one hold of the control lock
+ * Indexed by loop handle.
+ */
+typedef struct {
+    int count;
+    loop_reading_t loops[MAX_CONTROL_LOOPS];
+} loop_snapshot_t;
+
+/**
+ * One loop's runtime-settable state, as saved across a reboot
+ * Entries are matched back to loops by ID, not by handle.
+ */
+typedef struct {
+    char id[MAX_ID_LENGTH];
+    float target;            /* Commanded target (Kelvin) */
+    float ramp_rate;         /* K/min, 0 = step change */
+    float kp, ki, kd;
+    bool enabled;
+} loop_saved_state_t;
+
 /**
  * Initialize control loop subsystem
- * Creates PID controllers for each configured loop
+ * Creates PID controllers for each configured loop. IDs and sensor
+ * weights are read from the configuration rather than copied, so it
+ * must stay valid while the loops are in use.
  * @param config Pointer to thermal configuration
  * @return 0 on success, negative error code on failure
  */
 int control_loop_init(const thermal_config_t *config);
 
 /**
- * Update all control loops
+ * Update all due control loops
  * Called periodically by control thread
- * Reads sensors, runs PID, outputs to heaters
- * @param dt_seconds Time delta since last update (seconds)
+ * Loops with an update_period_ms run only once their deadline has passed,
+ * or is less than half a pass (dt_seconds / 2) away, earliest deadline
+ * first, integrating over their own measured dt. Loops
+ * with update_period_ms == 0 run on every call with dt_seconds.
+ * Reads sensors, runs PID, outputs to heaters, then records the pass in
+ * the flight recorder if it is enabled
+ * @param dt_seconds Time delta since last call (seconds)
  * @return 0 on success, negative error code on failure
  */
 int control_loop_update_all(float dt_seconds);
 
+/**
+ * Resolve a loop ID to a handle for the handle-based accessors
+ * Handles are indices into the configured loop table and stay valid for
+ * the lifetime of the configuration passed to init. The string APIs below
+ * resolve on every call and are meant for commands, not periodic callers.
+ * @param loop_id Loop ID string
+ * @return handle >= 0 on success, negative error code if not found
+ */
+int control_loop_find_handle(const char *loop_id);
+
+/**
+ * Set target temperature for a loop handle
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param target_kelvin Target temperature in Kelvin
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_set_target_by_handle(int handle, float target_kelvin);
+
+/**
+ * Get target temperature for a loop handle
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param target_kelvin Pointer to store target temperature
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_get_target_by_handle(int handle, float *target_kelvin);
+
+/**
+ * Set the setpoint ramp rate for a loop handle
+ * New targets are approached at this rate; 0 makes them step changes.
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param rate_k_per_min Rate limit in K/min, >= 0
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_set_ramp_rate_by_handle(int handle, float rate_k_per_min);
+
+/**
+ * Start a ramp-soak profile on a loop handle
+ * Replaces any running profile or pending target; the first segment
+ * starts from the current working setpoint.
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param segments Segment list (copied)
+ * @param num_segments Number of segments, 1..RAMP_MAX_SEGMENTS
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_start_profile_by_handle(int handle, const ramp_segment_t segments[],
+                                         int num_segments);
+
+/**
+ * Get ramp/profile progress for a loop handle
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param progress Pointer to store progress
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_get_ramp_progress_by_handle(int handle, ramp_progress_t *progress);
+
+/**
+ * Enable/disable a loop handle
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param enable true to enable, false to disable
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_enable_by_handle(int handle, bool enable);
+
+/**
+ * Get loop status for a loop handle
+ * @param handle Loop handle from control_loop_find_handle()
+ * @return loop_status_t status code
+ */
+loop_status_t control_loop_get_status_by_handle(int handle);
+
+/**
+ * Update PID gains for a loop handle
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param kp Proportional gain
+ * @param ki Integral gain
+ * @param kd Derivative gain
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_set_gains_by_handle(int handle, float kp, float ki, float kd);
+
+/**
+ * Get current PID gains for a loop handle
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param kp Pointer to store proportional gain
+ * @param ki Pointer to store integral gain
+ * @param kd Pointer to store derivative gain
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_get_gains_by_handle(int handle, float *kp, float *ki, float *kd);
+
 /**
  * Set target temperature for a loop
  * @param loop_id Loop ID string
@@ -53,6 +193,86 @@ int control_loop_set_target(const char *loop_id, float target_kelvin);
  */
 int control_loop_get_target(const char *loop_id, float *target_kelvin);
 
+/**
+ * Set the setpoint ramp rate for a loop
+ * @param loop_id Loop ID string
+ * @param rate_k_per_min Rate limit in K/min, >= 0 (0 = step change)
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_set_ramp_rate(const char *loop_id, float rate_k_per_min);
+
+/**
+ * Start a ramp-soak profile on a loop
+ * @param loop_id Loop ID string
+ * @param segments Segment list (copied)
+ * @param num_segments Number of segments, 1..RAMP_MAX_SEGMENTS
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_start_profile(const char *loop_id, const ramp_segment_t segments[],
+                               int num_segments);
+
+/**
+ * Stop a running profile; the setpoint holds where it is
+ * @param loop_id Loop ID string
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_stop_profile(const char *loop_id);
+
+/**
+ * Get ramp/profile progress for a loop
+ * @param loop_id Loop ID string
+ * @param progress Pointer to store progress
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_get_ramp_progress(const char *loop_id, ramp_progress_t *progress);
+
+/**
+ * Start a relay autotune on a loop
+ * The loop's PID is bypassed until the tune ends; other loops keep
+ * running. The relay levels are clamped to the loop's power limits and
+ * the working setpoint is held at params->setpoint. A loop alarm aborts
+ * the tune.
+ * @param loop_id Loop ID string
+ * @param params Experiment parameters
+ * @param apply true to install the identified gains when the tune finishes
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_autotune_start(const char *loop_id, const autotune_params_t *params,
+                                bool apply);
+
+/**
+ * Start a relay autotune by loop handle
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param params Experiment parameters
+ * @param apply true to install the identified gains when the tune finishes
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_autotune_start_by_handle(int handle, const autotune_params_t *params,
+                                          bool apply);
+
+/**
+ * Abort a running autotune; PID resumes with the existing gains
+ * @param loop_id Loop ID string
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_autotune_abort(const char *loop_id);
+
+/**
+ * Get autotune progress or result for a loop
+ * @param loop_id Loop ID string
+ * @param progress Pointer to store progress
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_get_autotune_progress(const char *loop_id, autotune_progress_t *progress);
+
+/**
+ * Get autotune progress or result by loop handle
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param progress Pointer to store progress
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_get_autotune_progress_by_handle(int handle, autotune_progress_t *progress);
+
 /**
  * Enable/disable a control loop
  * @param loop_id Loop ID string
@@ -108,6 +328,60 @@ int control_loop_set_gains(const char *loop_id, float kp, float ki, float kd);
  */
 int control_loop_get_gains(const char *loop_id, float *kp, float *ki, float *kd);
 
+/**
+ * Get the number of whole update periods a loop has missed
+ * @param loop_id Loop ID string
+ * @param overruns Pointer to store the overrun count
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_get_overruns(const char *loop_id, uint32_t *overruns);
+
+/**
+ * Get the shortest update_period_ms across configured loops
+ * The control pass must be called at least this often for every loop to
+ * meet its rate.
+ * @return period in ms, or 0 if no loop sets one
+ */
+uint32_t control_loop_get_min_period_ms(void);
+
+/**
+ * Copy one loop's state
+ * @param handle Loop handle from control_loop_find_handle()
+ * @param reading Pointer to store the state
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_get_reading_by_handle(int handle, loop_reading_t *reading);
+
+/**
+ * Copy every loop's state in one consistent read
+ * Takes the control lock once, so no pass lands between two loops.
+ * @param snapshot Pointer to store the snapshot
+ * @return 0 on success, negative error code on failure
+ */
+int control_loop_get_snapshot(loop_snapshot_t *snapshot);
+
+/**
+ * Copy every loop's runtime-settable state in one consistent read
+ * A running profile is saved as its current segment target. Unused
+ * bytes are zeroed, so two saves of the same state compare equal.
+ * @param states Array to fill, indexed by loop handle
+ * @param max_states Capacity of states
+ * @return number of entries written, negative error code on failure
+ */
+int control_loop_save_state(loop_saved_state_t states[], int max_states);
+
+/**
+ * Apply saved state to the loops with matching IDs
+ * Meant for boot, right after control_loop_init(): each matched loop's
+ * setpoint starts settled at the saved target. Entries for unknown IDs or
+ * with non-finite values are skipped. A loop disabled in the configuration
+ * stays disabled.
+ * @param states Saved entries
+ * @param num_states Number of entries
+ * @return number of loops restored, negative error code on failure
+ */
+int control_loop_restore_state(const loop_saved_state_t states[], int num_states);
+
 /**
  * Get the number of configured control loops
  * @return loop count
@@ -121,4 +395,22 @@ int control_loop_get_count(void);
  */
 const char *control_loop_get_id_at(int index);
 
+#ifdef CONFIG_COO_CONTROL_TELEMETRY
+/* Sample kinds in the control telemetry ring */
+#define CONTROL_TELEMETRY_KIND_LOOP   0U  /* channel = loop handle */
+#define CONTROL_TELEMETRY_KIND_SENSOR 1U  /* channel = sensor handle */
+#define CONTROL_TELEMETRY_KIND_HEATER 2U  /* channel = heater handle */
+
+/**
+ * Get the ring every control pass records into
+ * Per pass: one loop sample per loop that ran, then one sensor sample per
+ * sensor (measured = temperature in K, NaN if invalid; status = sensor
+ * status) and one heater sample per heater (output = power in %; status =
+ * heater status), read after the pass applied its heater commands. Drain
+ * it with coo_telemetry_encode() or coo_telemetry_publish().
+ * @return the control telemetry ring
+ */
+struct coo_telemetry *control_loop_get_telemetry(void);
+#endif
+
 #endif /* CONTROL_LOOP_H */
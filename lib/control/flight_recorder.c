@@ -0,0 +1,612 @@
+/**
+ * @file flight_recorder.c
+ * @brief Delta-encoded flight recorder over a ring of flash pages
+ */
+
+#include "flight_recorder.h"
+#include "flight_recorder_codec.h"
+#include "control_loop.h"
+#include "../sensors/sensor_manager.h"
+#include "../heaters/heater_manager.h"
+#include <coo_commons/log_limit.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(flight_recorder, LOG_LEVEL_INF);
+
+#define RECORDER_MAGIC   0x31435246u /* "FRC1" */
+#define RECORDER_VERSION 1
+
+#define REC_PAGE_SIZE    CONFIG_COO_FLIGHT_RECORDER_PAGE_SIZE
+#define REC_PAGE_BUFFERS CONFIG_COO_FLIGHT_RECORDER_PAGE_BUFFERS
+
+/*
+ * Page header, little-endian:
+ *    0  u32 magic
+ *    4  u32 seq          One per ring slot written, never reused
+ *    8  u32 t0_ms        Uptime of the first tick, low 32 bits
+ *   12  u16 boot         Boot number, +1 per flight_recorder_init()
+ *   14  u16 ticks
+ *   16  u16 bits         Payload length in bits
+ *   18  u8  version
+ *   19  u8  sensors      Tick layout
+ *   20  u8  loops
+ *   21  u8  heaters
+ *   22  u16 temp_res_mk  Temperature quantum
+ *   24  u32 crc          CRC-32 (IEEE) of bytes 0..23 and the payload bytes
+ */
+#define HDR_SEQ      4
+#define HDR_T0       8
+#define HDR_BOOT     12
+#define HDR_TICKS    14
+#define HDR_BITS     16
+#define HDR_VERSION  18
+#define HDR_LAYOUT   19
+#define HDR_RES      22
+#define HDR_CRC      24
+#define HDR_SIZE     28
+
+#define PAYLOAD_BITS ((REC_PAGE_SIZE - HDR_SIZE) * 8)
+
+/*
+ * Channels per tick, in order: the interval since the previous tick in
+ * the page, then per sensor (temperature, status), per loop (setpoint,
+ * measured, output, status) and per heater (power, status).
+ */
+#define CHANNELS_MAX (1 + 2 * MAX_MANAGED_SENSORS + 4 * MAX_CONTROL_LOOPS + \
+                      2 * MAX_MANAGED_HEATERS)
+
+BUILD_ASSERT(CHANNELS_MAX * RECORDER_CODE_BITS_MAX <= PAYLOAD_BITS,
+             "a page must hold one tick of absolute values; raise the page size");
+BUILD_ASSERT(PAYLOAD_BITS <= UINT16_MAX, "page payload length is stored in 16 bits");
+
+static const struct flash_area *rec_fa;
+static uint32_t sector_size;
+static uint32_t capacity;
+static uint16_t boot;
+static uint8_t num_sensors, num_loops, num_heaters;
+static int num_channels;
+static atomic_t ready = ATOMIC_INIT(0);
+
+static uint8_t page_buf[REC_PAGE_BUFFERS][REC_PAGE_SIZE] __aligned(4);
+
+/* Page buffer indices: free for the encoder, or full and waiting for flash */
+K_MSGQ_DEFINE(free_pages, sizeof(uint8_t), REC_PAGE_BUFFERS, 1);
+K_MSGQ_DEFINE(full_pages, sizeof(uint8_t), REC_PAGE_BUFFERS, 1);
+
+K_THREAD_STACK_DEFINE(recorder_stack, CONFIG_COO_FLIGHT_RECORDER_STACK_SIZE);
+static struct k_work_q recorder_wq;
+static struct k_work write_work;
+
+/*
+ * Encoder state, guarded by encoder_mutex. Never held across flash I/O,
+ * so the control thread waits at most for a flush closing a page.
+ */
+K_MUTEX_DEFINE(encoder_mutex);
+static struct {
+    int buf;                 /* Page buffer being filled, -1 if none */
+    uint32_t bits;           /* Payload bits used */
+    uint16_t ticks;
+    uint32_t last_ms;        /* Uptime of the last tick in the page */
+    int32_t prev[CHANNELS_MAX];
+} enc = { .buf = -1 };
+
+static int32_t tick_values[CHANNELS_MAX];
+static uint32_t tick_codes[CHANNELS_MAX];
+static struct coo_log_limit drop_log;
+
+/* Snapshots for the tick being built; only the control thread records */
+static sensor_snapshot_t rec_sensors;
+static loop_snapshot_t rec_loops;
+static heater_snapshot_t rec_heaters;
+static uint32_t decimation_count;
+
+/*
+ * Ring position and counters, guarded by ring_lock. Slots advance with
+ * seq, so the stored pages are the `stored` slots before next_slot.
+ */
+static struct k_spinlock ring_lock;
+static uint32_t next_slot;
+static uint32_t next_seq;
+static flight_recorder_stats_t stats;
+static struct coo_log_limit write_log;
+
+/* Fill tick_values[1..] from the snapshots. Caller holds encoder_mutex. */
+static void build_tick(void)
+{
+    const float temp_scale = 1000.0f / CONFIG_COO_FLIGHT_RECORDER_TEMP_RES_MK;
+    int c = 1;
+
+    for (int i = 0; i < num_sensors; i++) {
+        const sensor_reading_t *r = &rec_sensors.readings[i];
+        bool have = i < rec_sensors.count;
+        int32_t status = have ? r->status : SENSOR_STATUS_NOT_READY;
+
+        /* A stale reading records as not ready */
+        if (have && !rec_sensors.valid[i] && status == SENSOR_STATUS_OK) {
+            status = SENSOR_STATUS_NOT_READY;
+        }
+        tick_values[c] = have ? recorder_quantize(r->temperature_kelvin, temp_scale, enc.prev[c])
+                              : enc.prev[c];
+        tick_values[c + 1] = status;
+        c += 2;
+    }
+
+    for (int i = 0; i < num_loops; i++) {
+        const loop_reading_t *r = &rec_loops.loops[i];
+        bool have = i < rec_loops.count;
+
+        tick_values[c] = have ? recorder_quantize(r->ramp.setpoint, temp_scale, enc.prev[c])
+                              : enc.prev[c];
+        tick_values[c + 1] = have ? recorder_quantize(r->measured, temp_scale, enc.prev[c + 1])
+                                  : enc.prev[c + 1];
+        tick_values[c + 2] = have ? recorder_quantize(r->output, 100.0f, enc.prev[c + 2])
+                                  : enc.prev[c + 2];
+        tick_values[c + 3] = have ? r->status : LOOP_STATUS_NOT_INITIALIZED;
+        c += 4;
+    }
+
+    for (int i = 0; i < num_heaters; i++) {
+        const heater_reading_t *r = &rec_heaters.heaters[i];
+        bool have = i < rec_heaters.count;
+
+        tick_values[c] = have ? recorder_quantize(r->power_percent, 100.0f, enc.prev[c])
+                              : enc.prev[c];
+        tick_values[c + 1] = have ? r->status : HEATER_STATUS_NOT_READY;
+        c += 2;
+    }
+}
+
+/* Zig-zag every channel against the page's previous tick; returns the bits needed */
+static uint32_t code_tick(void)
+{
+    uint32_t bits = 0;
+
+    for (int c = 0; c < num_channels; c++) {
+        tick_codes[c] = recorder_zigzag(tick_values[c], enc.prev[c]);
+        bits += recorder_code_len(tick_codes[c]);
+    }
+    return bits;
+}
+
+/* Take a free page buffer for a tick at now_ms. Caller holds encoder_mutex. */
+static bool open_page(uint32_t now_ms)
+{
+    uint8_t idx;
+
+    if (k_msgq_get(&free_pages, &idx, K_NO_WAIT) != 0) {
+        return false;
+    }
+
+    uint8_t *page = page_buf[idx];
+
+    memset(page, 0, REC_PAGE_SIZE);
+    sys_put_le32(RECORDER_MAGIC, &page[0]);
+    sys_put_le32(now_ms, &page[HDR_T0]);
+    sys_put_le16(boot, &page[HDR_BOOT]);
+    page[HDR_VERSION] = RECORDER_VERSION;
+    page[HDR_LAYOUT] = num_sensors;
+    page[HDR_LAYOUT + 1] = num_loops;
+    page[HDR_LAYOUT + 2] = num_heaters;
+    sys_put_le16(CONFIG_COO_FLIGHT_RECORDER_TEMP_RES_MK, &page[HDR_RES]);
+
+    enc.buf = idx;
+    enc.bits = 0;
+    enc.ticks = 0;
+    /* Every page starts from zero, so its first tick holds absolute values */
+    memset(enc.prev, 0, sizeof(enc.prev));
+    return true;
+}
+
+/* Queue the page being filled for flash. Caller holds encoder_mutex. */
+static void close_page(void)
+{
+    uint8_t *page = page_buf[enc.buf];
+    uint8_t idx = (uint8_t)enc.buf;
+
+    sys_put_le16(enc.ticks, &page[HDR_TICKS]);
+    sys_put_le16((uint16_t)enc.bits, &page[HDR_BITS]);
+
+    /* Both queues are as deep as there are buffers, so this cannot fail */
+    (void)k_msgq_put(&full_pages, &idx, K_NO_WAIT);
+    enc.buf = -1;
+
+    k_spinlock_key_t key = k_spin_lock(&ring_lock);
+
+    stats.payload_bits += enc.bits;
+    stats.page_ticks += enc.ticks;
+    k_spin_unlock(&ring_lock, key);
+}
+
+static void count_tick(bool dropped)
+{
+    k_spinlock_key_t key = k_spin_lock(&ring_lock);
+
+    if (dropped) {
+        stats.dropped++;
+    } else {
+        stats.ticks++;
+    }
+    k_spin_unlock(&ring_lock, key);
+
+    if (dropped) {
+        COO_LOG_LIMITED(WRN, &drop_log, "Flight recorder behind flash, dropping ticks");
+    } else {
+        COO_LOG_LIMITED_CLEAR(INF, &drop_log, "Flight recorder caught up");
+    }
+}
+
+/* Encode the built tick. Caller holds encoder_mutex. Returns true if a page was queued. */
+static bool encode_tick(uint32_t now_ms)
+{
+    bool queued = false;
+    uint32_t bits;
+
+    if (enc.buf < 0 && !open_page(now_ms)) {
+        count_tick(true);
+        return false;
+    }
+
+    tick_values[0] = enc.ticks > 0 ? (int32_t)(now_ms - enc.last_ms) : 0;
+    bits = code_tick();
+
+    if (enc.bits + bits > PAYLOAD_BITS) {
+        close_page();
+        queued = true;
+        if (!open_page(now_ms)) {
+            count_tick(true);
+            return true;
+        }
+        tick_values[0] = 0;
+        bits = code_tick();
+    }
+
+    for (int c = 0; c < num_channels; c++) {
+        recorder_put_code(&page_buf[enc.buf][HDR_SIZE], &enc.bits, tick_codes[c]);
+    }
+    memcpy(enc.prev, tick_values, (size_t)num_channels * sizeof(tick_values[0]));
+    enc.ticks++;
+    enc.last_ms = now_ms;
+    count_tick(false);
+
+    return queued;
+}
+
+void flight_recorder_record(void)
+{
+    if (!atomic_get(&ready)) {
+        return;
+    }
+    if (++decimation_count < CONFIG_COO_FLIGHT_RECORDER_DECIMATION) {
+        return;
+    }
+    decimation_count = 0;
+
+    /* Each manager is read once under its own lock, before ours */
+    if (sensor_manager_get_snapshot(&rec_sensors) != 0 ||
+        control_loop_get_snapshot(&rec_loops) != 0 ||
+        heater_manager_get_snapshot(&rec_heaters) != 0) {
+        return;
+    }
+
+    uint32_t now_ms = k_uptime_get_32();
+
+    k_mutex_lock(&encoder_mutex, K_FOREVER);
+    build_tick();
+    bool queued = encode_tick(now_ms);
+    k_mutex_unlock(&encoder_mutex);
+
+    if (queued) {
+        (void)k_work_submit_to_queue(&recorder_wq, &write_work);
+    }
+}
+
+int flight_recorder_flush(void)
+{
+    bool queued = false;
+
+    if (!atomic_get(&ready)) {
+        return -1;
+    }
+
+    k_mutex_lock(&encoder_mutex, K_FOREVER);
+    if (enc.buf >= 0 && enc.ticks > 0) {
+        close_page();
+        queued = true;
+    }
+    k_mutex_unlock(&encoder_mutex);
+
+    if (queued) {
+        (void)k_work_submit_to_queue(&recorder_wq, &write_work);
+    }
+    return 0;
+}
+
+/* Program one closed page into the next slot; runs on the recorder work queue */
+static void write_page(uint8_t *page)
+{
+    uint32_t slot = next_slot;
+    off_t off = (off_t)slot * REC_PAGE_SIZE;
+    k_spinlock_key_t key;
+    int rc = 0;
+
+    if (off % sector_size == 0) {
+        uint32_t per_sector = sector_size / REC_PAGE_SIZE;
+
+        /* The sector ahead holds the oldest pages: drop them before erasing */
+        key = k_spin_lock(&ring_lock);
+        if (stats.stored > capacity - per_sector) {
+            stats.stored = capacity - per_sector;
+        }
+        k_spin_unlock(&ring_lock, key);
+
+        rc = flash_area_erase(rec_fa, off, sector_size);
+    }
+
+    if (rc == 0) {
+        uint32_t payload_len = DIV_ROUND_UP(sys_get_le16(&page[HDR_BITS]), 8U);
+        uint32_t crc;
+
+        sys_put_le32(next_seq, &page[HDR_SEQ]);
+        crc = crc32_ieee(page, HDR_CRC);
+        crc = crc32_ieee_update(crc, &page[HDR_SIZE], payload_len);
+        sys_put_le32(crc, &page[HDR_CRC]);
+
+        rc = flash_area_write(rec_fa, off, page, REC_PAGE_SIZE);
+    }
+
+    /*
+     * The slot is used either way, so seq keeps mapping onto slots; a
+     * failed page reads back with a bad header or CRC.
+     */
+    key = k_spin_lock(&ring_lock);
+    if (rc == 0) {
+        stats.pages_written++;
+    } else {
+        stats.write_errors++;
+    }
+    if (stats.stored < capacity) {
+        stats.stored++;
+    }
+    next_slot = (slot + 1U) % capacity;
+    next_seq++;
+    k_spin_unlock(&ring_lock, key);
+
+    if (rc != 0) {
+        COO_LOG_LIMITED(ERR, &write_log, "Flight recorder page write failed (%d)", rc);
+    } else {
+        COO_LOG_LIMITED_CLEAR(INF, &write_log, "Flight recorder writing again");
+    }
+}
+
+static void write_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    uint8_t idx;
+
+    while (k_msgq_get(&full_pages, &idx, K_NO_WAIT) == 0) {
+        write_page(page_buf[idx]);
+        (void)k_msgq_put(&free_pages, &idx, K_NO_WAIT);
+    }
+}
+
+/* Byte offset of a stored page, or false if it is not in the ring */
+static bool page_offset(uint32_t seq, off_t *off)
+{
+    k_spinlock_key_t key = k_spin_lock(&ring_lock);
+    uint32_t age = next_seq - 1U - seq;
+    bool stored = stats.stored > 0U && age < stats.stored;
+
+    if (stored) {
+        *off = (off_t)((next_slot + capacity - 1U - age) % capacity) * REC_PAGE_SIZE;
+    }
+    k_spin_unlock(&ring_lock, key);
+
+    return stored;
+}
+
+int flight_recorder_read(uint32_t seq, uint32_t offset, void *buf, size_t len)
+{
+    off_t off;
+    int rc;
+
+    if (!atomic_get(&ready) || buf == NULL) {
+        return -1;
+    }
+    if (!page_offset(seq, &off)) {
+        return -2;
+    }
+    if (offset >= REC_PAGE_SIZE) {
+        return 0;
+    }
+    len = MIN(len, REC_PAGE_SIZE - offset);
+
+    rc = flash_area_read(rec_fa, off + offset, buf, len);
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* The writer may have erased the slot for a new page while we read */
+    if (!page_offset(seq, &off)) {
+        return -2;
+    }
+    return (int)len;
+}
+
+int flight_recorder_get_stats(flight_recorder_stats_t *out)
+{
+    if (out == NULL) {
+        return -1;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&ring_lock);
+
+    *out = stats;
+    out->oldest_seq = next_seq - stats.stored;
+    out->newest_seq = next_seq - 1U;
+    k_spin_unlock(&ring_lock, key);
+
+    return 0;
+}
+
+static bool header_valid(const uint8_t *hdr)
+{
+    return sys_get_le32(&hdr[0]) == RECORDER_MAGIC && hdr[HDR_VERSION] == RECORDER_VERSION;
+}
+
+static bool slot_blank(uint32_t slot)
+{
+    uint8_t chunk[64];
+    uint8_t erased = flash_area_erased_val(rec_fa);
+
+    for (uint32_t pos = 0; pos < REC_PAGE_SIZE; pos += sizeof(chunk)) {
+        if (flash_area_read(rec_fa, (off_t)slot * REC_PAGE_SIZE + pos, chunk,
+                            sizeof(chunk)) != 0) {
+            return false;
+        }
+        for (size_t i = 0; i < sizeof(chunk); i++) {
+            if (chunk[i] != erased) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* Find the newest page and the run of pages before it; sets the ring up after it */
+static void scan_ring(void)
+{
+    uint8_t hdr[HDR_SIZE];
+    uint32_t newest_slot = 0;
+    uint32_t newest_seq = 0;
+    uint32_t stored = 0;
+    bool found = false;
+
+    for (uint32_t slot = 0; slot < capacity; slot++) {
+        if (flash_area_read(rec_fa, (off_t)slot * REC_PAGE_SIZE, hdr, sizeof(hdr)) != 0 ||
+            !header_valid(hdr)) {
+            continue;
+        }
+
+        uint32_t seq = sys_get_le32(&hdr[HDR_SEQ]);
+
+        if (!found || (int32_t)(seq - newest_seq) > 0) {
+            found = true;
+            newest_slot = slot;
+            newest_seq = seq;
+            boot = (uint16_t)(sys_get_le16(&hdr[HDR_BOOT]) + 1U);
+        }
+    }
+
+    if (!found) {
+        next_slot = 0;
+        next_seq = 0;
+        stats.stored = 0;
+        return;
+    }
+
+    /* Count back while the slots hold consecutive pages */
+    for (stored = 1; stored < capacity; stored++) {
+        uint32_t slot = (newest_slot + capacity - stored) % capacity;
+
+        if (flash_area_read(rec_fa, (off_t)slot * REC_PAGE_SIZE, hdr, sizeof(hdr)) != 0 ||
+            !header_valid(hdr) || sys_get_le32(&hdr[HDR_SEQ]) != newest_seq - stored) {
+            break;
+        }
+    }
+
+    next_slot = (newest_slot + 1U) % capacity;
+    next_seq = newest_seq + 1U;
+
+    /*
+     * The rest of the newest page's sector should still be erased. If a
+     * write was cut short there, skip to the next sector; the skipped
+     * slots stay in the ring as unreadable pages so seq still maps onto
+     * slots.
+     */
+    uint32_t per_sector = sector_size / REC_PAGE_SIZE;
+
+    for (uint32_t slot = next_slot; slot % per_sector != 0U; slot++) {
+        if (!slot_blank(slot)) {
+            uint32_t skip = per_sector - next_slot % per_sector;
+
+            LOG_WRN("Flight recorder: torn page at slot %u, skipping %u slots",
+                    slot, skip);
+            next_slot = (next_slot + skip) % capacity;
+            next_seq += skip;
+            stored = MIN(stored + skip, capacity);
+            break;
+        }
+    }
+
+    stats.stored = stored;
+}
+
+int flight_recorder_init(uint8_t area_id)
+{
+    struct flash_pages_info info;
+    const struct device *dev;
+    int rc;
+
+    if (atomic_get(&ready)) {
+        return -1;
+    }
+
+    rc = flash_area_open(area_id, &rec_fa);
+    if (rc != 0) {
+        LOG_ERR("Flight recorder: cannot open flash area %u (%d)", area_id, rc);
+        return -2;
+    }
+
+    dev = flash_area_get_device(rec_fa);
+    if (dev == NULL || !device_is_ready(dev) ||
+        flash_get_page_info_by_offs(dev, rec_fa->fa_off, &info) != 0) {
+        LOG_ERR("Flight recorder: flash device not ready");
+        flash_area_close(rec_fa);
+        return -3;
+    }
+
+    sector_size = (uint32_t)info.size;
+    if (sector_size % REC_PAGE_SIZE != 0U || rec_fa->fa_size / sector_size < 2U) {
+        LOG_ERR("Flight recorder: need 2+ sectors of a multiple of %u bytes "
+                "(sector %u, area %u)", REC_PAGE_SIZE, sector_size,
+                (unsigned int)rec_fa->fa_size);
+        flash_area_close(rec_fa);
+        return -4;
+    }
+    capacity = (uint32_t)(rec_fa->fa_size / sector_size) * (sector_size / REC_PAGE_SIZE);
+
+    num_sensors = (uint8_t)CLAMP(sensor_manager_get_count(), 0, MAX_MANAGED_SENSORS);
+    num_loops = (uint8_t)CLAMP(control_loop_get_count(), 0, MAX_CONTROL_LOOPS);
+    num_heaters = (uint8_t)CLAMP(heater_manager_get_count(), 0, MAX_MANAGED_HEATERS);
+    num_channels = 1 + 2 * num_sensors + 4 * num_loops + 2 * num_heaters;
+
+    scan_ring();
+    stats.page_size = REC_PAGE_SIZE;
+    stats.capacity = capacity;
+    stats.boot = boot;
+
+    for (uint8_t i = 0; i < REC_PAGE_BUFFERS; i++) {
+        (void)k_msgq_put(&free_pages, &i, K_NO_WAIT);
+    }
+
+    const struct k_work_queue_config wq_cfg = { .name = "recorder" };
+
+    k_work_init(&write_work, write_work_handler);
+    k_work_queue_init(&recorder_wq);
+    k_work_queue_start(&recorder_wq, recorder_stack, K_THREAD_STACK_SIZEOF(recorder_stack),
+                       CONFIG_COO_FLIGHT_RECORDER_PRIORITY, &wq_cfg);
+
+    atomic_set(&ready, 1);
+
+    LOG_INF("Flight recorder: %u pages of %u bytes, %u stored, boot %u",
+            capacity, REC_PAGE_SIZE, stats.stored, boot);
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file flight_recorder.h
+ * @brief Compressed circular record of every control pass in a flash partition
+ *
+ * Each control pass (or every Nth, see CONFIG_COO_FLIGHT_RECORDER_DECIMATION)
+ * is encoded as one tick: the pass interval, every sensor's temperature and
+ * status, every loop's setpoint, measurement, output and status, and every
+ * heater's power and status. Values are quantized to integers and stored as
+ * zig-zag deltas from the previous tick under a short prefix code, so a
+ * value that did not change costs one bit.
+ *
+ * Ticks are packed into RAM page buffers. A full page is handed to the
+ * recorder's own work queue, which erases and programs flash; the control
+ * thread only ever encodes into RAM, and drops ticks rather than wait when
+ * every buffer is still queued for flash.
+ *
+ * The partition is used as a ring of pages, erased one sector ahead of the
+ * writer. Every page carries its own header and starts from absolute values,
+ * so each page decodes without the ones before it, and losing the oldest
+ * sector to the ring loses nothing else. The page format is documented in
+ * the ICD, section 6.10.
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Recorder counters, since boot
+ */
+typedef struct {
+    uint32_t ticks;          /* Ticks encoded */
+    uint32_t dropped;        /* Ticks lost waiting for a free page buffer */
+    uint32_t pages_written;
+    uint32_t write_errors;   /* Pages or erases that failed */
+    uint64_t payload_bits;   /* Encoded bits in the pages closed so far */
+    uint32_t page_ticks;     /* Ticks in the pages closed so far */
+    uint32_t page_size;      /* Bytes per page, header included */
+    uint32_t capacity;       /* Pages the partition holds */
+    uint32_t stored;         /* Pages in flash now, oldest..newest */
+    uint32_t oldest_seq;     /* Valid when stored > 0 */
+    uint32_t newest_seq;     /* Valid when stored > 0 */
+    uint16_t boot;           /* Boot number stamped on this boot's pages */
+} flight_recorder_stats_t;
+
+/**
+ * Open the partition, find the newest page and start the writer
+ * Call once, after the sensor, heater and control loop managers are
+ * initialized: their counts fix the tick layout. Recording resumes after
+ * the newest page already in flash.
+ * @param area_id Flash area ID, e.g. FIXED_PARTITION_ID(recorder_partition)
+ * @return 0 on success, negative error code on failure
+ */
+int flight_recorder_init(uint8_t area_id);
+
+/**
+ * Encode one tick from the current sensor, loop and heater snapshots
+ * Called by the control pass once it has applied its heater commands.
+ * Never waits for flash. Does nothing before flight_recorder_init().
+ * Not reentrant: only the control thread calls it.
+ */
+void flight_recorder_record(void);
+
+/**
+ * Close the page being filled and queue it for flash, e.g. on a fault
+ * Returns once the page is queued, not written.
+ * @return 0 on success (or nothing to flush), negative error code on failure
+ */
+int flight_recorder_flush(void);
+
+/**
+ * Read part of a stored page
+ * @param seq Page sequence number, oldest_seq..newest_seq
+ * @param offset Byte offset into the page
+ * @param buf Destination
+ * @param len Bytes wanted; the read stops at the end of the page
+ * @return bytes read, -2 if the page is not stored (or was recycled during
+ *         the read), other negative error code on failure
+ */
+int flight_recorder_read(uint32_t seq, uint32_t offset, void *buf, size_t len);
+
+/**
+ * Copy the recorder counters
+ * @param stats Pointer to store the counters
+ * @return 0 on success, negative error code on failure
+ */
+int flight_recorder_get_stats(flight_recorder_stats_t *stats);
+
+#endif /* FLIGHT_RECORDER_H */
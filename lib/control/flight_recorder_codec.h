@@ -0,0 +1,142 @@
+/**
+ * @file flight_recorder_codec.h
+ * @brief Bit codec of the flight recorder page payload
+ *
+ * Each channel value is quantized, zig-zagged against the previous tick
+ * and written MSB first under a short prefix code (see the ICD, flight
+ * recorder page format). The encoder side is what flight_recorder.c
+ * writes to flash; the decoder side reads a payload back, for tests and
+ * host tools.
+ */
+
+#ifndef FLIGHT_RECORDER_CODEC_H
+#define FLIGHT_RECORDER_CODEC_H
+
+#include <math.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+/* The escape code is 5 prefix bits and a raw 32-bit value */
+#define RECORDER_CODE_BITS_MAX 37
+
+/*
+ * Prefix code over zig-zag deltas. A class holds value_bits bits of
+ * z - base; the last class escapes to the raw value.
+ */
+static const struct {
+    uint8_t prefix;
+    uint8_t prefix_len;
+    uint8_t value_bits;
+    uint32_t base;
+} recorder_codes[] = {
+    { 0x00, 1, 0, 0 },        /* 0 */
+    { 0x02, 2, 2, 1 },        /* 10    + 2 bits: 1..4 */
+    { 0x06, 3, 6, 5 },        /* 110   + 6 bits: 5..68 */
+    { 0x0e, 4, 12, 69 },      /* 1110  + 12 bits: 69..4164 */
+    { 0x1e, 5, 20, 4165 },    /* 11110 + 20 bits: 4165..1052740 */
+    { 0x1f, 5, 32, 0 },       /* 11111 + 32 bits: anything */
+};
+
+static inline uint32_t recorder_zigzag(int32_t cur, int32_t prev)
+{
+    uint32_t d = (uint32_t)cur - (uint32_t)prev;
+
+    return (d << 1) ^ (uint32_t)((int32_t)d >> 31);
+}
+
+/* Inverse of recorder_zigzag(): the value whose delta from prev codes as z */
+static inline int32_t recorder_unzigzag(uint32_t z, int32_t prev)
+{
+    uint32_t d = (z >> 1) ^ (0u - (z & 1u));
+
+    return (int32_t)((uint32_t)prev + d);
+}
+
+static inline int recorder_code_class(uint32_t z)
+{
+    int k = 0;
+
+    while (k < (int)ARRAY_SIZE(recorder_codes) - 1 &&
+           z - recorder_codes[k].base >= (1u << recorder_codes[k].value_bits)) {
+        k++;
+    }
+    return k;
+}
+
+static inline uint32_t recorder_code_len(uint32_t z)
+{
+    int k = recorder_code_class(z);
+
+    return recorder_codes[k].prefix_len + recorder_codes[k].value_bits;
+}
+
+/* Append the n low bits of value, MSB first, to a zeroed buffer */
+static inline void recorder_put_bits(uint8_t *buf, uint32_t *pos, uint32_t value,
+                                     unsigned int n)
+{
+    while (n > 0U) {
+        unsigned int room = 8U - (*pos & 7U);
+        unsigned int take = MIN(room, n);
+        uint32_t chunk = (uint32_t)(((uint64_t)value >> (n - take)) & BIT_MASK(take));
+
+        buf[*pos >> 3] |= (uint8_t)(chunk << (room - take));
+        *pos += take;
+        n -= take;
+    }
+}
+
+static inline void recorder_put_code(uint8_t *buf, uint32_t *pos, uint32_t z)
+{
+    int k = recorder_code_class(z);
+
+    recorder_put_bits(buf, pos, recorder_codes[k].prefix, recorder_codes[k].prefix_len);
+    recorder_put_bits(buf, pos, z - recorder_codes[k].base, recorder_codes[k].value_bits);
+}
+
+/* Read n bits, MSB first; n <= 32 */
+static inline uint32_t recorder_get_bits(const uint8_t *buf, uint32_t *pos, unsigned int n)
+{
+    uint32_t value = 0;
+
+    while (n > 0U) {
+        unsigned int room = 8U - (*pos & 7U);
+        unsigned int take = MIN(room, n);
+        uint32_t chunk = ((uint32_t)buf[*pos >> 3] >> (room - take)) & BIT_MASK(take);
+
+        value = (uint32_t)(((uint64_t)value << take) | chunk);
+        *pos += take;
+        n -= take;
+    }
+    return value;
+}
+
+/* Read one code written by recorder_put_code() */
+static inline uint32_t recorder_get_code(const uint8_t *buf, uint32_t *pos)
+{
+    int k = 0;
+
+    /* Each class's prefix is one more leading 1; the escape has no 0 */
+    while (k < (int)ARRAY_SIZE(recorder_codes) - 1 && recorder_get_bits(buf, pos, 1) != 0U) {
+        k++;
+    }
+    return recorder_codes[k].base + recorder_get_bits(buf, pos, recorder_codes[k].value_bits);
+}
+
+/* Quantize to the given scale, keeping the previous value through NaN */
+static inline int32_t recorder_quantize(float value, float scale, int32_t hold)
+{
+    if (!isfinite(value)) {
+        return hold;
+    }
+
+    float q = value * scale;
+
+    if (q > (float)INT32_MAX / 2) {
+        q = (float)INT32_MAX / 2;
+    } else if (q < (float)INT32_MIN / 2) {
+        q = (float)INT32_MIN / 2;
+    }
+    return (int32_t)lroundf(q);
+}
+
+#endif /* FLIGHT_RECORDER_CODEC_H */
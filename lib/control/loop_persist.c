@@ -0,0 +1,278 @@
+/**
+ * @file loop_persist.c
+ * @brief Coalesced NVS persistence of runtime loop state
+ */
+
+#include "loop_persist.h"
+#include "control_loop.h"
+#include <coo_commons/scheduled_action.h>
+#include <zephyr/kernel.h>
+#include <zephyr/kvss/nvs.h>
+#include <zephyr/logging/log.h>
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(loop_persist, LOG_LEVEL_INF);
+
+#define PERSIST_MAGIC   0x4c505354u /* "LPST" */
+#define PERSIST_VERSION 1
+
+/*
+ * One record holds every loop. Only the used entries are written, so its
+ * length follows the configured loop count.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;           /* Bytes written, header included */
+    int32_t count;
+    loop_saved_state_t loops[MAX_CONTROL_LOOPS];
+} persist_record_t;
+
+#define RECORD_SIZE(count) \
+    (offsetof(persist_record_t, loops) + (size_t)(count) * sizeof(loop_saved_state_t))
+
+enum {
+    PERSIST_ACTION_SAVE = 0,
+    PERSIST_ACTION_COUNT
+};
+
+static struct coo_scheduled_action persist_actions[PERSIST_ACTION_COUNT] = {
+    [PERSIST_ACTION_SAVE] = { .name = "loop_persist_save" },
+};
+
+static struct nvs_fs *persist_fs;
+static uint16_t persist_id;
+
+/*
+ * Record being built and the record NVS holds now, used to skip writes
+ * that would change nothing. Guarded by persist_mutex, which is taken
+ * before the control lock, never after it.
+ */
+K_MUTEX_DEFINE(persist_mutex);
+static persist_record_t scratch;
+static persist_record_t stored;
+static size_t stored_size;
+
+/* Dirty tracking and counters; the setters reach these with the control lock held */
+static struct k_spinlock dirty_lock;
+static bool dirty;
+static int64_t dirty_since_ms;
+static loop_persist_stats_t stats = { .last_write_ms = -1 };
+
+static bool record_valid(const persist_record_t *rec, int read_size)
+{
+    if (read_size < (int)RECORD_SIZE(0) ||
+        rec->magic != PERSIST_MAGIC ||
+        rec->version != PERSIST_VERSION ||
+        rec->count < 0 || rec->count > MAX_CONTROL_LOOPS ||
+        rec->size != RECORD_SIZE(rec->count) ||
+        read_size != (int)rec->size) {
+        return false;
+    }
+
+    for (int i = 0; i < rec->count; i++) {
+        if (memchr(rec->loops[i].id, '\0', sizeof(rec->loops[i].id)) == NULL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Save unless NVS already holds the same state. Caller holds persist_mutex. */
+static int save_locked(void)
+{
+    k_spinlock_key_t key;
+    int count;
+    size_t size;
+    int rc;
+
+    memset(&scratch, 0, sizeof(scratch));
+    count = control_loop_save_state(scratch.loops, MAX_CONTROL_LOOPS);
+    if (count < 0) {
+        return count;
+    }
+
+    size = RECORD_SIZE(count);
+    scratch.magic = PERSIST_MAGIC;
+    scratch.version = PERSIST_VERSION;
+    scratch.size = (uint16_t)size;
+    scratch.count = count;
+
+    if (size == stored_size && memcmp(&scratch, &stored, size) == 0) {
+        key = k_spin_lock(&dirty_lock);
+        stats.unchanged++;
+        k_spin_unlock(&dirty_lock, key);
+        return 0;
+    }
+
+    rc = nvs_write(persist_fs, persist_id, &scratch, size);
+
+    key = k_spin_lock(&dirty_lock);
+    if (rc < 0) {
+        stats.write_errors++;
+    } else {
+        stats.writes++;
+        stats.last_write_ms = k_uptime_get();
+    }
+    k_spin_unlock(&dirty_lock, key);
+
+    if (rc < 0) {
+        LOG_WRN("Loop state write failed (%d)", rc);
+        return rc;
+    }
+
+    memcpy(&stored, &scratch, size);
+    stored_size = size;
+    return 0;
+}
+
+static int save_now(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&dirty_lock);
+
+    /* A change from here on schedules another save */
+    dirty = false;
+    k_spin_unlock(&dirty_lock, key);
+
+    k_mutex_lock(&persist_mutex, K_FOREVER);
+    int rc = save_locked();
+    k_mutex_unlock(&persist_mutex);
+
+    return rc;
+}
+
+static void save_action(size_t id, void *user_data)
+{
+    ARG_UNUSED(id);
+    ARG_UNUSED(user_data);
+
+    if (save_now() != 0) {
+        /* Try again later rather than lose the change */
+        loop_persist_note_change();
+    }
+}
+
+int loop_persist_init(struct nvs_fs *fs, uint16_t nvs_id)
+{
+    int rc;
+    int restored = 0;
+
+    if (fs == NULL || nvs_id == 0U) {
+        return -1;
+    }
+
+    rc = coo_scheduled_actions_init(persist_actions, PERSIST_ACTION_COUNT);
+    if (rc == 0) {
+        rc = coo_scheduled_action_register(persist_actions, PERSIST_ACTION_COUNT,
+                                           PERSIST_ACTION_SAVE, save_action, NULL);
+    }
+    if (rc != 0) {
+        return rc;
+    }
+
+    k_mutex_lock(&persist_mutex, K_FOREVER);
+    rc = nvs_read(fs, nvs_id, &stored, sizeof(stored));
+    if (rc == -ENOENT) {
+        LOG_INF("No saved loop state, using configured defaults");
+    } else if (!record_valid(&stored, rc)) {
+        LOG_WRN("Ignoring invalid saved loop state (%d)", rc);
+    } else {
+        stored_size = stored.size;
+        restored = control_loop_restore_state(stored.loops, stored.count);
+        LOG_INF("Restored %d of %d saved loops", restored, (int)stored.count);
+    }
+    if (stored_size == 0U) {
+        memset(&stored, 0, sizeof(stored));
+    }
+
+    persist_fs = fs;
+    persist_id = nvs_id;
+    k_mutex_unlock(&persist_mutex);
+
+    k_spinlock_key_t key = k_spin_lock(&dirty_lock);
+    stats.restored = restored < 0 ? 0 : restored;
+    k_spin_unlock(&dirty_lock, key);
+
+    return restored;
+}
+
+void loop_persist_note_change(void)
+{
+    int64_t now_ms = k_uptime_get();
+    int64_t wait_ms = CONFIG_COO_CONTROL_PERSIST_DELAY_MS;
+    k_spinlock_key_t key;
+
+    if (persist_fs == NULL) {
+        return;
+    }
+
+    key = k_spin_lock(&dirty_lock);
+    stats.changes++;
+    if (!dirty) {
+        dirty = true;
+        dirty_since_ms = now_ms;
+    } else {
+        /* Keep deferring through a burst, but not past the maximum delay */
+        int64_t deadline_ms = dirty_since_ms + CONFIG_COO_CONTROL_PERSIST_MAX_DELAY_MS;
+
+        wait_ms = MAX(MIN(wait_ms, deadline_ms - now_ms), 0);
+    }
+    k_spin_unlock(&dirty_lock, key);
+
+    (void)coo_scheduled_action_schedule(persist_actions, PERSIST_ACTION_COUNT,
+                                        PERSIST_ACTION_SAVE, K_MSEC(wait_ms));
+}
+
+int loop_persist_flush(void)
+{
+    if (persist_fs == NULL) {
+        return -1;
+    }
+
+    (void)coo_scheduled_action_cancel(persist_actions, PERSIST_ACTION_COUNT,
+                                      PERSIST_ACTION_SAVE);
+    return save_now();
+}
+
+int loop_persist_clear(void)
+{
+    int rc;
+
+    if (persist_fs == NULL) {
+        return -1;
+    }
+
+    k_mutex_lock(&persist_mutex, K_FOREVER);
+    (void)coo_scheduled_action_cancel(persist_actions, PERSIST_ACTION_COUNT,
+                                      PERSIST_ACTION_SAVE);
+    rc = nvs_delete(persist_fs, persist_id);
+    if (rc == 0) {
+        memset(&stored, 0, sizeof(stored));
+        stored_size = 0U;
+        LOG_INF("Saved loop state cleared");
+    }
+    k_mutex_unlock(&persist_mutex);
+
+    k_spinlock_key_t key = k_spin_lock(&dirty_lock);
+    dirty = false;
+    k_spin_unlock(&dirty_lock, key);
+
+    return rc;
+}
+
+int loop_persist_get_stats(loop_persist_stats_t *out)
+{
+    if (out == NULL) {
+        return -1;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&dirty_lock);
+    *out = stats;
+    k_spin_unlock(&dirty_lock, key);
+
+    out->pending = coo_scheduled_action_is_pending(persist_actions, PERSIST_ACTION_COUNT,
+                                                   PERSIST_ACTION_SAVE);
+    return 0;
+}
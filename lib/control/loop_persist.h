@@ -0,0 +1,77 @@
+/**
+ * @file loop_persist.h
+ * @brief NVS persistence of runtime loop targets, ramp rates, gains and enables
+ *
+ * Every change made through the control loop setters marks the saved state
+ * dirty. The write itself is deferred with a coo_scheduled_action: each
+ * change restarts a quiet-period timer, so a burst of setpoint or gain
+ * commands ends up as one flash write, and a stream of changes that never
+ * goes quiet is still written once the oldest unsaved change reaches the
+ * maximum delay. A save that would write what NVS already holds is skipped.
+ *
+ * All loops are saved as one NVS record, and read back in one nvs_read()
+ * at boot. NVS itself rotates writes through the partition's sectors.
+ *
+ * Saves run on the system workqueue and include the flash write, which on
+ * a sector change also erases a sector.
+ */
+
+#ifndef LOOP_PERSIST_H
+#define LOOP_PERSIST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct nvs_fs;
+
+/**
+ * Persistence counters, since boot
+ */
+typedef struct {
+    uint32_t changes;        /* State changes noted */
+    uint32_t writes;         /* Records written to flash */
+    uint32_t unchanged;      /* Saves skipped because flash already held the state */
+    uint32_t write_errors;
+    int restored;            /* Loops restored at boot */
+    bool pending;            /* A save is scheduled */
+    int64_t last_write_ms;   /* Uptime of the last write, -1 if none */
+} loop_persist_stats_t;
+
+/**
+ * Restore saved loop state and start tracking changes
+ * Call once, after control_loop_init() and before the control thread
+ * starts. Without a valid record the loops keep their configured defaults.
+ * @param fs Mounted NVS file system, owned by the caller
+ * @param nvs_id NVS entry ID for the record, not 0
+ * @return number of loops restored, negative error code on failure
+ */
+int loop_persist_init(struct nvs_fs *fs, uint16_t nvs_id);
+
+/**
+ * Mark the saved state dirty and (re)start the quiet-period timer
+ * Called by the control loop setters. Never blocks; safe with the control
+ * lock held. Does nothing before loop_persist_init().
+ */
+void loop_persist_note_change(void);
+
+/**
+ * Save now instead of waiting for the quiet period, e.g. before a reboot
+ * @return 0 on success (or nothing to write), negative error code on failure
+ */
+int loop_persist_flush(void);
+
+/**
+ * Forget the saved state; the next boot uses the configured defaults
+ * A later change saves again.
+ * @return 0 on success, negative error code on failure
+ */
+int loop_persist_clear(void);
+
+/**
+ * Copy the persistence counters
+ * @param stats Pointer to store the counters
+ * @return 0 on success, negative error code on failure
+ */
+int loop_persist_get_stats(loop_persist_stats_t *stats);
+
+#endif /* LOOP_PERSIST_H */
@@ -0,0 +1,124 @@
+/**
+ * @file setpoint_ramp.c
+ * @brief Setpoint ramp and ramp-soak profile engine implementation
+ */
+
+#include "setpoint_ramp.h"
+#include <string.h>
+
+static float active_rate(const setpoint_ramp_t *ramp)
+{
+    if (ramp->profile_active) {
+        float rate = ramp->segments[ramp->segment].rate_k_per_min;
+
+        if (rate > 0.0f) {
+            return rate;
+        }
+    }
+    return ramp->rate_k_per_min;
+}
+
+/* Move the setpoint toward target by at most rate * dt; true once there */
+static bool step_toward_target(setpoint_ramp_t *ramp, float dt_seconds)
+{
+    float rate = active_rate(ramp);
+    float remaining = ramp->target - ramp->setpoint;
+
+    if (rate <= 0.0f) {
+        ramp->setpoint = ramp->target;
+        return true;
+    }
+
+    float step = rate * (dt_seconds / 60.0f);
+
+    if (remaining <= step && remaining >= -step) {
+        ramp->setpoint = ramp->target;
+        return true;
+    }
+
+    ramp->setpoint += (remaining > 0.0f) ? step : -step;
+    return false;
+}
+
+static void enter_segment(setpoint_ramp_t *ramp, int segment)
+{
+    ramp->segment = (uint8_t)segment;
+    ramp->target = ramp->segments[segment].target_kelvin;
+    ramp->soak_remaining_s = ramp->segments[segment].soak_seconds;
+}
+
+void setpoint_ramp_init(setpoint_ramp_t *ramp, float setpoint, float rate_k_per_min)
+{
+    memset(ramp, 0, sizeof(*ramp));
+    ramp->setpoint = setpoint;
+    ramp->target = setpoint;
+    ramp->rate_k_per_min = (rate_k_per_min > 0.0f) ? rate_k_per_min : 0.0f;
+}
+
+void setpoint_ramp_set_target(setpoint_ramp_t *ramp, float target_kelvin)
+{
+    ramp->profile_active = false;
+    ramp->target = target_kelvin;
+}
+
+void setpoint_ramp_set_rate(setpoint_ramp_t *ramp, float rate_k_per_min)
+{
+    ramp->rate_k_per_min = (rate_k_per_min > 0.0f) ? rate_k_per_min : 0.0f;
+}
+
+int setpoint_ramp_start_profile(setpoint_ramp_t *ramp, const ramp_segment_t segments[],
+                                int num_segments)
+{
+    if (segments == NULL || num_segments <= 0 || num_segments > RAMP_MAX_SEGMENTS) {
+        return -1;
+    }
+
+    memcpy(ramp->segments, segments, (size_t)num_segments * sizeof(ramp_segment_t));
+    ramp->num_segments = (uint8_t)num_segments;
+    ramp->profile_active = true;
+    enter_segment(ramp, 0);
+    return 0;
+}
+
+void setpoint_ramp_stop_profile(setpoint_ramp_t *ramp)
+{
+    ramp->profile_active = false;
+    ramp->target = ramp->setpoint;
+}
+
+float setpoint_ramp_advance(setpoint_ramp_t *ramp, float dt_seconds)
+{
+    if (dt_seconds < 0.0f) {
+        dt_seconds = 0.0f;
+    }
+
+    bool arrived = step_toward_target(ramp, dt_seconds);
+
+    if (ramp->profile_active && arrived) {
+        /* Soak time counts from the tick the target is reached */
+        ramp->soak_remaining_s -= dt_seconds;
+        if (ramp->soak_remaining_s <= 0.0f) {
+            if (ramp->segment + 1 < ramp->num_segments) {
+                enter_segment(ramp, ramp->segment + 1);
+            } else {
+                /* Profile finished: hold the final target */
+                ramp->profile_active = false;
+                ramp->soak_remaining_s = 0.0f;
+            }
+        }
+    }
+
+    return ramp->setpoint;
+}
+
+void setpoint_ramp_get_progress(const setpoint_ramp_t *ramp, ramp_progress_t *progress)
+{
+    progress->setpoint = ramp->setpoint;
+    progress->target = ramp->target;
+    progress->rate_k_per_min = active_rate(ramp);
+    progress->ramping = (ramp->setpoint != ramp->target);
+    progress->profile_active = ramp->profile_active;
+    progress->segment = ramp->segment;
+    progress->num_segments = ramp->num_segments;
+    progress->soak_remaining_s = ramp->profile_active ? ramp->soak_remaining_s : 0.0f;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file setpoint_ramp.h
+ * @brief Per-loop setpoint ramp and ramp-soak profile engine
+ *
+ * The engine moves the working setpoint toward a target by at most
+ * rate * dt per tick. A profile is a list of segments: ramp to the
+ * segment target, soak there for a set time, then go to the next one.
+ * Everything advances incrementally from the measured dt, so the engine
+ * has no timers of its own.
+ */
+
+#ifndef SETPOINT_RAMP_H
+#define SETPOINT_RAMP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_COO_RAMP_MAX_SEGMENTS
+#define RAMP_MAX_SEGMENTS CONFIG_COO_RAMP_MAX_SEGMENTS
+#else
+#define RAMP_MAX_SEGMENTS 8
+#endif
+
+/**
+ * One ramp-soak profile segment
+ */
+typedef struct {
+    float target_kelvin;
+    float rate_k_per_min;   /* 0 = use the loop's rate limit */
+    float soak_seconds;     /* Hold time once target is reached */
+} ramp_segment_t;
+
+/**
+ * Ramp engine state
+ */
+typedef struct {
+    float setpoint;          /* Working setpoint fed to the controller */
+    float target;            /* Where the setpoint is heading */
+    float rate_k_per_min;    /* Loop rate limit, 0 = step change */
+
+    ramp_segment_t segments[RAMP_MAX_SEGMENTS];
+    uint8_t num_segments;
+    uint8_t segment;         /* Index of the running segment */
+    bool profile_active;
+    float soak_remaining_s;
+} setpoint_ramp_t;
+
+/**
+ * Ramp progress, for status queries
+ */
+typedef struct {
+    float setpoint;
+    float target;
+    float rate_k_per_min;    /* Rate currently applied */
+    bool ramping;            /* Setpoint has not reached target */
+    bool profile_active;
+    int segment;
+    int num_segments;
+    float soak_remaining_s;
+} ramp_progress_t;
+
+/**
+ * Initialize at a settled setpoint
+ * @param ramp Ramp state
+ * @param setpoint Initial setpoint and target (Kelvin)
+ * @param rate_k_per_min Rate limit, 0 = step change
+ */
+void setpoint_ramp_init(setpoint_ramp_t *ramp, float setpoint, float rate_k_per_min);
+
+/**
+ * Head for a new target at the loop rate, cancelling any running profile
+ * @param ramp Ramp state
+ * @param target_kelvin New target
+ */
+void setpoint_ramp_set_target(setpoint_ramp_t *ramp, float target_kelvin);
+
+/**
+ * Change the loop rate limit; takes effect on the next tick
+ * @param ramp Ramp state
+ * @param rate_k_per_min Rate limit, 0 = step change
+ */
+void setpoint_ramp_set_rate(setpoint_ramp_t *ramp, float rate_k_per_min);
+
+/**
+ * Start a ramp-soak profile from the current setpoint
+ * @param ramp Ramp state
+ * @param segments Segment list, copied
+ * @param num_segments Number of segments, 1..RAMP_MAX_SEGMENTS
+ * @return 0 on success, -1 on bad arguments
+ */
+int setpoint_ramp_start_profile(setpoint_ramp_t *ramp, const ramp_segment_t segments[],
+                                int num_segments);
+
+/**
+ * Stop a running profile; the setpoint holds where it is
+ * @param ramp Ramp state
+ */
+void setpoint_ramp_stop_profile(setpoint_ramp_t *ramp);
+
+/**
+ * Advance one control tick
+ * @param ramp Ramp state
+ * @param dt_seconds Time since the previous tick
+ * @return the new working setpoint
+ */
+float setpoint_ramp_advance(setpoint_ramp_t *ramp, float dt_seconds);
+
+/**
+ * Snapshot ramp progress
+ * @param ramp Ramp state
+ * @param progress Pointer to store progress
+ */
+void setpoint_ramp_get_progress(const setpoint_ramp_t *ramp, ramp_progress_t *progress);
+
+#endif /* SETPOINT_RAMP_H */
@@ -6,11 +6,17 @@
 #include <coo_commons/command_dispatch.h>
 
 #include <coo_commons/json_utils.h>
+#include <coo_commons/mqtt_client.h>
+#include <coo_commons/stage_trace.h>
+#if defined(CONFIG_COO_SERIAL_UART_ASYNC)
+#include <coo_commons/serial_uart.h>
+#endif
 
 #include <ctype.h>
 #include <errno.h>
 #include <math.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
@@ -25,16 +31,44 @@
 LOG_MODULE_REGISTER(coo_command_dispatch, LOG_LEVEL_INF);
 
 #define SERIAL_POLL_CHAR_BUDGET 64
+#define SERIAL_POLL_LINE_BUDGET 4
 #define COO_CMD_SERIAL_LINE_END "\n"
 #define COO_CMD_LASTCOMMAND_MAGIC 0x434c4344U /* "CLCD" */
-#define COO_CMD_LASTCOMMAND_VERSION 1U
+#define COO_CMD_LASTCOMMAND_VERSION 2U
 #define COO_CMD_REBOOT_DEFAULT_DELAY_MS 3000U
 
 static void serial_reset_line(struct coo_cmd_runtime *runtime);
 static int runtime_init_serial_console(struct coo_cmd_runtime *runtime);
 static void runtime_enqueue_response(struct coo_cmd_runtime *runtime,
-				     const struct coo_cmd_response *out);
+				     struct coo_cmd_response *out);
 static void runtime_load_lastcommand(struct coo_cmd_runtime *runtime);
+static void runtime_build_spec_index(struct coo_cmd_runtime *runtime);
+
+/*
+ * Every byte of serial command output goes through here. With the async
+ * UART backend it is copied into the DMA transmit ring, so a long help or
+ * snapshot dump costs the caller a copy rather than the time the UART
+ * takes to shift it out.
+ */
+static void serial_printf(const char *fmt, ...) __printf_like(1, 2);
+
+static void serial_printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+#if defined(CONFIG_COO_SERIAL_UART_ASYNC)
+	char buf[128];
+	int len = vsnprintk(buf, sizeof(buf), fmt, args);
+
+	if (len > 0) {
+		(void)coo_serial_uart_write(buf, MIN((size_t)len, sizeof(buf) - 1U));
+	}
+#else
+	vprintk(fmt, args);
+#endif
+	va_end(args);
+}
 static int runtime_execute_default(struct coo_cmd_runtime *runtime,
 				   const struct coo_cmd_request *cmd,
 				   struct coo_cmd_response *out);
@@ -59,8 +93,13 @@ int coo_cmd_runtime_configure(struct coo_cmd_runtime *runtime,
 	int rc;
 
 	if (runtime == NULL || cfg == NULL || cfg->device_id == NULL ||
-	    cfg->device_id[0] == '\0' || cfg->inbound_queue == NULL ||
+	    cfg->device_id[0] == '\0' || cfg->request_slab == NULL ||
+	    cfg->response_slab == NULL || cfg->inbound_queue == NULL ||
 	    cfg->outbound_queue == NULL || cfg->mqtt_msg_id == NULL ||
+	    cfg->request_slab->info.block_size < sizeof(struct coo_cmd_request) ||
+	    cfg->response_slab->info.block_size < sizeof(struct coo_cmd_response) ||
+	    cfg->inbound_queue->msg_size != sizeof(struct coo_cmd_request *) ||
+	    cfg->outbound_queue->msg_size != sizeof(struct coo_cmd_response *) ||
 	    strlen(cfg->device_id) >= sizeof(runtime->device_id)) {
 		return -EINVAL;
 	}
@@ -80,6 +119,8 @@ int coo_cmd_runtime_configure(struct coo_cmd_runtime *runtime,
 		return rc;
 	}
 
+	runtime->request_slab = cfg->request_slab;
+	runtime->response_slab = cfg->response_slab;
 	runtime->inbound_queue = cfg->inbound_queue;
 	runtime->outbound_queue = cfg->outbound_queue;
 	runtime->execute_handler = cfg->execute_handler;
@@ -89,6 +130,7 @@ int coo_cmd_runtime_configure(struct coo_cmd_runtime *runtime,
 				      COO_CMD_SERIAL_WRAP_COLUMN;
 	runtime->command_specs = cfg->command_specs;
 	runtime->command_spec_count = cfg->command_spec_count;
+	runtime_build_spec_index(runtime);
 	runtime->lastcommand_nvs = cfg->lastcommand_nvs;
 	runtime->lastcommand_nvs_id = cfg->lastcommand_nvs_id;
 	runtime->user_data = cfg->user_data;
@@ -126,16 +168,88 @@ static bool coo_cmd_spec_key_matches(const struct coo_cmd_spec *spec,
 	return strcmp(key, spec->key) == 0;
 }
 
-const struct coo_cmd_spec *
-coo_cmd_runtime_find_spec(const struct coo_cmd_runtime *runtime,
-			  const char *key)
+/*
+ * Sort the spec pointers by key with a stable insertion sort, so equal keys
+ * keep table order and the first one still wins. Runs once per configure.
+ */
+static void runtime_build_spec_index(struct coo_cmd_runtime *runtime)
 {
-	const struct coo_cmd_spec *best = NULL;
-	size_t best_len = 0U;
+	size_t n = 0U;
 
-	if (runtime == NULL || key == NULL || runtime->command_specs == NULL) {
-		return NULL;
+	runtime->spec_index_count = 0U;
+	if (runtime->command_specs == NULL) {
+		return;
+	}
+	if (runtime->command_spec_count > ARRAY_SIZE(runtime->spec_index)) {
+		LOG_WRN("%zu command specs exceed the lookup index (%zu); using linear lookup",
+			runtime->command_spec_count, ARRAY_SIZE(runtime->spec_index));
+		return;
+	}
+
+	for (size_t i = 0U; i < runtime->command_spec_count; ++i) {
+		const struct coo_cmd_spec *spec = &runtime->command_specs[i];
+		size_t pos = n;
+
+		if (spec->key == NULL || spec->key[0] == '\0') {
+			continue;
+		}
+		while (pos > 0U && strcmp(runtime->spec_index[pos - 1U]->key, spec->key) > 0) {
+			runtime->spec_index[pos] = runtime->spec_index[pos - 1U];
+			pos--;
+		}
+		runtime->spec_index[pos] = spec;
+		n++;
+	}
+	runtime->spec_index_count = n;
+}
+
+/* Compare a spec key with the first @p len characters of @p key */
+static int spec_key_cmp(const char *spec_key, const char *key, size_t len)
+{
+	int rc = strncmp(spec_key, key, len);
+
+	if (rc != 0) {
+		return rc;
 	}
+	return spec_key[len] == '\0' ? 0 : 1;
+}
+
+/*
+ * First indexed spec whose key is exactly key[0..len) and that may match
+ * a key of which this is a @p whole key or only a prefix.
+ */
+static const struct coo_cmd_spec *spec_index_find(const struct coo_cmd_runtime *runtime,
+						  const char *key, size_t len,
+						  bool whole)
+{
+	size_t lo = 0U;
+	size_t hi = runtime->spec_index_count;
+
+	/* Lower bound, so duplicate keys are visited in table order */
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2U;
+
+		if (spec_key_cmp(runtime->spec_index[mid]->key, key, len) < 0) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+
+	for (; lo < runtime->spec_index_count &&
+	       spec_key_cmp(runtime->spec_index[lo]->key, key, len) == 0; ++lo) {
+		if (whole || runtime->spec_index[lo]->key_prefix_match) {
+			return runtime->spec_index[lo];
+		}
+	}
+	return NULL;
+}
+
+static const struct coo_cmd_spec *
+runtime_find_spec_linear(const struct coo_cmd_runtime *runtime, const char *key)
+{
+	const struct coo_cmd_spec *best = NULL;
+	size_t best_len = 0U;
 
 	for (size_t i = 0U; i < runtime->command_spec_count; ++i) {
 		const struct coo_cmd_spec *spec = &runtime->command_specs[i];
@@ -153,6 +267,40 @@ coo_cmd_runtime_find_spec(const struct coo_cmd_runtime *runtime,
 	return best;
 }
 
+const struct coo_cmd_spec *
+coo_cmd_runtime_find_spec(const struct coo_cmd_runtime *runtime,
+			  const char *key)
+{
+	size_t len;
+
+	if (runtime == NULL || key == NULL || runtime->command_specs == NULL) {
+		return NULL;
+	}
+	if (runtime->spec_index_count == 0U) {
+		return runtime_find_spec_linear(runtime, key);
+	}
+
+	/*
+	 * A spec key matches the whole key, or (with key_prefix_match) a
+	 * prefix that ends at a '/'. The candidates are few, so try each,
+	 * longest first, which is the longest-match rule of the linear scan.
+	 */
+	len = strlen(key);
+	while (len > 0U) {
+		const struct coo_cmd_spec *spec =
+			spec_index_find(runtime, key, len, key[len] == '\0');
+
+		if (spec != NULL) {
+			return spec;
+		}
+		do {
+			len--;
+		} while (len > 0U && key[len] != '/');
+	}
+
+	return NULL;
+}
+
 bool coo_cmd_runtime_spec_supported(const struct coo_cmd_runtime *runtime,
 				    const struct coo_cmd_spec *spec)
 {
@@ -224,6 +372,8 @@ static void runtime_load_lastcommand(struct coo_cmd_runtime *runtime)
 	runtime->lastcommand.valid = true;
 	runtime->lastcommand.time_ms = record.time_ms;
 	runtime->lastcommand.request = record.request;
+	/* The cached spec pointer is meaningless across a reboot */
+	runtime->lastcommand.request.spec = NULL;
 }
 
 static void runtime_record_lastcommand(struct coo_cmd_runtime *runtime,
@@ -242,6 +392,7 @@ static void runtime_record_lastcommand(struct coo_cmd_runtime *runtime,
 
 	record.time_ms = k_uptime_get();
 	record.request = *cmd;
+	record.request.spec = NULL;
 	runtime->lastcommand.valid = true;
 	runtime->lastcommand.time_ms = record.time_ms;
 	runtime->lastcommand.request = record.request;
@@ -1213,25 +1364,60 @@ static int runtime_build_warning(struct coo_cmd_response *out,
 	return 0;
 }
 
-static bool runtime_emit_scratch_take(struct coo_cmd_runtime *runtime)
+/*
+ * Request and response blocks come from the runtime's slabs and are never
+ * waited for: ingress, warnings and data publications run on producer
+ * threads that must not stall behind a slow outbound drain.
+ */
+static struct coo_cmd_request *runtime_request_alloc(struct coo_cmd_runtime *runtime)
 {
-	return runtime != NULL && atomic_cas(&runtime->emit_scratch_busy, 0, 1);
+	void *block;
+
+	if (k_mem_slab_alloc(runtime->request_slab, &block, K_NO_WAIT) != 0) {
+		return NULL;
+	}
+	return block;
 }
 
-static void runtime_emit_scratch_release(struct coo_cmd_runtime *runtime)
+static void runtime_request_free(struct coo_cmd_runtime *runtime,
+				 struct coo_cmd_request *cmd)
 {
-	if (runtime != NULL) {
-		(void)atomic_clear(&runtime->emit_scratch_busy);
+	k_mem_slab_free(runtime->request_slab, cmd);
+}
+
+static struct coo_cmd_response *runtime_response_alloc(struct coo_cmd_runtime *runtime)
+{
+	void *block;
+
+	if (runtime == NULL || runtime->response_slab == NULL ||
+	    k_mem_slab_alloc(runtime->response_slab, &block, K_NO_WAIT) != 0) {
+		return NULL;
 	}
+	return block;
+}
+
+static void runtime_response_free(struct coo_cmd_runtime *runtime,
+				  struct coo_cmd_response *out)
+{
+	k_mem_slab_free(runtime->response_slab, out);
+}
+
+/* Clear a request's fixed fields; the payload is written by its producer */
+static void runtime_request_clear(struct coo_cmd_request *cmd)
+{
+	memset(cmd, 0, offsetof(struct coo_cmd_request, payload));
+	cmd->payload[0] = '\0';
+	cmd->corr_len = 0U;
 }
 
 static int runtime_emit_queue(struct coo_cmd_runtime *runtime,
-			      const struct coo_cmd_response *out)
+			      struct coo_cmd_response *out)
 {
 	if (runtime == NULL || runtime->outbound_queue == NULL || out == NULL) {
 		return -EINVAL;
 	}
-	if (k_msgq_put(runtime->outbound_queue, out, K_NO_WAIT) != 0) {
+	if (k_msgq_put(runtime->outbound_queue, &out, K_NO_WAIT) != 0) {
+		runtime_response_free(runtime, out);
 		return -ENOSPC;
 	}
 	return 0;
@@ -1240,6 +1426,7 @@ static int runtime_emit_queue(struct coo_cmd_runtime *runtime,
 static int runtime_emit_data(struct coo_cmd_runtime *runtime,
 			     const struct coo_cmd_runtime_emit_args *args)
 {
+	const struct coo_cmd_response *src;
 	struct coo_cmd_response *out;
 	int rc;
 
@@ -1248,10 +1435,15 @@ static int runtime_emit_data(struct coo_cmd_runtime *runtime,
 		return -EINVAL;
 	}
 
-	out = args->out;
-	if (out->payload_len > sizeof(out->payload)) {
+	src = args->out;
+	if (src->payload_len > sizeof(src->payload)) {
+		return -ENOSPC;
+	}
+	out = runtime_response_alloc(runtime);
+	if (out == NULL) {
 		return -ENOSPC;
 	}
+
 	out->msg_type = COO_CMD_RESP_OK;
 	out->target = runtime_emit_target(args->delivery);
 	out->qos = 0U;
@@ -1259,8 +1451,15 @@ static int runtime_emit_data(struct coo_cmd_runtime *runtime,
 	rc = coo_cmd_format_data_topic(runtime->device_id, args->suffix,
 				       out->topic, sizeof(out->topic));
 	if (rc != 0) {
+		runtime_response_free(runtime, out);
 		return rc;
 	}
+	/* Data payloads may be binary: copy exactly payload_len bytes */
+	memcpy(out->payload, src->payload, src->payload_len);
+	if (src->payload_len < sizeof(out->payload)) {
+		out->payload[src->payload_len] = '\0';
+	}
+	out->payload_len = src->payload_len;
 
 	return runtime_emit_queue(runtime, out);
 }
@@ -1269,7 +1468,6 @@ static int runtime_emit_warning(struct coo_cmd_runtime *runtime,
 				const struct coo_cmd_runtime_emit_args *args)
 {
 	struct coo_cmd_response *out;
-	bool scratch = false;
 	int rc;
 
 	if (runtime == NULL || args == NULL || runtime->warning_topic[0] == '\0') {
@@ -1282,32 +1480,24 @@ static int runtime_emit_warning(struct coo_cmd_runtime *runtime,
 		args->context != NULL && args->context[0] != '\0' ? " context=" : "",
 		args->context != NULL ? args->context : "");
 
-	if (args->out != NULL) {
-		out = args->out;
-	} else if (runtime_emit_scratch_take(runtime)) {
-		out = &runtime->emit_scratch;
-		scratch = true;
-	} else {
-		LOG_WRN("warning scratch busy; warning was only logged locally");
-		return -EAGAIN;
+	out = runtime_response_alloc(runtime);
+	if (out == NULL) {
+		LOG_WRN("response pool empty; warning was only logged locally");
+		return -ENOSPC;
 	}
 
 	rc = runtime_build_warning(out, runtime->warning_topic, args->delivery,
 				   args->code, args->msg, args->context);
 	if (rc != 0) {
 		LOG_WRN("warning payload too large; MQTT warning dropped");
-		goto out;
+		runtime_response_free(runtime, out);
+		return rc;
 	}
 
 	rc = runtime_emit_queue(runtime, out);
 	if (rc != 0) {
 		LOG_WRN("warning MQTT queue full; warning was only logged locally");
 	}
-
-out:
-	if (scratch) {
-		runtime_emit_scratch_release(runtime);
-	}
 	return rc;
 }
 
@@ -1353,6 +1543,26 @@ static const struct coo_cmd_help_entry builtin_help_entries[] = {
 		.flags = COO_CMD_HELP_QUERY | COO_CMD_HELP_EFFECT |
 			 COO_CMD_HELP_SERIAL_GUARD_QUERY | COO_CMD_HELP_BUILTIN,
 	},
+#endif
+	{
+		.key = "mqttconn",
+		.usage = "mqttconn",
+		.args = "none",
+		.values = NULL,
+		.notes = "MQTT connects, failures, DNS cache use, backoff and time to reconnect",
+		.flags = COO_CMD_HELP_QUERY | COO_CMD_HELP_SERIAL_GUARD_QUERY |
+			 COO_CMD_HELP_BUILTIN,
+	},
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+	{
+		.key = "pubstats",
+		.usage = "pubstats [reset]",
+		.args = "optional reset flag",
+		.values = "reset: true zeroes the counters after reporting them",
+		.notes = "MQTT publish queue depth, drops, coalescing and latency",
+		.flags = COO_CMD_HELP_QUERY | COO_CMD_HELP_EFFECT |
+			 COO_CMD_HELP_SERIAL_GUARD_QUERY | COO_CMD_HELP_BUILTIN,
+	},
 #endif
 #if defined(CONFIG_COO_CMD_REBOOT)
 	{
@@ -1381,6 +1591,18 @@ static bool runtime_key_is_serial_guard(const char *key)
 #endif
 }
 
+static bool runtime_key_is_mqttconn(const char *key)
+{
+	return key != NULL && strcmp(key, "mqttconn") == 0;
+}
+
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+static bool runtime_key_is_pubstats(const char *key)
+{
+	return key != NULL && strcmp(key, "pubstats") == 0;
+}
+#endif
+
 static bool runtime_key_is_reboot(const char *key)
 {
 #if defined(CONFIG_COO_CMD_REBOOT)
@@ -1393,7 +1615,7 @@ static bool runtime_key_is_reboot(const char *key)
 
 static void serial_line_end(void)
 {
-	printk(COO_CMD_SERIAL_LINE_END);
+	serial_printf(COO_CMD_SERIAL_LINE_END);
 }
 
 static uint16_t serial_print_prefix(const char *prefix)
@@ -1401,7 +1623,7 @@ static uint16_t serial_print_prefix(const char *prefix)
 	uint16_t col = 0U;
 
 	for (const char *s = prefix != NULL ? prefix : ""; *s != '\0'; ++s) {
-		printk("%c", *s);
+		serial_printf("%c", *s);
 		col++;
 	}
 
@@ -1441,7 +1663,7 @@ static void serial_print_wrapped_text(const char *prefix,
 			continue;
 		}
 
-		printk("%c", at_space ? ' ' : *s);
+		serial_printf("%c", at_space ? ' ' : *s);
 		col++;
 		if (at_space) {
 			word_len = 0U;
@@ -1460,17 +1682,17 @@ static void serial_print_help_entry(const struct coo_cmd_runtime *runtime,
 		return;
 	}
 
-	printk("  %s", key);
+	serial_printf("  %s", key);
 	if (spec != NULL && !coo_cmd_runtime_spec_supported(runtime, spec)) {
-		printk(" [unsupported]");
+		serial_printf(" [unsupported]");
 	}
 	if ((entry->flags & COO_CMD_HELP_QUERY) != 0U &&
 	    (entry->flags & COO_CMD_HELP_EFFECT) != 0U) {
-		printk(" query/effect");
+		serial_printf(" query/effect");
 	} else if ((entry->flags & COO_CMD_HELP_QUERY) != 0U) {
-		printk(" query");
+		serial_printf(" query");
 	} else if ((entry->flags & COO_CMD_HELP_EFFECT) != 0U) {
-		printk(" effect");
+		serial_printf(" effect");
 	}
 	serial_line_end();
 
@@ -1487,13 +1709,13 @@ static void runtime_print_serial_help(const struct coo_cmd_runtime *runtime,
 		wrap_column = COO_CMD_SERIAL_WRAP_COLUMN;
 	}
 
-	printk("serial help");
+	serial_printf("serial help");
 	serial_line_end();
-	printk("  device: %s", runtime != NULL ? runtime->device_id : "");
+	serial_printf("  device: %s", runtime != NULL ? runtime->device_id : "");
 	serial_line_end();
-	printk("  request prefix: %s", runtime != NULL ? runtime->request_prefix : "");
+	serial_printf("  request prefix: %s", runtime != NULL ? runtime->request_prefix : "");
 	serial_line_end();
-	printk("  [] marks optional payload fields or serial tokens");
+	serial_printf("  [] marks optional payload fields or serial tokens");
 	serial_line_end();
 
 	for (size_t i = 0U; i < ARRAY_SIZE(builtin_help_entries); ++i) {
@@ -1641,11 +1863,21 @@ static bool runtime_mqtt_allowed_during_serial_guard(struct coo_cmd_runtime *run
 		return true;
 	}
 
+	if (runtime_key_is_mqttconn(cmd->key)) {
+		return cmd->msg_type == COO_CMD_QUERY;
+	}
+
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+	if (runtime_key_is_pubstats(cmd->key)) {
+		return cmd->msg_type == COO_CMD_QUERY;
+	}
+#endif
+
 	if (cmd->msg_type != COO_CMD_QUERY) {
 		return false;
 	}
 
-	spec = coo_cmd_runtime_find_spec(runtime, cmd->key);
+	spec = cmd->spec;
 	return spec != NULL &&
 	       spec->query_handler != NULL &&
 	       spec->mqtt_query_allowed_during_serial_guard;
@@ -1681,6 +1913,7 @@ static int runtime_serial_guard_set(struct coo_cmd_runtime *runtime,
 				    const struct coo_cmd_request *cmd,
 				    struct coo_cmd_response *out)
 {
+	struct coo_json_doc doc;
 	uint32_t holdoff_s = 0U;
 	bool was_active;
 	bool persist = false;
@@ -1692,8 +1925,12 @@ static int runtime_serial_guard_set(struct coo_cmd_runtime *runtime,
 		return coo_cmd_error(out, cmd, "serial guard unavailable");
 	}
 
-	parse_rc_seconds = coo_json_extract_u32(cmd->payload, "seconds", &holdoff_s);
-	parse_rc_value = coo_json_extract_u32(cmd->payload, "value", &holdoff_s);
+	if (coo_json_doc_parse(&doc, cmd->payload, NULL, NULL, 0U) != 0) {
+		return coo_cmd_error(out, cmd, "invalid seconds");
+	}
+
+	parse_rc_seconds = coo_json_doc_get_u32(&doc, "seconds", &holdoff_s);
+	parse_rc_value = coo_json_doc_get_u32(&doc, "value", &holdoff_s);
 	if (parse_rc_seconds == COO_JSON_EXTRACT_ERR ||
 	    parse_rc_value == COO_JSON_EXTRACT_ERR) {
 		return coo_cmd_error(out, cmd, "invalid seconds");
@@ -1703,7 +1940,7 @@ static int runtime_serial_guard_set(struct coo_cmd_runtime *runtime,
 		return coo_cmd_error(out, cmd, "missing seconds");
 	}
 
-	parse_rc_persist = coo_json_extract_bool(cmd->payload, "persist", &persist);
+	parse_rc_persist = coo_json_doc_get_bool(&doc, "persist", &persist);
 	if (parse_rc_persist != COO_JSON_EXTRACT_MISSING) {
 		return coo_cmd_error(out, cmd, "serialguard persistence unsupported");
 	}
@@ -1822,6 +2059,53 @@ static int runtime_reboot_set(struct coo_cmd_runtime *runtime,
 }
 #endif
 
+static int runtime_mqttconn(const struct coo_cmd_request *cmd,
+			    struct coo_cmd_response *out)
+{
+	struct coo_mqtt_connection_stats stats;
+
+	if (cmd->msg_type != COO_CMD_QUERY) {
+		return coo_cmd_error(out, cmd, "mqttconn is read-only");
+	}
+
+	coo_mqtt_get_connection_stats(&stats);
+	if (coo_mqtt_format_connection_stats(&stats, out->payload,
+					     sizeof(out->payload)) != 0) {
+		return coo_cmd_error(out, cmd, "response too large");
+	}
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, out->payload);
+}
+
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+static int runtime_pubstats(const struct coo_cmd_request *cmd,
+			    struct coo_cmd_response *out)
+{
+	struct coo_mqtt_publish_stats stats;
+	char value[16] = {0};
+	bool reset = false;
+
+	/* {"reset":true} over MQTT, or "pubstats reset" on serial */
+	if (cmd->msg_type == COO_CMD_EFFECT &&
+	    coo_json_extract_bool(cmd->payload, "reset", &reset) != COO_JSON_EXTRACT_OK) {
+		reset = coo_json_extract_string(cmd->payload, "value", value,
+						sizeof(value)) == COO_JSON_EXTRACT_OK &&
+			strcasecmp(value, "reset") == 0;
+	}
+	if (cmd->msg_type == COO_CMD_EFFECT && !reset) {
+		return coo_cmd_error(out, cmd, "invalid reset");
+	}
+
+	coo_mqtt_get_publish_stats(&stats);
+	if (reset) {
+		coo_mqtt_reset_publish_stats();
+	}
+	if (coo_mqtt_format_publish_stats(&stats, out->payload, sizeof(out->payload)) != 0) {
+		return coo_cmd_error(out, cmd, "response too large");
+	}
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, out->payload);
+}
+#endif
+
 static bool runtime_handle_builtin_request(struct coo_cmd_runtime *runtime,
 					   const struct coo_cmd_request *cmd,
 					   struct coo_cmd_response *out)
@@ -1853,6 +2137,18 @@ static bool runtime_handle_builtin_request(struct coo_cmd_runtime *runtime,
 	}
 #endif
 
+	if (runtime_key_is_mqttconn(cmd->key)) {
+		(void)runtime_mqttconn(cmd, out);
+		return true;
+	}
+
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+	if (runtime_key_is_pubstats(cmd->key)) {
+		(void)runtime_pubstats(cmd, out);
+		return true;
+	}
+#endif
+
 #if defined(CONFIG_COO_CMD_REBOOT)
 	if (runtime_key_is_reboot(cmd->key)) {
 		(void)runtime_reboot_set(runtime, cmd, out);
@@ -1885,7 +2181,11 @@ int coo_cmd_publish_mqtt(struct mqtt_client *client,
 	param.dup_flag = 0U;
 	param.retain_flag = 0U;
 
-	return mqtt_publish(client, &param);
+	COO_TRACE_BEGIN(publish_start);
+	int rc = mqtt_publish(client, &param);
+
+	COO_TRACE_END(COO_TRACE_MQTT_PUBLISH, publish_start);
+	return rc;
 }
 
 static int runtime_execute_default(struct coo_cmd_runtime *runtime,
@@ -1905,7 +2205,7 @@ static int runtime_execute_default(struct coo_cmd_runtime *runtime,
 	}
 #endif
 
-	spec = coo_cmd_runtime_find_spec(runtime, cmd->key);
+	spec = cmd->spec;
 	LOG_INF("Dispatching: %s", cmd->key);
 	if (spec == NULL) {
 		return coo_cmd_unknown_response(out, cmd);
@@ -1952,12 +2252,17 @@ void coo_cmd_runtime_executor_thread(void *p1, void *p2, void *p3)
 		return;
 	}
 
-	cmd = &runtime->executor_cmd;
-	out = &runtime->executor_out;
-
 	while (1) {
 		/* K_FOREVER sleeps until ingress queues a complete command. */
-		k_msgq_get(runtime->inbound_queue, cmd, K_FOREVER);
+		k_msgq_get(runtime->inbound_queue, &cmd, K_FOREVER);
+
+		/* A full outbound pool must not stop an effect from running */
+		out = runtime_response_alloc(runtime);
+		if (out == NULL) {
+			out = &runtime->executor_overflow;
+		}
+
+		COO_TRACE_BEGIN(command_start);
 		if (runtime_handle_builtin_request(runtime, cmd, out)) {
 			/* Built-ins stay library-owned even when the app provides a
 			 * custom executor hook.
@@ -1967,8 +2272,13 @@ void coo_cmd_runtime_executor_thread(void *p1, void *p2, void *p3)
 		} else {
 			(void)runtime_execute_default(runtime, cmd, out);
 		}
-		if (k_msgq_put(runtime->outbound_queue, out, K_NO_WAIT) != 0) {
+		COO_TRACE_END(COO_TRACE_COMMAND, command_start);
+		runtime_request_free(runtime, cmd);
+
+		if (out == &runtime->executor_overflow) {
 			LOG_WRN("Outbound queue full; dropping command response");
+		} else {
+			runtime_enqueue_response(runtime, out);
 		}
 	}
 }
@@ -1986,7 +2296,7 @@ static enum coo_cmd_msg_type runtime_classify(struct coo_cmd_runtime *runtime,
 		return COO_CMD_EFFECT;
 	}
 
-	spec = coo_cmd_runtime_find_spec(runtime, cmd->key);
+	spec = cmd->spec;
 	if (spec != NULL) {
 		switch (spec->class_policy) {
 		case COO_CMD_CLASS_ALWAYS_QUERY:
@@ -2013,16 +2323,32 @@ static enum coo_cmd_msg_type runtime_classify(struct coo_cmd_runtime *runtime,
 	return coo_cmd_payload_empty(cmd) ? COO_CMD_QUERY : COO_CMD_EFFECT;
 }
 
+/* Queue a pooled response; ownership passes to the outbound drain. */
 static void runtime_enqueue_response(struct coo_cmd_runtime *runtime,
-				     const struct coo_cmd_response *out)
+				     struct coo_cmd_response *out)
 {
 	if (runtime == NULL || runtime->outbound_queue == NULL || out == NULL) {
 		return;
 	}
 
-	if (k_msgq_put(runtime->outbound_queue, out, K_NO_WAIT) != 0) {
+	if (k_msgq_put(runtime->outbound_queue, &out, K_NO_WAIT) != 0) {
+		LOG_WRN("Outbound queue full; dropping immediate command response");
+		runtime_response_free(runtime, out);
+	}
+}
+
+/*
+ * Pooled response for an error reply built on an ingress thread, or NULL
+ * (logged) when every response block is already waiting for the drain.
+ */
+static struct coo_cmd_response *runtime_ingress_response(struct coo_cmd_runtime *runtime)
+{
+	struct coo_cmd_response *out = runtime_response_alloc(runtime);
+
+	if (out == NULL) {
 		LOG_WRN("Outbound queue full; dropping immediate command response");
 	}
+	return out;
 }
 
 static void runtime_enqueue_serial_error(struct coo_cmd_runtime *runtime, const char *msg)
@@ -2033,8 +2359,12 @@ static void runtime_enqueue_serial_error(struct coo_cmd_runtime *runtime, const
 		return;
 	}
 
-	out = &runtime->outbound_scratch;
-	memset(out, 0, sizeof(*out));
+	out = runtime_ingress_response(runtime);
+	if (out == NULL) {
+		return;
+	}
+	memset(out, 0, offsetof(struct coo_cmd_response, payload));
+	out->corr_len = 0U;
 	out->target = COO_CMD_OUT_SERIAL;
 	out->msg_type = COO_CMD_RESP_ERROR;
 	out->qos = MQTT_QOS_1_AT_LEAST_ONCE;
@@ -2097,13 +2427,18 @@ void coo_cmd_runtime_handle_serial_line(struct coo_cmd_runtime *runtime, char *l
 		return;
 	}
 
-	cmd = &runtime->ingress_cmd;
-	memset(cmd, 0, sizeof(*cmd));
+	cmd = runtime_request_alloc(runtime);
+	if (cmd == NULL) {
+		runtime_enqueue_serial_error(runtime, "busy");
+		return;
+	}
+	runtime_request_clear(cmd);
 	cmd->source = COO_CMD_SOURCE_SERIAL;
 	strncpy(cmd->key, key, sizeof(cmd->key) - 1U);
 	if (coo_cmd_format_response_topic(runtime->device_id, cmd->key,
 					  cmd->response_topic,
 					  sizeof(cmd->response_topic)) != 0) {
+		runtime_request_free(runtime, cmd);
 		runtime_enqueue_serial_error(runtime, "invalid command key");
 		return;
 	}
@@ -2111,17 +2446,23 @@ void coo_cmd_runtime_handle_serial_line(struct coo_cmd_runtime *runtime, char *l
 	if (runtime_normalize_serial_payload(spec, cmd->key, payload,
 					     runtime->user_data, cmd->payload,
 					     sizeof(cmd->payload)) != 0) {
+		runtime_request_free(runtime, cmd);
 		runtime_enqueue_serial_error(runtime, "invalid serial payload");
 		return;
 	}
 	cmd->payload_len = strlen(cmd->payload);
+	cmd->spec = spec;
 	cmd->msg_type = runtime_classify(runtime, cmd);
 
-	if (k_msgq_put(runtime->inbound_queue, cmd, K_NO_WAIT) != 0) {
-		struct coo_cmd_response *out = &runtime->outbound_scratch;
+	/* Queue depth matches the request slab, so this only fails if misconfigured */
+	if (k_msgq_put(runtime->inbound_queue, &cmd, K_NO_WAIT) != 0) {
+		struct coo_cmd_response *out = runtime_ingress_response(runtime);
 
-		(void)coo_cmd_busy_response(out, cmd);
-		runtime_enqueue_response(runtime, out);
+		if (out != NULL) {
+			(void)coo_cmd_busy_response(out, cmd);
+			runtime_enqueue_response(runtime, out);
+		}
+		runtime_request_free(runtime, cmd);
 	}
 }
 
@@ -2132,6 +2473,7 @@ static void serial_reset_line(struct coo_cmd_runtime *runtime)
 	runtime->serial_line_overflow = false;
 }
 
+#if !defined(CONFIG_COO_SERIAL_UART_ASYNC)
 static void serial_accept_char(struct coo_cmd_runtime *runtime, char ch)
 {
 	if (ch == '\r' || ch == '\n') {
@@ -2165,6 +2507,7 @@ static void serial_accept_char(struct coo_cmd_runtime *runtime, char ch)
 	runtime->serial_line[runtime->serial_line_len++] = ch;
 	runtime->serial_line[runtime->serial_line_len] = '\0';
 }
+#endif
 
 static int runtime_init_serial_console(struct coo_cmd_runtime *runtime)
 {
@@ -2174,12 +2517,19 @@ static int runtime_init_serial_console(struct coo_cmd_runtime *runtime)
 		return -EINVAL;
 	}
 
+#if defined(CONFIG_COO_SERIAL_UART_ASYNC)
+	rc = coo_serial_uart_init();
+	if (rc != 0) {
+		return rc;
+	}
+#else
 	rc = console_init();
 	if (rc != 0) {
 		return rc;
 	}
 
 	console_set_rx_timeout(K_NO_WAIT);
+#endif
 	serial_reset_line(runtime);
 	runtime->serial_initialized = true;
 	return 0;
@@ -2187,6 +2537,29 @@ static int runtime_init_serial_console(struct coo_cmd_runtime *runtime)
 
 void coo_cmd_runtime_serial_poll(struct coo_cmd_runtime *runtime)
 {
+#if defined(CONFIG_COO_SERIAL_UART_ASYNC)
+	int budget = SERIAL_POLL_LINE_BUDGET;
+
+	if (runtime == NULL || !runtime->serial_initialized) {
+		return;
+	}
+
+	/* The UART callback has already assembled whole lines */
+	while (budget-- > 0) {
+		int len = coo_serial_uart_read_line(runtime->serial_line,
+						    sizeof(runtime->serial_line));
+
+		if (len == -EAGAIN) {
+			break;
+		}
+		if (len == -EMSGSIZE) {
+			runtime_enqueue_serial_error(runtime, "serial line too long");
+		} else if (len > 0) {
+			coo_cmd_runtime_handle_serial_line(runtime, runtime->serial_line);
+		}
+		serial_reset_line(runtime);
+	}
+#else
 	int budget = SERIAL_POLL_CHAR_BUDGET;
 
 	if (runtime == NULL || !runtime->serial_initialized) {
@@ -2207,12 +2580,79 @@ void coo_cmd_runtime_serial_poll(struct coo_cmd_runtime *runtime)
 		}
 		break;
 	}
+#endif
 }
 
-void coo_cmd_runtime_handle_mqtt_publish(struct coo_cmd_runtime *runtime,
-					 const struct mqtt_publish_param *pub)
+/*
+ * Zephyr's MQTT client will not process further input until a publish
+ * payload has been read, so a reader-mode publish that is rejected before
+ * its payload is copied must still be drained.
+ */
+static void runtime_mqtt_skip_payload(struct mqtt_client *client,
+				      const struct mqtt_publish_param *pub)
+{
+	uint8_t discard[64];
+	size_t left;
+
+	if (client == NULL || pub == NULL) {
+		return;
+	}
+
+	left = pub->message.payload.len;
+	while (left > 0U) {
+		size_t chunk = MIN(left, sizeof(discard));
+
+		if (mqtt_readall_publish_payload(client, discard, chunk) != 0) {
+			LOG_WRN("Failed to discard MQTT payload");
+			return;
+		}
+		left -= chunk;
+	}
+}
+
+/* Busy reply for a publish that found no free request block */
+static void runtime_mqtt_busy(struct coo_cmd_runtime *runtime,
+			      const struct mqtt_publish_param *pub,
+			      const char *key)
+{
+	struct coo_cmd_response *out = runtime_ingress_response(runtime);
+
+	if (out == NULL) {
+		return;
+	}
+
+	(void)coo_cmd_reply(out, NULL, COO_CMD_RESP_ERROR, "{\"error\":\"busy\"}");
+	if (pub->prop.response_topic.utf8 != NULL &&
+	    pub->prop.response_topic.size > 0U &&
+	    pub->prop.response_topic.size < sizeof(out->topic)) {
+		memcpy(out->topic, pub->prop.response_topic.utf8,
+		       pub->prop.response_topic.size);
+		out->topic[pub->prop.response_topic.size] = '\0';
+	} else if (coo_cmd_format_response_topic(runtime->device_id, key,
+						 out->topic, sizeof(out->topic)) != 0) {
+		runtime_response_free(runtime, out);
+		return;
+	}
+	if (pub->prop.correlation_data.len > 0U &&
+	    pub->prop.correlation_data.len <= sizeof(out->correlation_data)) {
+		memcpy(out->correlation_data, pub->prop.correlation_data.data,
+		       pub->prop.correlation_data.len);
+		out->corr_len = pub->prop.correlation_data.len;
+	}
+	runtime_enqueue_response(runtime, out);
+}
+
+/*
+ * Turn one MQTT publish into a pooled request. With @p client set the
+ * payload is still unread and goes straight from the client into the
+ * request; otherwise it is copied from pub->message.payload.
+ */
+static void runtime_ingress_mqtt(struct coo_cmd_runtime *runtime,
+				 struct mqtt_client *client,
+				 const struct mqtt_publish_param *pub)
 {
 	struct coo_cmd_request *cmd;
+	struct coo_cmd_response *out;
 	char req_topic[COO_CMD_TOPIC_MAX];
 	const char *suffix;
 	size_t prefix_len;
@@ -2221,47 +2661,61 @@ void coo_cmd_runtime_handle_mqtt_publish(struct coo_cmd_runtime *runtime,
 	if (runtime == NULL || pub == NULL ||
 	    !coo_cmd_copy_mqtt_utf8(&pub->message.topic.topic,
 				    req_topic, sizeof(req_topic))) {
+		runtime_mqtt_skip_payload(client, pub);
 		return;
 	}
-	cmd = &runtime->ingress_cmd;
-	memset(cmd, 0, sizeof(*cmd));
 
 	prefix_len = strlen(runtime->request_prefix);
 	if (prefix_len == 0U ||
 	    strncmp(req_topic, runtime->request_prefix, prefix_len) != 0) {
+		runtime_mqtt_skip_payload(client, pub);
 		return;
 	}
 
 	suffix = req_topic + prefix_len;
 	suffix_len = strlen(suffix);
-	if (suffix_len == 0U || suffix_len >= sizeof(cmd->key)) {
+	if (suffix_len == 0U || suffix_len >= COO_CMD_KEY_MAX) {
 		LOG_WRN("Invalid MQTT command topic suffix");
+		runtime_mqtt_skip_payload(client, pub);
+		return;
+	}
+
+	cmd = runtime_request_alloc(runtime);
+	if (cmd == NULL) {
+		runtime_mqtt_skip_payload(client, pub);
+		runtime_mqtt_busy(runtime, pub, suffix);
 		return;
 	}
+	runtime_request_clear(cmd);
 
 	cmd->source = COO_CMD_SOURCE_MQTT;
 	memcpy(cmd->key, suffix, suffix_len);
 	cmd->key[suffix_len] = '\0';
+	cmd->spec = coo_cmd_runtime_find_spec(runtime, cmd->key);
 
-		if (coo_cmd_format_response_topic(runtime->device_id, cmd->key,
-						  cmd->response_topic,
-						  sizeof(cmd->response_topic)) != 0) {
-			struct coo_cmd_response *out = &runtime->outbound_scratch;
-
+	if (coo_cmd_format_response_topic(runtime->device_id, cmd->key,
+					  cmd->response_topic,
+					  sizeof(cmd->response_topic)) != 0) {
+		runtime_mqtt_skip_payload(client, pub);
+		out = runtime_ingress_response(runtime);
+		if (out != NULL) {
 			(void)coo_cmd_invalid_response(out, cmd);
 			runtime_enqueue_response(runtime, out);
-			return;
 		}
+		goto drop;
+	}
 
-		if (pub->retain_flag != 0U) {
-			struct coo_cmd_response *out = &runtime->outbound_scratch;
-
+	if (pub->retain_flag != 0U) {
+		runtime_mqtt_skip_payload(client, pub);
+		LOG_WRN("Ignoring retained MQTT command '%s'", cmd->key);
+		out = runtime_ingress_response(runtime);
+		if (out != NULL) {
 			(void)coo_cmd_reply(out, cmd, COO_CMD_RESP_ERROR,
 					    "{\"error\":\"retained MQTT command ignored\"}");
-			LOG_WRN("Ignoring retained MQTT command '%s'", cmd->key);
 			runtime_enqueue_response(runtime, out);
-			return;
 		}
+		goto drop;
+	}
 
 	if (pub->prop.response_topic.utf8 != NULL &&
 	    pub->prop.response_topic.size > 0U &&
@@ -2271,17 +2725,37 @@ void coo_cmd_runtime_handle_mqtt_publish(struct coo_cmd_runtime *runtime,
 		cmd->response_topic[pub->prop.response_topic.size] = '\0';
 	}
 
-		if (pub->message.payload.len >= sizeof(cmd->payload)) {
-			struct coo_cmd_response *out = &runtime->outbound_scratch;
+	if (pub->prop.correlation_data.len > 0U &&
+	    pub->prop.correlation_data.len <= sizeof(cmd->correlation_data)) {
+		memcpy(cmd->correlation_data, pub->prop.correlation_data.data,
+		       pub->prop.correlation_data.len);
+		cmd->corr_len = pub->prop.correlation_data.len;
+	} else if (pub->prop.correlation_data.len > sizeof(cmd->correlation_data)) {
+		LOG_WRN("MQTT correlation_data too long (%zu > %zu); response will not echo it",
+			pub->prop.correlation_data.len, sizeof(cmd->correlation_data));
+	}
 
+	if (pub->message.payload.len >= sizeof(cmd->payload)) {
+		runtime_mqtt_skip_payload(client, pub);
+		out = runtime_ingress_response(runtime);
+		if (out != NULL) {
 			(void)coo_cmd_invalid_response(out, cmd);
 			runtime_enqueue_response(runtime, out);
-			return;
 		}
+		goto drop;
+	}
 
 	if (pub->message.payload.len > 0U) {
-		memcpy(cmd->payload, pub->message.payload.data,
-		       pub->message.payload.len);
+		if (client != NULL) {
+			if (mqtt_readall_publish_payload(client, (uint8_t *)cmd->payload,
+							 pub->message.payload.len) != 0) {
+				LOG_ERR("Failed to read received MQTT payload");
+				goto drop;
+			}
+		} else {
+			memcpy(cmd->payload, pub->message.payload.data,
+			       pub->message.payload.len);
+		}
 		cmd->payload[pub->message.payload.len] = '\0';
 		cmd->payload_len = pub->message.payload.len;
 	} else {
@@ -2290,42 +2764,45 @@ void coo_cmd_runtime_handle_mqtt_publish(struct coo_cmd_runtime *runtime,
 	}
 	cmd->msg_type = runtime_classify(runtime, cmd);
 
-	if (pub->prop.correlation_data.len > 0U &&
-	    pub->prop.correlation_data.len <= sizeof(cmd->correlation_data)) {
-		memcpy(cmd->correlation_data, pub->prop.correlation_data.data,
-		       pub->prop.correlation_data.len);
-		cmd->corr_len = pub->prop.correlation_data.len;
-	} else if (pub->prop.correlation_data.len > sizeof(cmd->correlation_data)) {
-		LOG_WRN("MQTT correlation_data too long (%zu > %zu); response will not echo it",
-			pub->prop.correlation_data.len, sizeof(cmd->correlation_data));
-	}
-
 #if defined(CONFIG_COO_CMD_SERIAL_GUARD)
-		if (!runtime_mqtt_allowed_during_serial_guard(runtime, cmd)) {
-			struct coo_cmd_response *out = &runtime->outbound_scratch;
-
+	if (!runtime_mqtt_allowed_during_serial_guard(runtime, cmd)) {
+		LOG_WRN("Rejecting MQTT command '%s': local serial control is active", cmd->key);
+		out = runtime_ingress_response(runtime);
+		if (out != NULL) {
 			(void)coo_cmd_serial_active_response(out, cmd);
-			LOG_WRN("Rejecting MQTT command '%s': local serial control is active", cmd->key);
 			runtime_enqueue_response(runtime, out);
-			(void)coo_cmd_runtime_emit(
-				runtime,
-				&(const struct coo_cmd_runtime_emit_args){
-					.type = COO_CMD_RUNTIME_EMIT_WARNING,
-					.delivery = COO_CMD_RUNTIME_EMIT_BEST_EFFORT,
-					.code = "serial_guard_active",
-					.msg = "MQTT command rejected while serial command guard is active",
-					.context = cmd->key,
-				});
-		return;
+		}
+		(void)coo_cmd_runtime_emit(
+			runtime,
+			&(const struct coo_cmd_runtime_emit_args){
+				.type = COO_CMD_RUNTIME_EMIT_WARNING,
+				.delivery = COO_CMD_RUNTIME_EMIT_BEST_EFFORT,
+				.code = "serial_guard_active",
+				.msg = "MQTT command rejected while serial command guard is active",
+				.context = cmd->key,
+			});
+		goto drop;
 	}
 #endif
 
-	if (k_msgq_put(runtime->inbound_queue, cmd, K_NO_WAIT) != 0) {
-		struct coo_cmd_response *out = &runtime->outbound_scratch;
-
+	/* Queue depth matches the request slab, so this only fails if misconfigured */
+	if (k_msgq_put(runtime->inbound_queue, &cmd, K_NO_WAIT) == 0) {
+		return;
+	}
+	out = runtime_ingress_response(runtime);
+	if (out != NULL) {
 		(void)coo_cmd_busy_response(out, cmd);
 		runtime_enqueue_response(runtime, out);
 	}
+
+drop:
+	runtime_request_free(runtime, cmd);
+}
+
+void coo_cmd_runtime_handle_mqtt_publish(struct coo_cmd_runtime *runtime,
+					 const struct mqtt_publish_param *pub)
+{
+	runtime_ingress_mqtt(runtime, NULL, pub);
 }
 
 void coo_cmd_runtime_mqtt_callback(const struct mqtt_publish_param *pub,
@@ -2334,6 +2811,13 @@ void coo_cmd_runtime_mqtt_callback(const struct mqtt_publish_param *pub,
 	coo_cmd_runtime_handle_mqtt_publish(user_data, pub);
 }
 
+void coo_cmd_runtime_mqtt_reader(struct mqtt_client *client,
+				 const struct mqtt_publish_param *pub,
+				 void *user_data)
+{
+	runtime_ingress_mqtt(user_data, client, pub);
+}
+
 void coo_cmd_runtime_drain_outbound(struct coo_cmd_runtime *runtime,
 				    struct mqtt_client *client,
 				    bool mqtt_available)
@@ -2349,7 +2833,6 @@ void coo_cmd_runtime_drain_outbound(struct coo_cmd_runtime *runtime,
 	}
 	wrap_column = runtime->serial_wrap_column != 0U ?
 		runtime->serial_wrap_column : COO_CMD_SERIAL_WRAP_COLUMN;
-	out = &runtime->outbound_scratch;
 
 	outbound_full = (k_msgq_num_free_get(runtime->outbound_queue) == 0U);
 	if (outbound_full) {
@@ -2361,22 +2844,29 @@ void coo_cmd_runtime_drain_outbound(struct coo_cmd_runtime *runtime,
 		runtime->outbound_full_warning_seen = false;
 	}
 
+	/*
+	 * Responses are dequeued by pointer. A message is either freed once it
+	 * is printed, published or dropped, or put back (by pointer) for retry.
+	 */
 	while (budget-- > 0 &&
-	       k_msgq_get(runtime->outbound_queue, out, K_NO_WAIT) == 0) {
+	       k_msgq_get(runtime->outbound_queue, &out, K_NO_WAIT) == 0) {
 		const bool best_effort = (out->target == COO_CMD_OUT_MQTT_BEST_EFFORT);
 
 		if (out->target == COO_CMD_OUT_SERIAL) {
 			coo_cmd_print_serial_response_pretty(out, wrap_column);
+			runtime_response_free(runtime, out);
 			continue;
 		}
 
 		if (!mqtt_available) {
 			if (best_effort) {
 				LOG_DBG("Dropping best-effort MQTT msg while MQTT unavailable");
+				runtime_response_free(runtime, out);
 				continue;
 			}
-			if (k_msgq_put(runtime->outbound_queue, out, K_NO_WAIT) != 0) {
+			if (k_msgq_put(runtime->outbound_queue, &out, K_NO_WAIT) != 0) {
 				LOG_WRN("Dropping MQTT msg (queue full while requeueing)");
+				runtime_response_free(runtime, out);
 			}
 			continue;
 		}
@@ -2384,14 +2874,17 @@ void coo_cmd_runtime_drain_outbound(struct coo_cmd_runtime *runtime,
 		if (coo_cmd_publish_mqtt(client, out, runtime->mqtt_msg_id) != 0) {
 			if (best_effort) {
 				LOG_WRN("Best-effort MQTT publish failed; dropping msg");
+				runtime_response_free(runtime, out);
 				continue;
 			}
 			LOG_WRN("MQTT publish failed; will retry");
-			if (k_msgq_put(runtime->outbound_queue, out, K_NO_WAIT) != 0) {
+			if (k_msgq_put(runtime->outbound_queue, &out, K_NO_WAIT) != 0) {
 				LOG_WRN("Dropping MQTT msg (queue full after publish failure)");
+				runtime_response_free(runtime, out);
 			}
 			break;
 		}
+		runtime_response_free(runtime, out);
 	}
 }
 
@@ -2405,7 +2898,7 @@ void coo_cmd_print_serial_response(const struct coo_cmd_response *out,
 		return;
 	}
 
-	printk("%s" COO_CMD_SERIAL_LINE_END "        ",
+	serial_printf("%s" COO_CMD_SERIAL_LINE_END "        ",
 	       out->topic[0] != '\0' ? out->topic : "serial");
 	col = 8U;
 	len = out->payload_len > 0U ? out->payload_len : strlen(out->payload);
@@ -2418,25 +2911,25 @@ void coo_cmd_print_serial_response(const struct coo_cmd_response *out,
 		}
 
 		if (ch == '\n' || (wrap_column != 0U && col >= wrap_column)) {
-			printk(COO_CMD_SERIAL_LINE_END "        ");
+			serial_printf(COO_CMD_SERIAL_LINE_END "        ");
 			col = 8U;
 			if (ch == '\n') {
 				continue;
 			}
 		}
 
-		printk("%c", ch);
+		serial_printf("%c", ch);
 		col++;
 
 		if (wrap_column != 0U &&
 		    (ch == ',' || ch == '}') && col >= (wrap_column - 8U) &&
 		    i + 1U < len) {
-			printk(COO_CMD_SERIAL_LINE_END "        ");
+			serial_printf(COO_CMD_SERIAL_LINE_END "        ");
 			col = 8U;
 		}
 	}
 
-	printk(COO_CMD_SERIAL_LINE_END);
+	serial_printf(COO_CMD_SERIAL_LINE_END);
 }
 
 static const char *serial_payload_start(const char *payload)
@@ -2450,13 +2943,13 @@ static const char *serial_payload_start(const char *payload)
 
 static void serial_response_newline_indent(uint8_t indent, uint16_t *col)
 {
-	printk(COO_CMD_SERIAL_LINE_END);
+	serial_printf(COO_CMD_SERIAL_LINE_END);
 	*col = 8U;
 	for (uint8_t i = 0U; i < 8U; ++i) {
-		printk(" ");
+		serial_printf(" ");
 	}
 	for (uint8_t i = 0U; i < indent; ++i) {
-		printk("  ");
+		serial_printf("  ");
 		*col += 2U;
 	}
 }
@@ -2543,7 +3036,7 @@ static bool serial_print_json_scalar_array(const char *payload, size_t start,
 		const char ch = payload[i];
 
 		if (in_string) {
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			(*col)++;
 			if (escaped) {
 				escaped = false;
@@ -2563,16 +3056,16 @@ static bool serial_print_json_scalar_array(const char *payload, size_t start,
 
 		if (ch == '"') {
 			in_string = true;
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			(*col)++;
 		} else if (ch == ',') {
-			printk(", ");
+			serial_printf(", ");
 			*col += 2U;
 		} else {
 			if ((unsigned char)ch < 0x20U) {
 				return false;
 			}
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			(*col)++;
 		}
 	}
@@ -2593,7 +3086,7 @@ static bool serial_print_json_payload(const char *payload, size_t len)
 		const char ch = payload[i];
 
 		if (in_string) {
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			col++;
 			if (escaped) {
 				escaped = false;
@@ -2615,14 +3108,14 @@ static bool serial_print_json_payload(const char *payload, size_t len)
 		switch (ch) {
 		case '"':
 			in_string = true;
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			col++;
 			break;
 		case '{':
 			if (!json_stack_push(stack, sizeof(stack), &depth, '}')) {
 				return false;
 			}
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			col++;
 			serial_response_newline_indent(depth, &col);
 			break;
@@ -2640,7 +3133,7 @@ static bool serial_print_json_payload(const char *payload, size_t len)
 			if (!json_stack_push(stack, sizeof(stack), &depth, ']')) {
 				return false;
 			}
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			col++;
 			serial_response_newline_indent(depth, &col);
 			break;
@@ -2651,23 +3144,23 @@ static bool serial_print_json_payload(const char *payload, size_t len)
 				return false;
 			}
 			serial_response_newline_indent(depth, &col);
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			col++;
 			break;
 		case ',':
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			col++;
 			serial_response_newline_indent(depth, &col);
 			break;
 		case ':':
-			printk(": ");
+			serial_printf(": ");
 			col += 2U;
 			break;
 		default:
 			if ((unsigned char)ch < 0x20U) {
 				return false;
 			}
-			printk("%c", ch);
+			serial_printf("%c", ch);
 			col++;
 			break;
 		}
@@ -2688,7 +3181,7 @@ void coo_cmd_print_serial_response_pretty(const struct coo_cmd_response *out,
 
 	payload = out->payload;
 	len = out->payload_len > 0U ? out->payload_len : strlen(out->payload);
-	printk("%s" COO_CMD_SERIAL_LINE_END "        ",
+	serial_printf("%s" COO_CMD_SERIAL_LINE_END "        ",
 	       out->topic[0] != '\0' ? out->topic : "serial");
 
 	payload = serial_payload_start(payload);
@@ -2696,7 +3189,7 @@ void coo_cmd_print_serial_response_pretty(const struct coo_cmd_response *out,
 		if (!serial_print_json_payload(payload, len - (size_t)(payload - out->payload))) {
 			uint16_t col = 13U;
 
-			printk("{\"error\":\"serial JSON render failed\"}"
+			serial_printf("{\"error\":\"serial JSON render failed\"}"
 			       COO_CMD_SERIAL_LINE_END "        raw: ");
 			for (size_t i = 0U; i < len && out->payload[i] != '\0'; ++i) {
 				const char ch = out->payload[i];
@@ -2706,19 +3199,19 @@ void coo_cmd_print_serial_response_pretty(const struct coo_cmd_response *out,
 				}
 				if (ch == '\n' ||
 				    (wrap_column != 0U && col >= wrap_column)) {
-					printk(COO_CMD_SERIAL_LINE_END "        ");
+					serial_printf(COO_CMD_SERIAL_LINE_END "        ");
 					col = 8U;
 					if (ch == '\n') {
 						continue;
 					}
 				}
-				printk("%c", ch);
+				serial_printf("%c", ch);
 				col++;
 			}
-			printk(COO_CMD_SERIAL_LINE_END);
+			serial_printf(COO_CMD_SERIAL_LINE_END);
 			return;
 		}
-		printk(COO_CMD_SERIAL_LINE_END);
+		serial_printf(COO_CMD_SERIAL_LINE_END);
 		return;
 	}
 
@@ -2729,10 +3222,10 @@ void coo_cmd_print_serial_response_pretty(const struct coo_cmd_response *out,
 			continue;
 		}
 		if (ch == '\n') {
-			printk(COO_CMD_SERIAL_LINE_END "        ");
+			serial_printf(COO_CMD_SERIAL_LINE_END "        ");
 			continue;
 		}
-		printk("%c", ch);
+		serial_printf("%c", ch);
 	}
-	printk(COO_CMD_SERIAL_LINE_END);
+	serial_printf(COO_CMD_SERIAL_LINE_END);
 }
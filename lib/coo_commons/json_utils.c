@@ -14,10 +14,12 @@
 #include <coo_commons/json_utils.h>
 #include <ctype.h>
 #include <errno.h>
+#include <math.h>
 #include <stdarg.h>
 #include <zephyr/data/json.h>
 #include <zephyr/sys/util.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 
@@ -60,30 +62,27 @@ static int coo_json_skip_string_value(const char **cursor)
 	return -EINVAL;
 }
 
-static int coo_json_read_top_key(const char **cursor, char *key, size_t key_len)
+static int coo_json_read_top_key(const char **cursor, const char **key, size_t *key_len)
 {
 	const char *p;
-	size_t off = 0U;
 
-	if (cursor == NULL || *cursor == NULL || key == NULL || key_len == 0U ||
+	if (cursor == NULL || *cursor == NULL || key == NULL || key_len == NULL ||
 	    **cursor != '"') {
 		return -EINVAL;
 	}
 
 	p = *cursor + 1;
+	*key = p;
 	while (*p != '\0') {
 		if (*p == '\\') {
 			return -EINVAL;
 		}
 		if (*p == '"') {
-			key[off] = '\0';
+			*key_len = (size_t)(p - *key);
 			*cursor = p + 1;
 			return 0;
 		}
-		if (off + 1U >= key_len) {
-			return -ENOSPC;
-		}
-		key[off++] = *p++;
+		p++;
 	}
 
 	return -EINVAL;
@@ -152,10 +151,10 @@ static int coo_json_skip_value(const char **cursor)
 		return -EINVAL;
 	}
 
-	while (*p != '\0' && *p != ',' && *p != '}' && *p != ']') {
-		if (!isspace((unsigned char)*p)) {
-			saw_primitive = true;
-		}
+	/* A bare number or literal ends at the first blank, so "1 2" is two tokens */
+	while (*p != '\0' && *p != ',' && *p != '}' && *p != ']' &&
+	       !isspace((unsigned char)*p)) {
+		saw_primitive = true;
 		p++;
 	}
 	if (!saw_primitive) {
@@ -166,16 +165,15 @@ static int coo_json_skip_value(const char **cursor)
 	return 0;
 }
 
-static bool coo_json_key_allowed(const char *allowed, const char *key)
+static bool coo_json_key_allowed(const char *allowed, const char *key,
+				 size_t key_len)
 {
 	const char *p = allowed;
-	size_t key_len;
 
 	if (allowed == NULL || key == NULL) {
 		return false;
 	}
 
-	key_len = strlen(key);
 	while (*p != '\0') {
 		const char *start;
 		const char *end;
@@ -200,66 +198,587 @@ static bool coo_json_key_allowed(const char *allowed, const char *key)
 	return false;
 }
 
+static uint8_t coo_json_value_type_of(char c)
+{
+	switch (c) {
+	case '"':
+		return COO_JSON_VALUE_STRING;
+	case '{':
+		return COO_JSON_VALUE_OBJECT;
+	case '[':
+		return COO_JSON_VALUE_ARRAY;
+	case 't':
+		return COO_JSON_VALUE_TRUE;
+	case 'f':
+		return COO_JSON_VALUE_FALSE;
+	case 'n':
+		return COO_JSON_VALUE_NULL;
+	default:
+		return COO_JSON_VALUE_NUMBER;
+	}
+}
+
+static int coo_json_object_open(const char **cursor)
+{
+	const char *p = coo_json_skip_ws(*cursor);
+
+	if (p == NULL || *p != '{') {
+		return -EINVAL;
+	}
+
+	*cursor = coo_json_skip_ws(p + 1);
+	return 0;
+}
+
+/*
+ * Read the next top-level member at @p cursor into @p field.
+ *
+ * Returns 1 when a member was read, 0 once the object closed with nothing
+ * but whitespace after it, or a negative errno.
+ */
+static int coo_json_next_member(const char **cursor, struct coo_json_field *field)
+{
+	const char *p = *cursor;
+	const char *key;
+	const char *value;
+	const char *end;
+	size_t key_len;
+	int rc;
+
+	if (*p == '}') {
+		p = coo_json_skip_ws(p + 1);
+		return *p == '\0' ? 0 : -EINVAL;
+	}
+
+	rc = coo_json_read_top_key(&p, &key, &key_len);
+	if (rc != 0) {
+		return rc;
+	}
+	if (key_len > COO_JSON_KEY_MAX) {
+		return -ENOSPC;
+	}
+
+	p = coo_json_skip_ws(p);
+	if (*p != ':') {
+		return -EINVAL;
+	}
+	value = coo_json_skip_ws(p + 1);
+	p = value;
+	rc = coo_json_skip_value(&p);
+	if (rc != 0) {
+		return rc;
+	}
+	end = p;
+	while (end > value && isspace((unsigned char)end[-1])) {
+		end--;
+	}
+	if ((size_t)(end - value) > UINT16_MAX) {
+		return -EINVAL;
+	}
+
+	p = coo_json_skip_ws(p);
+	if (*p == ',') {
+		p = coo_json_skip_ws(p + 1);
+		if (*p != '"') {
+			return -EINVAL;
+		}
+	} else if (*p != '}') {
+		return -EINVAL;
+	}
+
+	field->key = key;
+	field->key_len = (uint8_t)key_len;
+	field->value = value;
+	field->value_len = (uint16_t)(end - value);
+	field->type = coo_json_value_type_of(*value);
+	*cursor = p;
+	return 1;
+}
+
+static int coo_json_check_key(const struct coo_json_field *field,
+			      const char *allowed_keys,
+			      char *unknown_key,
+			      size_t unknown_key_len)
+{
+	if (coo_json_key_allowed(allowed_keys, field->key, field->key_len)) {
+		return 0;
+	}
+
+	if (unknown_key != NULL && unknown_key_len > 0U) {
+		if (field->key_len >= unknown_key_len) {
+			return -ENOSPC;
+		}
+		memcpy(unknown_key, field->key, field->key_len);
+		unknown_key[field->key_len] = '\0';
+	}
+
+	return -ENOENT;
+}
+
 int coo_json_validate_top_level_keys(const char *json,
 				     const char *allowed_keys,
 				     char *unknown_key,
 				     size_t unknown_key_len)
 {
-	const char *p;
-	char key[64];
+	struct coo_json_field field;
+	const char *p = json;
 	int rc;
 
 	if (json == NULL) {
 		return -EINVAL;
 	}
 
-	p = coo_json_skip_ws(json);
-	if (*p != '{') {
-		return -EINVAL;
-	}
-	p = coo_json_skip_ws(p + 1);
-	if (*p == '}') {
-		p = coo_json_skip_ws(p + 1);
-		return *p == '\0' ? 0 : -EINVAL;
+	rc = coo_json_object_open(&p);
+	if (rc != 0) {
+		return rc;
 	}
 
-	while (*p != '\0') {
-		rc = coo_json_read_top_key(&p, key, sizeof(key));
+	while ((rc = coo_json_next_member(&p, &field)) > 0) {
+		rc = coo_json_check_key(&field, allowed_keys != NULL ? allowed_keys : "",
+					unknown_key, unknown_key_len);
 		if (rc != 0) {
 			return rc;
 		}
-		if (!coo_json_key_allowed(allowed_keys, key)) {
-			if (unknown_key != NULL && unknown_key_len > 0U) {
-				if (strlen(key) >= unknown_key_len) {
-					return -ENOSPC;
-				}
-				strcpy(unknown_key, key);
+	}
+
+	return rc;
+}
+
+int coo_json_doc_parse(struct coo_json_doc *doc, const char *json,
+		       const char *allowed_keys, char *unknown_key,
+		       size_t unknown_key_len)
+{
+	struct coo_json_field field;
+	const char *p = json;
+	int rc;
+
+	if (doc == NULL || json == NULL) {
+		return -EINVAL;
+	}
+	doc->count = 0U;
+
+	rc = coo_json_object_open(&p);
+	if (rc != 0) {
+		return rc;
+	}
+
+	while ((rc = coo_json_next_member(&p, &field)) > 0) {
+		if (allowed_keys != NULL) {
+			rc = coo_json_check_key(&field, allowed_keys,
+						unknown_key, unknown_key_len);
+			if (rc != 0) {
+				return rc;
 			}
-			return -ENOENT;
 		}
+		if (doc->count >= COO_JSON_DOC_FIELDS_MAX) {
+			return -E2BIG;
+		}
+		doc->fields[doc->count++] = field;
+	}
 
-		p = coo_json_skip_ws(p);
-		if (*p != ':') {
-			return -EINVAL;
+	return rc;
+}
+
+const struct coo_json_field *coo_json_doc_find(const struct coo_json_doc *doc,
+					       const char *key)
+{
+	size_t key_len;
+
+	if (doc == NULL || key == NULL) {
+		return NULL;
+	}
+
+	key_len = strlen(key);
+	for (size_t i = 0U; i < doc->count; ++i) {
+		const struct coo_json_field *field = &doc->fields[i];
+
+		if (field->key_len == key_len &&
+		    memcmp(field->key, key, key_len) == 0) {
+			return field;
 		}
+	}
+
+	return NULL;
+}
+
+static const char *coo_json_skip_digits(const char *p, const char *end)
+{
+	while (p < end && isdigit((unsigned char)*p)) {
 		p++;
-		rc = coo_json_skip_value(&p);
-		if (rc != 0) {
-			return rc;
+	}
+	return p;
+}
+
+/*
+ * True if the span is exactly one JSON number (RFC 8259 section 6):
+ * -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+ * strtod() alone also takes inf, nan, hex floats and a leading '+'.
+ */
+static bool coo_json_span_is_number(const char *text, size_t len)
+{
+	const char *p = text;
+	const char *end = text + len;
+
+	if (p < end && *p == '-') {
+		p++;
+	}
+	if (p == end || !isdigit((unsigned char)*p)) {
+		return false;
+	}
+	p = (*p == '0') ? p + 1 : coo_json_skip_digits(p, end);
+
+	if (p < end && *p == '.') {
+		p++;
+		if (p == end || !isdigit((unsigned char)*p)) {
+			return false;
+		}
+		p = coo_json_skip_digits(p, end);
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		if (p < end && (*p == '+' || *p == '-')) {
+			p++;
 		}
+		if (p == end || !isdigit((unsigned char)*p)) {
+			return false;
+		}
+		p = coo_json_skip_digits(p, end);
+	}
+
+	return p == end;
+}
+
+/*
+ * Parse a number span with strtod(); the span must match the JSON number
+ * grammar, be consumed whole, and give a finite value.
+ */
+static int coo_json_span_double(const char *text, size_t len, double *value)
+{
+	char *end;
+
+	if (!coo_json_span_is_number(text, len)) {
+		return -EINVAL;
+	}
+
+	errno = 0;
+	*value = strtod(text, &end);
+	if (errno != 0 || end != text + len || !isfinite(*value)) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int coo_json_span_u64(const char *text, size_t len, uint64_t *value)
+{
+	char *end;
+
+	if (len == 0U || !isdigit((unsigned char)text[0])) {
+		return -EINVAL;
+	}
+
+	errno = 0;
+	*value = strtoull(text, &end, 10);
+	if (errno != 0 || end != text + len) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int coo_json_doc_get_bool(const struct coo_json_doc *doc, const char *key, bool *value)
+{
+	const struct coo_json_field *field;
+
+	if (value == NULL) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	field = coo_json_doc_find(doc, key);
+	if (field == NULL) {
+		return COO_JSON_EXTRACT_MISSING;
+	}
+	if (field->type == COO_JSON_VALUE_TRUE && field->value_len == 4U &&
+	    strncmp(field->value, "true", 4U) == 0) {
+		*value = true;
+		return COO_JSON_EXTRACT_OK;
+	}
+	if (field->type == COO_JSON_VALUE_FALSE && field->value_len == 5U &&
+	    strncmp(field->value, "false", 5U) == 0) {
+		*value = false;
+		return COO_JSON_EXTRACT_OK;
+	}
+
+	return COO_JSON_EXTRACT_ERR;
+}
+
+int coo_json_doc_get_u64(const struct coo_json_doc *doc, const char *key, uint64_t *value)
+{
+	const struct coo_json_field *field;
+
+	if (value == NULL) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	field = coo_json_doc_find(doc, key);
+	if (field == NULL) {
+		return COO_JSON_EXTRACT_MISSING;
+	}
+	if (field->type != COO_JSON_VALUE_NUMBER ||
+	    coo_json_span_u64(field->value, field->value_len, value) != 0) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	return COO_JSON_EXTRACT_OK;
+}
+
+int coo_json_doc_get_u32(const struct coo_json_doc *doc, const char *key, uint32_t *value)
+{
+	uint64_t parsed;
+	int rc;
+
+	if (value == NULL) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	rc = coo_json_doc_get_u64(doc, key, &parsed);
+	if (rc != COO_JSON_EXTRACT_OK) {
+		return rc;
+	}
+	if (parsed > UINT32_MAX) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	*value = (uint32_t)parsed;
+	return COO_JSON_EXTRACT_OK;
+}
+
+int coo_json_doc_get_double(const struct coo_json_doc *doc, const char *key, double *value)
+{
+	const struct coo_json_field *field;
+
+	if (value == NULL) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	field = coo_json_doc_find(doc, key);
+	if (field == NULL) {
+		return COO_JSON_EXTRACT_MISSING;
+	}
+	if (field->type != COO_JSON_VALUE_NUMBER ||
+	    coo_json_span_double(field->value, field->value_len, value) != 0) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	return COO_JSON_EXTRACT_OK;
+}
+
+int coo_json_doc_get_double_array(const struct coo_json_doc *doc, const char *key,
+				  double *values, size_t max_values,
+				  size_t *parsed_len)
+{
+	const struct coo_json_field *field;
+	const char *p;
+	const char *end;
+	size_t count = 0U;
+
+	if (values == NULL || parsed_len == NULL || max_values == 0U) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+	*parsed_len = 0U;
+
+	field = coo_json_doc_find(doc, key);
+	if (field == NULL) {
+		return COO_JSON_EXTRACT_MISSING;
+	}
+	if (field->type != COO_JSON_VALUE_ARRAY) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	/* The span runs from '[' to the matching ']' */
+	end = field->value + field->value_len - 1U;
+	p = coo_json_skip_ws(field->value + 1);
+	if (p == end) {
+		return COO_JSON_EXTRACT_OK;
+	}
+
+	while (p < end) {
+		const char *num = p;
+
+		while (p < end && *p != ',' && !isspace((unsigned char)*p)) {
+			p++;
+		}
+		if (count >= max_values ||
+		    coo_json_span_double(num, (size_t)(p - num), &values[count]) != 0) {
+			return COO_JSON_EXTRACT_ERR;
+		}
+		count++;
+
 		p = coo_json_skip_ws(p);
 		if (*p == ',') {
 			p = coo_json_skip_ws(p + 1);
-			continue;
-		}
-		if (*p == '}') {
-			p = coo_json_skip_ws(p + 1);
-			return *p == '\0' ? 0 : -EINVAL;
+			if (p == end) {
+				return COO_JSON_EXTRACT_ERR;
+			}
+		} else if (p != end) {
+			return COO_JSON_EXTRACT_ERR;
 		}
+	}
+
+	*parsed_len = count;
+	return COO_JSON_EXTRACT_OK;
+}
+
+static int coo_json_field_copy(const struct coo_json_field *field,
+			       size_t skip, char *out, size_t out_len)
+{
+	size_t len = field->value_len - 2U * skip;
+
+	if (len >= out_len) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	memcpy(out, field->value + skip, len);
+	out[len] = '\0';
+	return COO_JSON_EXTRACT_OK;
+}
+
+int coo_json_doc_get_string(const struct coo_json_doc *doc, const char *key,
+			    char *out, size_t out_len)
+{
+	const struct coo_json_field *field;
+
+	if (out == NULL || out_len == 0U) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	field = coo_json_doc_find(doc, key);
+	if (field == NULL) {
+		return COO_JSON_EXTRACT_MISSING;
+	}
+	if (field->type != COO_JSON_VALUE_STRING) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	return coo_json_field_copy(field, 1U, out, out_len);
+}
+
+int coo_json_doc_get_string_choice(const struct coo_json_doc *doc, const char *key,
+				   const struct coo_json_string_choice *choices,
+				   size_t choice_count, int *value)
+{
+	char text[COO_JSON_STRING_CHOICE_MAX] = {0};
+	int rc;
+
+	if (choices == NULL || choice_count == 0U || value == NULL) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	rc = coo_json_doc_get_string(doc, key, text, sizeof(text));
+	if (rc != COO_JSON_EXTRACT_OK) {
+		return rc;
+	}
+
+	return coo_json_match_string_choice(text, choices, choice_count, value) == 0 ?
+	       COO_JSON_EXTRACT_OK : COO_JSON_EXTRACT_ERR;
+}
+
+int coo_json_doc_get_object(const struct coo_json_doc *doc, const char *key,
+			    char *out, size_t out_len)
+{
+	const struct coo_json_field *field;
+
+	if (out == NULL || out_len == 0U) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	field = coo_json_doc_find(doc, key);
+	if (field == NULL) {
+		return COO_JSON_EXTRACT_MISSING;
+	}
+	if (field->type != COO_JSON_VALUE_OBJECT) {
+		return COO_JSON_EXTRACT_ERR;
+	}
+
+	return coo_json_field_copy(field, 0U, out, out_len);
+}
+
+int coo_json_doc_optional_bool(const struct coo_json_doc *doc, const char *key,
+			       bool *value, bool *changed)
+{
+	bool parsed;
+	int rc;
+
+	if (value == NULL) {
 		return -EINVAL;
 	}
 
-	return -EINVAL;
+	rc = coo_json_doc_get_bool(doc, key, &parsed);
+	if (rc == COO_JSON_EXTRACT_MISSING) {
+		return 0;
+	}
+	if (rc == COO_JSON_EXTRACT_ERR) {
+		return -EINVAL;
+	}
+
+	*value = parsed;
+	if (changed != NULL) {
+		*changed = true;
+	}
+	return 0;
+}
+
+int coo_json_doc_optional_u32(const struct coo_json_doc *doc, const char *key,
+			      uint32_t *value, bool *changed)
+{
+	uint32_t parsed;
+	int rc;
+
+	if (value == NULL) {
+		return -EINVAL;
+	}
+
+	rc = coo_json_doc_get_u32(doc, key, &parsed);
+	if (rc == COO_JSON_EXTRACT_MISSING) {
+		return 0;
+	}
+	if (rc == COO_JSON_EXTRACT_ERR) {
+		return -EINVAL;
+	}
+
+	*value = parsed;
+	if (changed != NULL) {
+		*changed = true;
+	}
+	return 0;
+}
+
+int coo_json_doc_optional_double_range(const struct coo_json_doc *doc, const char *key,
+				       double *value, bool *changed,
+				       double min_value, double max_value)
+{
+	double parsed;
+	int rc;
+
+	if (value == NULL || !(min_value <= max_value)) {
+		return -EINVAL;
+	}
+
+	rc = coo_json_doc_get_double(doc, key, &parsed);
+	if (rc == COO_JSON_EXTRACT_MISSING) {
+		return 0;
+	}
+	if (rc == COO_JSON_EXTRACT_ERR ||
+	    !(parsed >= min_value && parsed <= max_value)) {
+		return -EINVAL;
+	}
+
+	*value = parsed;
+	if (changed != NULL) {
+		*changed = true;
+	}
+	return 0;
 }
 
 int coo_json_match_string_choice(const char *text,
@@ -616,82 +1135,31 @@ int coo_json_extract_string_choice(const char *json,
 
 int coo_json_extract_object(const char *json, const char *key, char *out, size_t out_len)
 {
-	char pattern[80];
-	const char *match;
-	const char *cursor;
-	const char *start;
-	int depth = 0;
-	bool in_string = false;
-	bool escaped = false;
-	int written;
-
-	if (json == NULL || key == NULL || out == NULL || out_len == 0U ||
-	    strlen(key) > 60U) {
-		return COO_JSON_EXTRACT_ERR;
-	}
+	struct coo_json_field field;
+	const char *p = json;
+	size_t key_len;
+	int rc;
 
-	written = snprintf(pattern, sizeof(pattern), "\"%s\"", key);
-	if (written < 0 || written >= (int)sizeof(pattern)) {
+	if (json == NULL || key == NULL || out == NULL || out_len == 0U) {
 		return COO_JSON_EXTRACT_ERR;
 	}
+	key_len = strlen(key);
 
-	match = strstr(json, pattern);
-	if (match == NULL) {
-		return COO_JSON_EXTRACT_MISSING;
-	}
-
-	cursor = match + strlen(pattern);
-	while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n') {
-		cursor++;
-	}
-	if (*cursor != ':') {
-		return COO_JSON_EXTRACT_ERR;
-	}
-	cursor++;
-	while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n') {
-		cursor++;
-	}
-	if (*cursor != '{') {
+	/* Walk top-level members only, so a nested or quoted match is ignored */
+	if (coo_json_object_open(&p) != 0) {
 		return COO_JSON_EXTRACT_ERR;
 	}
-
-	start = cursor;
-	for (; *cursor != '\0'; ++cursor) {
-		char c = *cursor;
-
-		if (escaped) {
-			escaped = false;
-			continue;
-		}
-		if (in_string && c == '\\') {
-			escaped = true;
+	while ((rc = coo_json_next_member(&p, &field)) > 0) {
+		if (field.key_len != key_len || memcmp(field.key, key, key_len) != 0) {
 			continue;
 		}
-		if (c == '"') {
-			in_string = !in_string;
-			continue;
-		}
-		if (in_string) {
-			continue;
-		}
-		if (c == '{') {
-			depth++;
-		} else if (c == '}') {
-			depth--;
-			if (depth == 0) {
-				size_t len = (size_t)(cursor - start + 1);
-
-				if (len >= out_len) {
-					return COO_JSON_EXTRACT_ERR;
-				}
-				memcpy(out, start, len);
-				out[len] = '\0';
-				return COO_JSON_EXTRACT_OK;
-			}
+		if (field.type != COO_JSON_VALUE_OBJECT) {
+			return COO_JSON_EXTRACT_ERR;
 		}
+		return coo_json_field_copy(&field, 0U, out, out_len);
 	}
 
-	return COO_JSON_EXTRACT_ERR;
+	return rc == 0 ? COO_JSON_EXTRACT_MISSING : COO_JSON_EXTRACT_ERR;
 }
 
 int coo_json_vappend(char *buf, size_t buf_len, size_t *offset,
@@ -2,8 +2,11 @@
  * @file mqtt_client.c
  * @brief Blocking MQTT connect/process helpers around Zephyr MQTT.
  *
- * Incoming payload bytes are copied into a stack buffer before the user
- * callback runs. Outgoing publishes are intentionally left to the application.
+ * Incoming payload bytes are copied into a static buffer before the user
+ * callback runs, unless a publish reader is set, in which case the reader
+ * takes them straight from the client. Outgoing publishes are left to the
+ * application, or with CONFIG_COO_MQTT_PUBLISH_QUEUE copied into a queue
+ * that coo_mqtt_process() sends from the MQTT thread.
  */
 /*
  * Copyright (c) 2025 Caltech Optical Observatories
@@ -11,6 +14,8 @@
  */
 
 #include <coo_commons/mqtt_client.h>
+#include <coo_commons/backoff.h>
+#include <coo_commons/stage_trace.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/net/socket.h>
 #include <zephyr/net/net_ip.h>
@@ -43,12 +48,33 @@ static uint8_t client_id[50];
 /* User callback for messages */
 static mqtt_message_cb_t user_mqtt_cb = NULL;
 static void *user_mqtt_cb_data;
+static mqtt_publish_reader_cb_t user_mqtt_reader;
+static void *user_mqtt_reader_data;
 
 /* Subscriptions */
 #define MAX_SUBSCRIPTIONS 4
 static struct mqtt_topic subscriptions[MAX_SUBSCRIPTIONS];
 static int num_subscriptions = 0;
 
+/*
+ * Last resolved broker address, reused until the TTL expires or this many
+ * connects in a row fail on it. broker_resolved_ms < 0: nothing cached.
+ */
+#define BROKER_CACHE_MAX_FAILURES 3
+static int64_t broker_resolved_ms = -1;
+static uint8_t broker_connect_failures;
+
+/* Connection manager state, owned by the thread calling coo_mqtt_maintain() */
+static struct coo_backoff reconnect_backoff =
+	COO_BACKOFF_INIT(CONFIG_COO_MQTT_RECONNECT_MIN_MS, CONFIG_COO_MQTT_RECONNECT_MAX_MS);
+static int64_t next_attempt_ms;
+/* Uptime when the connection was lost, or -1 while connected */
+static int64_t disconnected_ms = -1;
+static bool session_present;
+static bool subscribed;
+/* Written only by the MQTT thread; readers may see one update half-applied */
+static struct coo_mqtt_connection_stats conn_stats;
+
 /* Keep failed broker attempts below the application watchdog interval. */
 #define MSECS_NET_POLL_TIMEOUT 3000
 /* Keep connected idle polling short enough for the application watchdog loop. */
@@ -186,7 +212,28 @@ int coo_mqtt_resolve_broker_config(const struct coo_mqtt_broker_config *cfg,
 
 static int resolve_broker_addr(void)
 {
-	return resolve_broker_addr_for_config(&active_broker_cfg, &broker, NULL, 0U);
+	const int64_t now = k_uptime_get();
+	int rc;
+
+	if (broker_resolved_ms >= 0 &&
+	    now - broker_resolved_ms < (int64_t)CONFIG_COO_MQTT_DNS_CACHE_TTL_S * MSEC_PER_SEC &&
+	    broker_connect_failures < BROKER_CACHE_MAX_FAILURES) {
+		conn_stats.dns_cache_hits++;
+		return 0;
+	}
+
+	conn_stats.dns_lookups++;
+	rc = resolve_broker_addr_for_config(&active_broker_cfg, &broker, NULL, 0U);
+	if (rc == 0) {
+		broker_resolved_ms = now;
+		broker_connect_failures = 0U;
+	} else if (broker_resolved_ms >= 0) {
+		/* A stale address beats none while DNS is down */
+		LOG_WRN("Broker lookup failed [%d]; reusing the cached address", rc);
+		return 0;
+	}
+
+	return rc;
 }
 
 int coo_mqtt_set_broker_config(const struct coo_mqtt_broker_config *cfg)
@@ -198,6 +245,7 @@ int coo_mqtt_set_broker_config(const struct coo_mqtt_broker_config *cfg)
 	strncpy(active_broker_cfg.host, cfg->host, sizeof(active_broker_cfg.host) - 1U);
 	active_broker_cfg.host[sizeof(active_broker_cfg.host) - 1U] = '\0';
 	active_broker_cfg.port = cfg->port;
+	broker_resolved_ms = -1;
 
 	return 0;
 }
@@ -208,6 +256,12 @@ void coo_mqtt_set_message_callback(mqtt_message_cb_t cb, void *user_data)
 	user_mqtt_cb_data = user_data;
 }
 
+void coo_mqtt_set_publish_reader(mqtt_publish_reader_cb_t cb, void *user_data)
+{
+	user_mqtt_reader = cb;
+	user_mqtt_reader_data = user_data;
+}
+
 int coo_mqtt_add_subscription(const char *topic_str, uint8_t qos)
 {
 	if (num_subscriptions >= MAX_SUBSCRIPTIONS) {
@@ -251,6 +305,11 @@ static inline void on_mqtt_connect(void)
 
 static inline void on_mqtt_disconnect(void)
 {
+	if (mqtt_connected) {
+		conn_stats.disconnects++;
+		disconnected_ms = k_uptime_get();
+	}
+	subscribed = false;
 	mqtt_connected = false;
 	clear_fds();
 	LOG_INF("Disconnected from MQTT broker");
@@ -262,6 +321,15 @@ static void on_mqtt_publish(struct mqtt_client *const client, const struct mqtt_
 	int rc;
 	struct mqtt_publish_param publish_param = evt->param.publish;
 
+	if (user_mqtt_reader != NULL) {
+		LOG_INF("MQTT payload received on '%.*s' (%u bytes)",
+			(int)publish_param.message.topic.topic.size,
+			publish_param.message.topic.topic.utf8,
+			publish_param.message.payload.len);
+		user_mqtt_reader(client, &publish_param, user_mqtt_reader_data);
+		return;
+	}
+
 	/* mqtt_read_publish_payload() drains Zephyr's MQTT RX buffer into a local
 	 * buffer so the command layer can copy it before this event handler returns.
 	 */
@@ -288,6 +356,337 @@ static void on_mqtt_publish(struct mqtt_client *const client, const struct mqtt_
 	}
 }
 
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+/* Most queued messages sent per coo_mqtt_process() call */
+#define PUBLISH_BUDGET 8
+
+/*
+ * Every block is either free, queued, or inflight, and the queue has a slot
+ * for every block, so a put after a successful allocation cannot fail.
+ */
+#define PUBLISH_BLOCKS (CONFIG_COO_MQTT_PUBLISH_QUEUE_DEPTH + CONFIG_COO_MQTT_INFLIGHT_WINDOW)
+
+struct publish_entry {
+	int64_t queued_ms;
+	int64_t sent_ms;
+	uint16_t message_id;
+	uint16_t len;
+	uint8_t qos;
+	uint8_t flags;
+	char topic[COO_MQTT_PUBLISH_TOPIC_MAX];
+	uint8_t payload[CONFIG_COO_MQTT_PUBLISH_PAYLOAD_SIZE];
+};
+
+K_MEM_SLAB_DEFINE_STATIC(publish_slab, sizeof(struct publish_entry), PUBLISH_BLOCKS, 8);
+K_MSGQ_DEFINE(publish_queue, sizeof(struct publish_entry *), PUBLISH_BLOCKS, 4);
+
+/* Owned by the MQTT thread: touched only from coo_mqtt_process() and events */
+static struct publish_entry *inflight[CONFIG_COO_MQTT_INFLIGHT_WINDOW];
+static size_t inflight_used;
+static uint16_t publish_msg_id;
+
+static struct k_spinlock stats_lock;
+static struct coo_mqtt_publish_stats pub_stats;
+static uint64_t latency_total_ms;
+
+static void publish_entry_free(struct publish_entry *e)
+{
+	k_mem_slab_free(&publish_slab, e);
+}
+
+/* Message IDs are never 0 */
+static uint16_t publish_next_id(void)
+{
+	if (++publish_msg_id == 0U) {
+		publish_msg_id = 1U;
+	}
+	return publish_msg_id;
+}
+
+int coo_mqtt_publish_queued(const char *topic, const void *payload, size_t len,
+			    uint8_t qos, uint32_t flags)
+{
+	struct publish_entry *e;
+	k_spinlock_key_t key;
+	uint32_t depth;
+
+	if (topic == NULL || (payload == NULL && len > 0U) ||
+	    qos > MQTT_QOS_1_AT_LEAST_ONCE) {
+		return -EINVAL;
+	}
+	if (strlen(topic) >= COO_MQTT_PUBLISH_TOPIC_MAX ||
+	    len > CONFIG_COO_MQTT_PUBLISH_PAYLOAD_SIZE) {
+		return -EMSGSIZE;
+	}
+	if (!mqtt_connected && qos == MQTT_QOS_0_AT_MOST_ONCE) {
+		key = k_spin_lock(&stats_lock);
+		pub_stats.dropped_offline++;
+		k_spin_unlock(&stats_lock, key);
+		return -ENOTCONN;
+	}
+	if (k_mem_slab_alloc(&publish_slab, (void **)&e, K_NO_WAIT) != 0) {
+		key = k_spin_lock(&stats_lock);
+		pub_stats.dropped_full++;
+		k_spin_unlock(&stats_lock, key);
+		return -ENOSPC;
+	}
+
+	strcpy(e->topic, topic);
+	if (len > 0U) {
+		memcpy(e->payload, payload, len);
+	}
+	e->len = (uint16_t)len;
+	e->qos = qos;
+	e->flags = (uint8_t)flags;
+	e->message_id = 0U;
+	e->queued_ms = k_uptime_get();
+	(void)k_msgq_put(&publish_queue, &e, K_NO_WAIT);
+
+	depth = k_msgq_num_used_get(&publish_queue);
+	key = k_spin_lock(&stats_lock);
+	pub_stats.queued++;
+	pub_stats.depth_max = MAX(pub_stats.depth_max, depth);
+	k_spin_unlock(&stats_lock, key);
+
+	return 0;
+}
+
+void coo_mqtt_get_publish_stats(struct coo_mqtt_publish_stats *stats)
+{
+	k_spinlock_key_t key;
+
+	if (stats == NULL) {
+		return;
+	}
+
+	key = k_spin_lock(&stats_lock);
+	*stats = pub_stats;
+	stats->latency_avg_ms = pub_stats.published > 0U ?
+		(uint32_t)(latency_total_ms / pub_stats.published) : 0U;
+	k_spin_unlock(&stats_lock, key);
+	stats->depth = k_msgq_num_used_get(&publish_queue);
+	stats->inflight = (uint32_t)inflight_used;
+}
+
+void coo_mqtt_reset_publish_stats(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	memset(&pub_stats, 0, sizeof(pub_stats));
+	latency_total_ms = 0U;
+	k_spin_unlock(&stats_lock, key);
+}
+
+int coo_mqtt_format_publish_stats(const struct coo_mqtt_publish_stats *stats,
+				  char *out, size_t out_len)
+{
+	int written;
+
+	if (stats == NULL || out == NULL || out_len == 0U) {
+		return -EINVAL;
+	}
+
+	written = snprintk(out, out_len,
+			   "{\"queued\":%u,\"published\":%u,\"acked\":%u,\"rejected\":%u,"
+			   "\"retransmits\":%u,\"coalesced\":%u,\"dropped_full\":%u,"
+			   "\"dropped_offline\":%u,\"dropped_error\":%u,\"window_stalls\":%u,"
+			   "\"depth\":%u,\"depth_max\":%u,\"inflight\":%u,\"window\":%u,"
+			   "\"latency_avg_ms\":%u,\"latency_max_ms\":%u,\"ack_max_ms\":%u}",
+			   stats->queued, stats->published, stats->acked, stats->rejected,
+			   stats->retransmits, stats->coalesced, stats->dropped_full,
+			   stats->dropped_offline, stats->dropped_error, stats->window_stalls,
+			   stats->depth, stats->depth_max, stats->inflight,
+			   (unsigned int)CONFIG_COO_MQTT_INFLIGHT_WINDOW,
+			   stats->latency_avg_ms, stats->latency_max_ms, stats->ack_max_ms);
+	if (written < 0 || written >= (int)out_len) {
+		return -ENOSPC;
+	}
+
+	return 0;
+}
+
+static int publish_entry_send(struct mqtt_client *client, const struct publish_entry *e,
+			      bool dup)
+{
+	struct mqtt_publish_param param;
+
+	memset(&param, 0, sizeof(param));
+	param.message.topic.qos = e->qos;
+	param.message.topic.topic.utf8 = (const uint8_t *)e->topic;
+	param.message.topic.topic.size = strlen(e->topic);
+	param.message.payload.data = (uint8_t *)e->payload;
+	param.message.payload.len = e->len;
+	param.message_id = e->message_id;
+	param.dup_flag = dup ? 1U : 0U;
+	param.retain_flag = 0U;
+
+	COO_TRACE_BEGIN(publish_start);
+	int rc = mqtt_publish(client, &param);
+
+	COO_TRACE_END(COO_TRACE_MQTT_PUBLISH, publish_start);
+	return rc;
+}
+
+/*
+ * True if a newer coalescing message for the same topic is queued behind
+ * @p e. Queued entries are written before they are put and freed only by
+ * this thread, so peeking at them is safe while producers keep appending.
+ */
+static bool publish_superseded(const struct publish_entry *e)
+{
+	const struct publish_entry *later;
+	uint32_t used;
+
+	if ((e->flags & COO_MQTT_PUBLISH_COALESCE) == 0U) {
+		return false;
+	}
+
+	used = k_msgq_num_used_get(&publish_queue);
+	for (uint32_t i = 0U; i < used; ++i) {
+		if (k_msgq_peek_at(&publish_queue, &later, i) != 0) {
+			break;
+		}
+		if ((later->flags & COO_MQTT_PUBLISH_COALESCE) != 0U &&
+		    strcmp(later->topic, e->topic) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void publish_inflight_add(struct publish_entry *e)
+{
+	for (size_t i = 0U; i < ARRAY_SIZE(inflight); ++i) {
+		if (inflight[i] == NULL) {
+			inflight[i] = e;
+			inflight_used++;
+			return;
+		}
+	}
+}
+
+/* Release the inflight message a PUBACK names; unknown IDs are ignored */
+static void publish_queue_ack(uint16_t message_id, bool accepted)
+{
+	k_spinlock_key_t key;
+	uint32_t ack_ms;
+
+	for (size_t i = 0U; i < ARRAY_SIZE(inflight); ++i) {
+		struct publish_entry *e = inflight[i];
+
+		if (e == NULL || e->message_id != message_id) {
+			continue;
+		}
+
+		ack_ms = (uint32_t)(k_uptime_get() - e->sent_ms);
+		key = k_spin_lock(&stats_lock);
+		if (accepted) {
+			pub_stats.acked++;
+		} else {
+			pub_stats.rejected++;
+		}
+		pub_stats.ack_max_ms = MAX(pub_stats.ack_max_ms, ack_ms);
+		k_spin_unlock(&stats_lock, key);
+
+		inflight[i] = NULL;
+		inflight_used--;
+		publish_entry_free(e);
+		return;
+	}
+}
+
+/* After a reconnect, resend every unacknowledged message straight away */
+static void publish_queue_on_connect(void)
+{
+	int64_t due = k_uptime_get() - CONFIG_COO_MQTT_ACK_TIMEOUT_MS;
+
+	for (size_t i = 0U; i < ARRAY_SIZE(inflight); ++i) {
+		if (inflight[i] != NULL) {
+			inflight[i]->sent_ms = due;
+		}
+	}
+}
+
+static void publish_queue_service(struct mqtt_client *client)
+{
+	struct publish_entry *e;
+	k_spinlock_key_t key;
+	int64_t now;
+	int budget = PUBLISH_BUDGET;
+
+	if (!mqtt_connected) {
+		return;
+	}
+
+	now = k_uptime_get();
+	for (size_t i = 0U; i < ARRAY_SIZE(inflight); ++i) {
+		e = inflight[i];
+		if (e == NULL || now - e->sent_ms < CONFIG_COO_MQTT_ACK_TIMEOUT_MS) {
+			continue;
+		}
+		if (publish_entry_send(client, e, true) != 0) {
+			return;
+		}
+		e->sent_ms = now;
+		key = k_spin_lock(&stats_lock);
+		pub_stats.retransmits++;
+		k_spin_unlock(&stats_lock, key);
+	}
+
+	while (budget-- > 0 && k_msgq_peek(&publish_queue, &e) == 0) {
+		uint32_t latency_ms;
+		int rc;
+
+		/* Hold the queue in order rather than let QoS 0 overtake */
+		if (e->qos != MQTT_QOS_0_AT_MOST_ONCE &&
+		    inflight_used == ARRAY_SIZE(inflight)) {
+			key = k_spin_lock(&stats_lock);
+			pub_stats.window_stalls++;
+			k_spin_unlock(&stats_lock, key);
+			break;
+		}
+		(void)k_msgq_get(&publish_queue, &e, K_NO_WAIT);
+
+		if (publish_superseded(e)) {
+			key = k_spin_lock(&stats_lock);
+			pub_stats.coalesced++;
+			k_spin_unlock(&stats_lock, key);
+			publish_entry_free(e);
+			continue;
+		}
+
+		if (e->qos != MQTT_QOS_0_AT_MOST_ONCE) {
+			e->message_id = publish_next_id();
+		}
+		rc = publish_entry_send(client, e, false);
+		latency_ms = (uint32_t)(now - e->queued_ms);
+
+		key = k_spin_lock(&stats_lock);
+		if (rc == 0) {
+			pub_stats.published++;
+			pub_stats.latency_max_ms = MAX(pub_stats.latency_max_ms, latency_ms);
+			latency_total_ms += latency_ms;
+		} else if (e->qos == MQTT_QOS_0_AT_MOST_ONCE) {
+			pub_stats.dropped_error++;
+		}
+		k_spin_unlock(&stats_lock, key);
+
+		if (e->qos == MQTT_QOS_0_AT_MOST_ONCE) {
+			publish_entry_free(e);
+		} else {
+			/* A failed first send goes out again as a retransmit */
+			e->sent_ms = rc == 0 ? now : now - CONFIG_COO_MQTT_ACK_TIMEOUT_MS;
+			publish_inflight_add(e);
+		}
+		if (rc != 0) {
+			LOG_WRN("Queued MQTT publish on '%s' failed [%d]", e->topic, rc);
+			break;
+		}
+	}
+}
+#endif /* CONFIG_COO_MQTT_PUBLISH_QUEUE */
+
 /** Handler for asynchronous MQTT events */
 static void mqtt_event_handler(struct mqtt_client *const client, const struct mqtt_evt *evt)
 {
@@ -297,7 +696,11 @@ static void mqtt_event_handler(struct mqtt_client *const client, const struct mq
 			LOG_ERR("MQTT Event Connect failed [%d]", evt->result);
 			break;
 		}
+		session_present = evt->param.connack.session_present_flag != 0U;
 		on_mqtt_connect();
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+		publish_queue_on_connect();
+#endif
 		break;
 
 	case MQTT_EVT_DISCONNECT:
@@ -309,6 +712,9 @@ static void mqtt_event_handler(struct mqtt_client *const client, const struct mq
 		break;
 
 	case MQTT_EVT_PUBACK:
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+		publish_queue_ack(evt->param.puback.message_id, evt->result == 0);
+#endif
 		if (evt->result != 0) {
 			LOG_ERR("MQTT PUBACK error [%d]", evt->result);
 			break;
@@ -422,6 +828,8 @@ int coo_mqtt_subscribe(struct mqtt_client *client)
 	rc = mqtt_subscribe(client, &sub_list);
 	if (rc != 0) {
 		LOG_ERR("MQTT Subscribe failed [%d]", rc);
+	} else {
+		subscribed = true;
 	}
 
 	return rc;
@@ -439,6 +847,10 @@ int coo_mqtt_process(struct mqtt_client *client)
 	}
 	waited_for_keepalive = (keepalive_ms >= 0 && timeout_ms == keepalive_ms);
 
+#if defined(CONFIG_COO_MQTT_PUBLISH_QUEUE)
+	publish_queue_service(client);
+#endif
+
 	rc = poll_mqtt_socket(client, timeout_ms);
 	if (rc < 0) {
 		return rc;
@@ -455,6 +867,8 @@ int coo_mqtt_process(struct mqtt_client *client)
 			/* Socket error */
 			if (fds[0].revents & (ZSOCK_POLLHUP | ZSOCK_POLLERR)) {
 				LOG_ERR("MQTT socket closed / error");
+				/* Raises MQTT_EVT_DISCONNECT so a reconnect follows */
+				mqtt_abort(client);
 				return -ENOTCONN;
 			}
 		}
@@ -491,7 +905,7 @@ void coo_mqtt_run(struct mqtt_client *client)
 	mqtt_disconnect(client, NULL);
 }
 
-int coo_mqtt_connect(struct mqtt_client *client)
+static int connect_once(struct mqtt_client *client)
 {
 	int rc;
 
@@ -531,6 +945,98 @@ int coo_mqtt_connect(struct mqtt_client *client)
 	return 0;
 }
 
+int coo_mqtt_connect(struct mqtt_client *client)
+{
+	int rc = connect_once(client);
+
+	if (rc != 0) {
+		conn_stats.connect_failures++;
+		if (broker_connect_failures < UINT8_MAX) {
+			broker_connect_failures++;
+		}
+	} else {
+		conn_stats.connects++;
+		broker_connect_failures = 0U;
+	}
+
+	return rc;
+}
+
+int coo_mqtt_maintain(struct mqtt_client *client)
+{
+	int rc;
+
+	if (!mqtt_connected) {
+		if (k_uptime_get() < next_attempt_ms) {
+			return -EAGAIN;
+		}
+
+		rc = coo_mqtt_connect(client);
+		if (rc != 0) {
+			uint32_t delay_ms = coo_backoff_next(&reconnect_backoff);
+
+			/* The attempt itself may have blocked; count from its end */
+			next_attempt_ms = k_uptime_get() + delay_ms;
+			conn_stats.retry_in_ms = delay_ms;
+			LOG_WRN("MQTT connect failed [%d]; retry in %u ms", rc, delay_ms);
+			return rc;
+		}
+		coo_backoff_reset(&reconnect_backoff);
+		conn_stats.retry_in_ms = 0U;
+		/* A kept session still holds our subscriptions */
+		subscribed = session_present || num_subscriptions == 0;
+	}
+
+	if (!subscribed) {
+		rc = coo_mqtt_subscribe(client);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	if (disconnected_ms >= 0) {
+		uint32_t took_ms = (uint32_t)(k_uptime_get() - disconnected_ms);
+
+		conn_stats.last_reconnect_ms = took_ms;
+		conn_stats.max_reconnect_ms = MAX(conn_stats.max_reconnect_ms, took_ms);
+		disconnected_ms = -1;
+		LOG_INF("MQTT reconnected in %u ms", took_ms);
+	}
+
+	return 0;
+}
+
+void coo_mqtt_get_connection_stats(struct coo_mqtt_connection_stats *stats)
+{
+	if (stats != NULL) {
+		*stats = conn_stats;
+	}
+}
+
+int coo_mqtt_format_connection_stats(const struct coo_mqtt_connection_stats *stats,
+				     char *out, size_t out_len)
+{
+	int written;
+
+	if (stats == NULL || out == NULL || out_len == 0U) {
+		return -EINVAL;
+	}
+
+	written = snprintk(out, out_len,
+			   "{\"connected\":%s,\"connects\":%u,\"connect_failures\":%u,"
+			   "\"disconnects\":%u,\"dns_lookups\":%u,\"dns_cache_hits\":%u,"
+			   "\"retry_in_ms\":%u,\"last_reconnect_ms\":%u,\"max_reconnect_ms\":%u}",
+			   mqtt_connected ? "true" : "false", stats->connects,
+			   stats->connect_failures, stats->disconnects, stats->dns_lookups,
+			   stats->dns_cache_hits, stats->retry_in_ms, stats->last_reconnect_ms,
+			   stats->max_reconnect_ms);
+	if (written < 0 || written >= (int)out_len) {
+		return -ENOSPC;
+	}
+
+	return 0;
+}
+
 int coo_mqtt_init(struct mqtt_client *client, const char *id_str)
 {
 	/* MQTT client configuration */
@@ -12,6 +12,7 @@
  */
 
 #include <coo_commons/network.h>
+#include <coo_commons/backoff.h>
 
 #include <errno.h>
 #include <string.h>
@@ -46,6 +47,9 @@ static struct net_mgmt_event_callback net_l4_mgmt_cb;
 static struct net_mgmt_event_callback net_iface_mgmt_cb;
 static struct net_mgmt_event_callback net_ipv4_mgmt_cb;
 static struct k_work_delayable reconnect_work;
+/* Link flaps back off from 250 ms instead of retrying at a fixed rate */
+static struct coo_backoff reconnect_backoff =
+	COO_BACKOFF_INIT(250U, CONFIG_NETWORK_HELPER_RECONNECT_MAX_MS);
 static struct k_work_delayable dhcp_fallback_work;
 static bool network_initialized;
 
@@ -501,7 +505,10 @@ static void reconnect_work_handler(struct k_work *work)
 
 	rc = conn_mgr_all_if_connect(true);
 	if (rc != 0) {
-		LOG_WRN("conn_mgr_all_if_connect() failed (%d)", rc);
+		uint32_t delay_ms = coo_backoff_next(&reconnect_backoff);
+
+		LOG_WRN("conn_mgr_all_if_connect() failed (%d); retry in %u ms", rc, delay_ms);
+		k_work_reschedule(&reconnect_work, K_MSEC(delay_ms));
 	}
 }
 
@@ -513,9 +520,11 @@ static void net_l4_evt_handler(struct net_mgmt_event_callback *cb,
 	ARG_UNUSED(iface);
 
 	if (mgmt_event == NET_EVENT_L4_CONNECTED) {
+		coo_backoff_reset(&reconnect_backoff);
 		notify_ready(true);
 	} else if (mgmt_event == NET_EVENT_L4_DISCONNECTED) {
-		k_work_reschedule(&reconnect_work, K_MSEC(250));
+		k_work_reschedule(&reconnect_work,
+				  K_MSEC(coo_backoff_next(&reconnect_backoff)));
 		notify_ready(false);
 	}
 }
@@ -541,7 +550,8 @@ static void net_iface_evt_handler(struct net_mgmt_event_callback *cb,
 		active_source = NETWORK_IPV4_SOURCE_UNKNOWN;
 		k_work_cancel_delayable(&dhcp_fallback_work);
 		notify_ready(false);
-		k_work_reschedule(&reconnect_work, K_MSEC(250));
+		k_work_reschedule(&reconnect_work,
+				  K_MSEC(coo_backoff_next(&reconnect_backoff)));
 	}
 }
 
@@ -6,6 +6,8 @@
 #include <coo_commons/pid.h>
 #include <string.h>
 
+#include "pid_law.h"
+
 void coo_pid_init(struct coo_pid *pid, float kp, float ki, float kd,
 		  float output_min, float output_max)
 {
@@ -21,12 +23,17 @@ void coo_pid_init(struct coo_pid *pid, float kp, float ki, float kd,
 	/* Set integral limits to output limits by default */
 	pid->integral_min = output_min;
 	pid->integral_max = output_max;
+
+	coo_pid_options_default(&pid->options);
 }
 
 void coo_pid_reset(struct coo_pid *pid)
 {
 	pid->integral = 0.0f;
 	pid->prev_error = 0.0f;
+	pid->prev_measured = 0.0f;
+	pid->d_filtered = 0.0f;
+	pid->primed = false;
 }
 
 void coo_pid_set_gains(struct coo_pid *pid, float kp, float ki, float kd)
@@ -36,41 +43,42 @@ void coo_pid_set_gains(struct coo_pid *pid, float kp, float ki, float kd)
 	pid->kd = kd;
 }
 
-float coo_pid_update(struct coo_pid *pid, float setpoint, float measured, float dt)
+void coo_pid_options_default(struct coo_pid_options *opts)
 {
-	float error, derivative, output;
-
-	/* Calculate error */
-	error = setpoint - measured;
-
-	/* Proportional term */
-	float p_term = pid->kp * error;
-
-	/* Integral term with anti-windup */
-	pid->integral += error * dt;
-	if (pid->integral > pid->integral_max) {
-		pid->integral = pid->integral_max;
-	} else if (pid->integral < pid->integral_min) {
-		pid->integral = pid->integral_min;
-	}
-	float i_term = pid->ki * pid->integral;
-
-	/* Derivative term */
-	derivative = (dt > 0.0f) ? (error - pid->prev_error) / dt : 0.0f;
-	float d_term = pid->kd * derivative;
-
-	/* Compute output */
-	output = p_term + i_term + d_term;
+	opts->setpoint_weight = 1.0f;
+	opts->derivative_on_measurement = false;
+	opts->derivative_filter_tau = 0.0f;
+	opts->anti_windup = COO_PID_ANTI_WINDUP_CLAMP;
+	opts->tracking_time = 0.0f;
+}
 
-	/* Clamp output */
-	if (output > pid->output_max) {
-		output = pid->output_max;
-	} else if (output < pid->output_min) {
-		output = pid->output_min;
-	}
+void coo_pid_set_options(struct coo_pid *pid, const struct coo_pid_options *opts)
+{
+	pid->options = *opts;
 
-	/* Save error for next iteration */
-	pid->prev_error = error;
+	/* Derivative history may mean something else in the new mode */
+	pid->d_filtered = 0.0f;
+	pid->primed = false;
+}
 
-	return output;
+float coo_pid_update(struct coo_pid *pid, float setpoint, float measured, float dt)
+{
+	const struct pid_law_gains gains = {
+		.kp = pid->kp,
+		.ki = pid->ki,
+		.kd = pid->kd,
+		.output_min = pid->output_min,
+		.output_max = pid->output_max,
+		.integral_min = pid->integral_min,
+		.integral_max = pid->integral_max,
+	};
+	const struct pid_law_state state = {
+		.integral = &pid->integral,
+		.prev_error = &pid->prev_error,
+		.prev_measured = &pid->prev_measured,
+		.d_filtered = &pid->d_filtered,
+		.primed = &pid->primed,
+	};
+
+	return pid_law_step(&gains, &pid->options, &state, setpoint, measured, dt);
 }
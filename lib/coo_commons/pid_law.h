@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2024 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * PID control law shared by struct coo_pid and struct coo_pid_bank, so
+ * both compute the same output from the same state. Private to
+ * coo_commons.
+ */
+
+#ifndef COO_COMMONS_PID_LAW_H_
+#define COO_COMMONS_PID_LAW_H_
+
+#include <coo_commons/pid.h>
+
+struct pid_law_gains {
+	float kp;
+	float ki;
+	float kd;
+	float output_min;
+	float output_max;
+	float integral_min;
+	float integral_max;
+};
+
+struct pid_law_state {
+	float *integral;
+	float *prev_error;
+	float *prev_measured;
+	float *d_filtered;
+	bool *primed;
+	/** Optional: where to store this step's P, I and D contributions */
+	float *p_term;
+	float *i_term;
+	float *d_term;
+};
+
+static inline float pid_law_clamp(float v, float lo, float hi)
+{
+	if (v > hi) {
+		return hi;
+	}
+	if (v < lo) {
+		return lo;
+	}
+	return v;
+}
+
+static inline float pid_law_step(const struct pid_law_gains *g,
+				 const struct coo_pid_options *opt,
+				 const struct pid_law_state *s,
+				 float setpoint, float measured, float dt)
+{
+	float error = setpoint - measured;
+
+	/* Proportional term, setpoint weighted */
+	float p_term = g->kp * (opt->setpoint_weight * setpoint - measured);
+
+	/* Derivative term */
+	float raw;
+
+	if (opt->derivative_on_measurement) {
+		/* First sample has no history: no derivative rather than a kick */
+		raw = (*s->primed && dt > 0.0f) ? -(measured - *s->prev_measured) / dt : 0.0f;
+	} else {
+		raw = (dt > 0.0f) ? (error - *s->prev_error) / dt : 0.0f;
+	}
+
+	float derivative = raw;
+
+	if (opt->derivative_filter_tau > 0.0f && dt > 0.0f) {
+		if (*s->primed) {
+			float alpha = dt / (opt->derivative_filter_tau + dt);
+
+			derivative = *s->d_filtered + alpha * (raw - *s->d_filtered);
+		}
+		*s->d_filtered = derivative;
+	}
+	float d_term = g->kd * derivative;
+
+	/* Integral term with anti-windup */
+	float integral = *s->integral;
+
+	switch (opt->anti_windup) {
+	case COO_PID_ANTI_WINDUP_CONDITIONAL: {
+		float trial = pid_law_clamp(integral + error * dt, g->integral_min,
+					    g->integral_max);
+		float v = p_term + g->ki * trial + d_term;
+
+		/* Integrate unless it pushes an already saturated output further */
+		if (!((v > g->output_max && error * g->ki > 0.0f) ||
+		      (v < g->output_min && error * g->ki < 0.0f))) {
+			integral = trial;
+		}
+		break;
+	}
+	case COO_PID_ANTI_WINDUP_BACK_CALC:
+		/* Updated after the output is known, below */
+		break;
+	case COO_PID_ANTI_WINDUP_CLAMP:
+	default:
+		integral = pid_law_clamp(integral + error * dt, g->integral_min,
+					 g->integral_max);
+		break;
+	}
+
+	float v = p_term + g->ki * integral + d_term;
+	float output = pid_law_clamp(v, g->output_min, g->output_max);
+
+	if (opt->anti_windup == COO_PID_ANTI_WINDUP_BACK_CALC) {
+		float tt = opt->tracking_time;
+
+		if (tt <= 0.0f) {
+			tt = (g->ki != 0.0f && g->kp != 0.0f) ? g->kp / g->ki : 1.0f;
+		}
+		/* integral is error-seconds; (u - v) / Tt is in output units */
+		float track = (g->ki != 0.0f) ? (output - v) / (g->ki * tt) : 0.0f;
+
+		integral = pid_law_clamp(integral + (error + track) * dt, g->integral_min,
+					 g->integral_max);
+	}
+
+	if (s->p_term != NULL) {
+		*s->p_term = p_term;
+		*s->i_term = v - p_term - d_term;
+		*s->d_term = d_term;
+	}
+
+	*s->integral = integral;
+	*s->prev_error = error;
+	*s->prev_measured = measured;
+	*s->primed = true;
+
+	return output;
+}
+
+#endif /* COO_COMMONS_PID_LAW_H_ */
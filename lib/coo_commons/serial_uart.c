@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <coo_commons/serial_uart.h>
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(coo_serial_uart, LOG_LEVEL_INF);
+
+#if DT_HAS_CHOSEN(coo_command_uart)
+#define SERIAL_UART_NODE DT_CHOSEN(coo_command_uart)
+#else
+#define SERIAL_UART_NODE DT_CHOSEN(zephyr_console)
+#endif
+
+/* Largest single DMA transfer taken from the transmit ring */
+#define TX_CHUNK_MAX 256U
+
+struct serial_line {
+	uint16_t len;
+	bool too_long;
+	char text[CONFIG_COO_SERIAL_UART_LINE_MAX];
+};
+
+static const struct device *const uart_dev = DEVICE_DT_GET(SERIAL_UART_NODE);
+
+/* Receive: two DMA buffers handed to the driver in turn */
+static uint8_t rx_buf[2][CONFIG_COO_SERIAL_UART_RX_BUF_SIZE];
+static uint8_t rx_next;
+/* Line being assembled; touched only from the UART callback */
+static struct serial_line rx_line;
+K_MSGQ_DEFINE(rx_lines, sizeof(struct serial_line), CONFIG_COO_SERIAL_UART_RX_LINES, 4);
+
+/* Transmit: puts and DMA claims both happen under tx_lock */
+RING_BUF_DECLARE(tx_ring, CONFIG_COO_SERIAL_UART_TX_BUF_SIZE);
+static struct k_spinlock tx_lock;
+static uint32_t tx_inflight;
+static bool tx_busy;
+K_SEM_DEFINE(tx_space, 0, 1);
+
+static struct coo_serial_uart_stats stats;
+
+/* Caller holds tx_lock */
+static void tx_kick_locked(void)
+{
+	uint8_t *chunk;
+	uint32_t len;
+
+	if (tx_busy) {
+		return;
+	}
+
+	len = ring_buf_get_claim(&tx_ring, &chunk, TX_CHUNK_MAX);
+	if (len == 0U) {
+		return;
+	}
+	if (uart_tx(uart_dev, chunk, len, SYS_FOREVER_US) != 0) {
+		(void)ring_buf_get_finish(&tx_ring, 0U);
+		return;
+	}
+	tx_inflight = len;
+	tx_busy = true;
+}
+
+static void tx_done(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+	(void)ring_buf_get_finish(&tx_ring, tx_inflight);
+	tx_inflight = 0U;
+	tx_busy = false;
+	tx_kick_locked();
+	k_spin_unlock(&tx_lock, key);
+
+	k_sem_give(&tx_space);
+}
+
+static void rx_line_end(void)
+{
+	if (rx_line.len > 0U || rx_line.too_long) {
+		rx_line.text[rx_line.len] = '\0';
+		if (rx_line.too_long) {
+			stats.lines_too_long++;
+		}
+		if (k_msgq_put(&rx_lines, &rx_line, K_NO_WAIT) != 0) {
+			stats.lines_dropped++;
+		} else {
+			stats.lines++;
+		}
+	}
+	rx_line.len = 0U;
+	rx_line.too_long = false;
+}
+
+static void rx_bytes(const uint8_t *buf, size_t len)
+{
+	for (size_t i = 0U; i < len; ++i) {
+		const char ch = (char)buf[i];
+
+		if (ch == '\r' || ch == '\n') {
+			rx_line_end();
+			continue;
+		}
+		if (ch == '\b' || ch == 0x7f) {
+			if (rx_line.len > 0U) {
+				rx_line.len--;
+			}
+			continue;
+		}
+		if ((unsigned char)ch < 0x20U && ch != '\t') {
+			continue;
+		}
+		if (rx_line.len + 1U >= sizeof(rx_line.text)) {
+			rx_line.too_long = true;
+			continue;
+		}
+		rx_line.text[rx_line.len++] = ch;
+	}
+}
+
+static int rx_start(void)
+{
+	int rc = uart_rx_enable(uart_dev, rx_buf[rx_next], sizeof(rx_buf[0]),
+				CONFIG_COO_SERIAL_UART_RX_IDLE_US);
+
+	if (rc == 0) {
+		rx_next ^= 1U;
+	}
+	return rc;
+}
+
+static void serial_uart_event(const struct device *dev, struct uart_event *evt, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	switch (evt->type) {
+	case UART_TX_DONE:
+	case UART_TX_ABORTED:
+		tx_done();
+		break;
+
+	case UART_RX_RDY:
+		rx_bytes(&evt->data.rx.buf[evt->data.rx.offset], evt->data.rx.len);
+		break;
+
+	case UART_RX_BUF_REQUEST:
+		if (uart_rx_buf_rsp(dev, rx_buf[rx_next], sizeof(rx_buf[0])) == 0) {
+			rx_next ^= 1U;
+		}
+		break;
+
+	case UART_RX_STOPPED:
+		stats.rx_errors++;
+		break;
+
+	case UART_RX_DISABLED:
+		/* An error or a missed buffer request stopped the receiver */
+		(void)rx_start();
+		break;
+
+	default:
+		break;
+	}
+}
+
+int coo_serial_uart_init(void)
+{
+	int rc;
+
+	if (!device_is_ready(uart_dev)) {
+		LOG_ERR("Serial command UART not ready");
+		return -ENODEV;
+	}
+
+	rc = uart_callback_set(uart_dev, serial_uart_event, NULL);
+	if (rc != 0) {
+		LOG_ERR("UART async API unavailable (%d)", rc);
+		return rc;
+	}
+
+	rc = rx_start();
+	if (rc != 0) {
+		LOG_ERR("UART DMA receive failed to start (%d)", rc);
+	}
+	return rc;
+}
+
+int coo_serial_uart_read_line(char *line, size_t line_size)
+{
+	struct serial_line next;
+
+	if (line == NULL || line_size == 0U) {
+		return -EINVAL;
+	}
+	if (k_msgq_get(&rx_lines, &next, K_NO_WAIT) != 0) {
+		return -EAGAIN;
+	}
+	if (next.too_long || next.len >= line_size) {
+		line[0] = '\0';
+		return -EMSGSIZE;
+	}
+
+	memcpy(line, next.text, next.len + 1U);
+	return next.len;
+}
+
+size_t coo_serial_uart_write(const void *data, size_t len)
+{
+	const uint8_t *src = data;
+	k_spinlock_key_t key;
+	size_t done = 0U;
+
+	if (src == NULL) {
+		return 0U;
+	}
+
+	while (done < len) {
+		key = k_spin_lock(&tx_lock);
+		done += ring_buf_put(&tx_ring, &src[done], len - done);
+		stats.tx_pending_max = MAX(stats.tx_pending_max, ring_buf_size_get(&tx_ring));
+		tx_kick_locked();
+		k_spin_unlock(&tx_lock, key);
+
+		if (done == len) {
+			break;
+		}
+		/* Ring full: sleep until a DMA transfer finishes, never spin */
+		if (k_is_in_isr() ||
+		    k_sem_take(&tx_space, K_MSEC(CONFIG_COO_SERIAL_UART_TX_WAIT_MS)) != 0) {
+			key = k_spin_lock(&tx_lock);
+			stats.tx_dropped += len - done;
+			k_spin_unlock(&tx_lock, key);
+			break;
+		}
+	}
+
+	key = k_spin_lock(&tx_lock);
+	stats.tx_bytes += done;
+	k_spin_unlock(&tx_lock, key);
+
+	return done;
+}
+
+void coo_serial_uart_get_stats(struct coo_serial_uart_stats *out)
+{
+	k_spinlock_key_t key;
+
+	if (out == NULL) {
+		return;
+	}
+
+	key = k_spin_lock(&tx_lock);
+	*out = stats;
+	k_spin_unlock(&tx_lock, key);
+}
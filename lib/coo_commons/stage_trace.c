@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <coo_commons/stage_trace.h>
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+
+static const char *const stage_names[COO_TRACE_STAGE_COUNT] = {
+	[COO_TRACE_ADC_SWEEP] = "adc_sweep",
+	[COO_TRACE_SENSOR_CONVERT] = "convert",
+	[COO_TRACE_FUSION] = "fusion",
+	[COO_TRACE_PID] = "pid",
+	[COO_TRACE_HEATER_APPLY] = "heaters",
+	[COO_TRACE_COMMAND] = "command",
+	[COO_TRACE_MQTT_PUBLISH] = "publish",
+};
+
+static struct k_spinlock trace_lock;
+static struct coo_trace_stage_stats trace_table[COO_TRACE_STAGE_COUNT];
+static uint32_t trace_hz;
+
+void coo_trace_record(enum coo_trace_stage stage, uint32_t cycles)
+{
+	struct coo_trace_stage_stats *s;
+	k_spinlock_key_t key;
+	uint32_t bucket;
+
+	if ((unsigned int)stage >= COO_TRACE_STAGE_COUNT) {
+		return;
+	}
+
+	bucket = 31U - (uint32_t)__builtin_clz(cycles | 1U);
+	s = &trace_table[stage];
+
+	key = k_spin_lock(&trace_lock);
+	if (s->count == 0U || cycles < s->min_cycles) {
+		s->min_cycles = cycles;
+	}
+	if (cycles > s->max_cycles) {
+		s->max_cycles = cycles;
+	}
+	s->total_cycles += cycles;
+	s->hist[bucket]++;
+	s->count++;
+	k_spin_unlock(&trace_lock, key);
+}
+
+int coo_trace_get(enum coo_trace_stage stage, struct coo_trace_stage_stats *out)
+{
+	k_spinlock_key_t key;
+
+	if ((unsigned int)stage >= COO_TRACE_STAGE_COUNT || out == NULL) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&trace_lock);
+	*out = trace_table[stage];
+	k_spin_unlock(&trace_lock, key);
+
+	return 0;
+}
+
+void coo_trace_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+	memset(trace_table, 0, sizeof(trace_table));
+	k_spin_unlock(&trace_lock, key);
+}
+
+uint32_t coo_trace_cycles_per_sec(void)
+{
+	return trace_hz;
+}
+
+const char *coo_trace_stage_name(enum coo_trace_stage stage)
+{
+	if ((unsigned int)stage >= COO_TRACE_STAGE_COUNT) {
+		return NULL;
+	}
+
+	return stage_names[stage];
+}
+
+int coo_trace_stage_find(const char *name)
+{
+	if (name == NULL) {
+		return -ENOENT;
+	}
+
+	for (int i = 0; i < COO_TRACE_STAGE_COUNT; i++) {
+		if (strcmp(name, stage_names[i]) == 0) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static int stage_trace_init(void)
+{
+#ifdef CONFIG_CPU_CORTEX_M_HAS_DWT
+	uint32_t cyc_start;
+	uint32_t dwt_start;
+	uint64_t cyc;
+	uint64_t dwt;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0U;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	/*
+	 * The DWT runs at the core clock, which the system timer need not.
+	 * Measure it against the kernel cycle counter over a short busy wait.
+	 */
+	cyc_start = k_cycle_get_32();
+	dwt_start = DWT->CYCCNT;
+	k_busy_wait(CONFIG_COO_STAGE_TRACE_CALIBRATION_US);
+	dwt = DWT->CYCCNT - dwt_start;
+	cyc = k_cycle_get_32() - cyc_start;
+
+	trace_hz = (cyc > 0U)
+		   ? (uint32_t)(dwt * sys_clock_hw_cycles_per_sec() / cyc)
+		   : (uint32_t)sys_clock_hw_cycles_per_sec();
+#else
+	trace_hz = (uint32_t)sys_clock_hw_cycles_per_sec();
+#endif
+
+	return 0;
+}
+
+SYS_INIT(stage_trace_init, APPLICATION, 0);
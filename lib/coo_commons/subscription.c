@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <coo_commons/subscription.h>
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <coo_commons/json_utils.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(coo_subscription, LOG_LEVEL_INF);
+
+/* Caller holds subs->lock */
+static struct coo_subscription *find_locked(struct coo_subscriptions *subs,
+					    const char *key)
+{
+	for (size_t i = 0U; i < subs->count; ++i) {
+		if (subs->table[i].active && strcmp(subs->table[i].key, key) == 0) {
+			return &subs->table[i];
+		}
+	}
+
+	return NULL;
+}
+
+int coo_subscriptions_init(struct coo_subscriptions *subs,
+			   coo_subscription_resolve_fn resolve,
+			   coo_subscription_read_fn read,
+			   void *user_data)
+{
+	if (subs == NULL || subs->table == NULL || subs->count == 0U ||
+	    resolve == NULL || read == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_init(&subs->lock);
+	subs->resolve = resolve;
+	subs->read = read;
+	subs->user_data = user_data;
+	memset(subs->table, 0, subs->count * sizeof(subs->table[0]));
+	return 0;
+}
+
+int coo_subscription_add(struct coo_subscriptions *subs, const char *key,
+			 const struct coo_subscription_params *params)
+{
+	struct coo_subscription *sub;
+	uint32_t ref;
+	int rc;
+
+	if (subs == NULL || subs->resolve == NULL || key == NULL || params == NULL ||
+	    key[0] == '\0' || strlen(key) >= COO_CMD_KEY_MAX ||
+	    !(params->deadband >= 0.0) ||
+	    (params->max_interval_ms != 0U &&
+	     params->max_interval_ms < params->min_interval_ms)) {
+		return -EINVAL;
+	}
+
+	rc = subs->resolve(key, &ref, subs->user_data);
+	if (rc != 0) {
+		return -ENOENT;
+	}
+
+	k_mutex_lock(&subs->lock, K_FOREVER);
+	sub = find_locked(subs, key);
+	for (size_t i = 0U; sub == NULL && i < subs->count; ++i) {
+		if (!subs->table[i].active) {
+			sub = &subs->table[i];
+			strcpy(sub->key, key);
+		}
+	}
+	if (sub == NULL) {
+		k_mutex_unlock(&subs->lock);
+		return -ENOSPC;
+	}
+
+	sub->ref = ref;
+	sub->params = *params;
+	sub->published = false;
+	sub->active = true;
+	k_mutex_unlock(&subs->lock);
+
+	return 0;
+}
+
+int coo_subscription_remove(struct coo_subscriptions *subs, const char *key)
+{
+	struct coo_subscription *sub;
+
+	if (subs == NULL || key == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&subs->lock, K_FOREVER);
+	sub = find_locked(subs, key);
+	if (sub != NULL) {
+		sub->active = false;
+	}
+	k_mutex_unlock(&subs->lock);
+
+	return sub != NULL ? 0 : -ENOENT;
+}
+
+void coo_subscription_clear(struct coo_subscriptions *subs)
+{
+	if (subs == NULL) {
+		return;
+	}
+
+	k_mutex_lock(&subs->lock, K_FOREVER);
+	for (size_t i = 0U; i < subs->count; ++i) {
+		subs->table[i].active = false;
+	}
+	k_mutex_unlock(&subs->lock);
+}
+
+/* Decide whether @p value is worth a publication at @p now_ms */
+static bool subscription_due(const struct coo_subscription *sub, double value,
+			     int64_t now_ms)
+{
+	int64_t since = now_ms - sub->last_publish_ms;
+
+	if (!sub->published) {
+		return true;
+	}
+	if (since < (int64_t)sub->params.min_interval_ms) {
+		return false;
+	}
+	if (sub->params.max_interval_ms != 0U &&
+	    since >= (int64_t)sub->params.max_interval_ms) {
+		return true;
+	}
+	if (isnan(value) || isnan(sub->last_value)) {
+		return isnan(value) != isnan(sub->last_value);
+	}
+
+	return fabs(value - sub->last_value) > sub->params.deadband;
+}
+
+int coo_subscription_poll(struct coo_subscriptions *subs,
+			  struct coo_cmd_runtime *runtime,
+			  struct coo_cmd_response *out)
+{
+	int published = 0;
+
+	if (subs == NULL || subs->read == NULL || runtime == NULL || out == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&subs->lock, K_FOREVER);
+	for (size_t i = 0U; i < subs->count; ++i) {
+		struct coo_subscription *sub = &subs->table[i];
+		int64_t now_ms;
+		double value;
+		size_t off = 0U;
+		int rc;
+
+		if (!sub->active) {
+			continue;
+		}
+
+		/* Skip the read entirely while the rate limit holds */
+		now_ms = k_uptime_get();
+		if (sub->published &&
+		    now_ms - sub->last_publish_ms < (int64_t)sub->params.min_interval_ms) {
+			continue;
+		}
+
+		if (subs->read(sub->ref, &value, subs->user_data) != 0) {
+			value = NAN;
+		}
+		if (!subscription_due(sub, value, now_ms)) {
+			continue;
+		}
+
+		rc = coo_json_append(out->payload, sizeof(out->payload), &off, "{\"value\":");
+		if (rc == 0) {
+			rc = coo_json_append_float_or_null(out->payload, sizeof(out->payload),
+							   &off, value, 12);
+		}
+		if (rc == 0) {
+			rc = coo_json_append(out->payload, sizeof(out->payload), &off,
+					     ",\"time_ms\":%lld}", (long long)now_ms);
+		}
+		if (rc != 0) {
+			continue;
+		}
+		out->payload_len = off;
+
+		rc = coo_cmd_runtime_emit(runtime, &(const struct coo_cmd_runtime_emit_args){
+			.type = COO_CMD_RUNTIME_EMIT_DATA,
+			.delivery = COO_CMD_RUNTIME_EMIT_BEST_EFFORT,
+			.suffix = sub->key,
+			.out = out,
+		});
+		if (rc != 0) {
+			/* Outbound queue full; the rest wait for the next poll */
+			break;
+		}
+
+		sub->last_value = value;
+		sub->last_publish_ms = now_ms;
+		sub->published = true;
+		published++;
+	}
+	k_mutex_unlock(&subs->lock);
+
+	return published;
+}
+
+int coo_subscription_subscribe_cmd(struct coo_subscriptions *subs,
+				   const struct coo_cmd_request *cmd,
+				   struct coo_cmd_response *out)
+{
+	struct coo_subscription_params params = {0};
+	struct coo_json_doc doc;
+	char key[COO_CMD_KEY_MAX];
+	int rc;
+
+	if (coo_json_doc_parse(&doc, cmd->payload, NULL, NULL, 0U) != 0 ||
+	    coo_json_doc_get_string(&doc, "key", key, sizeof(key)) != COO_JSON_EXTRACT_OK) {
+		return coo_cmd_error(out, cmd, "key required");
+	}
+	if (coo_json_doc_optional_double_range(&doc, "deadband", &params.deadband, NULL,
+					       0.0, 1e9) != 0 ||
+	    coo_json_doc_optional_u32(&doc, "min_interval", &params.min_interval_ms,
+				      NULL) != 0 ||
+	    coo_json_doc_optional_u32(&doc, "max_interval", &params.max_interval_ms,
+				      NULL) != 0) {
+		return coo_cmd_error(out, cmd, "invalid subscription parameters");
+	}
+
+	rc = coo_subscription_add(subs, key, &params);
+	if (rc == -ENOENT) {
+		return coo_cmd_error(out, cmd, "unknown value key");
+	}
+	if (rc == -ENOSPC) {
+		return coo_cmd_error(out, cmd, "subscription table full");
+	}
+	if (rc != 0) {
+		return coo_cmd_error(out, cmd, "invalid subscription parameters");
+	}
+
+	return coo_cmd_ok(out, cmd);
+}
+
+int coo_subscription_unsubscribe_cmd(struct coo_subscriptions *subs,
+				     const struct coo_cmd_request *cmd,
+				     struct coo_cmd_response *out)
+{
+	struct coo_json_doc doc;
+	char key[COO_CMD_KEY_MAX];
+
+	if (coo_json_doc_parse(&doc, cmd->payload, NULL, NULL, 0U) != 0 ||
+	    coo_json_doc_get_string(&doc, "key", key, sizeof(key)) != COO_JSON_EXTRACT_OK) {
+		return coo_cmd_error(out, cmd, "key required");
+	}
+	if (coo_subscription_remove(subs, key) != 0) {
+		return coo_cmd_error(out, cmd, "not subscribed");
+	}
+
+	return coo_cmd_ok(out, cmd);
+}
+
+int coo_subscription_list_cmd(struct coo_subscriptions *subs,
+			      const struct coo_cmd_request *cmd,
+			      struct coo_cmd_response *out)
+{
+	char payload[COO_CMD_PAYLOAD_MAX];
+	size_t off = 0U;
+	bool first = true;
+	int rc;
+
+	if (subs == NULL) {
+		return coo_cmd_error(out, cmd, "subscriptions unavailable");
+	}
+
+	rc = coo_json_append(payload, sizeof(payload), &off, "{\"subscriptions\":[");
+	k_mutex_lock(&subs->lock, K_FOREVER);
+	for (size_t i = 0U; i < subs->count && rc == 0; ++i) {
+		const struct coo_subscription *sub = &subs->table[i];
+
+		if (!sub->active) {
+			continue;
+		}
+		rc = coo_json_append(payload, sizeof(payload), &off,
+				     "%s{\"key\":\"%s\",\"deadband\":%g,"
+				     "\"min_interval\":%u,\"max_interval\":%u}",
+				     first ? "" : ",", sub->key, sub->params.deadband,
+				     (unsigned int)sub->params.min_interval_ms,
+				     (unsigned int)sub->params.max_interval_ms);
+		first = false;
+	}
+	k_mutex_unlock(&subs->lock);
+	if (rc == 0) {
+		rc = coo_json_append(payload, sizeof(payload), &off, "]}");
+	}
+	if (rc != 0) {
+		return coo_cmd_error(out, cmd, "response too large");
+	}
+
+	return coo_cmd_reply(out, cmd, COO_CMD_RESP_OK, payload);
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2024 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <coo_commons/telemetry.h>
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+
+#if defined(CONFIG_COO_MQTT)
+#include <coo_commons/command_dispatch.h>
+#endif
+
+#ifdef CONFIG_COO_TELEMETRY_BATCH_RECORDS
+#define TELEMETRY_BATCH_RECORDS CONFIG_COO_TELEMETRY_BATCH_RECORDS
+#else
+#define TELEMETRY_BATCH_RECORDS 32
+#endif
+
+BUILD_ASSERT(sizeof(float) == sizeof(uint32_t), "telemetry encodes floats as 32 bits");
+
+void coo_telemetry_record(struct coo_telemetry *tm,
+			  const struct coo_telemetry_sample *sample)
+{
+	k_spinlock_key_t key;
+	uint16_t slot;
+
+	if (tm == NULL || sample == NULL || tm->depth == 0U) {
+		return;
+	}
+
+	key = k_spin_lock(&tm->lock);
+	slot = (uint16_t)((tm->head + tm->count) % tm->depth);
+	if (tm->count == tm->depth) {
+		/* Full: overwrite the oldest sample */
+		tm->head = (uint16_t)((tm->head + 1U) % tm->depth);
+		if (tm->dropped < UINT16_MAX) {
+			tm->dropped++;
+		}
+	} else {
+		tm->count++;
+	}
+	tm->ring[slot] = *sample;
+	k_spin_unlock(&tm->lock, key);
+}
+
+size_t coo_telemetry_pending(struct coo_telemetry *tm)
+{
+	k_spinlock_key_t key;
+	size_t count;
+
+	if (tm == NULL) {
+		return 0U;
+	}
+
+	key = k_spin_lock(&tm->lock);
+	count = tm->count;
+	k_spin_unlock(&tm->lock, key);
+
+	return count;
+}
+
+void coo_telemetry_clear(struct coo_telemetry *tm)
+{
+	k_spinlock_key_t key;
+
+	if (tm == NULL) {
+		return;
+	}
+
+	key = k_spin_lock(&tm->lock);
+	tm->head = 0U;
+	tm->count = 0U;
+	tm->dropped = 0U;
+	k_spin_unlock(&tm->lock, key);
+}
+
+static void put_le_float(uint8_t *dst, float value)
+{
+	uint32_t bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+	sys_put_le32(bits, dst);
+}
+
+static void encode_record(uint8_t *dst, const struct coo_telemetry_sample *s)
+{
+	sys_put_le32(s->timestamp_ms, &dst[0]);
+	dst[4] = s->channel;
+	dst[5] = s->flags;
+	dst[6] = (uint8_t)s->status;
+	dst[7] = s->kind;
+	put_le_float(&dst[8], s->measured);
+	put_le_float(&dst[12], s->setpoint);
+	put_le_float(&dst[16], s->p_term);
+	put_le_float(&dst[20], s->i_term);
+	put_le_float(&dst[24], s->d_term);
+	put_le_float(&dst[28], s->output);
+}
+
+int coo_telemetry_encode(struct coo_telemetry *tm, uint8_t *buf, size_t buf_len,
+			 size_t max_records)
+{
+	struct coo_telemetry_sample sample;
+	k_spinlock_key_t key;
+	size_t fit;
+	uint16_t dropped;
+	uint32_t seq;
+	size_t n = 0U;
+
+	if (tm == NULL || buf == NULL) {
+		return -EINVAL;
+	}
+	if (buf_len < COO_TELEMETRY_FRAME_SIZE(1)) {
+		return -ENOSPC;
+	}
+
+	fit = (buf_len - COO_TELEMETRY_HEADER_SIZE) / COO_TELEMETRY_RECORD_SIZE;
+	if (max_records > fit) {
+		max_records = fit;
+	}
+	if (max_records > UINT16_MAX) {
+		max_records = UINT16_MAX;
+	}
+
+	key = k_spin_lock(&tm->lock);
+	if (tm->count == 0U || max_records == 0U) {
+		k_spin_unlock(&tm->lock, key);
+		return 0;
+	}
+	dropped = tm->dropped;
+	tm->dropped = 0U;
+	seq = tm->seq++;
+	k_spin_unlock(&tm->lock, key);
+
+	/*
+	 * Pop one sample per lock hold so the producer is never held off for
+	 * a whole batch; it only ever appends behind what is being drained.
+	 */
+	while (n < max_records) {
+		key = k_spin_lock(&tm->lock);
+		if (tm->count == 0U) {
+			k_spin_unlock(&tm->lock, key);
+			break;
+		}
+		sample = tm->ring[tm->head];
+		tm->head = (uint16_t)((tm->head + 1U) % tm->depth);
+		tm->count--;
+		k_spin_unlock(&tm->lock, key);
+
+		encode_record(&buf[COO_TELEMETRY_FRAME_SIZE(n)], &sample);
+		n++;
+	}
+
+	sys_put_le16(COO_TELEMETRY_SCHEMA_ID, &buf[0]);
+	buf[2] = COO_TELEMETRY_SCHEMA_VERSION;
+	buf[3] = COO_TELEMETRY_RECORD_SIZE;
+	sys_put_le16((uint16_t)n, &buf[4]);
+	sys_put_le16(dropped, &buf[6]);
+	sys_put_le32(seq, &buf[8]);
+
+	return (int)COO_TELEMETRY_FRAME_SIZE(n);
+}
+
+#if defined(CONFIG_COO_MQTT)
+int coo_telemetry_publish(struct coo_telemetry *tm, struct coo_cmd_runtime *runtime,
+			  const char *suffix, struct coo_cmd_response *out)
+{
+	int len;
+
+	if (tm == NULL || runtime == NULL || suffix == NULL || out == NULL) {
+		return -EINVAL;
+	}
+
+	len = coo_telemetry_encode(tm, (uint8_t *)out->payload, sizeof(out->payload),
+				   TELEMETRY_BATCH_RECORDS);
+	if (len <= 0) {
+		return len;
+	}
+	out->payload_len = (size_t)len;
+
+	/* The runtime fills in the data topic, target and QoS */
+	len = coo_cmd_runtime_emit(runtime, &(const struct coo_cmd_runtime_emit_args){
+		.type = COO_CMD_RUNTIME_EMIT_DATA,
+		.delivery = COO_CMD_RUNTIME_EMIT_BEST_EFFORT,
+		.suffix = suffix,
+		.out = out,
+	});
+	if (len != 0) {
+		return len;
+	}
+
+	return (int)((out->payload_len - COO_TELEMETRY_HEADER_SIZE) /
+		     COO_TELEMETRY_RECORD_SIZE);
+}
+#endif
@@ -7,16 +7,21 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/regulator.h>
+#include <zephyr/sys/atomic.h>
+#include <coo_commons/log_limit.h>
+#include <coo_commons/stage_trace.h>
+#ifdef CONFIG_COO_HEATER_PWM
+#include <zephyr/drivers/pwm.h>
+#endif
 #include <math.h>
 #include <string.h>
 
 LOG_MODULE_REGISTER(heater_manager, LOG_LEVEL_INF);
 
-#define MAX_MANAGED_HEATERS 16
+BUILD_ASSERT(MAX_MANAGED_HEATERS < NO_CONFIG_INDEX, "heater handles must fit config_index_t");
 
-/* Heater state */
+/* Heater state; IDs stay in the config */
 static struct {
-    char id[MAX_ID_LENGTH];
     float power_percent;
     float max_power_watts;
     float resistance_ohms;
@@ -24,7 +29,23 @@ static struct {
     bool enabled;
     heater_type_t type;
     const struct device *regulator_dev;
-    bool regulator_active;
+    int (*force_off)(const struct device *dev); /* Lock-free cut, NULL = none */
+    atomic_t regulator_owned;    /* 1 while this module holds an enable on regulator_dev */
+    float uv_per_sqrt_percent;   /* sqrt(max_power * R / 100) in uV, set at init */
+    bool hw_synced;              /* Hardware reflects power_percent */
+    atomic_t fault;              /* Set by heater_manager_report_fault(), lock-free */
+    struct coo_log_limit hw_log;       /* Output write failures */
+    struct coo_log_limit disabled_log; /* Commands to a disabled heater */
+    struct coo_log_limit clamp_log;    /* Power clamps of the group this heater leads */
+#ifdef CONFIG_COO_HEATER_PWM
+    /*
+     * PWM heaters never take heater_mutex: the duty is one timer compare
+     * register write, latched by the timer at its next period boundary,
+     * and the last duty is kept in an atomic for readers.
+     */
+    const struct pwm_dt_spec *pwm;
+    atomic_t pwm_duty_centi;     /* Duty in 0.01% units, -1 = not yet written */
+#endif
 } heater_state[MAX_MANAGED_HEATERS];
 
 static int num_heaters = 0;
@@ -33,6 +54,13 @@ static const thermal_config_t *config_ptr = NULL;
 /* Thread-safe mutex for heater control */
 K_MUTEX_DEFINE(heater_mutex);
 
+static struct coo_log_limit no_capacity_log;
+
+static inline const char *id_of(int idx)
+{
+    return config_ptr->heaters[idx].id;
+}
+
 int heater_manager_init(const thermal_config_t *config)
 {
     if (config == NULL) {
@@ -51,7 +79,6 @@ int heater_manager_init(const thermal_config_t *config)
     /* Initialize heater state */
     memset(heater_state, 0, sizeof(heater_state));
     for (int i = 0; i < num_heaters; i++) {
-        strncpy(heater_state[i].id, config->heaters[i].id, MAX_ID_LENGTH - 1);
         heater_state[i].power_percent = 0.0f;
         heater_state[i].max_power_watts = config->heaters[i].max_power_w;
         heater_state[i].resistance_ohms = config->heaters[i].resistance_ohms;
@@ -59,7 +86,16 @@ int heater_manager_init(const thermal_config_t *config)
         heater_state[i].enabled = config->heaters[i].enabled;
         heater_state[i].status = config->heaters[i].enabled ?
                                   HEATER_STATUS_OK : HEATER_STATUS_DISABLED;
-        heater_state[i].regulator_active = false;
+        atomic_clear(&heater_state[i].regulator_owned);
+        heater_state[i].hw_synced = false;
+
+        float resistance = config->heaters[i].resistance_ohms;
+        if (resistance <= 0.001f) {
+            /* Avoid division by zero/invalid resistance */
+            resistance = 1.0f;
+        }
+        heater_state[i].uv_per_sqrt_percent =
+            sqrtf(heater_state[i].max_power_watts * resistance / 100.0f) * 1000000.0f;
 
         /* Initialize regulator if applicable */
         if (heater_state[i].type == HEATER_TYPE_HIGH_POWER) {
@@ -67,29 +103,40 @@ int heater_manager_init(const thermal_config_t *config)
               * Using regulator device provided in configuration.
               */
              heater_state[i].regulator_dev = config->heaters[i].regulator_dev;
+             heater_state[i].force_off = config->heaters[i].force_off;
              
              if (!heater_state[i].regulator_dev) {
-                 LOG_ERR("Regulator device not provided for heater %s", heater_state[i].id);
+                 LOG_ERR("Regulator device not provided for heater %s", id_of(i));
                  heater_state[i].status = HEATER_STATUS_ERROR;
              } else if (!device_is_ready(heater_state[i].regulator_dev)) {
-                 LOG_ERR("Regulator device not ready for heater %s", heater_state[i].id);
+                 LOG_ERR("Regulator device not ready for heater %s", id_of(i));
                  heater_state[i].status = HEATER_STATUS_ERROR;
              } else {
-                 LOG_INF("Bound heater %s to regulator", heater_state[i].id);
-                 /* Ensure output is disabled initially */
-                 if (heater_state[i].regulator_active) {
-                     regulator_disable(heater_state[i].regulator_dev);
-                     heater_state[i].regulator_active = false;
-                 }
+                 /* Output stays off until the first non-zero command enables it */
+                 LOG_INF("Bound heater %s to regulator", id_of(i));
              }
         } else {
             heater_state[i].regulator_dev = NULL;
+#ifdef CONFIG_COO_HEATER_PWM
+            heater_state[i].pwm = config->heaters[i].pwm;
+            atomic_set(&heater_state[i].pwm_duty_centi, -1);
+            if (heater_state[i].pwm == NULL) {
+                LOG_WRN("No PWM output for low-power heater %s", id_of(i));
+            } else if (!pwm_is_ready_dt(heater_state[i].pwm)) {
+                LOG_ERR("PWM device not ready for heater %s", id_of(i));
+                heater_state[i].pwm = NULL;
+                heater_state[i].status = HEATER_STATUS_ERROR;
+            } else {
+                LOG_INF("Bound heater %s to PWM channel %u", id_of(i),
+                        (unsigned int)heater_state[i].pwm->channel);
+            }
+#endif
         }
     }
 
     /* Ensure all heaters are starting in a safe off state */
     for (int i = 0; i < num_heaters; i++) {
-        heater_manager_set_power(heater_state[i].id, 0.0f);
+        heater_manager_set_power_by_handle(i, 0.0f);
     }
 
     LOG_INF("Heater manager initialized with %d heaters", num_heaters);
@@ -97,13 +144,65 @@ int heater_manager_init(const thermal_config_t *config)
     return 0;
 }
 
+int heater_manager_find_handle(const char *heater_id)
+{
+    if (heater_id == NULL) {
+        return -1;
+    }
+
+    /* The config outlives the manager and its IDs never change, so no lock */
+    int index = (config_ptr != NULL) ? config_heater_index(config_ptr, heater_id) : -1;
+
+    return (index >= 0 && index < num_heaters) ? index : -2;
+}
+
 int heater_manager_set_power(const char *heater_id, float power_percent)
 {
     if (heater_id == NULL) {
         return -1;
     }
 
-    /* Clamp to valid range */
+    int handle = heater_manager_find_handle(heater_id);
+    if (handle < 0) {
+        LOG_ERR("Heater %s not found", heater_id);
+        return -2;
+    }
+
+    return heater_manager_set_power_by_handle(handle, power_percent);
+}
+
+#ifdef CONFIG_COO_HEATER_PWM
+static inline bool is_pwm_heater(int idx)
+{
+    return heater_state[idx].pwm != NULL;
+}
+
+/* Zero a PWM heater's duty regardless of the fault latch; lock-free */
+static int cut_pwm(int idx)
+{
+    int ret = pwm_set_pulse_dt(heater_state[idx].pwm, 0);
+
+    if (ret == 0) {
+        atomic_set(&heater_state[idx].pwm_duty_centi, 0);
+    }
+    return ret;
+}
+
+/*
+ * Drive a PWM heater; lock-free. Power into a resistive load at fixed
+ * supply voltage is proportional to duty, so the duty is power_percent.
+ * pwm_set_pulse_dt only writes the compare register, and the STM32 timer
+ * preloads it to the next update event, so the call never blocks and a
+ * period is never cut short.
+ */
+static int apply_pwm(int idx, float power_percent)
+{
+    const struct pwm_dt_spec *pwm = heater_state[idx].pwm;
+
+    if (!heater_state[idx].enabled) {
+        return -3;
+    }
+
     if (power_percent < 0.0f) {
         power_percent = 0.0f;
     }
@@ -111,201 +210,605 @@ int heater_manager_set_power(const char *heater_id, float power_percent)
         power_percent = 100.0f;
     }
 
-    k_mutex_lock(&heater_mutex, K_FOREVER);
+    /* A latched fault holds the output at zero until it is cleared */
+    if (atomic_get(&heater_state[idx].fault)) {
+        return -4;
+    }
 
-    /* Find heater */
-    int idx = -1;
-    for (int i = 0; i < num_heaters; i++) {
-        if (strcmp(heater_state[i].id, heater_id) == 0) {
-            idx = i;
-            break;
-        }
+    atomic_val_t centi = (atomic_val_t)(power_percent * 100.0f + 0.5f);
+
+    if (atomic_get(&heater_state[idx].pwm_duty_centi) == centi) {
+        return 0;
     }
 
-    if (idx < 0) {
-        k_mutex_unlock(&heater_mutex);
-        LOG_ERR("Heater %s not found", heater_id);
-        return -2;
+    uint32_t pulse = (uint32_t)(((uint64_t)pwm->period * (uint32_t)centi) / 10000U);
+    int ret = pwm_set_pulse_dt(pwm, pulse);
+    if (ret < 0) {
+        COO_LOG_LIMITED(ERR, &heater_state[idx].hw_log,
+                        "Failed to set PWM duty for heater %s: %d", id_of(idx), ret);
+        return -5;
+    }
+
+    atomic_set(&heater_state[idx].pwm_duty_centi, centi);
+
+    /*
+     * A fault latched between the check above and the write may have cut
+     * the output before our write: cut it again. Checked after the duty
+     * is published, so a cut racing this one still leaves it at zero.
+     */
+    if (atomic_get(&heater_state[idx].fault)) {
+        (void)cut_pwm(idx);
+        return -4;
+    }
+
+    COO_LOG_LIMITED_CLEAR(INF, &heater_state[idx].hw_log, "Heater %s output recovered",
+                          id_of(idx));
+    return 0;
+}
+
+#else
+static inline bool is_pwm_heater(int idx)
+{
+    ARG_UNUSED(idx);
+    return false;
+}
+
+static inline int apply_pwm(int idx, float power_percent)
+{
+    ARG_UNUSED(idx);
+    ARG_UNUSED(power_percent);
+    return -5;
+}
+
+static inline int cut_pwm(int idx)
+{
+    ARG_UNUSED(idx);
+    return -5;
+}
+#endif
+
+/*
+ * Drop this module's enable on the regulator, if it holds one. The
+ * regulator API counts enables, so ownership is taken with a
+ * compare-and-swap: each enable is matched by exactly one disable however
+ * the cut paths race, and a heater that was never enabled is not touched.
+ * A failed disable leaves the count as it was, and ownership with it.
+ * @return 0, or the regulator's error
+ */
+static int release_regulator(int idx)
+{
+    if (!atomic_cas(&heater_state[idx].regulator_owned, 1, 0)) {
+        return 0;
+    }
+
+    int ret = regulator_disable(heater_state[idx].regulator_dev);
+
+    if (ret < 0) {
+        atomic_set(&heater_state[idx].regulator_owned, 1);
+    }
+    return ret;
+}
+
+/*
+ * Disable a faulted regulator heater and bring its bookkeeping in line.
+ * The reporter cut it without the lock, but may have lost a race with an
+ * enable here that took ownership after its cut, so release again rather
+ * than assume its cut won. The release is the counted disable matching
+ * our enable, so it runs once per enable; later commands while latched
+ * find nothing owned and touch no hardware. Caller holds heater_mutex.
+ * @return -4 (faulted), or -5 if the regulator would not disable
+ */
+static int cut_regulator_locked(int idx)
+{
+    int ret = release_regulator(idx);
+
+    heater_state[idx].status = HEATER_STATUS_ERROR;
+    heater_state[idx].power_percent = 0.0f;
+    heater_state[idx].hw_synced = false;
+    if (ret < 0) {
+        COO_LOG_LIMITED(ERR, &heater_state[idx].hw_log,
+                        "Failed to disable faulted heater %s: %d", id_of(idx), ret);
+        return -5;
+    }
+    return -4;
+}
+
+/*
+ * Drive one heater to power_percent. Caller holds heater_mutex.
+ * A heater already at the requested level is not touched, so a steady
+ * control output costs no bus traffic.
+ */
+static int apply_locked(int idx, float power_percent)
+{
+    const char *heater_id = id_of(idx);
+
+    /* Clamp to valid range */
+    if (power_percent < 0.0f) {
+        power_percent = 0.0f;
+    }
+    if (power_percent > 100.0f) {
+        power_percent = 100.0f;
     }
 
     if (!heater_state[idx].enabled) {
-        k_mutex_unlock(&heater_mutex);
-        LOG_WRN("Heater %s is disabled", heater_id);
+        COO_LOG_LIMITED(WRN, &heater_state[idx].disabled_log, "Heater %s is disabled",
+                        heater_id);
         return -3;
     }
 
+    bool regulated = heater_state[idx].type == HEATER_TYPE_HIGH_POWER &&
+                     heater_state[idx].regulator_dev != NULL;
+
+    /* Before the unchanged-power shortcut, so a steady command still sees the latch */
+    if (atomic_get(&heater_state[idx].fault)) {
+        if (regulated) {
+            return cut_regulator_locked(idx);
+        }
+        /* No output to cut, but a latched heater takes no commands either */
+        return -4;
+    }
+
+    if (heater_state[idx].hw_synced && heater_state[idx].power_percent == power_percent) {
+        return 0;
+    }
+
     /* Update power level */
     heater_state[idx].power_percent = power_percent;
 
-    if (heater_state[idx].type == HEATER_TYPE_HIGH_POWER && heater_state[idx].regulator_dev != NULL) {
-        
+    if (regulated) {
         if (heater_state[idx].status == HEATER_STATUS_ERROR) {
-            k_mutex_unlock(&heater_mutex);
             return -4;
         }
 
-        /* Calculate target power in Watts */
-        float target_power = (power_percent / 100.0f) * heater_state[idx].max_power_watts;
-        
-        /* Calculate target voltage: V = sqrt(P * R) */
-        /* Convert to microvolts for regulator API */
-        float resistance = heater_state[idx].resistance_ohms;
-        if (resistance <= 0.001f) {
-             /* Avoid division by zero/invalid resistance */
-             resistance = 1.0f; 
-        }
-        
-        float target_voltage = sqrtf(target_power * resistance);
-        int32_t target_uv = (int32_t)(target_voltage * 1000000.0f);
+        /* V = sqrt(P * R) with P = percent/100 * max, folded into uv_per_sqrt_percent */
+        int32_t target_uv = (int32_t)(heater_state[idx].uv_per_sqrt_percent * sqrtf(power_percent));
+
+        LOG_DBG("Heater %s: %.1f%% -> %d uV", heater_id, (double)power_percent, target_uv);
 
-        LOG_DBG("Heater %s: %.1f%% -> %.2fW -> %.3fV (%d uV)", heater_id, (double)power_percent, (double)target_power, (double)target_voltage, target_uv);
+        /* Mark unsynced until the hardware has taken the new state */
+        heater_state[idx].hw_synced = false;
 
         if (target_uv > 0) {
+            /* The driver skips the bus write if the DAC code is unchanged */
             int ret = regulator_set_voltage(heater_state[idx].regulator_dev, target_uv, target_uv);
-            if (ret < 0) {
-                LOG_ERR("Failed to set voltage for heater %s: %d", heater_id, ret);
+            bool failed = (ret < 0);
+            if (failed) {
+                COO_LOG_LIMITED(ERR, &heater_state[idx].hw_log,
+                                "Failed to set voltage for heater %s: %d", heater_id, ret);
                 /* Don't return error yet, try to enable/disable */
             }
-            
-            if (!heater_state[idx].regulator_active) {
+
+            if (!atomic_get(&heater_state[idx].regulator_owned)) {
                 ret = regulator_enable(heater_state[idx].regulator_dev);
                 if (ret < 0) {
-                    LOG_ERR("Failed to enable regulator for heater %s: %d", heater_id, ret);
+                    COO_LOG_LIMITED(ERR, &heater_state[idx].hw_log,
+                                    "Failed to enable regulator for heater %s: %d",
+                                    heater_id, ret);
+                    failed = true;
                 } else {
-                    heater_state[idx].regulator_active = true;
+                    /* Owned only from here, so a cut that ran before this can't disable it */
+                    atomic_set(&heater_state[idx].regulator_owned, 1);
                 }
             }
+            /* A fault latched while we drove the output may have lost the race to it */
+            if (atomic_get(&heater_state[idx].fault)) {
+                return cut_regulator_locked(idx);
+            }
+            if (failed) {
+                return -5;
+            }
         } else {
-             if (heater_state[idx].regulator_active) {
-                int ret = regulator_disable(heater_state[idx].regulator_dev);
-                if (ret < 0) {
-                    LOG_ERR("Failed to disable regulator for heater %s: %d", heater_id, ret);
-                } else {
-                    heater_state[idx].regulator_active = false;
-                }
+             int ret = release_regulator(idx);
+             if (ret < 0) {
+                COO_LOG_LIMITED(ERR, &heater_state[idx].hw_log,
+                                "Failed to disable regulator for heater %s: %d",
+                                heater_id, ret);
+                return -5;
              }
         }
     }
 
-    /* TODO: Set hardware output based on power_percent (PWM for low power) */
-    /* For now, just log */
+    /* Low-power heaters without a PWM binding have no output to drive */
+    heater_state[idx].hw_synced = true;
+    COO_LOG_LIMITED_CLEAR(INF, &heater_state[idx].hw_log, "Heater %s output recovered",
+                          heater_id);
     LOG_DBG("Heater %s power set to %.1f%%", heater_id, (double)power_percent);
 
-    k_mutex_unlock(&heater_mutex);
     return 0;
 }
 
-int heater_manager_distribute_power(const char *heater_ids[], int num_heaters_to_use,
-                                     float total_power_watts)
+int heater_manager_set_power_by_handle(int handle, float power_percent)
 {
-    if (heater_ids == NULL || num_heaters_to_use <= 0) {
+    if (handle < 0 || handle >= num_heaters) {
+        return -2;
+    }
+
+    if (is_pwm_heater(handle)) {
+        return apply_pwm(handle, power_percent);
+    }
+
+    k_mutex_lock(&heater_mutex, K_FOREVER);
+    int ret = apply_locked(handle, power_percent);
+    k_mutex_unlock(&heater_mutex);
+
+    return ret;
+}
+
+static int apply_batch(const heater_command_t cmds[], int num_cmds)
+{
+    int errors = 0;
+
+    if (cmds == NULL || num_cmds < 0) {
+        return -1;
+    }
+
+    /* PWM heaters first, without the lock */
+    int locked_cmds = 0;
+
+    for (int i = 0; i < num_cmds; i++) {
+        int h = cmds[i].handle;
+
+        if (h < 0 || h >= num_heaters) {
+            errors++;
+        } else if (is_pwm_heater(h)) {
+            if (apply_pwm(h, cmds[i].power_percent) != 0) {
+                errors++;
+            }
+        } else {
+            locked_cmds++;
+        }
+    }
+
+    if (locked_cmds == 0) {
+        return -errors;
+    }
+
+    /* One lock for the rest of the tick's commands */
+    k_mutex_lock(&heater_mutex, K_FOREVER);
+
+    for (int i = 0; i < num_cmds; i++) {
+        int h = cmds[i].handle;
+
+        if (h >= 0 && h < num_heaters && !is_pwm_heater(h) &&
+            apply_locked(h, cmds[i].power_percent) != 0) {
+            errors++;
+        }
+    }
+
+    k_mutex_unlock(&heater_mutex);
+
+    return -errors;
+}
+
+int heater_manager_apply(const heater_command_t cmds[], int num_cmds)
+{
+    COO_TRACE_BEGIN(apply_start);
+    int ret = apply_batch(cmds, num_cmds);
+
+    COO_TRACE_END(COO_TRACE_HEATER_APPLY, apply_start);
+    return ret;
+}
+
+int heater_manager_plan_distribution(const config_index_t handles[], int num_handles,
+                                     float total_power_watts,
+                                     heater_command_t cmds[], int max_cmds)
+{
+    if (handles == NULL || num_handles <= 0 || cmds == NULL) {
         return -1;
     }
 
-    /* Calculate total max power available */
+    /* max_power_watts is set once at init, so no lock is needed here */
     float total_max_power = 0.0f;
-    for (int i = 0; i < num_heaters_to_use; i++) {
-        for (int j = 0; j < num_heaters; j++) {
-            if (strcmp(heater_state[j].id, heater_ids[i]) == 0) {
-                total_max_power += heater_state[j].max_power_watts;
-                break;
+    int lead = -1;
+    for (int i = 0; i < num_handles; i++) {
+        int h = handles[i];
+        if (h >= 0 && h < num_heaters) {
+            total_max_power += heater_state[h].max_power_watts;
+            if (lead < 0) {
+                lead = h;
             }
         }
     }
 
     if (total_max_power <= 0.0f) {
-        LOG_ERR("No heater capacity available");
+        COO_LOG_LIMITED(ERR, &no_capacity_log, "No heater capacity available");
         return -2;
     }
 
-    /* Clamp total power */
+    /*
+     * Clamp total power. A saturated loop asks for too much every tick, so
+     * the warning is kept per group, on the state of its first heater.
+     */
     if (total_power_watts > total_max_power) {
-        LOG_WRN("Requested power %.1fW exceeds max %.1fW, clamping",
-                (double)total_power_watts, (double)total_max_power);
+        COO_LOG_LIMITED(WRN, &heater_state[lead].clamp_log,
+                        "Requested power %.1fW exceeds max %.1fW for heater %s, clamping",
+                        (double)total_power_watts, (double)total_max_power, id_of(lead));
         total_power_watts = total_max_power;
+    } else {
+        COO_LOG_LIMITED_CLEAR(INF, &heater_state[lead].clamp_log,
+                              "Heater %s group back within its power limit", id_of(lead));
     }
     if (total_power_watts < 0.0f) {
         total_power_watts = 0.0f;
     }
 
-    /* Distribute proportionally */
-    for (int i = 0; i < num_heaters_to_use; i++) {
-        for (int j = 0; j < num_heaters; j++) {
-            if (strcmp(heater_state[j].id, heater_ids[i]) == 0) {
-                float fraction = heater_state[j].max_power_watts / total_max_power;
-                float heater_power = total_power_watts * fraction;
-                float power_percent = (heater_power / heater_state[j].max_power_watts) * 100.0f;
-                heater_manager_set_power(heater_ids[i], power_percent);
-                break;
+    /*
+     * Distribute proportionally: each heater gets max_i / total_max of the
+     * total, which is the same fraction of its own max for every heater.
+     */
+    float power_percent = (total_power_watts / total_max_power) * 100.0f;
+    int count = 0;
+
+    for (int i = 0; i < num_handles; i++) {
+        int h = handles[i];
+        if (h >= 0 && h < num_heaters) {
+            if (count >= max_cmds) {
+                return -3;
             }
+            cmds[count].handle = h;
+            cmds[count].power_percent = power_percent;
+            count++;
         }
     }
 
+    return count;
+}
+
+int heater_manager_distribute_power_by_handle(const config_index_t handles[], int num_handles,
+                                               float total_power_watts)
+{
+    heater_command_t cmds[MAX_HEATERS_PER_LOOP];
+    int count = heater_manager_plan_distribution(handles, num_handles, total_power_watts,
+                                                 cmds, ARRAY_SIZE(cmds));
+
+    if (count < 0) {
+        return count;
+    }
+
+    heater_manager_apply(cmds, count);
     return 0;
 }
 
+int heater_manager_distribute_power(const char *heater_ids[], int num_heaters_to_use,
+                                     float total_power_watts)
+{
+    if (heater_ids == NULL || num_heaters_to_use <= 0) {
+        return -1;
+    }
+
+    config_index_t handles[MAX_HEATERS_PER_LOOP];
+
+    if (num_heaters_to_use > MAX_HEATERS_PER_LOOP) {
+        num_heaters_to_use = MAX_HEATERS_PER_LOOP;
+    }
+    for (int i = 0; i < num_heaters_to_use; i++) {
+        int handle = heater_manager_find_handle(heater_ids[i]);
+
+        handles[i] = (handle < 0) ? NO_CONFIG_INDEX : (config_index_t)handle;
+    }
+
+    return heater_manager_distribute_power_by_handle(handles, num_heaters_to_use,
+                                                     total_power_watts);
+}
+
 int heater_manager_emergency_stop(void)
 {
+    int errors = 0;
+
     LOG_WRN("EMERGENCY STOP - Disabling all heaters!");
 
     k_mutex_lock(&heater_mutex, K_FOREVER);
 
+    /*
+     * Cut every output in hardware now, latched fault or not. A regulator
+     * is disabled only if this module holds an enable on it: one it never
+     * enabled, or whose fault cut already released it, is already off as
+     * far as we are concerned, and a second disable would unbalance its
+     * enable count.
+     */
     for (int i = 0; i < num_heaters; i++) {
+        int ret = 0;
+
         heater_state[i].power_percent = 0.0f;
-        /* TODO: Set hardware output to 0% immediately */
+        /* Force the next command through to hardware */
+        heater_state[i].hw_synced = false;
+
+        if (is_pwm_heater(i)) {
+            ret = cut_pwm(i);
+        } else if (heater_state[i].regulator_dev != NULL) {
+            ret = release_regulator(i);
+        }
+        if (ret < 0) {
+            LOG_ERR("Failed to cut output of heater %s: %d", id_of(i), ret);
+            errors++;
+        }
     }
 
     k_mutex_unlock(&heater_mutex);
 
+    if (errors > 0) {
+        LOG_ERR("Emergency stop: %d heater(s) could not be cut", errors);
+        return -5;
+    }
+
     LOG_INF("All heaters stopped");
     return 0;
 }
 
-int heater_manager_get_power(const char *heater_id, float *power_percent)
+/*
+ * Latch the fault and cut the output. Callers may run while the control
+ * thread holds heater_mutex, so this must not block on it. Cut the
+ * output first, then let the next apply_locked() or clear update
+ * power_percent and release the enable. A regulator with a force_off
+ * hook is cut at the driver without locks or the enable count; one
+ * without falls back to releasing our enable here, which goes through
+ * the regulator API's own lock. Only an enable this module owns is
+ * released, so a repeated report cannot unbalance the regulator's count.
+ * A writer that checked the latch before it was set re-checks after its
+ * own write and cuts again, so losing the race to it cannot leave the
+ * output on.
+ * @return 1 if the fault was newly latched, 0 if already set, -5 if the
+ *         output could not be cut
+ */
+static int latch_fault(int handle)
 {
-    if (heater_id == NULL || power_percent == NULL) {
+    int latched = (atomic_set(&heater_state[handle].fault, 1) == 0) ? 1 : 0;
+    int ret = 0;
+
+    if (is_pwm_heater(handle)) {
+        ret = cut_pwm(handle);
+    } else if (heater_state[handle].force_off != NULL) {
+        ret = heater_state[handle].force_off(heater_state[handle].regulator_dev);
+    } else if (heater_state[handle].regulator_dev != NULL) {
+        ret = release_regulator(handle);
+    }
+    if (ret < 0) {
+        LOG_ERR("Failed to cut output of heater %s: %d", id_of(handle), ret);
+        return -5;
+    }
+
+    return latched;
+}
+
+int heater_manager_report_fault(int handle)
+{
+    if (handle < 0 || handle >= num_heaters) {
         return -1;
     }
 
-    k_mutex_lock(&heater_mutex, K_FOREVER);
+    int ret = latch_fault(handle);
 
-    int idx = -1;
-    for (int i = 0; i < num_heaters; i++) {
-        if (strcmp(heater_state[i].id, heater_id) == 0) {
-            idx = i;
-            break;
-        }
+    if (ret == 1) {
+        LOG_ERR("Hardware fault on heater %s", id_of(handle));
     }
+    return (ret < 0) ? ret : 0;
+}
 
-    if (idx < 0) {
-        k_mutex_unlock(&heater_mutex);
-        return -2;
+int heater_manager_interlock_cut(int handle)
+{
+    if (handle < 0 || handle >= num_heaters) {
+        return -1;
+    }
+
+    /* The interlock logs the trip itself, after the cut */
+    int ret = latch_fault(handle);
+
+    return (ret < 0) ? ret : 0;
+}
+
+int heater_manager_clear_fault(int handle)
+{
+    if (handle < 0 || handle >= num_heaters) {
+        return -1;
     }
 
-    *power_percent = heater_state[idx].power_percent;
+    k_mutex_lock(&heater_mutex, K_FOREVER);
+
+    atomic_clear(&heater_state[handle].fault);
+#ifdef CONFIG_COO_HEATER_PWM
+    /* Force the next duty through to the timer */
+    atomic_set(&heater_state[handle].pwm_duty_centi, -1);
+#endif
+    heater_state[handle].power_percent = 0.0f;
+    /*
+     * Ownership is left alone: the cut released it, and if that disable
+     * failed the enable is still held and the next zero command or cut
+     * releases it. The next non-zero command re-enables only if not owned.
+     */
+    heater_state[handle].hw_synced = false;
+    heater_state[handle].status = heater_state[handle].enabled ?
+                                  HEATER_STATUS_OK : HEATER_STATUS_DISABLED;
 
     k_mutex_unlock(&heater_mutex);
+
+    LOG_INF("Fault cleared on heater %s", id_of(handle));
     return 0;
 }
 
+int heater_manager_get_power_by_handle(int handle, float *power_percent)
+{
+    if (handle < 0 || handle >= num_heaters || power_percent == NULL) {
+        return -1;
+    }
+
+#ifdef CONFIG_COO_HEATER_PWM
+    if (is_pwm_heater(handle)) {
+        atomic_val_t centi = atomic_get(&heater_state[handle].pwm_duty_centi);
+
+        *power_percent = (centi < 0) ? 0.0f : (float)centi / 100.0f;
+        return 0;
+    }
+#endif
+
+    k_mutex_lock(&heater_mutex, K_FOREVER);
+    *power_percent = heater_state[handle].power_percent;
+    k_mutex_unlock(&heater_mutex);
+
+    return 0;
+}
+
+int heater_manager_get_power(const char *heater_id, float *power_percent)
+{
+    if (heater_id == NULL || power_percent == NULL) {
+        return -1;
+    }
+
+    int handle = heater_manager_find_handle(heater_id);
+    if (handle < 0) {
+        return -2;
+    }
+
+    return heater_manager_get_power_by_handle(handle, power_percent);
+}
+
 heater_status_t heater_manager_get_status(const char *heater_id)
 {
-    if (heater_id == NULL) {
+    int handle = heater_manager_find_handle(heater_id);
+    if (handle < 0) {
+        return HEATER_STATUS_ERROR;
+    }
+
+    /* A reported fault wins even before the control thread has seen it */
+    if (atomic_get(&heater_state[handle].fault)) {
         return HEATER_STATUS_ERROR;
     }
 
     k_mutex_lock(&heater_mutex, K_FOREVER);
+    heater_status_t status = heater_state[handle].status;
+    k_mutex_unlock(&heater_mutex);
+
+    return status;
+}
+
+int heater_manager_get_snapshot(heater_snapshot_t *snapshot)
+{
+    if (snapshot == NULL) {
+        return -1;
+    }
+
+    k_mutex_lock(&heater_mutex, K_FOREVER);
+    snapshot->count = num_heaters;
+    for (int i = 0; i < num_heaters; i++) {
+        snapshot->heaters[i].power_percent = heater_state[i].power_percent;
+        snapshot->heaters[i].status = heater_state[i].status;
+    }
+    k_mutex_unlock(&heater_mutex);
 
-    heater_status_t status = HEATER_STATUS_ERROR;
+    /* Same overrides as the single-heater getters */
     for (int i = 0; i < num_heaters; i++) {
-        if (strcmp(heater_state[i].id, heater_id) == 0) {
-            status = heater_state[i].status;
-            break;
+#ifdef CONFIG_COO_HEATER_PWM
+        if (is_pwm_heater(i)) {
+            atomic_val_t centi = atomic_get(&heater_state[i].pwm_duty_centi);
+
+            snapshot->heaters[i].power_percent = (centi < 0) ? 0.0f : (float)centi / 100.0f;
+        }
+#endif
+        if (atomic_get(&heater_state[i].fault)) {
+            snapshot->heaters[i].status = HEATER_STATUS_ERROR;
         }
     }
 
-    k_mutex_unlock(&heater_mutex);
-    return status;
+    return 0;
 }
 
 int heater_manager_get_count(void)
@@ -313,11 +816,11 @@ int heater_manager_get_count(void)
     return num_heaters;
 }
 
-/* IDs are set once at init and never mutated, so no lock is needed here */
+/* IDs live in the config and never change, so no lock is needed here */
 const char *heater_manager_get_id_at(int index)
 {
     if (index < 0 || index >= num_heaters) {
         return NULL;
     }
-    return heater_state[index].id;
+    return id_of(index);
 }
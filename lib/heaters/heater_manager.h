@@ -21,13 +21,104 @@ typedef enum {
     HEATER_STATUS_OVER_LIMIT = -4
 } heater_status_t;
 
+/* Maximum number of heaters we can manage */
+#define MAX_MANAGED_HEATERS 16
+
+/**
+ * One heater's state in a heater_manager_get_snapshot()
+ */
+typedef struct {
+    float power_percent;
+    heater_status_t status;
+} heater_reading_t;
+
+/**
+ * Every heater read under one hold of the heater lock
+ * Indexed by heater handle.
+ */
+typedef struct {
+    int count;
+    heater_reading_t heaters[MAX_MANAGED_HEATERS];
+} heater_snapshot_t;
+
+/**
+ * One heater power command, for batched actuation
+ */
+typedef struct {
+    int handle;
+    float power_percent;
+} heater_command_t;
+
 /**
  * Initialize heater manager
+ * Heater IDs are read from the configuration rather than copied, so it
+ * must stay valid while the manager is in use.
  * @param config Pointer to thermal configuration
  * @return 0 on success, negative error code on failure
  */
 int heater_manager_init(const thermal_config_t *config);
 
+/**
+ * Resolve a heater ID to a handle for the handle-based accessors
+ * Handles are indices into the configured heater table, so they stay
+ * valid for the lifetime of the configuration passed to init.
+ * @param heater_id Heater ID string
+ * @return handle >= 0 on success, negative error code if not found
+ */
+int heater_manager_find_handle(const char *heater_id);
+
+/**
+ * Set power level for a heater handle
+ * @param handle Heater handle from heater_manager_find_handle()
+ * @param power_percent Power level 0.0-100.0%
+ * @return 0 on success, negative error code on failure
+ */
+int heater_manager_set_power_by_handle(int handle, float power_percent);
+
+/**
+ * Distribute power across multiple heater handles
+ * Unresolved handles (NO_CONFIG_INDEX) are skipped.
+ * @param handles Array of heater handles
+ * @param num_handles Number of handles
+ * @param total_power_watts Total power to distribute in watts
+ * @return 0 on success, negative error code on failure
+ */
+int heater_manager_distribute_power_by_handle(const config_index_t handles[], int num_handles,
+                                               float total_power_watts);
+
+/**
+ * Compute per-heater commands for a power distribution without applying them
+ * Lets a caller gather every loop's commands for a tick and hand them to
+ * heater_manager_apply() in one go. Takes no locks.
+ * @param handles Array of heater handles (NO_CONFIG_INDEX entries are skipped)
+ * @param num_handles Number of handles
+ * @param total_power_watts Total power to distribute in watts
+ * @param cmds Output command array
+ * @param max_cmds Capacity of cmds
+ * @return number of commands written (>= 0), negative error code on failure
+ */
+int heater_manager_plan_distribution(const config_index_t handles[], int num_handles,
+                                     float total_power_watts,
+                                     heater_command_t cmds[], int max_cmds);
+
+/**
+ * Apply a batch of heater commands under a single lock
+ * Heaters already at the commanded level are skipped, and regulators
+ * skip writes whose DAC code is unchanged.
+ * @param cmds Command array
+ * @param num_cmds Number of commands
+ * @return 0 on success, negative count of failed commands otherwise
+ */
+int heater_manager_apply(const heater_command_t cmds[], int num_cmds);
+
+/**
+ * Get current power level for a heater handle
+ * @param handle Heater handle from heater_manager_find_handle()
+ * @param power_percent Pointer to store power level
+ * @return 0 on success, negative error code on failure
+ */
+int heater_manager_get_power_by_handle(int handle, float *power_percent);
+
 /**
  * Set power level for a specific heater
  * @param heater_id Heater ID string
@@ -49,10 +140,40 @@ int heater_manager_distribute_power(const char *heater_ids[], int num_heaters,
 
 /**
  * Emergency stop: turn off all heaters immediately
- * @return 0 on success, negative error code on failure
+ * Zeroes every PWM duty and disables every regulator in hardware, whether
+ * or not a fault is latched. Every heater is tried even if one fails.
+ * @return 0 on success, -5 if any output could not be cut
  */
 int heater_manager_emergency_stop(void);
 
+/**
+ * Report a hardware fault (short, overcurrent, overvoltage) on a heater
+ * Disables the heater's regulator (or zeroes its PWM duty) at once and
+ * latches HEATER_STATUS_ERROR until heater_manager_clear_fault(). Never
+ * blocks on the heater lock, so it is safe from a driver's fault work item.
+ * @param handle Heater handle
+ * @return 0 on success, negative error code on failure
+ */
+int heater_manager_report_fault(int handle);
+
+/**
+ * Cut a heater for a safety interlock trip
+ * Latches the same fault as heater_manager_report_fault(), so the heater
+ * stays off until heater_manager_clear_fault(), but does not log the
+ * fault: the caller reports the trip. Lock-free, safe from the sensor sweep.
+ * @param handle Heater handle
+ * @return 0 on success, negative error code on failure
+ */
+int heater_manager_interlock_cut(int handle);
+
+/**
+ * Clear a latched hardware fault
+ * The heater comes back off; the next command re-enables it.
+ * @param handle Heater handle
+ * @return 0 on success, negative error code on failure
+ */
+int heater_manager_clear_fault(int handle);
+
 /**
  * Get current power level for a heater
  * @param heater_id Heater ID string
@@ -68,6 +189,13 @@ int heater_manager_get_power(const char *heater_id, float *power_percent);
  */
 heater_status_t heater_manager_get_status(const char *heater_id);
 
+/**
+ * Copy every heater's power and status in one consistent read
+ * @param snapshot Pointer to store the snapshot
+ * @return 0 on success, negative error code on failure
+ */
+int heater_manager_get_snapshot(heater_snapshot_t *snapshot);
+
 /**
  * Get the number of configured heaters
  * @return heater count
@@ -2,18 +2,26 @@
  * @file adc_temp_sensor.c
  * @brief AD7124 ADC temperature sensor driver implementation
  *
- * Currently configured to read the AD7124's internal chip temperature sensor
+ * The single-shot API reads the AD7124's internal chip temperature sensor
  * for testing/development purposes.
  *
- * In production, this will be reconfigured to read external Penguin RTD sensors
- * connected to the AD7124's analog input channels.
+ * With CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER the same register helpers also
+ * back a Zephyr ADC device for the "adi,ad7124" node, which is how the
+ * sensor manager reads the external RTD channels: one adc_read() with a
+ * channel mask is one DRDY-paced pass of the part's channel sequencer.
  */
 
 #include "adc_temp_sensor.h"
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER
+#include <zephyr/drivers/adc.h>
+#include <zephyr/drivers/gpio.h>
+#endif
 #include <zephyr/logging/log.h>
+#include <coo_commons/log_limit.h>
+#include <errno.h>
 #include <string.h>
 
 LOG_MODULE_REGISTER(adc_temp_sensor, LOG_LEVEL_INF);
@@ -27,21 +35,176 @@ static const struct spi_dt_spec bus =
                     SPI_WORD_SET(8) | SPI_TRANSFER_MSB | SPI_MODE_CPOL | SPI_MODE_CPHA,
                     0);
 
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER
+BUILD_ASSERT(DT_NODE_HAS_COMPAT(AD7124_NODE, adi_ad7124),
+             "the sequencer ADC device needs the ad7124 node bound to adi,ad7124");
+
+/*
+ * Sequencer variant: the AD7124 only drives RDY onto DOUT while CS is low,
+ * so continuous mode keeps CS asserted and the bus locked between transfers.
+ */
+static const struct spi_dt_spec seq_bus =
+    SPI_DT_SPEC_GET(AD7124_NODE,
+                    SPI_WORD_SET(8) | SPI_TRANSFER_MSB | SPI_MODE_CPOL | SPI_MODE_CPHA |
+                    SPI_HOLD_ON_CS | SPI_LOCK_ON,
+                    0);
+
+/* Optional GPIO wired to DOUT/RDY for conversion-ready interrupts */
+static const struct gpio_dt_spec rdy_gpio = GPIO_DT_SPEC_GET_OR(AD7124_NODE, rdy_gpios, {0});
+#endif
+
+/* Which spec the register helpers use: seq_bus while the sequencer runs */
+static const struct spi_dt_spec *active_bus = &bus;
+
 /* AD7124 register addresses */
 #define REG_COMMS        0x00
 #define REG_ADC_CONTROL  0x01
 #define REG_DATA         0x02
+#define REG_IO_CONTROL_1 0x03
 #define REG_IO_CONTROL_2 0x04
 #define REG_ID           0x05
 #define REG_CHANNEL_0    0x09
 #define REG_CONFIG_0     0x19
 #define REG_FILTER0      0x21
 
+/* ADC_CONTROL bits */
+#define ADC_CTRL_DATA_STATUS (1u << 10)
+#define ADC_CTRL_REF_EN      (1u << 8)
+#define ADC_CTRL_FULL_POWER  (0x2u << 6)
+#define ADC_CTRL_STANDBY     (0x2u << 2)
+
+/* STATUS byte appended to DATA when DATA_STATUS is set */
+#define STATUS_RDY_N     0x80u
+#define STATUS_ERROR     0x40u
+#define STATUS_CH_MASK   0x0Fu
+
 /* Module state */
 static bool initialized = false;
 
+/* Per-sample failures: logged on the edge, then as periodic counts */
+static struct coo_log_limit not_ready_log;
+static struct coo_log_limit read_fail_log;
+
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER
+#define AD7124_MAX_CHANNELS 16
+#define AD7124_MAX_SETUPS   8
+
+static struct coo_log_limit seq_timeout_log;
+
+/*
+ * Sequencer state. Channel n of an adc_read() is CHANNEL_n of the part;
+ * its inputs and setup come from adc_channel_setup(). The sequence stays
+ * programmed and converting between reads, and is only rewritten when a
+ * read asks for a different channel mask.
+ */
+static struct {
+    bool running;
+    uint16_t enabled_mask;       /* Bit n set = CHANNEL_n in the sequence */
+    uint16_t configured_mask;    /* Channels with a channel_setup() */
+    struct {
+        uint8_t ainp;
+        uint8_t ainm;
+        uint8_t pga_code;
+        uint8_t ref_sel;
+    } channels[AD7124_MAX_CHANNELS];
+    bool iout_set;               /* Excitation pins, shared by every channel */
+    uint8_t iout_pins[2];
+    struct gpio_callback rdy_cb;
+    struct k_sem rdy_sem;
+} seq;
+
+/* Serializes the sequencer and single-shot paths over the register helpers */
+static K_MUTEX_DEFINE(ad7124_lock);
+#endif
+
 /* ========== Low-level SPI helpers ========== */
 
+/*
+ * Every register access is one full-duplex frame: command byte followed by
+ * up to four data bytes (24-bit DATA + STATUS). Frames go through static
+ * buffers so the async path can hand them to DMA.
+ */
+#define XFER_MAX 8
+
+static uint8_t xfer_tx[XFER_MAX] __aligned(4);
+static uint8_t xfer_rx[XFER_MAX] __aligned(4);
+
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_ASYNC
+/* A frame is at most 8 bytes; anything past this means the bus is stuck */
+#define XFER_TIMEOUT K_MSEC(50)
+
+static K_SEM_DEFINE(xfer_sem, 0, 1);
+static int xfer_result;
+
+/*
+ * Set when a frame timed out. Its callback may still come and DMA into
+ * xfer_rx, so the buffers stay with it until xfer_sem shows it arrived.
+ */
+static bool xfer_abandoned;
+static struct coo_log_limit xfer_busy_log;
+
+static void xfer_done(const struct device *dev, int result, void *user_data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(user_data);
+
+    xfer_result = result;
+    k_sem_give(&xfer_sem);
+}
+#endif
+
+/**
+ * Check that the frame buffers are free before filling them
+ * Each give of xfer_sem is taken exactly once, so a late callback of an
+ * abandoned frame is collected here rather than mistaken for the next
+ * frame's completion.
+ * @return false while an abandoned frame is still outstanding
+ */
+static bool xfer_buffers_free(void)
+{
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_ASYNC
+    if (xfer_abandoned) {
+        if (k_sem_take(&xfer_sem, K_NO_WAIT) != 0) {
+            COO_LOG_LIMITED(ERR, &xfer_busy_log, "SPI frame still outstanding, bus refused");
+            return false;
+        }
+        xfer_abandoned = false;
+        COO_LOG_LIMITED_CLEAR(INF, &xfer_busy_log, "Outstanding SPI frame completed");
+    }
+#endif
+    return true;
+}
+
+/**
+ * Run one frame of len bytes from xfer_tx, capturing into xfer_rx if rx.
+ * The caller checks xfer_buffers_free() before filling xfer_tx.
+ * With CONFIG_COO_ADC_TEMP_SENSOR_ASYNC the caller sleeps until the
+ * completion callback instead of spinning in the blocking transceive.
+ */
+static bool ad7124_xfer(size_t len, bool rx)
+{
+    struct spi_buf txb = { .buf = xfer_tx, .len = len };
+    struct spi_buf rxb = { .buf = xfer_rx, .len = len };
+    struct spi_buf_set TX = { .buffers = &txb, .count = 1 };
+    struct spi_buf_set RX = { .buffers = &rxb, .count = 1 };
+
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_ASYNC
+    if (spi_transceive_cb(active_bus->bus, &active_bus->config, &TX,
+                          rx ? &RX : NULL, xfer_done, NULL) != 0) {
+        return false;
+    }
+    if (k_sem_take(&xfer_sem, XFER_TIMEOUT) != 0) {
+        /* The frame still owns the buffers; no new frame until its callback */
+        xfer_abandoned = true;
+        LOG_ERR("SPI transfer timeout");
+        return false;
+    }
+    return xfer_result == 0;
+#else
+    return spi_transceive_dt(active_bus, &TX, rx ? &RX : NULL) == 0;
+#endif
+}
+
 /* ADI "no-shift" read command (R/W=1 at bit6, 6-bit addr) */
 static inline uint8_t cmd_read(uint8_t addr)
 {
@@ -53,18 +216,18 @@ static inline uint8_t cmd_read(uint8_t addr)
  */
 static bool ad7124_read(uint8_t reg, uint8_t *dst, size_t n)
 {
-    uint8_t tx[4] = { cmd_read(reg), 0xFF, 0xFF, 0xFF };
-    uint8_t rx[4] = { 0 };
-    struct spi_buf txb = { .buf = tx, .len = (uint32_t)(1 + n) };
-    struct spi_buf rxb = { .buf = rx, .len = (uint32_t)(1 + n) };
-    struct spi_buf_set TX = { .buffers = &txb, .count = 1 };
-    struct spi_buf_set RX = { .buffers = &rxb, .count = 1 };
+    if (n > XFER_MAX - 1 || !xfer_buffers_free()) {
+        return false;
+    }
+
+    xfer_tx[0] = cmd_read(reg);
+    memset(&xfer_tx[1], 0xFF, n);
 
-    if (spi_transceive_dt(&bus, &TX, &RX) != 0) {
+    if (!ad7124_xfer(1 + n, true)) {
         return false;
     }
 
-    memcpy(dst, &rx[1], n);
+    memcpy(dst, &xfer_rx[1], n);
     return true;
 }
 
@@ -93,18 +256,32 @@ static bool ad7124_read24(uint8_t reg, uint32_t *v)
     return true;
 }
 
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER
+/* 24-bit DATA followed by the STATUS byte (ADC_CONTROL.DATA_STATUS = 1) */
+static bool ad7124_read_data_status(uint32_t *data, uint8_t *status)
+{
+    uint8_t b[4] = {0, 0, 0, 0};
+    if (!ad7124_read(REG_DATA, b, 4)) {
+        return false;
+    }
+    *data = ((uint32_t)b[0] << 16) | ((uint32_t)b[1] << 8) | b[2];
+    *status = b[3];
+    return true;
+}
+#endif
+
 /**
  * Generic SPI write
  */
 static bool ad7124_write(uint8_t reg, const uint8_t *data, size_t n)
 {
-    uint8_t hdr = (uint8_t)(0x00u | (reg & 0x7Fu)); /* write, no-shift */
-    struct spi_buf seg[2] = {
-        { .buf = &hdr,         .len = 1 },
-        { .buf = (void*)data,  .len = (uint32_t)n }
-    };
-    struct spi_buf_set TX = { .buffers = seg, .count = 2 };
-    return spi_write_dt(&bus, &TX) == 0;
+    if (n > XFER_MAX - 1 || !xfer_buffers_free()) {
+        return false;
+    }
+
+    xfer_tx[0] = (uint8_t)(0x00u | (reg & 0x7Fu)); /* write, no-shift */
+    memcpy(&xfer_tx[1], data, n);
+    return ad7124_xfer(1 + n, false);
 }
 
 static bool ad7124_write16(uint8_t reg, uint16_t v)
@@ -124,11 +301,11 @@ static bool ad7124_write24(uint8_t reg, uint32_t v)
  */
 static void ad7124_soft_reset(void)
 {
-    uint8_t ff[8];
-    memset(ff, 0xFF, sizeof(ff));
-    struct spi_buf txb = { .buf = ff, .len = sizeof(ff) };
-    struct spi_buf_set TX = { .buffers = &txb, .count = 1 };
-    (void)spi_write_dt(&bus, &TX);
+    if (!xfer_buffers_free()) {
+        return;
+    }
+    memset(xfer_tx, 0xFF, XFER_MAX);
+    (void)ad7124_xfer(XFER_MAX, false);
 }
 
 /**
@@ -146,6 +323,45 @@ static bool ad7124_wait_ready_ms(int timeout_ms)
     return false;
 }
 
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER
+/* ========== DRDY interrupt ========== */
+
+static void rdy_isr(const struct device *port, struct gpio_callback *cb, gpio_port_pins_t pins)
+{
+    ARG_UNUSED(port);
+    ARG_UNUSED(cb);
+    ARG_UNUSED(pins);
+
+    /* One-shot: the line also toggles as DOUT during the data read */
+    (void)gpio_pin_interrupt_configure_dt(&rdy_gpio, GPIO_INT_DISABLE);
+    k_sem_give(&seq.rdy_sem);
+}
+
+/**
+ * Wait for the next conversion. With a RDY GPIO this sleeps on the falling
+ * edge; without one it falls back to polling STATUS.
+ */
+static bool ad7124_wait_conversion(k_timeout_t timeout)
+{
+    if (rdy_gpio.port == NULL) {
+        return ad7124_wait_ready_ms((int)k_ticks_to_ms_floor64(timeout.ticks));
+    }
+
+    k_sem_reset(&seq.rdy_sem);
+    if (gpio_pin_interrupt_configure_dt(&rdy_gpio, GPIO_INT_EDGE_TO_ACTIVE) != 0) {
+        return false;
+    }
+
+    /* A conversion that finished before arming left the line already low */
+    if (gpio_pin_get_dt(&rdy_gpio) == 1) {
+        (void)gpio_pin_interrupt_configure_dt(&rdy_gpio, GPIO_INT_DISABLE);
+        return true;
+    }
+
+    return k_sem_take(&seq.rdy_sem, timeout) == 0;
+}
+#endif
+
 /* ========== Temperature sensor configuration ========== */
 
 /**
@@ -224,6 +440,14 @@ int adc_temp_sensor_init(const thermal_config_t *config)
 
     LOG_INF("Initializing AD7124 temperature sensor");
 
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER
+    /* A reset would drop the sequence out from under the ADC device */
+    if (seq.running) {
+        LOG_ERR("Sequencer running; single-shot mode unavailable");
+        return -4;
+    }
+#endif
+
     /* Check SPI bus */
     if (!device_is_ready(bus.bus)) {
         LOG_ERR("SPI bus not ready");
@@ -258,7 +482,7 @@ int adc_temp_sensor_init(const thermal_config_t *config)
     return 0;
 }
 
-int adc_temp_sensor_read(const char *sensor_id, float *temp_kelvin)
+static int read_single(const char *sensor_id, float *temp_kelvin)
 {
     if (!initialized) {
         LOG_ERR("ADC temp sensor not initialized");
@@ -271,14 +495,14 @@ int adc_temp_sensor_read(const char *sensor_id, float *temp_kelvin)
 
     /* Wait for ADC ready */
     if (!ad7124_wait_ready_ms(500)) {
-        LOG_WRN("ADC not ready (sensor: %s)", sensor_id);
+        COO_LOG_LIMITED(WRN, &not_ready_log, "ADC not ready (sensor: %s)", sensor_id);
         return -3;
     }
 
     /* Read 24-bit data register */
     uint32_t raw = 0;
     if (!ad7124_read24(REG_DATA, &raw)) {
-        LOG_ERR("Failed to read ADC data (sensor: %s)", sensor_id);
+        COO_LOG_LIMITED(ERR, &read_fail_log, "Failed to read ADC data (sensor: %s)", sensor_id);
         return -4;
     }
 
@@ -286,12 +510,35 @@ int adc_temp_sensor_read(const char *sensor_id, float *temp_kelvin)
     float temp_c = ad7124_code_to_celsius(raw);
     *temp_kelvin = celsius_to_kelvin(temp_c);
 
-    LOG_INF("Sensor %s: Raw=0x%06x => %.2f C (%.2f K)",
+    COO_LOG_LIMITED_CLEAR(INF, &not_ready_log, "ADC ready again");
+    COO_LOG_LIMITED_CLEAR(INF, &read_fail_log, "ADC data reads recovered");
+    LOG_DBG("Sensor %s: Raw=0x%06x => %.2f C (%.2f K)",
             sensor_id, (unsigned)raw, (double)temp_c, (double)*temp_kelvin);
 
     return 0;
 }
 
+int adc_temp_sensor_read(const char *sensor_id, float *temp_kelvin)
+{
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER
+    int ret = -5;
+
+    /* The sequencer device owns the part while its sequence is running */
+    k_mutex_lock(&ad7124_lock, K_FOREVER);
+    if (!seq.running) {
+        ret = read_single(sensor_id, temp_kelvin);
+    }
+    k_mutex_unlock(&ad7124_lock);
+
+    if (ret == -5) {
+        LOG_WRN("Sequencer running; read the AD7124 through its ADC device");
+    }
+    return ret;
+#else
+    return read_single(sensor_id, temp_kelvin);
+#endif
+}
+
 int adc_temp_sensor_configure_channel(const char *sensor_id,
                                       const adc_channel_config_t *channel_config)
 {
@@ -318,9 +565,376 @@ bool adc_temp_sensor_is_ready(const char *sensor_id)
     }
 
     uint8_t st = 0xFF;
-    if (ad7124_read8(REG_COMMS, &st) && ((st & 0x80u) == 0)) {
-        return true;
+    bool ok = false;
+
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER
+    k_mutex_lock(&ad7124_lock, K_FOREVER);
+    if (!seq.running) {
+        ok = ad7124_read8(REG_COMMS, &st);
     }
+    k_mutex_unlock(&ad7124_lock);
+#else
+    ok = ad7124_read8(REG_COMMS, &st);
+#endif
 
-    return false;
+    return ok && ((st & 0x80u) == 0);
 }
+
+#ifdef CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER
+/* ========== Channel sequencer ========== */
+
+/* Zephyr gain -> CONFIG_n.PGA code */
+static int pga_code_of(enum adc_gain gain)
+{
+    switch (gain) {
+    case ADC_GAIN_1:   return 0;
+    case ADC_GAIN_2:   return 1;
+    case ADC_GAIN_4:   return 2;
+    case ADC_GAIN_8:   return 3;
+    case ADC_GAIN_16:  return 4;
+    case ADC_GAIN_32:  return 5;
+    case ADC_GAIN_64:  return 6;
+    case ADC_GAIN_128: return 7;
+    default:           return -1;
+    }
+}
+
+/* Zephyr reference -> CONFIG_n.REF_SEL */
+static int ref_sel_of(enum adc_reference ref)
+{
+    switch (ref) {
+    case ADC_REF_EXTERNAL0: return 0x0;   /* REFIN1 */
+    case ADC_REF_EXTERNAL1: return 0x1;   /* REFIN2 */
+    case ADC_REF_INTERNAL:  return 0x2;   /* Internal 2.5 V */
+    case ADC_REF_VDD_1:     return 0x3;   /* AVDD */
+    default:                return -1;
+    }
+}
+
+/* excitation-current-microamp -> IO_CONTROL_1.IOUTn code */
+static uint32_t iout_code(void)
+{
+    switch (DT_PROP_OR(AD7124_NODE, excitation_current_microamp, 500)) {
+    case 50:   return 1;
+    case 100:  return 2;
+    case 250:  return 3;
+    case 500:  return 4;
+    case 750:  return 5;
+    case 1000: return 6;
+    default:   return 0;
+    }
+}
+
+/* Back to standby, then drop CS and the bus lock. Caller holds ad7124_lock. */
+static void seq_stop(void)
+{
+    if (!seq.running) {
+        return;
+    }
+
+    if (rdy_gpio.port != NULL) {
+        (void)gpio_pin_interrupt_configure_dt(&rdy_gpio, GPIO_INT_DISABLE);
+    }
+
+    (void)ad7124_write16(REG_ADC_CONTROL, ADC_CTRL_REF_EN | ADC_CTRL_STANDBY);
+    (void)spi_release_dt(&seq_bus);
+    active_bus = &bus;
+    seq.running = false;
+}
+
+/*
+ * Program the channels in mask into the sequencer and start continuous
+ * conversion with STATUS appended. One setup (CONFIG_n/FILTER_n) per
+ * distinct gain and reference; the AD7124 has eight. Caller holds
+ * ad7124_lock.
+ */
+static int seq_start(uint16_t mask)
+{
+    uint8_t setup_key[AD7124_MAX_SETUPS];
+    int num_setups = 0;
+
+    seq_stop();
+
+    /* Standby while the sequence is rewritten */
+    if (!ad7124_write16(REG_ADC_CONTROL, ADC_CTRL_REF_EN | ADC_CTRL_STANDBY)) {
+        return -EIO;
+    }
+
+    uint32_t io1 = 0;
+
+    if (seq.iout_set) {
+        uint32_t code = iout_code();
+
+        io1 = (seq.iout_pins[0] & 0x0Fu) | ((uint32_t)(seq.iout_pins[1] & 0x0Fu) << 4) |
+              (code << 8) | (code << 11);
+    }
+    if (!ad7124_write24(REG_IO_CONTROL_1, io1)) {
+        return -EIO;
+    }
+
+    for (int ch = 0; ch < AD7124_MAX_CHANNELS; ch++) {
+        uint16_t reg = 0;
+
+        if (mask & BIT(ch)) {
+            uint8_t key = (uint8_t)((seq.channels[ch].ref_sel << 3) | seq.channels[ch].pga_code);
+            int setup = 0;
+
+            while (setup < num_setups && setup_key[setup] != key) {
+                setup++;
+            }
+            if (setup == num_setups) {
+                if (num_setups == AD7124_MAX_SETUPS) {
+                    LOG_ERR("Sequencer: more than %d distinct gain/reference setups",
+                            AD7124_MAX_SETUPS);
+                    return -ENOTSUP;
+                }
+                setup_key[num_setups++] = key;
+
+                /* Bipolar, reference and input buffers on, as in single-shot mode */
+                const uint16_t config =
+                    (1u << 11) | (1u << 8) | (1u << 7) | (1u << 6) | (1u << 5) | key;
+                if (!ad7124_write16(REG_CONFIG_0 + setup, config) ||
+                    !ad7124_write24(REG_FILTER0 + setup, 0x060180)) {
+                    return -EIO;
+                }
+            }
+
+            reg = (1u << 15) | ((uint16_t)setup << 12) |
+                  ((uint16_t)(seq.channels[ch].ainp & 0x1Fu) << 5) |
+                  (seq.channels[ch].ainm & 0x1Fu);
+        }
+
+        /* Unused channels are written zero so a stale enable cannot linger */
+        if (!ad7124_write16(REG_CHANNEL_0 + ch, reg)) {
+            return -EIO;
+        }
+    }
+
+    /*
+     * Continuous mode with STATUS appended; CS stays low from here on.
+     * Full power keeps the per-channel settling time short enough for a
+     * sixteen-channel sweep per control period.
+     */
+    active_bus = &seq_bus;
+    if (!ad7124_write16(REG_ADC_CONTROL,
+                        ADC_CTRL_DATA_STATUS | ADC_CTRL_REF_EN | ADC_CTRL_FULL_POWER)) {
+        (void)spi_release_dt(&seq_bus);
+        active_bus = &bus;
+        return -EIO;
+    }
+
+    seq.enabled_mask = mask;
+    seq.running = true;
+    LOG_INF("AD7124 sequencer running %d channels (%s)", POPCOUNT(mask),
+            rdy_gpio.port != NULL ? "RDY interrupt" : "polled");
+    return 0;
+}
+
+/*
+ * Collect one result from every sequenced channel into raw[channel]. The
+ * part cycles through the enabled channels on its own; take results as
+ * they arrive and file them by the channel number in STATUS until every
+ * channel has reported once, so a sweep costs the sum of the conversion
+ * times. Caller holds ad7124_lock.
+ */
+static int seq_sweep(uint32_t raw[AD7124_MAX_CHANNELS], k_timeout_t timeout)
+{
+    int64_t deadline = k_uptime_get() + k_ticks_to_ms_floor64(timeout.ticks);
+    uint16_t pending = seq.enabled_mask;
+    int errors = 0;
+
+    while (pending != 0) {
+        int64_t remaining = deadline - k_uptime_get();
+
+        if (remaining <= 0 || !ad7124_wait_conversion(K_MSEC(remaining))) {
+            COO_LOG_LIMITED(WRN, &seq_timeout_log, "Sequencer timeout, pending mask 0x%04x",
+                            pending);
+            return -ETIMEDOUT;
+        }
+
+        uint32_t data;
+        uint8_t status;
+
+        if (!ad7124_read_data_status(&data, &status)) {
+            return -EIO;
+        }
+
+        uint8_t ch = status & STATUS_CH_MASK;
+
+        if ((pending & BIT(ch)) == 0) {
+            continue;
+        }
+        if (status & STATUS_ERROR) {
+            errors++;
+        }
+        raw[ch] = data;
+        pending &= (uint16_t)~BIT(ch);
+    }
+
+    COO_LOG_LIMITED_CLEAR(INF, &seq_timeout_log, "Sequencer conversions resumed");
+    return (errors > 0) ? -EIO : 0;
+}
+
+/* ========== Zephyr ADC device ========== */
+
+static int ad7124_adc_channel_setup(const struct device *dev,
+                                    const struct adc_channel_cfg *cfg)
+{
+    ARG_UNUSED(dev);
+
+    int pga = pga_code_of(cfg->gain);
+    int ref = ref_sel_of(cfg->reference);
+
+    if (cfg->channel_id >= AD7124_MAX_CHANNELS || pga < 0 || ref < 0 ||
+        cfg->acquisition_time != ADC_ACQ_TIME_DEFAULT ||
+        cfg->input_positive > 0x1F || cfg->input_negative > 0x1F) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&ad7124_lock, K_FOREVER);
+
+#ifdef CONFIG_ADC_CONFIGURABLE_EXCITATION_CURRENT_SOURCE_PIN
+    /* IO_CONTROL_1 is one register, so every channel shares one excitation */
+    if (cfg->current_source_pin_set) {
+        if (seq.iout_set && (seq.iout_pins[0] != cfg->current_source_pin[0] ||
+                             seq.iout_pins[1] != cfg->current_source_pin[1])) {
+            k_mutex_unlock(&ad7124_lock);
+            LOG_ERR("Channel %u: excitation pins differ from another channel's",
+                    cfg->channel_id);
+            return -EINVAL;
+        }
+        seq.iout_pins[0] = cfg->current_source_pin[0];
+        seq.iout_pins[1] = cfg->current_source_pin[1];
+        seq.iout_set = true;
+    }
+#endif
+
+    seq.channels[cfg->channel_id].ainp = cfg->input_positive;
+    seq.channels[cfg->channel_id].ainm = cfg->input_negative;
+    seq.channels[cfg->channel_id].pga_code = (uint8_t)pga;
+    seq.channels[cfg->channel_id].ref_sel = (uint8_t)ref;
+    seq.configured_mask |= (uint16_t)BIT(cfg->channel_id);
+
+    /* The next read reprograms the part with the new setup */
+    seq_stop();
+    k_mutex_unlock(&ad7124_lock);
+    return 0;
+}
+
+/*
+ * One pass of the sequencer over the requested channels. Samples are the
+ * raw 24-bit offset-binary codes, one per channel in ascending channel
+ * order.
+ */
+static int ad7124_adc_read(const struct device *dev, const struct adc_sequence *sequence)
+{
+    ARG_UNUSED(dev);
+
+    uint32_t raw[AD7124_MAX_CHANNELS];
+    uint32_t channels = sequence->channels;
+    int count = POPCOUNT(channels);
+
+    if (channels == 0U || (channels & ~(uint32_t)seq.configured_mask) != 0U ||
+        sequence->resolution != 24) {
+        return -EINVAL;
+    }
+    if (sequence->oversampling != 0U || sequence->options != NULL || sequence->calibrate) {
+        return -ENOTSUP;
+    }
+    if (sequence->buffer_size < (size_t)count * sizeof(int32_t)) {
+        return -ENOMEM;
+    }
+
+    k_mutex_lock(&ad7124_lock, K_FOREVER);
+
+    int ret = 0;
+
+    if (!seq.running || seq.enabled_mask != (uint16_t)channels) {
+        ret = seq_start((uint16_t)channels);
+    }
+    if (ret == 0) {
+        ret = seq_sweep(raw, K_MSEC(count * CONFIG_COO_ADC_TEMP_SENSOR_CHANNEL_TIMEOUT_MS));
+    }
+    if (ret == -EIO || ret == -ETIMEDOUT) {
+        /* Reprogram from scratch on the next read rather than trust the part */
+        seq_stop();
+    }
+
+    k_mutex_unlock(&ad7124_lock);
+
+    if (ret != 0) {
+        return ret;
+    }
+
+    int32_t *out = sequence->buffer;
+
+    for (int ch = 0; ch < AD7124_MAX_CHANNELS; ch++) {
+        if (channels & BIT(ch)) {
+            *out++ = (int32_t)raw[ch];
+        }
+    }
+    return 0;
+}
+
+#ifdef CONFIG_ADC_ASYNC
+/* The sweep completes before this returns; the signal carries its result */
+static int ad7124_adc_read_async(const struct device *dev, const struct adc_sequence *sequence,
+                                 struct k_poll_signal *async)
+{
+    int ret = ad7124_adc_read(dev, sequence);
+
+    if (async == NULL) {
+        return ret;
+    }
+    (void)k_poll_signal_raise(async, ret);
+    return 0;
+}
+#endif
+
+static int ad7124_adc_init(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+
+    if (!spi_is_ready_dt(&bus)) {
+        LOG_ERR("SPI bus not ready");
+        return -ENODEV;
+    }
+
+    if (rdy_gpio.port != NULL) {
+        if (!gpio_is_ready_dt(&rdy_gpio) ||
+            gpio_pin_configure_dt(&rdy_gpio, GPIO_INPUT) != 0) {
+            LOG_ERR("RDY GPIO not ready");
+            return -ENODEV;
+        }
+        k_sem_init(&seq.rdy_sem, 0, 1);
+        gpio_init_callback(&seq.rdy_cb, rdy_isr, BIT(rdy_gpio.pin));
+        if (gpio_add_callback_dt(&rdy_gpio, &seq.rdy_cb) != 0) {
+            return -ENODEV;
+        }
+    }
+
+    ad7124_soft_reset();
+    k_msleep(3);
+
+    uint8_t id = 0;
+
+    if (!ad7124_read8(REG_ID, &id)) {
+        LOG_ERR("AD7124 not responding");
+        return -EIO;
+    }
+    LOG_INF("AD7124 sequencer device ready (ID 0x%02x)", id);
+    return 0;
+}
+
+static const struct adc_driver_api ad7124_adc_api = {
+    .channel_setup = ad7124_adc_channel_setup,
+    .read = ad7124_adc_read,
+#ifdef CONFIG_ADC_ASYNC
+    .read_async = ad7124_adc_read_async,
+#endif
+    .ref_internal = 2500,
+};
+
+DEVICE_DT_DEFINE(AD7124_NODE, ad7124_adc_init, NULL, NULL, NULL, POST_KERNEL,
+                 CONFIG_ADC_INIT_PRIORITY, &ad7124_adc_api);
+#endif /* CONFIG_COO_ADC_TEMP_SENSOR_SEQUENCER */
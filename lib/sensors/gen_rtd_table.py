@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Generate rtd_table.h: platinum RTD temperature vs. resistance ratio.
+
+The table is the inverse of the IEC 60751 Callendar-Van Dusen equation,
+sampled on a uniform grid of W = R(T) / R(0 C) so the firmware can index it
+directly (one multiply, one truncation, one lerp per sample).
+
+    T >= 0 C:  W = 1 + A*t + B*t^2
+    T <  0 C:  W = 1 + A*t + B*t^2 + C*(t - 100)*t^3
+
+Usage: gen_rtd_table.py > rtd_table.h
+"""
+
+A = 3.9083e-3
+B = -5.775e-7
+C = -4.183e-12
+
+# Grid: W = W_MIN + i / STEPS_PER_UNIT, covering -200 C .. 850 C
+STEPS_PER_UNIT = 64
+W_MIN_STEPS = 11
+ENTRIES = 240
+
+
+def cvd_ratio(t):
+    w = 1.0 + A * t + B * t * t
+    if t < 0.0:
+        w += C * (t - 100.0) * t ** 3
+    return w
+
+
+def cvd_inverse(w):
+    # W(t) is monotonic over the range, so bisection always converges
+    lo, hi = -273.15, 1000.0
+    for _ in range(100):
+        mid = 0.5 * (lo + hi)
+        if cvd_ratio(mid) < w:
+            lo = mid
+        else:
+            hi = mid
+    return 0.5 * (lo + hi)
+
+
+def main():
+    w_min = W_MIN_STEPS / STEPS_PER_UNIT
+    w_max = (W_MIN_STEPS + ENTRIES - 1) / STEPS_PER_UNIT
+
+    print("/**")
+    print(" * @file rtd_table.h")
+    print(" * @brief Platinum RTD Callendar-Van Dusen lookup table")
+    print(" *")
+    print(" * GENERATED by gen_rtd_table.py - do not edit by hand.")
+    print(" *")
+    print(" * Temperature in Kelvin at W = RTD_TABLE_W_MIN + i / RTD_TABLE_STEPS_PER_UNIT,")
+    print(" * where W = R(T) / R(0 C). IEC 60751: A = %.4e, B = %.4e, C = %.4e." % (A, B, C))
+    print(" * Range W = %.6f .. %.6f (%.1f C .. %.1f C)."
+          % (w_min, w_max, cvd_inverse(w_min), cvd_inverse(w_max)))
+    print(" */")
+    print()
+    print("#ifndef RTD_TABLE_H")
+    print("#define RTD_TABLE_H")
+    print()
+    print("#define RTD_TABLE_STEPS_PER_UNIT %d" % STEPS_PER_UNIT)
+    print("#define RTD_TABLE_W_MIN (%d.0f / RTD_TABLE_STEPS_PER_UNIT)" % W_MIN_STEPS)
+    print("#define RTD_TABLE_ENTRIES %d" % ENTRIES)
+    print()
+    print("static const float rtd_table_kelvin[RTD_TABLE_ENTRIES] = {")
+    for row in range(0, ENTRIES, 6):
+        vals = []
+        for i in range(row, min(row + 6, ENTRIES)):
+            w = (W_MIN_STEPS + i) / STEPS_PER_UNIT
+            vals.append("%.4ff" % (cvd_inverse(w) + 273.15))
+        print("    " + ", ".join(vals) + ",")
+    print("};")
+    print()
+    print("#endif /* RTD_TABLE_H */")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,62 @@
+/**
+ * @file rtd_table.h
+ * @brief Platinum RTD Callendar-Van Dusen lookup table
+ *
+ * GENERATED by gen_rtd_table.py - do not edit by hand.
+ *
+ * Temperature in Kelvin at W = RTD_TABLE_W_MIN + i / RTD_TABLE_STEPS_PER_UNIT,
+ * where W = R(T) / R(0 C). IEC 60751: A = 3.9083e-03, B = -5.7750e-07, C = -4.1830e-12.
+ * Range W = 0.171875 .. 3.906250 (-203.1 C .. 850.5 C).
+ */
+
+#ifndef RTD_TABLE_H
+#define RTD_TABLE_H
+
+#define RTD_TABLE_STEPS_PER_UNIT 64
+#define RTD_TABLE_W_MIN (11.0f / RTD_TABLE_STEPS_PER_UNIT)
+#define RTD_TABLE_ENTRIES 240
+
+static const float rtd_table_kelvin[RTD_TABLE_ENTRIES] = {
+    70.0718f, 73.6819f, 77.3032f, 80.9353f, 84.5782f, 88.2317f,
+    91.8956f, 95.5698f, 99.2542f, 102.9486f, 106.6529f, 110.3668f,
+    114.0902f, 117.8230f, 121.5650f, 125.3161f, 129.0760f, 132.8447f,
+    136.6220f, 140.4076f, 144.2016f, 148.0036f, 151.8137f, 155.6315f,
+    159.4570f, 163.2899f, 167.1303f, 170.9779f, 174.8325f, 178.6941f,
+    182.5624f, 186.4375f, 190.3191f, 194.2070f, 198.1013f, 202.0017f,
+    205.9082f, 209.8206f, 213.7388f, 217.6627f, 221.5923f, 225.5274f,
+    229.4678f, 233.4137f, 237.3648f, 241.3210f, 245.2824f, 249.2488f,
+    253.2202f, 257.1965f, 261.1777f, 265.1637f, 269.1545f, 273.1500f,
+    277.1503f, 281.1553f, 285.1650f, 289.1796f, 293.1989f, 297.2230f,
+    301.2520f, 305.2858f, 309.3245f, 313.3680f, 317.4165f, 321.4698f,
+    325.5281f, 329.5913f, 333.6595f, 337.7327f, 341.8109f, 345.8942f,
+    349.9824f, 354.0757f, 358.1741f, 362.2776f, 366.3862f, 370.5000f,
+    374.6189f, 378.7430f, 382.8723f, 387.0068f, 391.1465f, 395.2915f,
+    399.4417f, 403.5973f, 407.7581f, 411.9243f, 416.0959f, 420.2728f,
+    424.4551f, 428.6429f, 432.8361f, 437.0347f, 441.2388f, 445.4485f,
+    449.6636f, 453.8843f, 458.1106f, 462.3425f, 466.5799f, 470.8231f,
+    475.0718f, 479.3263f, 483.5864f, 487.8523f, 492.1239f, 496.4014f,
+    500.6846f, 504.9736f, 509.2684f, 513.5692f, 517.8758f, 522.1884f,
+    526.5068f, 530.8313f, 535.1617f, 539.4982f, 543.8407f, 548.1893f,
+    552.5439f, 556.9047f, 561.2716f, 565.6447f, 570.0240f, 574.4095f,
+    578.8012f, 583.1992f, 587.6035f, 592.0142f, 596.4312f, 600.8546f,
+    605.2844f, 609.7207f, 614.1634f, 618.6126f, 623.0683f, 627.5306f,
+    631.9995f, 636.4749f, 640.9571f, 645.4459f, 649.9414f, 654.4436f,
+    658.9526f, 663.4684f, 667.9910f, 672.5204f, 677.0567f, 681.6000f,
+    686.1502f, 690.7074f, 695.2716f, 699.8428f, 704.4211f, 709.0066f,
+    713.5991f, 718.1989f, 722.8058f, 727.4201f, 732.0415f, 736.6703f,
+    741.3065f, 745.9500f, 750.6010f, 755.2594f, 759.9252f, 764.5987f,
+    769.2797f, 773.9682f, 778.6645f, 783.3684f, 788.0800f, 792.7993f,
+    797.5265f, 802.2615f, 807.0043f, 811.7550f, 816.5137f, 821.2804f,
+    826.0551f, 830.8379f, 835.6288f, 840.4278f, 845.2350f, 850.0505f,
+    854.8742f, 859.7063f, 864.5467f, 869.3955f, 874.2528f, 879.1185f,
+    883.9928f, 888.8757f, 893.7672f, 898.6674f, 903.5763f, 908.4940f,
+    913.4204f, 918.3558f, 923.3000f, 928.2533f, 933.2155f, 938.1868f,
+    943.1671f, 948.1567f, 953.1554f, 958.1635f, 963.1808f, 968.2075f,
+    973.2436f, 978.2891f, 983.3442f, 988.4089f, 993.4832f, 998.5672f,
+    1003.6609f, 1008.7644f, 1013.8778f, 1019.0011f, 1024.1343f, 1029.2776f,
+    1034.4310f, 1039.5945f, 1044.7682f, 1049.9522f, 1055.1465f, 1060.3512f,
+    1065.5664f, 1070.7921f, 1076.0283f, 1081.2752f, 1086.5328f, 1091.8012f,
+    1097.0805f, 1102.3706f, 1107.6717f, 1112.9839f, 1118.3072f, 1123.6417f,
+};
+
+#endif /* RTD_TABLE_H */
@@ -0,0 +1,104 @@
+/**
+ * @file sensor_filter.c
+ * @brief Per-sensor streaming filter chain implementation
+ */
+
+#include "sensor_filter.h"
+#include <string.h>
+
+void sensor_filter_init(sensor_filter_t *filter, const sensor_config_t *sensor)
+{
+    memset(filter, 0, sizeof(*filter));
+
+    int window = sensor->median_filter_window;
+    if (window > SENSOR_FILTER_MAX_MEDIAN) {
+        window = SENSOR_FILTER_MAX_MEDIAN;
+    }
+    if (window > 1 && (window % 2) == 0) {
+        window--;    /* Odd sizes only, so the median is a real sample */
+    }
+    filter->median_window = (window > 1) ? (uint8_t)window : 0;
+
+    filter->oversample = (sensor->oversample > 1) ? sensor->oversample : 0;
+
+    float alpha = sensor->iir_alpha;
+    if (alpha < 0.0f) {
+        alpha = 0.0f;
+    } else if (alpha > 1.0f) {
+        alpha = 1.0f;
+    }
+    /* alpha of 1 passes input straight through, same as disabled */
+    filter->iir_alpha = (alpha < 1.0f) ? alpha : 0.0f;
+}
+
+void sensor_filter_reset(sensor_filter_t *filter)
+{
+    filter->ring_head = 0;
+    filter->ring_fill = 0;
+    filter->decim_count = 0;
+    filter->decim_sum = 0.0f;
+    filter->iir_primed = false;
+}
+
+static float median_push(sensor_filter_t *f, float in)
+{
+    int n = f->ring_fill;
+    int pos;
+
+    if (n == f->median_window) {
+        /* Evict the oldest sample from the sorted copy */
+        float old = f->ring[f->ring_head];
+
+        for (pos = 0; pos < n - 1 && f->sorted[pos] != old; pos++) {
+        }
+        memmove(&f->sorted[pos], &f->sorted[pos + 1], (size_t)(n - 1 - pos) * sizeof(float));
+        n--;
+    } else {
+        f->ring_fill++;
+    }
+
+    f->ring[f->ring_head] = in;
+    f->ring_head = (uint8_t)((f->ring_head + 1) % f->median_window);
+
+    /* Insert the new sample in order */
+    for (pos = n; pos > 0 && f->sorted[pos - 1] > in; pos--) {
+        f->sorted[pos] = f->sorted[pos - 1];
+    }
+    f->sorted[pos] = in;
+    n++;
+
+    /* Until the window fills, use the median of what we have */
+    return f->sorted[n / 2];
+}
+
+bool sensor_filter_push(sensor_filter_t *filter, float in, float *out)
+{
+    float x = in;
+
+    if (filter->median_window > 1) {
+        x = median_push(filter, x);
+    }
+
+    if (filter->oversample > 1) {
+        filter->decim_sum += x;
+        if (++filter->decim_count < filter->oversample) {
+            return false;
+        }
+        x = filter->decim_sum / (float)filter->oversample;
+        filter->decim_sum = 0.0f;
+        filter->decim_count = 0;
+    }
+
+    if (filter->iir_alpha > 0.0f) {
+        if (!filter->iir_primed) {
+            filter->iir_state = x;
+            filter->iir_primed = true;
+        } else {
+            filter->iir_state += filter->iir_alpha * (x - filter->iir_state);
+        }
+        x = filter->iir_state;
+    }
+
+    *out = x;
+    return true;
+}
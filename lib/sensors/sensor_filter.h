@@ -0,0 +1,74 @@
+/**
+ * @file sensor_filter.h
+ * @brief Per-sensor streaming filter chain
+ *
+ * Each sensor gets a fixed-size state block, so nothing is allocated at
+ * runtime. Every stage is optional. Samples pass through the stages in
+ * this order:
+ *   median (spike rejection) -> oversampling decimation -> IIR low-pass
+ * Each stage costs O(1) per sample; the median is bounded by
+ * SENSOR_FILTER_MAX_MEDIAN.
+ */
+
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include "../config/config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_COO_SENSOR_FILTER_MAX_MEDIAN
+#define SENSOR_FILTER_MAX_MEDIAN CONFIG_COO_SENSOR_FILTER_MAX_MEDIAN
+#else
+#define SENSOR_FILTER_MAX_MEDIAN 7
+#endif
+
+/**
+ * Filter state for one sensor
+ */
+typedef struct {
+    /* Median: ring of the last samples, plus the same samples kept sorted */
+    float ring[SENSOR_FILTER_MAX_MEDIAN];
+    float sorted[SENSOR_FILTER_MAX_MEDIAN];
+    uint8_t median_window;
+    uint8_t ring_head;
+    uint8_t ring_fill;
+
+    /* Oversampling: boxcar sum emitted every `oversample` samples */
+    uint8_t oversample;
+    uint8_t decim_count;
+    float decim_sum;
+
+    /* IIR: y += alpha * (x - y) */
+    float iir_alpha;
+    float iir_state;
+    bool iir_primed;
+} sensor_filter_t;
+
+/**
+ * Set up a filter from the sensor configuration
+ * Clamps median_filter_window to SENSOR_FILTER_MAX_MEDIAN (rounded down
+ * to an odd size) and iir_alpha to [0, 1].
+ * @param filter Filter state to initialize
+ * @param sensor Sensor configuration
+ */
+void sensor_filter_init(sensor_filter_t *filter, const sensor_config_t *sensor);
+
+/**
+ * Drop all history, e.g. after a read error
+ * The next sample passes through as if it were the first one.
+ * @param filter Filter state
+ */
+void sensor_filter_reset(sensor_filter_t *filter);
+
+/**
+ * Push one sample through the chain
+ * @param filter Filter state
+ * @param in Raw sample
+ * @param out Filtered value; written only when the function returns true
+ * @return true if a new output is available, false while the decimator
+ *         is still accumulating
+ */
+bool sensor_filter_push(sensor_filter_t *filter, float in, float *out);
+
+#endif /* SENSOR_FILTER_H */
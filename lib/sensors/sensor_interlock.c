@@ -0,0 +1,246 @@
+/**
+ * @file sensor_interlock.c
+ * @brief Sample-level safety interlock implementation
+ */
+
+#include "sensor_interlock.h"
+#include "sensor_manager.h"
+#include "../heaters/heater_manager.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <math.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(sensor_interlock, LOG_LEVEL_INF);
+
+BUILD_ASSERT(MAX_INTERLOCKS <= 32, "interlock trips are kept in one 32-bit mask");
+
+/*
+ * Interlock state; IDs stay in the config. Everything but the trip
+ * record is set at init, so the check reads it without a lock. The trip
+ * record is written only by the sample that won the trip bit.
+ */
+static struct {
+    config_index_t heater_handles[MAX_HEATERS_PER_LOOP];
+    uint8_t num_heaters;
+    config_index_t next;       /* Next interlock on the same sensor */
+    float min_temp;
+    float max_temp;
+    float trip_temp;
+    int64_t trip_time_ms;
+} ilk_state[MAX_INTERLOCKS];
+
+/* First interlock on each sensor, chained through next */
+static config_index_t first_for_sensor[MAX_MANAGED_SENSORS];
+
+/* Consecutive failed reads per sensor; written only by the sensor's sweep slot */
+static uint8_t read_failures[MAX_MANAGED_SENSORS];
+
+static int num_interlocks = 0;
+static const thermal_config_t *config_ptr = NULL;
+static atomic_t tripped = ATOMIC_INIT(0);
+static sensor_interlock_handler_t trip_handler;
+
+int sensor_interlock_init(const thermal_config_t *config, int num_sensors)
+{
+    if (config == NULL) {
+        LOG_ERR("Config is NULL");
+        return -1;
+    }
+
+    if (config->number_of_interlocks > MAX_INTERLOCKS) {
+        LOG_ERR("Too many interlocks: %d (max %d)", config->number_of_interlocks,
+                MAX_INTERLOCKS);
+        return -2;
+    }
+
+    memset(ilk_state, 0, sizeof(ilk_state));
+    memset(first_for_sensor, NO_CONFIG_INDEX, sizeof(first_for_sensor));
+    memset(read_failures, 0, sizeof(read_failures));
+    atomic_clear(&tripped);
+    num_interlocks = 0;
+    config_ptr = config;
+
+    for (int i = 0; i < config->number_of_interlocks; i++) {
+        const interlock_config_t *cfg = &config->interlocks[i];
+        int sensor = config_sensor_index(config, cfg->sensor_id);
+
+        if (!cfg->enabled) {
+            continue;
+        }
+        if (sensor < 0 || sensor >= num_sensors) {
+            LOG_ERR("Interlock %s: unknown sensor %s", cfg->id, cfg->sensor_id);
+            return -3;
+        }
+        if (cfg->num_heaters <= 0 || cfg->num_heaters > MAX_HEATERS_PER_LOOP) {
+            LOG_ERR("Interlock %s: invalid heater count %d", cfg->id, cfg->num_heaters);
+            return -3;
+        }
+        for (int j = 0; j < cfg->num_heaters; j++) {
+            int h = config_heater_index(config, cfg->heater_ids[j]);
+
+            if (h < 0) {
+                LOG_ERR("Interlock %s: unknown heater %s", cfg->id, cfg->heater_ids[j]);
+                return -3;
+            }
+            ilk_state[i].heater_handles[j] = (config_index_t)h;
+        }
+        ilk_state[i].num_heaters = (uint8_t)cfg->num_heaters;
+        ilk_state[i].min_temp = cfg->min_temp;
+        ilk_state[i].max_temp = cfg->max_temp;
+
+        /* Push onto the sensor's chain */
+        ilk_state[i].next = first_for_sensor[sensor];
+        first_for_sensor[sensor] = (config_index_t)i;
+
+        LOG_INF("Interlock %s: sensor %s held to %.2f - %.2f K, %d heater(s)",
+                cfg->id, cfg->sensor_id, (double)cfg->min_temp, (double)cfg->max_temp,
+                cfg->num_heaters);
+    }
+
+    num_interlocks = config->number_of_interlocks;
+    return 0;
+}
+
+void sensor_interlock_set_handler(sensor_interlock_handler_t handler)
+{
+    trip_handler = handler;
+}
+
+static void trip(int k, float temp_kelvin)
+{
+    /* Cut first; bookkeeping and reporting come after the heaters are off */
+    for (int j = 0; j < ilk_state[k].num_heaters; j++) {
+        (void)heater_manager_interlock_cut(ilk_state[k].heater_handles[j]);
+    }
+
+    ilk_state[k].trip_temp = temp_kelvin;
+    ilk_state[k].trip_time_ms = k_uptime_get();
+
+    const interlock_config_t *cfg = &config_ptr->interlocks[k];
+
+    if (isnan(temp_kelvin)) {
+        LOG_ERR("Interlock %s tripped: no valid sample from sensor %s", cfg->id,
+                cfg->sensor_id);
+    } else {
+        LOG_ERR("Interlock %s tripped: sensor %s at %.2f K (limits %.2f - %.2f K)",
+                cfg->id, cfg->sensor_id, (double)temp_kelvin,
+                (double)ilk_state[k].min_temp, (double)ilk_state[k].max_temp);
+    }
+
+    sensor_interlock_handler_t handler = trip_handler;
+
+    if (handler != NULL) {
+        handler(k);
+    }
+}
+
+void sensor_interlock_check(int sensor, float temp_kelvin)
+{
+    if (sensor < 0 || sensor >= MAX_MANAGED_SENSORS) {
+        return;
+    }
+
+    if (first_for_sensor[sensor] != NO_CONFIG_INDEX) {
+        read_failures[sensor] = 0;
+    }
+
+    for (int k = first_for_sensor[sensor]; k != NO_CONFIG_INDEX; k = ilk_state[k].next) {
+        /* Written so that NaN fails the test */
+        if (temp_kelvin >= ilk_state[k].min_temp && temp_kelvin <= ilk_state[k].max_temp) {
+            continue;
+        }
+        /* Only the first offending sample acts; the rest see the bit set */
+        if (!atomic_test_and_set_bit(&tripped, k)) {
+            trip(k, temp_kelvin);
+        }
+    }
+}
+
+void sensor_interlock_read_failed(int sensor)
+{
+    if (sensor < 0 || sensor >= MAX_MANAGED_SENSORS ||
+        first_for_sensor[sensor] == NO_CONFIG_INDEX) {
+        return;
+    }
+
+    if (read_failures[sensor] < CONFIG_COO_SENSOR_INTERLOCK_READ_FAILURES) {
+        read_failures[sensor]++;
+    }
+    if (read_failures[sensor] < CONFIG_COO_SENSOR_INTERLOCK_READ_FAILURES) {
+        return;
+    }
+
+    /* A sensor that cannot be read cannot be held to its band: fail closed */
+    for (int k = first_for_sensor[sensor]; k != NO_CONFIG_INDEX; k = ilk_state[k].next) {
+        if (!atomic_test_and_set_bit(&tripped, k)) {
+            trip(k, NAN);
+        }
+    }
+}
+
+uint32_t sensor_interlock_get_tripped(void)
+{
+    return (uint32_t)atomic_get(&tripped);
+}
+
+int sensor_interlock_get_status(int interlock, sensor_interlock_status_t *status)
+{
+    if (interlock < 0 || interlock >= num_interlocks || status == NULL) {
+        return -1;
+    }
+
+    status->tripped = atomic_test_bit(&tripped, interlock);
+    status->trip_temperature = ilk_state[interlock].trip_temp;
+    status->trip_time_ms = ilk_state[interlock].trip_time_ms;
+    return 0;
+}
+
+bool sensor_interlock_holds_heater(int heater)
+{
+    uint32_t mask = (uint32_t)atomic_get(&tripped);
+
+    while (mask != 0U) {
+        int k = (int)find_lsb_set(mask) - 1;
+
+        mask &= mask - 1U;
+        for (int j = 0; j < ilk_state[k].num_heaters; j++) {
+            if (ilk_state[k].heater_handles[j] == heater) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int sensor_interlock_rearm(int interlock)
+{
+    if (interlock < 0 || interlock >= num_interlocks) {
+        return -1;
+    }
+
+    if (atomic_test_and_clear_bit(&tripped, interlock)) {
+        LOG_INF("Interlock %s re-armed", config_ptr->interlocks[interlock].id);
+    }
+    return 0;
+}
+
+int sensor_interlock_find_handle(const char *interlock_id)
+{
+    if (interlock_id == NULL || config_ptr == NULL) {
+        return -1;
+    }
+
+    for (int i = 0; i < num_interlocks; i++) {
+        if (strcmp(config_ptr->interlocks[i].id, interlock_id) == 0) {
+            return i;
+        }
+    }
+    return -2;
+}
+
+int sensor_interlock_get_count(void)
+{
+    return num_interlocks;
+}
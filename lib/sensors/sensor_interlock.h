@@ -0,0 +1,120 @@
+/**
+ * @file sensor_interlock.h
+ * @brief Sample-level safety interlocks evaluated inside the sensor sweep
+ *
+ * Each interlock holds one sensor's converted samples to a hard band.
+ * The sweep checks every sample as soon as it is converted, before the
+ * filter chain and fusion, and a sample outside the band latches the
+ * interlock's heaters off through the heater manager's lock-free fault
+ * path. The trip handler then tells the rest of the system; the control
+ * loop and supervisor react on their own schedule, but the heaters are
+ * already off. A sensor that fails CONFIG_COO_SENSOR_INTERLOCK_READ_FAILURES
+ * reads in a row trips its interlocks too, so a dead sensor fails closed.
+ */
+
+#ifndef SENSOR_INTERLOCK_H
+#define SENSOR_INTERLOCK_H
+
+#include "../config/config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Trip callback
+ * Runs in the thread sweeping the sensor, right after the heaters are
+ * cut, once per trip. It must not block; defer real work to a work item.
+ * @param interlock Interlock handle (index into config->interlocks)
+ */
+typedef void (*sensor_interlock_handler_t)(int interlock);
+
+/**
+ * Interlock status
+ */
+typedef struct {
+    bool tripped;
+    float trip_temperature;   // Sample that tripped it, Kelvin; NaN for read failures
+    int64_t trip_time_ms;     // Uptime of the trip (valid when tripped)
+} sensor_interlock_status_t;
+
+/**
+ * Resolve the configured interlocks and arm them all
+ * Called by sensor_manager_init(). Heater handles are config indices,
+ * so the heater manager need not be initialized yet, but a trip only
+ * cuts heaters once it is.
+ * @param config Thermal configuration, must stay valid while in use
+ * @param num_sensors Number of sensors managed by the sweep
+ * @return 0 on success, negative error code on failure
+ */
+int sensor_interlock_init(const thermal_config_t *config, int num_sensors);
+
+/**
+ * Set the trip callback
+ * @param handler Callback, or NULL for none
+ */
+void sensor_interlock_set_handler(sensor_interlock_handler_t handler);
+
+/**
+ * Check one converted sample against the sensor's interlocks
+ * Called by the sweep for every sample. Costs one load when the sensor
+ * has no interlock, and two compares per interlock otherwise. A NaN
+ * sample trips.
+ * @param sensor Sensor handle
+ * @param temp_kelvin Converted, unfiltered sample
+ */
+void sensor_interlock_check(int sensor, float temp_kelvin);
+
+/**
+ * Count a failed read of one sensor
+ * Called by the sweep for every read that produced no sample. After
+ * CONFIG_COO_SENSOR_INTERLOCK_READ_FAILURES in a row, with no good
+ * sample between them, the sensor's interlocks trip as on a NaN sample.
+ * @param sensor Sensor handle
+ */
+void sensor_interlock_read_failed(int sensor);
+
+/**
+ * Get the tripped interlocks
+ * @return Bit i set = interlock i tripped
+ */
+uint32_t sensor_interlock_get_tripped(void);
+
+/**
+ * Get one interlock's status
+ * @param interlock Interlock handle
+ * @param status Pointer to store the status
+ * @return 0 on success, negative error code on failure
+ */
+int sensor_interlock_get_status(int interlock, sensor_interlock_status_t *status);
+
+/**
+ * Check whether a tripped interlock is holding a heater off
+ * Used to refuse a heater fault clear that the interlock would not see:
+ * a tripped interlock does not trip again until it is re-armed.
+ * @param heater Heater handle
+ * @return true if a tripped interlock lists the heater
+ */
+bool sensor_interlock_holds_heater(int heater);
+
+/**
+ * Re-arm a tripped interlock
+ * The heaters stay latched off until heater_manager_clear_fault(); a
+ * sample still outside the band trips the interlock again.
+ * @param interlock Interlock handle
+ * @return 0 on success, negative error code on failure
+ */
+int sensor_interlock_rearm(int interlock);
+
+/**
+ * Resolve an interlock ID to a handle
+ * @param interlock_id Interlock ID
+ * @return Handle, or negative if not found
+ */
+int sensor_interlock_find_handle(const char *interlock_id);
+
+/**
+ * Get the number of configured interlocks
+ * @return Interlock count
+ */
+int sensor_interlock_get_count(void);
+
+#endif /* SENSOR_INTERLOCK_H */
@@ -7,26 +7,535 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/adc.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+#include <coo_commons/log_limit.h>
+#include <coo_commons/stage_trace.h>
 #include <string.h>
+#include "rtd_table.h"
+#include "sensor_filter.h"
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+#include "sensor_interlock.h"
+#endif
 
 LOG_MODULE_REGISTER(sensor_manager, LOG_LEVEL_INF);
 
-/* Maximum number of sensors we can manage */
-#define MAX_MANAGED_SENSORS 16
-
-/* Sensor reading cache */
+/*
+ * Raw code -> temperature, folded at init so a sample costs one integer
+ * subtract and one multiply-add (plus a table lerp for CVD sensors):
+ *   x = (float)((code & code_mask) - code_offset) * scale + offset
+ * x is Kelvin for linear conversions, or W = R / R0 when use_table is set.
+ */
+typedef struct {
+    uint32_t code_mask;
+    int32_t code_offset;
+    float scale;
+    float offset;
+    bool use_table;
+} sensor_conversion_t;
+
+BUILD_ASSERT(MAX_MANAGED_SENSORS < NO_CONFIG_INDEX, "sensor handles must fit config_index_t");
+
+/*
+ * Conversion constants, set once at init. The filter and read-error log
+ * state are only touched by read_all, under sensor_mutex. IDs stay in
+ * the config.
+ */
 static struct {
-    char id[MAX_ID_LENGTH];
-    sensor_reading_t reading;
-    bool valid;
+    sensor_conversion_t conv;
+    sensor_filter_t filter;
+    struct coo_log_limit read_log;
 } sensor_cache[MAX_MANAGED_SENSORS];
 
+/* Fusion runs once per loop per tick, so its warnings are rate-limited too */
+static struct coo_log_limit fusion_empty_log;
+static struct coo_log_limit fusion_rejected_log;
+
 static int num_sensors = 0;
 static const thermal_config_t *config_ptr = NULL;
 
-/* Thread-safe mutex for sensor readings */
+/*
+ * Double-buffered snapshot. The sweep fills snapshots[(seq + 1) & 1] while
+ * readers use snapshots[seq & 1], then publishes by bumping seq. A reader
+ * that sees seq change under it retries; that only happens if a whole new
+ * sweep completed during its read, so readers never wait on ADC I/O.
+ */
+static sensor_snapshot_t snapshots[2];
+static atomic_t snapshot_seq = ATOMIC_INIT(0);
+
+/* Serializes sweeps (the single writer); readers never take it */
 K_MUTEX_DEFINE(sensor_mutex);
 
+/*
+ * Read groups, set at init. A group is the enabled sensors on one ADC
+ * device that share a resolution and oversampling, each on its own
+ * channel: one multi-channel adc_read() converts them back to back and
+ * returns one sample per channel, in ascending channel order. The AD7124
+ * device (adc_temp_sensor.c) runs such a read as one DRDY-paced pass of
+ * the part's channel sequencer, so a device costs one sweep of
+ * conversions instead of one polled read per sensor. An
+ * enabled sensor without an ADC is a group of its own that always fails.
+ * group_members[group_start[g] .. group_start[g + 1]) lists group g's
+ * sensors by ascending channel.
+ */
+static struct {
+    const struct adc_dt_spec *adc;   /* First member's spec, NULL for no ADC */
+    uint32_t channels;               /* Members' channel mask */
+} read_groups[MAX_MANAGED_SENSORS];
+
+static config_index_t group_members[MAX_MANAGED_SENSORS];
+static uint8_t group_start[MAX_MANAGED_SENSORS + 1];
+static int num_groups = 0;
+
+/* Group g's samples land in group_samples[group_start[g] ..] */
+static int32_t group_samples[MAX_MANAGED_SENSORS];
+
+#ifdef CONFIG_COO_SENSOR_ADC_ASYNC
+/*
+ * Async read state per group. The driver owns a group's samples and
+ * sequence until it raises done, which may come after the sweep gave up
+ * waiting, so both are static and nothing on that device is read again
+ * until done is raised.
+ */
+static struct {
+    struct adc_sequence sequence;
+    struct k_poll_signal done;
+    bool in_flight;
+} group_io[MAX_MANAGED_SENSORS];
+#endif
+
+#ifdef CONFIG_COO_SENSOR_PARALLEL_SWEEP
+/*
+ * Parallel sweep: read groups are split into slots by ADC device. Slot 0
+ * is read by the thread calling read_all, every other slot by its own
+ * worker. slot_members[slot_start[s] .. slot_start[s + 1]) lists slot s's
+ * groups. All of it is set at init and only read during a sweep.
+ */
+#define SWEEP_SLOTS (CONFIG_COO_SENSOR_SWEEP_WORKERS + 1)
+
+static uint8_t slot_members[MAX_MANAGED_SENSORS];
+static uint8_t slot_start[SWEEP_SLOTS + 1];
+static int num_slots = 1;
+
+static struct {
+    struct k_thread thread;
+    struct k_sem start;
+    int errors;
+} sweep_workers[SWEEP_SLOTS - 1];
+
+K_THREAD_STACK_ARRAY_DEFINE(sweep_worker_stacks, SWEEP_SLOTS - 1,
+                            CONFIG_COO_SENSOR_SWEEP_WORKER_STACK_SIZE);
+K_SEM_DEFINE(sweep_done, 0, SWEEP_SLOTS);
+
+/* Back buffer of the sweep in progress, handed to the workers */
+static sensor_snapshot_t *sweep_back;
+#endif
+
+static inline const sensor_snapshot_t *snapshot_begin(atomic_val_t *seq)
+{
+    *seq = atomic_get(&snapshot_seq);
+    return &snapshots[*seq & 1];
+}
+
+static inline bool snapshot_retry(atomic_val_t seq)
+{
+    /* Order the snapshot loads before the re-check */
+    barrier_dmem_fence_full();
+    return atomic_get(&snapshot_seq) != seq;
+}
+
+static int prepare_conversion(const sensor_config_t *sensor, sensor_conversion_t *conv)
+{
+    if (sensor->type == SENSOR_TYPE_INTERNAL_TEMP) {
+        /*
+         * AD7124 internal temp sensor: Temp(C) = ((Code - 0x800000) / 13584) - 272.5
+         * on the 24-bit code, as in the earlier manual driver.
+         */
+        conv->code_mask = 0xFFFFFF;
+        conv->code_offset = 0x800000;
+        conv->scale = 1.0f / 13584.0f;
+        conv->offset = -272.5f + 273.15f;
+        conv->use_table = false;
+        return 0;
+    }
+
+    /*
+     * P_RTD: R = (Code - max_count) * r_ref / (gain * max_count). At most
+     * 31 bits, so convert_code() can take Code - max_count in int32.
+     */
+    if (sensor->adc_gain <= 0 || sensor->adc_resolution < 2 || sensor->adc_resolution > 31 ||
+        sensor->nominal_resistance <= 0.0f || sensor->temperature_coefficient == 0.0f) {
+        return -1;
+    }
+
+    int32_t max_count = (int32_t)((1ULL << (sensor->adc_resolution - 1)) - 1);
+    float ohms_per_count = sensor->reference_resistance /
+                           ((float)sensor->adc_gain * (float)max_count);
+
+    conv->code_mask = 0xFFFFFFFF;
+    conv->code_offset = max_count;
+
+    if (sensor->extrapolate_method == EXTRAP_CVD_TABLE) {
+        /* W = R / R0, looked up in the CVD table */
+        conv->scale = ohms_per_count / sensor->nominal_resistance;
+        conv->offset = 0.0f;
+        conv->use_table = true;
+    } else {
+        /* Linear: Temp(C) = (R - r_nom) * r_nom / tc */
+        float k_per_ohm = sensor->nominal_resistance / sensor->temperature_coefficient;
+
+        conv->scale = ohms_per_count * k_per_ohm;
+        conv->offset = 273.15f - sensor->nominal_resistance * k_per_ohm;
+        conv->use_table = false;
+    }
+    return 0;
+}
+
+static inline float rtd_table_lookup(float w)
+{
+    float x = (w - RTD_TABLE_W_MIN) * (float)RTD_TABLE_STEPS_PER_UNIT;
+    int idx = (int)x;
+
+    /* Clamp the segment, not x: outside the table we extrapolate the end slope */
+    if (x < 0.0f) {
+        idx = 0;
+    } else if (idx > RTD_TABLE_ENTRIES - 2) {
+        idx = RTD_TABLE_ENTRIES - 2;
+    }
+
+    float frac = x - (float)idx;
+
+    return rtd_table_kelvin[idx] + frac * (rtd_table_kelvin[idx + 1] - rtd_table_kelvin[idx]);
+}
+
+static inline float convert_code(const sensor_conversion_t *conv, int32_t code)
+{
+    int32_t counts = (int32_t)((uint32_t)code & conv->code_mask) - conv->code_offset;
+    float x = (float)counts * conv->scale + conv->offset;
+
+    return conv->use_table ? rtd_table_lookup(x) : x;
+}
+
+/*
+ * Store one read result in the back buffer. Each sensor belongs to exactly
+ * one read group, so concurrent slots never touch the same entry or filter.
+ * @param ret Result of the group's read, 0 if code is a sample
+ * @return 1 if the read failed, 0 otherwise
+ */
+static int store_sample(int i, sensor_snapshot_t *back, int ret, int32_t code)
+{
+    const char *sensor_id = config_ptr->sensors[i].id;
+    float temp_k = 0.0f;
+
+    if (ret == 0) {
+        COO_TRACE_BEGIN(convert_start);
+        temp_k = convert_code(&sensor_cache[i].conv, code);
+        COO_TRACE_END(COO_TRACE_SENSOR_CONVERT, convert_start);
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+        /* Hard limits see the raw sample, before any filtering delay */
+        sensor_interlock_check(i, temp_k);
+#endif
+        LOG_DBG("Sensor %s: raw %d | Temp: %.3f K", sensor_id, code, (double)temp_k);
+
+        if (!sensor_filter_push(&sensor_cache[i].filter, temp_k, &temp_k)) {
+            /* Decimator still accumulating: keep the previous reading */
+            return 0;
+        }
+        back->readings[i].temperature_kelvin = temp_k;
+        back->readings[i].timestamp_ms = k_uptime_get();
+        back->readings[i].status = SENSOR_STATUS_OK;
+        back->valid[i] = true;
+        COO_LOG_LIMITED_CLEAR(INF, &sensor_cache[i].read_log, "Sensor %s reading again",
+                              sensor_id);
+        return 0;
+    }
+
+    back->readings[i].status = SENSOR_STATUS_READ_ERROR;
+    back->valid[i] = false;
+    sensor_filter_reset(&sensor_cache[i].filter);
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+    sensor_interlock_read_failed(i);
+#endif
+    COO_LOG_LIMITED(WRN, &sensor_cache[i].read_log, "Failed to read sensor %s: %d",
+                    sensor_id, ret);
+    return 1;
+}
+
+#ifdef CONFIG_COO_SENSOR_ADC_ASYNC
+/*
+ * A group whose read timed out holds its device until the driver raises
+ * done. Collect any late completions on g's device; the late samples are
+ * dropped, since a newer sweep is already under way.
+ * @return true while a read is still outstanding on g's device
+ */
+static bool device_busy(int g)
+{
+    bool busy = false;
+
+    for (int h = 0; h < num_groups; h++) {
+        unsigned int signaled;
+        int result;
+
+        /* Same device means same slot, so no other thread touches these groups */
+        if (read_groups[h].adc == NULL || read_groups[h].adc->dev != read_groups[g].adc->dev ||
+            !group_io[h].in_flight) {
+            continue;
+        }
+        k_poll_signal_check(&group_io[h].done, &signaled, &result);
+        if (signaled != 0U) {
+            group_io[h].in_flight = false;
+        } else {
+            busy = true;
+        }
+    }
+    return busy;
+}
+
+/* Start the group's read and wait at most CONFIG_COO_SENSOR_ADC_TIMEOUT_MS for it */
+static int group_adc_read(int g, const struct adc_sequence *sequence)
+{
+    const struct adc_dt_spec *adc = read_groups[g].adc;
+    struct k_poll_event done = K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL,
+                                                        K_POLL_MODE_NOTIFY_ONLY,
+                                                        &group_io[g].done);
+
+    if (device_busy(g)) {
+        return -EBUSY;
+    }
+
+    group_io[g].sequence = *sequence;
+    k_poll_signal_reset(&group_io[g].done);
+
+    int ret = adc_read_async(adc->dev, &group_io[g].sequence, &group_io[g].done);
+
+    if (ret != 0) {
+        return ret;
+    }
+    if (k_poll(&done, 1, K_MSEC(CONFIG_COO_SENSOR_ADC_TIMEOUT_MS)) != 0) {
+        /* The driver still owns the buffer; hold the device until it is done */
+        group_io[g].in_flight = true;
+        return -ETIMEDOUT;
+    }
+    return group_io[g].done.result;
+}
+#else
+static int group_adc_read(int g, const struct adc_sequence *sequence)
+{
+    return adc_read_dt(read_groups[g].adc, sequence);
+}
+#endif
+
+/*
+ * Read one group with a single adc_read() and store each member's sample
+ * @return Number of members whose read failed
+ */
+static int read_group(int g, sensor_snapshot_t *back)
+{
+    const struct adc_dt_spec *adc = read_groups[g].adc;
+    int first = group_start[g];
+    int count = group_start[g + 1] - first;
+    int32_t *buf = &group_samples[first];
+    int errors = 0;
+    int ret = -1;
+
+    if (adc != NULL) {
+        struct adc_sequence sequence = {
+            .buffer = buf,
+            .buffer_size = (size_t)count * sizeof(buf[0]),
+        };
+
+        adc_sequence_init_dt(adc, &sequence);
+        sequence.channels = read_groups[g].channels;
+        ret = group_adc_read(g, &sequence);
+    }
+
+    /* Samples come back in ascending channel order, as the members are sorted */
+    for (int n = 0; n < count; n++) {
+        errors += store_sample(group_members[first + n], back, ret, ret == 0 ? buf[n] : 0);
+    }
+    return errors;
+}
+
+static inline const struct adc_dt_spec *adc_of(const thermal_config_t *config, int i)
+{
+    return (const struct adc_dt_spec *)config->sensors[i].driver_data;
+}
+
+static bool group_accepts(int g, const struct adc_dt_spec *adc)
+{
+    const struct adc_dt_spec *lead = read_groups[g].adc;
+
+    return lead != NULL && lead->dev == adc->dev && lead->resolution == adc->resolution &&
+           lead->oversampling == adc->oversampling &&
+           (read_groups[g].channels & BIT(adc->channel_id)) == 0U;
+}
+
+/*
+ * Group the enabled sensors for the sweep. Disabled sensors are in no
+ * group, so they carry their last state forward.
+ */
+static void plan_groups(const thermal_config_t *config)
+{
+    int group_of[MAX_MANAGED_SENSORS];
+    uint8_t fill[MAX_MANAGED_SENSORS];
+    int group_count[MAX_MANAGED_SENSORS] = { 0 };
+
+    num_groups = 0;
+    for (int i = 0; i < num_sensors; i++) {
+        const struct adc_dt_spec *adc = adc_of(config, i);
+        int g = 0;
+
+        group_of[i] = -1;
+        if (!config->sensors[i].enabled) {
+            continue;
+        }
+        if (adc == NULL) {
+            g = num_groups;
+        }
+        while (g < num_groups && !group_accepts(g, adc)) {
+            g++;
+        }
+        if (g == num_groups) {
+            read_groups[g].adc = adc;
+            read_groups[g].channels = 0U;
+#ifdef CONFIG_COO_SENSOR_ADC_ASYNC
+            k_poll_signal_init(&group_io[g].done);
+            group_io[g].in_flight = false;
+#endif
+            num_groups++;
+        }
+        if (adc != NULL) {
+            read_groups[g].channels |= BIT(adc->channel_id);
+        }
+        group_of[i] = g;
+        group_count[g]++;
+    }
+
+    group_start[0] = 0;
+    for (int g = 0; g < num_groups; g++) {
+        group_start[g + 1] = (uint8_t)(group_start[g] + group_count[g]);
+        fill[g] = group_start[g];
+    }
+
+    /* Insert each member in ascending channel order within its group */
+    for (int i = 0; i < num_sensors; i++) {
+        int g = group_of[i];
+
+        if (g < 0) {
+            continue;
+        }
+
+        const struct adc_dt_spec *adc = adc_of(config, i);
+        int n = fill[g]++;
+
+        while (adc != NULL && n > group_start[g] &&
+               adc_of(config, group_members[n - 1])->channel_id > adc->channel_id) {
+            group_members[n] = group_members[n - 1];
+            n--;
+        }
+        group_members[n] = (config_index_t)i;
+    }
+}
+
+#ifdef CONFIG_COO_SENSOR_PARALLEL_SWEEP
+/* Read every group in one slot */
+static int sweep_slot(int slot, sensor_snapshot_t *back)
+{
+    int errors = 0;
+
+    for (int n = slot_start[slot]; n < slot_start[slot + 1]; n++) {
+        errors += read_group(slot_members[n], back);
+    }
+    return errors;
+}
+
+static void sweep_worker_entry(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    int slot = (int)(intptr_t)p1;
+
+    for (;;) {
+        k_sem_take(&sweep_workers[slot - 1].start, K_FOREVER);
+        sweep_workers[slot - 1].errors = sweep_slot(slot, sweep_back);
+        k_sem_give(&sweep_done);
+    }
+}
+
+/*
+ * Deal read groups into slots by ADC device: every group on one device
+ * lands in the same slot, so each device is only ever driven by one
+ * thread. With more devices than slots, devices share slots round-robin.
+ * Groups without an ADC go to slot 0, which the sweeping thread reads
+ * itself.
+ */
+static void plan_slots(void)
+{
+    const struct device *devices[MAX_MANAGED_SENSORS];
+    uint8_t slot_of[MAX_MANAGED_SENSORS];
+    int slot_count[SWEEP_SLOTS] = { 0 };
+    int num_devices = 0;
+
+    for (int i = 0; i < num_groups; i++) {
+        const struct adc_dt_spec *adc = read_groups[i].adc;
+        int d = 0;
+
+        slot_of[i] = 0;
+        if (adc == NULL) {
+            slot_count[0]++;
+            continue;
+        }
+        while (d < num_devices && devices[d] != adc->dev) {
+            d++;
+        }
+        if (d == num_devices) {
+            devices[num_devices++] = adc->dev;
+        }
+        slot_of[i] = (uint8_t)(d % SWEEP_SLOTS);
+        slot_count[slot_of[i]]++;
+    }
+
+    /* Counting sort: members of each slot stay in config order */
+    num_slots = 1;
+    slot_start[0] = 0;
+    for (int s = 0; s < SWEEP_SLOTS; s++) {
+        slot_start[s + 1] = (uint8_t)(slot_start[s] + slot_count[s]);
+        if (slot_count[s] > 0) {
+            num_slots = s + 1;
+        }
+    }
+
+    uint8_t fill[SWEEP_SLOTS];
+
+    memcpy(fill, slot_start, sizeof(fill));
+    for (int i = 0; i < num_groups; i++) {
+        slot_members[fill[slot_of[i]]++] = (uint8_t)i;
+    }
+
+    LOG_INF("Sweeping %d ADC device(s) from %d thread(s)", num_devices, num_slots);
+}
+
+static void start_workers(void)
+{
+    static bool started;
+
+    if (started) {
+        return;
+    }
+    started = true;
+
+    for (int w = 0; w < SWEEP_SLOTS - 1; w++) {
+        k_sem_init(&sweep_workers[w].start, 0, 1);
+        k_thread_create(&sweep_workers[w].thread, sweep_worker_stacks[w],
+                        K_THREAD_STACK_SIZEOF(sweep_worker_stacks[w]),
+                        sweep_worker_entry, (void *)(intptr_t)(w + 1), NULL, NULL,
+                        CONFIG_COO_SENSOR_SWEEP_WORKER_PRIORITY, 0, K_NO_WAIT);
+        k_thread_name_set(&sweep_workers[w].thread, "sensor_sweep");
+    }
+}
+#endif /* CONFIG_COO_SENSOR_PARALLEL_SWEEP */
+
 int sensor_manager_init(const thermal_config_t *config)
 {
     if (config == NULL) {
@@ -42,13 +551,18 @@ int sensor_manager_init(const thermal_config_t *config)
         return -2;
     }
 
-    /* Initialize sensor cache */
+    /* Initialize sensor cache and both snapshot buffers (all invalid) */
     memset(sensor_cache, 0, sizeof(sensor_cache));
+    memset(snapshots, 0, sizeof(snapshots));
+    snapshots[0].count = num_sensors;
+    snapshots[1].count = num_sensors;
     for (int i = 0; i < num_sensors; i++) {
-        strncpy(sensor_cache[i].id, config->sensors[i].id, MAX_ID_LENGTH - 1);
-        sensor_cache[i].valid = false;
-        
-        /* Check if ADC device is ready if configured */
+        if (prepare_conversion(&config->sensors[i], &sensor_cache[i].conv) != 0) {
+            LOG_ERR("Invalid conversion parameters for sensor %s", config->sensors[i].id);
+            return -5;
+        }
+        sensor_filter_init(&sensor_cache[i].filter, &config->sensors[i]);
+
         /* Check if ADC device is ready if configured */
         const struct adc_dt_spec *adc = (const struct adc_dt_spec *)config->sensors[i].driver_data;
         if (adc != NULL) {
@@ -65,7 +579,22 @@ int sensor_manager_init(const thermal_config_t *config)
         }
     }
 
-    LOG_INF("Sensor manager initialized with %d sensors", num_sensors);
+#ifdef CONFIG_COO_SENSOR_INTERLOCK
+    int ilk_ret = sensor_interlock_init(config, num_sensors);
+    if (ilk_ret != 0) {
+        LOG_ERR("Interlock setup failed: %d", ilk_ret);
+        return -6;
+    }
+#endif
+
+    plan_groups(config);
+#ifdef CONFIG_COO_SENSOR_PARALLEL_SWEEP
+    plan_slots();
+    start_workers();
+#endif
+
+    LOG_INF("Sensor manager initialized with %d sensors in %d read group(s)", num_sensors,
+            num_groups);
     return 0;
 }
 
@@ -74,177 +603,250 @@ int sensor_manager_read_all(void)
     int errors = 0;
 
     k_mutex_lock(&sensor_mutex, K_FOREVER);
+    COO_TRACE_BEGIN(sweep_start);
+
+    /*
+     * Build the next snapshot in the back buffer. Start from the published
+     * one so disabled sensors carry their last state forward.
+     */
+    atomic_val_t seq = atomic_get(&snapshot_seq);
+    sensor_snapshot_t *back = &snapshots[(seq + 1) & 1];
+
+    memcpy(back, &snapshots[seq & 1], sizeof(*back));
+
+#ifdef CONFIG_COO_SENSOR_PARALLEL_SWEEP
+    /* Fan out to the workers, read slot 0 here, then wait for all of them */
+    sweep_back = back;
+    for (int s = 1; s < num_slots; s++) {
+        k_sem_give(&sweep_workers[s - 1].start);
+    }
+    errors = sweep_slot(0, back);
+    for (int s = 1; s < num_slots; s++) {
+        k_sem_take(&sweep_done, K_FOREVER);
+    }
+    for (int s = 1; s < num_slots; s++) {
+        errors += sweep_workers[s - 1].errors;
+    }
+#else
+    for (int g = 0; g < num_groups; g++) {
+        errors += read_group(g, back);
+    }
+#endif
 
-    for (int i = 0; i < num_sensors; i++) {
-        if (!config_ptr->sensors[i].enabled) {
-            continue;
-        }
+    back->count = num_sensors;
+    back->sweep++;
+    back->timestamp_ms = k_uptime_get();
+    COO_TRACE_END(COO_TRACE_ADC_SWEEP, sweep_start);
 
-        const char *sensor_id = config_ptr->sensors[i].id;
-        float temp_k = 0.0f;
-        int ret = -1;
+    /* Publish: atomic_inc is a full barrier, so the buffer is complete first */
+    atomic_inc(&snapshot_seq);
 
-        const struct adc_dt_spec *adc = (const struct adc_dt_spec *)config_ptr->sensors[i].driver_data;
+    k_mutex_unlock(&sensor_mutex);
 
-        /* Read from ADC if configured */
-        if (adc != NULL) {
-            int32_t buf;
-            struct adc_sequence sequence = {
-                .buffer = &buf,
-                .buffer_size = sizeof(buf),
-            };
-
-            adc_sequence_init_dt(adc, &sequence);
-
-            ret = adc_read_dt(adc, &sequence);
-            if (ret == 0) {
-                if (config_ptr->sensors[i].type == SENSOR_TYPE_INTERNAL_TEMP) {
-                        /* 
-                        * Convert raw ADC code to temperature.
-                        * AD7124 Internal Temp Sensor formula:
-                        * Temp(C) = ((Code - 0x800000) / 13584) - 272.5
-                        * Code is 24-bit unipolar (0 to 2^24-1) effectively in bipolar mode context from previous driver
-                        * but Zephyr AD7124 likely returns 32-bit signed or unsigned.
-                        * Let's assume the raw value is what we expect. 
-                        * NOTE: If using differential mode, Zephyr might return signed value centered at 0?
-                        * But overlay says bipolar?
-                        * Let's stick to the formula from the manual driver which expected 0x800000 offset for 0V?
-                        * Actually, let's treat 'buf' as the raw code.
-                        */
-                        
-                        /* 
-                        * Note: The previous manual driver was bit-banging and knew exactly what it got.
-                        * The Zephyr AD7124 driver might do some processing. 
-                        * For now, applying the same formula.
-                        */
-                    float temp_c = ((float)((uint32_t)buf & 0xFFFFFF) - 8388608.0f) / 13584.0f - 272.5f;
-                    temp_k = temp_c + 273.15f;
-                } else if (config_ptr->sensors[i].type == SENSOR_TYPE_P_RTD) {
-                    float rtd_tc = config_ptr->sensors[i].temperature_coefficient;
-                    float r_ref = config_ptr->sensors[i].reference_resistance;
-                    float r_nom = config_ptr->sensors[i].nominal_resistance;
-                    float gain = (float)config_ptr->sensors[i].adc_gain;
-                    LOG_DBG("Sensor %s: rtd_tc = %f, r_ref = %f, r_nom = %f, gain = %f", config_ptr->sensors[i].id, (double)rtd_tc, (double)r_ref, (double)r_nom, (double)gain);
-                    
-                    int32_t max_count = (1 << (config_ptr->sensors[i].adc_resolution - 1)) - 1;
-
-                    float r_rtd = (((float)(uint32_t)buf - (float)max_count) * r_ref) / (gain * (float)max_count);
-                    float temp_c = (r_rtd - r_nom) / (rtd_tc / r_nom);
-                    temp_k = temp_c + 273.15f;
-                    LOG_DBG("Raw: %d | Res: %.2f Ohms | Temp: %.3f C", buf, (double)r_rtd, (double)temp_c);
-
-                }
-            }
-        }
+    return (errors > 0) ? -errors : 0;
+}
 
-        if (ret == 0) {
-            sensor_cache[i].reading.temperature_kelvin = temp_k;
-            sensor_cache[i].reading.timestamp_ms = k_uptime_get();
-            sensor_cache[i].reading.status = SENSOR_STATUS_OK;
-            sensor_cache[i].valid = true;
-        } else {
-            sensor_cache[i].reading.status = SENSOR_STATUS_READ_ERROR;
-            sensor_cache[i].valid = false;
-            errors++;
-            LOG_WRN("Failed to read sensor %s: %d", sensor_id, ret);
-        }
+int sensor_manager_find_handle(const char *sensor_id)
+{
+    if (sensor_id == NULL) {
+        return -1;
     }
 
-    k_mutex_unlock(&sensor_mutex);
+    /* The config outlives the manager and its IDs never change, so no lock */
+    int index = (config_ptr != NULL) ? config_sensor_index(config_ptr, sensor_id) : -1;
 
-    return (errors > 0) ? -errors : 0;
+    return (index >= 0 && index < num_sensors) ? index : -2;
 }
 
-int sensor_manager_get_reading(const char *sensor_id, sensor_reading_t *reading)
+int sensor_manager_get_snapshot(sensor_snapshot_t *snapshot)
 {
-    if (sensor_id == NULL || reading == NULL) {
+    if (snapshot == NULL) {
         return -1;
     }
 
-    k_mutex_lock(&sensor_mutex, K_FOREVER);
+    atomic_val_t seq;
 
-    /* Find sensor in cache */
-    int idx = -1;
-    for (int i = 0; i < num_sensors; i++) {
-        if (strcmp(sensor_cache[i].id, sensor_id) == 0) {
-            idx = i;
-            break;
-        }
-    }
+    do {
+        memcpy(snapshot, snapshot_begin(&seq), sizeof(*snapshot));
+    } while (snapshot_retry(seq));
 
-    if (idx < 0) {
-        k_mutex_unlock(&sensor_mutex);
-        LOG_ERR("Sensor %s not found", sensor_id);
-        return -2;
+    return 0;
+}
+
+int sensor_manager_get_reading_by_handle(int handle, sensor_reading_t *reading)
+{
+    if (handle < 0 || handle >= num_sensors || reading == NULL) {
+        return -1;
     }
 
-    if (!sensor_cache[idx].valid) {
-        k_mutex_unlock(&sensor_mutex);
-        return -3;
+    atomic_val_t seq;
+    bool valid;
+
+    do {
+        const sensor_snapshot_t *snap = snapshot_begin(&seq);
+
+        valid = snap->valid[handle];
+        *reading = snap->readings[handle];
+    } while (snapshot_retry(seq));
+
+    return valid ? 0 : -3;
+}
+
+int sensor_manager_get_reading(const char *sensor_id, sensor_reading_t *reading)
+{
+    if (sensor_id == NULL || reading == NULL) {
+        return -1;
     }
 
-    /* Copy reading */
-    memcpy(reading, &sensor_cache[idx].reading, sizeof(sensor_reading_t));
+    int handle = sensor_manager_find_handle(sensor_id);
+    if (handle < 0) {
+        LOG_ERR("Sensor %s not found", sensor_id);
+        return -2;
+    }
 
-    k_mutex_unlock(&sensor_mutex);
-    return 0;
+    return sensor_manager_get_reading_by_handle(handle, reading);
 }
 
-int sensor_manager_get_average(const char *sensor_ids[], int num_sensors_to_avg, float *avg_temp)
+static int fuse(const config_index_t handles[], int num_handles,
+                const sensor_fusion_params_t *params, float *temp, int *num_used)
 {
-    if (sensor_ids == NULL || avg_temp == NULL || num_sensors_to_avg <= 0) {
+    if (handles == NULL || temp == NULL || num_handles <= 0 ||
+        num_handles > MAX_SENSORS_PER_LOOP) {
         return -1;
     }
 
-    float sum = 0.0f;
-    int valid_count = 0;
+    float values[MAX_SENSORS_PER_LOOP];
+    float weights[MAX_SENSORS_PER_LOOP];
+    int count;
+    atomic_val_t seq;
+    int64_t now_ms = k_uptime_get();
+    int64_t max_age_ms = (params != NULL) ? (int64_t)params->max_age_ms : 0;
 
-    k_mutex_lock(&sensor_mutex, K_FOREVER);
+    /* Gather every usable reading from one sweep, then work on the copy */
+    do {
+        const sensor_snapshot_t *snap = snapshot_begin(&seq);
 
-    for (int i = 0; i < num_sensors_to_avg; i++) {
-        /* Find sensor in cache */
-        int idx = -1;
-        for (int j = 0; j < num_sensors; j++) {
-            if (strcmp(sensor_cache[j].id, sensor_ids[i]) == 0) {
-                idx = j;
-                break;
+        count = 0;
+        for (int i = 0; i < num_handles; i++) {
+            int h = handles[i];
+
+            /* Unresolved handles (unknown IDs) are skipped like invalid readings */
+            if (h >= num_sensors || !snap->valid[h]) {
+                continue;
+            }
+            if (max_age_ms > 0 && now_ms - snap->readings[h].timestamp_ms > max_age_ms) {
+                continue;
             }
+            values[count] = snap->readings[h].temperature_kelvin;
+            weights[count] = (params != NULL && params->weights != NULL) ? params->weights[i] : 1.0f;
+            count++;
         }
+    } while (snapshot_retry(seq));
+
+    if (count == 0) {
+        COO_LOG_LIMITED(WRN, &fusion_empty_log, "No valid sensors for fusion");
+        return -2;
+    }
+
+    float median = 0.0f;
+    bool reject = (params != NULL && params->outlier_threshold > 0.0f && count > 2);
 
-        if (idx >= 0 && sensor_cache[idx].valid) {
-            sum += sensor_cache[idx].reading.temperature_kelvin;
-            valid_count++;
+    /* Two sensors can't outvote each other, so rejection needs three or more */
+    if (reject) {
+        float sorted[MAX_SENSORS_PER_LOOP];
+
+        for (int i = 0; i < count; i++) {
+            int j = i;
+
+            for (; j > 0 && sorted[j - 1] > values[i]; j--) {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = values[i];
         }
+        median = (count % 2) ? sorted[count / 2]
+                             : 0.5f * (sorted[count / 2 - 1] + sorted[count / 2]);
     }
 
-    k_mutex_unlock(&sensor_mutex);
+    float sum = 0.0f;
+    float weight_sum = 0.0f;
+    int used = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (reject) {
+            float dev = values[i] - median;
 
-    if (valid_count == 0) {
-        LOG_WRN("No valid sensors for averaging");
+            if (dev > params->outlier_threshold || dev < -params->outlier_threshold) {
+                continue;
+            }
+        }
+        sum += weights[i] * values[i];
+        weight_sum += weights[i];
+        used++;
+    }
+
+    if (used == 0 || weight_sum <= 0.0f) {
+        COO_LOG_LIMITED(WRN, &fusion_rejected_log, "All sensors rejected by fusion");
         return -2;
     }
 
-    *avg_temp = sum / (float)valid_count;
+    *temp = sum / weight_sum;
+    if (num_used != NULL) {
+        *num_used = used;
+    }
     return 0;
 }
 
+int sensor_manager_fuse_by_handle(const config_index_t handles[], int num_handles,
+                                  const sensor_fusion_params_t *params,
+                                  float *temp, int *num_used)
+{
+    COO_TRACE_BEGIN(fusion_start);
+    int ret = fuse(handles, num_handles, params, temp, num_used);
+
+    COO_TRACE_END(COO_TRACE_FUSION, fusion_start);
+    return ret;
+}
+
+int sensor_manager_get_average_by_handle(const config_index_t handles[], int num_handles,
+                                         float *avg_temp)
+{
+    return sensor_manager_fuse_by_handle(handles, num_handles, NULL, avg_temp, NULL);
+}
+
+int sensor_manager_get_average(const char *sensor_ids[], int num_sensors_to_avg, float *avg_temp)
+{
+    if (sensor_ids == NULL || avg_temp == NULL || num_sensors_to_avg <= 0) {
+        return -1;
+    }
+
+    config_index_t handles[MAX_SENSORS_PER_LOOP];
+
+    if (num_sensors_to_avg > MAX_SENSORS_PER_LOOP) {
+        num_sensors_to_avg = MAX_SENSORS_PER_LOOP;
+    }
+    for (int i = 0; i < num_sensors_to_avg; i++) {
+        int handle = sensor_manager_find_handle(sensor_ids[i]);
+
+        handles[i] = (handle < 0) ? NO_CONFIG_INDEX : (config_index_t)handle;
+    }
+
+    return sensor_manager_get_average_by_handle(handles, num_sensors_to_avg, avg_temp);
+}
+
 bool sensor_manager_is_valid(const char *sensor_id)
 {
-    if (sensor_id == NULL) {
+    int handle = sensor_manager_find_handle(sensor_id);
+    if (handle < 0) {
         return false;
     }
 
-    k_mutex_lock(&sensor_mutex, K_FOREVER);
+    atomic_val_t seq;
+    bool valid;
 
-    bool valid = false;
-    for (int i = 0; i < num_sensors; i++) {
-        if (strcmp(sensor_cache[i].id, sensor_id) == 0) {
-            valid = sensor_cache[i].valid;
-            break;
-        }
-    }
+    do {
+        valid = snapshot_begin(&seq)->valid[handle];
+    } while (snapshot_retry(seq));
 
-    k_mutex_unlock(&sensor_mutex);
     return valid;
 }
 
@@ -253,11 +855,11 @@ int sensor_manager_get_count(void)
     return num_sensors;
 }
 
-/* IDs are set once at init and never mutated, so no lock is needed here */
+/* IDs live in the config and never change, so no lock is needed here */
 const char *sensor_manager_get_id_at(int index)
 {
     if (index < 0 || index >= num_sensors) {
         return NULL;
     }
-    return sensor_cache[index].id;
+    return config_ptr->sensors[index].id;
 }
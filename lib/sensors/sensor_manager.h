@@ -7,6 +7,7 @@
 #define SENSOR_MANAGER_H
 
 #include "../config/config.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 /**
@@ -29,8 +30,25 @@ typedef struct {
     sensor_status_t status;
 } sensor_reading_t;
 
+/* Maximum number of sensors we can manage */
+#define MAX_MANAGED_SENSORS 16
+
+/**
+ * Coherent set of readings from one completed sweep
+ * Indexed by sensor handle.
+ */
+typedef struct {
+    uint32_t sweep;          /* Increments once per sensor_manager_read_all() */
+    int64_t timestamp_ms;    /* Uptime when the sweep completed */
+    int count;
+    sensor_reading_t readings[MAX_MANAGED_SENSORS];
+    bool valid[MAX_MANAGED_SENSORS];
+} sensor_snapshot_t;
+
 /**
  * Initialize sensor manager
+ * Sensor IDs are read from the configuration rather than copied, so it
+ * must stay valid while the manager is in use.
  * @param config Pointer to thermal configuration
  * @return 0 on success, negative error code on failure
  */
@@ -39,10 +57,77 @@ int sensor_manager_init(const thermal_config_t *config);
 /**
  * Read all enabled sensors
  * Called periodically by sensor thread
+ * Builds the next snapshot off to the side and publishes it in one step
+ * when the sweep completes; readers keep seeing the previous sweep until
+ * then and never block on the ADC.
+ * With CONFIG_COO_SENSOR_PARALLEL_SWEEP, each ADC device is read by its
+ * own thread and this call returns once every device has finished.
  * @return 0 on success, negative if any sensor failed
  */
 int sensor_manager_read_all(void);
 
+/**
+ * Copy the most recently published sweep
+ * @param snapshot Pointer to store the snapshot
+ * @return 0 on success, negative error code on failure
+ */
+int sensor_manager_get_snapshot(sensor_snapshot_t *snapshot);
+
+/**
+ * Resolve a sensor ID to a handle for the handle-based accessors
+ * Handles are indices into the configured sensor table, so they stay
+ * valid for the lifetime of the configuration passed to init. Resolve
+ * once at init and keep string lookups off the hot path.
+ * @param sensor_id Sensor ID string
+ * @return handle >= 0 on success, negative error code if not found
+ */
+int sensor_manager_find_handle(const char *sensor_id);
+
+/**
+ * Get latest reading for a sensor handle
+ * @param handle Sensor handle from sensor_manager_find_handle()
+ * @param reading Pointer to store reading
+ * @return 0 on success, negative error code on failure
+ */
+int sensor_manager_get_reading_by_handle(int handle, sensor_reading_t *reading);
+
+/**
+ * Get average temperature from multiple sensor handles
+ * Negative (unresolved) handles are skipped like invalid readings.
+ * @param handles Array of sensor handles
+ * @param num_handles Number of handles to average
+ * @param avg_temp Pointer to store average temperature
+ * @return 0 on success, negative error code on failure
+ */
+int sensor_manager_get_average_by_handle(const config_index_t handles[], int num_handles,
+                                         float *avg_temp);
+
+/**
+ * Fusion parameters for sensor_manager_fuse_by_handle()
+ */
+typedef struct {
+    float outlier_threshold;   /* Max |T - median| in Kelvin; <= 0 disables rejection */
+    uint32_t max_age_ms;       /* Oldest reading accepted; 0 = no age limit */
+    const float *weights;      /* One weight per handle; NULL = equal weights */
+} sensor_fusion_params_t;
+
+/**
+ * Fuse readings from multiple sensor handles into one temperature
+ * All readings come from the same sweep. Invalid, unresolved and stale
+ * readings are dropped first; the rest are compared against their
+ * median and any further than outlier_threshold away are rejected. The
+ * survivors are combined as a weighted mean.
+ * @param handles Array of sensor handles, NO_CONFIG_INDEX for unresolved IDs
+ * @param num_handles Number of handles (at most MAX_SENSORS_PER_LOOP)
+ * @param params Fusion parameters, NULL for a plain average
+ * @param temp Pointer to store the fused temperature
+ * @param num_used Optional; number of readings that survived, may be NULL
+ * @return 0 on success, -1 on bad arguments, -2 if no reading survived
+ */
+int sensor_manager_fuse_by_handle(const config_index_t handles[], int num_handles,
+                                  const sensor_fusion_params_t *params,
+                                  float *temp, int *num_used);
+
 /**
  * Get latest reading for a specific sensor
  * @param sensor_id Sensor ID string
@@ -0,0 +1,212 @@
+/**
+ * @file supervisor.c
+ * @brief Pipeline deadline supervision and hardware watchdog implementation
+ */
+
+#include "supervisor.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#ifdef CONFIG_WATCHDOG
+#include <zephyr/drivers/watchdog.h>
+#endif
+#include <string.h>
+
+LOG_MODULE_REGISTER(supervisor, LOG_LEVEL_INF);
+
+#define MIN_CHECK_PERIOD_MS 10
+
+static supervisor_config_t sup_cfg;
+static uint32_t check_period_ms;
+static int wdt_channel = -1;
+
+/* Check-in times, k_uptime_get_32() ms; compared wrap-safe */
+static atomic_t stage_last_ms[SUPERVISOR_NUM_STAGES];
+static atomic_t command_last_ms;
+static atomic_t command_armed;
+static atomic_t tripped;
+static atomic_t started;
+static atomic_t interlock_pending; /* Bit i = interlock i not yet handled */
+static bool command_timed_out;    /* Work-item only */
+
+static void supervisor_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(supervisor_work, supervisor_work_handler);
+
+static void supervisor_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    uint32_t now = k_uptime_get_32();
+    bool on_time = !atomic_get(&tripped);
+
+    /* Interlock trips first: they may be why this pass ran early */
+    uint32_t interlocks = (uint32_t)atomic_clear(&interlock_pending);
+
+    while (interlocks != 0U) {
+        int i = (int)find_lsb_set(interlocks) - 1;
+
+        interlocks &= interlocks - 1U;
+        if (sup_cfg.on_fault != NULL) {
+            sup_cfg.on_fault(SUPERVISOR_FAULT_INTERLOCK, i);
+        }
+    }
+
+    for (int s = 0; s < SUPERVISOR_NUM_STAGES && on_time; s++) {
+        uint32_t deadline = sup_cfg.stage_deadline_ms[s];
+        uint32_t age = now - (uint32_t)atomic_get(&stage_last_ms[s]);
+
+        if (deadline > 0 && age > deadline) {
+            atomic_set(&tripped, 1);
+            on_time = false;
+            LOG_ERR("Stage %d missed its deadline (%u ms > %u ms)", s, age, deadline);
+            if (sup_cfg.on_fault != NULL) {
+                sup_cfg.on_fault(SUPERVISOR_FAULT_STAGE_MISSED, s);
+            }
+        }
+    }
+
+    if (sup_cfg.command_timeout_ms > 0 && atomic_get(&command_armed)) {
+        uint32_t age = now - (uint32_t)atomic_get(&command_last_ms);
+
+        if (age <= sup_cfg.command_timeout_ms) {
+            command_timed_out = false;
+        } else if (!command_timed_out) {
+            /* Once per lapse; the next command re-arms it */
+            command_timed_out = true;
+            LOG_ERR("No command for %u ms", age);
+            if (sup_cfg.on_fault != NULL) {
+                sup_cfg.on_fault(SUPERVISOR_FAULT_COMMAND_TIMEOUT, -1);
+            }
+        }
+    }
+
+#ifdef CONFIG_WATCHDOG
+    if (on_time && wdt_channel >= 0) {
+        wdt_feed(sup_cfg.watchdog, wdt_channel);
+    }
+#endif
+
+    k_work_schedule(&supervisor_work, K_MSEC(check_period_ms));
+}
+
+static int watchdog_start(void)
+{
+#ifdef CONFIG_WATCHDOG
+    if (sup_cfg.watchdog == NULL) {
+        LOG_WRN("No hardware watchdog; deadlines are still enforced");
+        return 0;
+    }
+    if (!device_is_ready(sup_cfg.watchdog)) {
+        LOG_ERR("Watchdog device not ready");
+        return -1;
+    }
+
+    struct wdt_timeout_cfg wdt_cfg = {
+        .window = { .min = 0, .max = sup_cfg.watchdog_timeout_ms },
+        .callback = NULL,
+        .flags = WDT_FLAG_RESET_SOC,
+    };
+
+    wdt_channel = wdt_install_timeout(sup_cfg.watchdog, &wdt_cfg);
+    if (wdt_channel < 0) {
+        LOG_ERR("Watchdog timeout install failed: %d", wdt_channel);
+        return -2;
+    }
+
+    int ret = wdt_setup(sup_cfg.watchdog, WDT_OPT_PAUSE_HALTED_BY_DBG);
+    if (ret < 0) {
+        LOG_ERR("Watchdog setup failed: %d", ret);
+        wdt_channel = -1;
+        return -3;
+    }
+
+    LOG_INF("Watchdog armed, %u ms", sup_cfg.watchdog_timeout_ms);
+#else
+    if (sup_cfg.watchdog != NULL) {
+        LOG_WRN("CONFIG_WATCHDOG disabled; hardware watchdog not used");
+    }
+#endif
+    return 0;
+}
+
+int supervisor_init(const supervisor_config_t *config)
+{
+    if (config == NULL) {
+        LOG_ERR("Config is NULL");
+        return -1;
+    }
+
+    memcpy(&sup_cfg, config, sizeof(sup_cfg));
+
+    /*
+     * Check often enough to feed the watchdog with margin and to catch a
+     * late stage within half its deadline.
+     */
+    check_period_ms = UINT32_MAX;
+    if (sup_cfg.watchdog != NULL && sup_cfg.watchdog_timeout_ms > 0) {
+        check_period_ms = sup_cfg.watchdog_timeout_ms / 4;
+    }
+    for (int s = 0; s < SUPERVISOR_NUM_STAGES; s++) {
+        if (sup_cfg.stage_deadline_ms[s] > 0 &&
+            sup_cfg.stage_deadline_ms[s] / 2 < check_period_ms) {
+            check_period_ms = sup_cfg.stage_deadline_ms[s] / 2;
+        }
+    }
+    if (check_period_ms == UINT32_MAX) {
+        check_period_ms = 1000;
+    }
+    if (check_period_ms < MIN_CHECK_PERIOD_MS) {
+        check_period_ms = MIN_CHECK_PERIOD_MS;
+    }
+
+    uint32_t now = k_uptime_get_32();
+
+    for (int s = 0; s < SUPERVISOR_NUM_STAGES; s++) {
+        atomic_set(&stage_last_ms[s], (atomic_val_t)now);
+    }
+    atomic_clear(&command_armed);
+    atomic_clear(&tripped);
+    command_timed_out = false;
+
+    int ret = watchdog_start();
+    if (ret != 0) {
+        return ret;
+    }
+
+    k_work_schedule(&supervisor_work, K_MSEC(check_period_ms));
+    atomic_set(&started, 1);
+
+    LOG_INF("Supervisor started, checking every %u ms", check_period_ms);
+    return 0;
+}
+
+void supervisor_checkin(supervisor_stage_t stage)
+{
+    if ((unsigned int)stage < SUPERVISOR_NUM_STAGES) {
+        atomic_set(&stage_last_ms[stage], (atomic_val_t)k_uptime_get_32());
+    }
+}
+
+void supervisor_note_command(void)
+{
+    atomic_set(&command_last_ms, (atomic_val_t)k_uptime_get_32());
+    atomic_set(&command_armed, 1);
+}
+
+void supervisor_report_interlock(int interlock)
+{
+    if (interlock < 0 || interlock >= 32) {
+        return;
+    }
+
+    atomic_or(&interlock_pending, (atomic_val_t)BIT(interlock));
+    if (atomic_get(&started)) {
+        /* Run the check now; it reschedules itself at the usual period */
+        k_work_reschedule(&supervisor_work, K_NO_WAIT);
+    }
+}
+
+bool supervisor_is_tripped(void)
+{
+    return atomic_get(&tripped) != 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file supervisor.h
+ * @brief Pipeline deadline supervision and hardware watchdog
+ *
+ * Each pipeline stage checks in once per cycle. A delayed work item
+ * checks the check-in ages; it feeds the hardware watchdog only while
+ * every stage is within its deadline. A late stage trips the fault
+ * handler once and the watchdog is never fed again, so a hung stage
+ * ends in a reset, with the heaters already off. Nothing polls: the
+ * stages only store a timestamp.
+ */
+
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+/**
+ * Supervised pipeline stages
+ */
+typedef enum {
+    SUPERVISOR_STAGE_SENSOR = 0,
+    SUPERVISOR_STAGE_CONTROL,
+    SUPERVISOR_NUM_STAGES
+} supervisor_stage_t;
+
+/**
+ * Supervision faults
+ */
+typedef enum {
+    SUPERVISOR_FAULT_STAGE_MISSED,     // A stage missed its deadline
+    SUPERVISOR_FAULT_COMMAND_TIMEOUT,  // No host command within the timeout
+    SUPERVISOR_FAULT_INTERLOCK         // A sensor interlock cut its heaters
+} supervisor_fault_t;
+
+/**
+ * Fault callback, run from the system workqueue
+ * @param fault What tripped
+ * @param stage Stage that missed its deadline, interlock handle for an
+ *              interlock trip, -1 for a command timeout
+ */
+typedef void (*supervisor_fault_handler_t)(supervisor_fault_t fault, int stage);
+
+/**
+ * Supervisor configuration
+ */
+typedef struct {
+    const struct device *watchdog;   // NULL = no hardware watchdog
+    uint32_t watchdog_timeout_ms;
+    uint32_t stage_deadline_ms[SUPERVISOR_NUM_STAGES];  // 0 = not supervised
+    uint32_t command_timeout_ms;     // 0 = no command timeout
+    supervisor_fault_handler_t on_fault;
+} supervisor_config_t;
+
+/**
+ * Start supervision
+ * Deadlines count from this call, so stages must start checking in
+ * within one deadline.
+ * @param config Configuration, copied
+ * @return 0 on success, negative error code on failure
+ */
+int supervisor_init(const supervisor_config_t *config);
+
+/**
+ * Record that a stage completed a cycle; lock-free
+ * @param stage Stage
+ */
+void supervisor_checkin(supervisor_stage_t stage);
+
+/**
+ * Record that a host command arrived; lock-free
+ * The command timeout is armed by the first command, so a controller
+ * running without a host never times out.
+ */
+void supervisor_note_command(void);
+
+/**
+ * Report a sensor interlock trip; lock-free
+ * Safe from the sensor sweep. The fault handler runs for it from the
+ * system workqueue straight away rather than at the next check; the
+ * heaters are already off, so this only fans the trip out. Trips
+ * reported before supervisor_init() are handled at the first check.
+ * @param interlock Interlock handle, 0..31
+ */
+void supervisor_report_interlock(int interlock);
+
+/**
+ * Check whether a stage deadline has tripped
+ * @return true after a missed deadline (until reset)
+ */
+bool supervisor_is_tripped(void);
+
+#endif /* SUPERVISOR_H */
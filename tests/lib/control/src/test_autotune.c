@@ -0,0 +1,165 @@
+/**
+ * @file test_autotune.c
+ * @brief Relay autotuner tests
+ *
+ * The process value is a sine of known amplitude and period around the
+ * setpoint, so Ku and Pu, and from them each rule's gains, have a closed
+ * form to check against.
+ */
+
+#include <zephyr/ztest.h>
+#include "autotune.h"
+#include <math.h>
+
+#define SETPOINT   300.0f
+#define AMPLITUDE  1.0f
+#define PERIOD_S   60.0f
+#define DT_S       0.1f
+
+static autotune_t tune;
+
+static autotune_params_t default_params(void)
+{
+    return (autotune_params_t){
+        .setpoint = SETPOINT,
+        .output_high = 40.0f,
+        .output_low = 0.0f,
+        .hysteresis = 0.1f,
+        .max_deviation = 5.0f,
+        .timeout_s = 3600.0f,
+        .cycles = 3,
+        .rule = AUTOTUNE_RULE_TYREUS_LUYBEN,
+    };
+}
+
+/* Step the tuner on the sine until it stops running */
+static void run_sine(void)
+{
+    for (int tick = 0; autotune_running(&tune) && tick < 1000000; tick++) {
+        float t = (float)tick * DT_S;
+        float pv = SETPOINT + AMPLITUDE * sinf(2.0f * 3.14159265f * t / PERIOD_S);
+
+        (void)autotune_step(&tune, pv, DT_S);
+    }
+}
+
+static float expected_ku(const autotune_params_t *p)
+{
+    float d = 0.5f * (p->output_high - p->output_low);
+    float h = p->hysteresis;
+
+    return 4.0f * d / (3.14159265f * sqrtf(AMPLITUDE * AMPLITUDE - h * h));
+}
+
+ZTEST(autotune, test_rejects_bad_params)
+{
+    autotune_params_t p = default_params();
+
+    zassert_equal(autotune_start(&tune, NULL), -1);
+
+    p.output_low = p.output_high;
+    zassert_equal(autotune_start(&tune, &p), -1);
+
+    p = default_params();
+    p.hysteresis = -0.1f;
+    zassert_equal(autotune_start(&tune, &p), -1);
+
+    p = default_params();
+    p.max_deviation = -1.0f;
+    zassert_equal(autotune_start(&tune, &p), -1);
+
+    p = default_params();
+    p.timeout_s = -1.0f;
+    zassert_equal(autotune_start(&tune, &p), -1);
+
+    p = default_params();
+    p.cycles = 0;
+    zassert_equal(autotune_start(&tune, &p), -1);
+}
+
+ZTEST(autotune, test_relay_switching)
+{
+    autotune_params_t p = default_params();
+
+    zassert_ok(autotune_start(&tune, &p));
+    zassert_true(autotune_running(&tune));
+
+    /* High until above the band, low until below it */
+    zassert_equal(autotune_step(&tune, SETPOINT, DT_S), 40.0f);
+    zassert_equal(autotune_step(&tune, SETPOINT + 0.05f, DT_S), 40.0f);
+    zassert_equal(autotune_step(&tune, SETPOINT + 0.15f, DT_S), 0.0f);
+    zassert_equal(autotune_step(&tune, SETPOINT - 0.05f, DT_S), 0.0f);
+    zassert_equal(autotune_step(&tune, SETPOINT - 0.15f, DT_S), 40.0f);
+}
+
+ZTEST(autotune, test_tyreus_luyben)
+{
+    autotune_params_t p = default_params();
+    autotune_progress_t progress;
+
+    zassert_ok(autotune_start(&tune, &p));
+    run_sine();
+
+    zassert_equal(tune.state, AUTOTUNE_DONE, "state %d error %d", tune.state, tune.error);
+    zassert_within(tune.pu, PERIOD_S, 2.0f * DT_S);
+    zassert_within(tune.ku, expected_ku(&p), 0.01f * expected_ku(&p));
+
+    zassert_within(tune.kp, tune.ku / 2.2f, 1e-4f);
+    zassert_within(tune.ki, tune.kp / (2.2f * tune.pu), 1e-6f);
+    zassert_within(tune.kd, tune.kp * tune.pu / 6.3f, 1e-3f);
+
+    autotune_get_progress(&tune, &progress);
+    zassert_equal(progress.cycles_done, 3);
+    zassert_equal(progress.output, 0.0f);
+
+    /* Idle once done */
+    zassert_equal(autotune_step(&tune, SETPOINT - 1.0f, DT_S), 0.0f);
+}
+
+ZTEST(autotune, test_ziegler_nichols)
+{
+    autotune_params_t p = default_params();
+
+    p.rule = AUTOTUNE_RULE_ZIEGLER_NICHOLS;
+    zassert_ok(autotune_start(&tune, &p));
+    run_sine();
+
+    zassert_equal(tune.state, AUTOTUNE_DONE);
+    zassert_within(tune.kp, 0.6f * tune.ku, 1e-4f);
+    zassert_within(tune.ki, tune.kp / (0.5f * tune.pu), 1e-6f);
+    zassert_within(tune.kd, tune.kp * 0.125f * tune.pu, 1e-3f);
+}
+
+ZTEST(autotune, test_failures)
+{
+    autotune_params_t p = default_params();
+
+    /* No oscillation: the relay never switches */
+    p.timeout_s = 10.0f;
+    zassert_ok(autotune_start(&tune, &p));
+    for (int i = 0; i < 200 && autotune_running(&tune); i++) {
+        (void)autotune_step(&tune, SETPOINT, DT_S);
+    }
+    zassert_equal(tune.state, AUTOTUNE_FAILED);
+    zassert_equal(tune.error, AUTOTUNE_ERR_TIMEOUT);
+
+    /* Runaway */
+    p = default_params();
+    zassert_ok(autotune_start(&tune, &p));
+    zassert_equal(autotune_step(&tune, SETPOINT + 6.0f, DT_S), 0.0f);
+    zassert_equal(tune.error, AUTOTUNE_ERR_DEVIATION);
+
+    /* Aborted by command; a finished tune cannot be aborted */
+    zassert_ok(autotune_start(&tune, &p));
+    autotune_abort(&tune);
+    zassert_equal(tune.state, AUTOTUNE_FAILED);
+    zassert_equal(tune.error, AUTOTUNE_ERR_ABORTED);
+
+    p.timeout_s = 0.0f;
+    zassert_ok(autotune_start(&tune, &p));
+    run_sine();
+    autotune_abort(&tune);
+    zassert_equal(tune.state, AUTOTUNE_DONE);
+}
+
+ZTEST_SUITE(autotune, NULL, NULL, NULL, NULL, NULL);
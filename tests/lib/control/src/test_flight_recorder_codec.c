@@ -0,0 +1,145 @@
+/**
+ * @file test_flight_recorder_codec.c
+ * @brief Flight recorder payload codec tests
+ */
+
+#include <zephyr/ztest.h>
+#include "flight_recorder_codec.h"
+#include <math.h>
+#include <string.h>
+
+#define VALUES 512
+
+static uint8_t buf[VALUES * RECORDER_CODE_BITS_MAX / 8 + 1];
+static int32_t values[VALUES];
+
+static void clear_buf(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    memset(buf, 0, sizeof(buf));
+}
+
+ZTEST(flight_recorder_codec, test_zigzag)
+{
+    zassert_equal(recorder_zigzag(0, 0), 0U);
+    zassert_equal(recorder_zigzag(-1, 0), 1U);
+    zassert_equal(recorder_zigzag(1, 0), 2U);
+    zassert_equal(recorder_zigzag(-2, 0), 3U);
+    zassert_equal(recorder_zigzag(105, 100), 10U);
+    zassert_equal(recorder_zigzag(INT32_MAX, 0), UINT32_MAX - 1U);
+    zassert_equal(recorder_zigzag(INT32_MIN, 0), UINT32_MAX);
+
+    /* Deltas wrap, so any pair round-trips */
+    static const int32_t pairs[][2] = {
+        { 0, 0 }, { 7, -3 }, { -300150, 300150 }, { INT32_MAX, INT32_MIN },
+        { INT32_MIN, INT32_MAX }, { INT32_MIN, 1 },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(pairs); i++) {
+        uint32_t z = recorder_zigzag(pairs[i][0], pairs[i][1]);
+
+        zassert_equal(recorder_unzigzag(z, pairs[i][1]), pairs[i][0], "pair %u", (unsigned)i);
+    }
+}
+
+ZTEST(flight_recorder_codec, test_class_boundaries)
+{
+    static const struct {
+        uint32_t z;
+        uint32_t len;
+    } cases[] = {
+        { 0, 1 },
+        { 1, 4 }, { 4, 4 },
+        { 5, 9 }, { 68, 9 },
+        { 69, 16 }, { 4164, 16 },
+        { 4165, 25 }, { 1052740, 25 },
+        { 1052741, RECORDER_CODE_BITS_MAX }, { UINT32_MAX, RECORDER_CODE_BITS_MAX },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+        zassert_equal(recorder_code_len(cases[i].z), cases[i].len, "z=%u", cases[i].z);
+    }
+}
+
+ZTEST(flight_recorder_codec, test_bit_layout)
+{
+    uint32_t pos = 0;
+
+    /* 0 | 10 01 | 110 000000, MSB first */
+    recorder_put_code(buf, &pos, 0);
+    recorder_put_code(buf, &pos, 2);
+    recorder_put_code(buf, &pos, 5);
+    zassert_equal(pos, 14U);
+    zassert_equal(buf[0], 0x4e);
+    zassert_equal(buf[1], 0x00);
+
+    /* The escape is five ones and the raw value */
+    memset(buf, 0, sizeof(buf));
+    pos = 3;
+    recorder_put_code(buf, &pos, 0xdeadbeef);
+    zassert_equal(pos, 3U + RECORDER_CODE_BITS_MAX);
+
+    uint32_t rd = 3;
+
+    zassert_equal(recorder_get_bits(buf, &rd, 5), 0x1fU);
+    zassert_equal(recorder_get_bits(buf, &rd, 32), 0xdeadbeefU);
+}
+
+ZTEST(flight_recorder_codec, test_round_trip)
+{
+    uint32_t state = 1;
+    uint32_t pos = 0;
+    uint32_t bits = 0;
+    int32_t prev = 0;
+
+    /* Mostly small steps, as a slow temperature gives, with jumps in every class */
+    for (int i = 0; i < VALUES; i++) {
+        state = state * 1664525u + 1013904223u;
+
+        int32_t step = (int32_t)(state >> 8) % 16 - 8;
+
+        if (i % 37 == 0) {
+            step = (int32_t)(state >> (i % 24));
+        }
+        values[i] = (int32_t)((uint32_t)prev + (uint32_t)step);
+        if (i == VALUES / 2) {
+            values[i] = INT32_MIN;
+        }
+
+        uint32_t z = recorder_zigzag(values[i], prev);
+
+        bits += recorder_code_len(z);
+        recorder_put_code(buf, &pos, z);
+        prev = values[i];
+    }
+    zassert_equal(pos, bits, "code_len disagrees with what put_code wrote");
+    zassert_true(pos <= sizeof(buf) * 8U);
+
+    pos = 0;
+    prev = 0;
+    for (int i = 0; i < VALUES; i++) {
+        int32_t v = recorder_unzigzag(recorder_get_code(buf, &pos), prev);
+
+        zassert_equal(v, values[i], "value %d: %d != %d", i, v, values[i]);
+        prev = v;
+    }
+    zassert_equal(pos, bits);
+}
+
+ZTEST(flight_recorder_codec, test_quantize)
+{
+    zassert_equal(recorder_quantize(300.15f, 1000.0f, 0), 300150);
+    zassert_equal(recorder_quantize(-0.0026f, 1000.0f, 0), -3);
+    zassert_equal(recorder_quantize(12.5f, 100.0f, 0), 1250);
+
+    /* Not a number: the previous value is held */
+    zassert_equal(recorder_quantize(NAN, 1000.0f, 42), 42);
+    zassert_equal(recorder_quantize(INFINITY, 1000.0f, -7), -7);
+
+    /* Clamped to half range, so a delta between any two values fits */
+    zassert_equal(recorder_quantize(1e12f, 1000.0f, 0), INT32_MAX / 2 + 1);
+    zassert_equal(recorder_quantize(-1e12f, 1000.0f, 0), INT32_MIN / 2);
+}
+
+ZTEST_SUITE(flight_recorder_codec, NULL, NULL, clear_buf, NULL, NULL);
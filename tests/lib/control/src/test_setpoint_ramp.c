@@ -0,0 +1,145 @@
+/**
+ * @file test_setpoint_ramp.c
+ * @brief Setpoint ramp and ramp-soak profile engine tests
+ */
+
+#include <zephyr/ztest.h>
+#include "setpoint_ramp.h"
+
+static setpoint_ramp_t ramp;
+
+/* Advance n ticks of dt; returns the last setpoint */
+static float advance_n(int n, float dt)
+{
+    float sp = ramp.setpoint;
+
+    for (int i = 0; i < n; i++) {
+        sp = setpoint_ramp_advance(&ramp, dt);
+    }
+    return sp;
+}
+
+ZTEST(setpoint_ramp, test_init)
+{
+    ramp_progress_t p;
+
+    setpoint_ramp_init(&ramp, 300.0f, -5.0f);
+    setpoint_ramp_get_progress(&ramp, &p);
+
+    zassert_equal(p.setpoint, 300.0f);
+    zassert_equal(p.target, 300.0f);
+    zassert_equal(p.rate_k_per_min, 0.0f, "negative rate not treated as a step");
+    zassert_false(p.ramping);
+    zassert_false(p.profile_active);
+}
+
+ZTEST(setpoint_ramp, test_step_without_rate)
+{
+    setpoint_ramp_init(&ramp, 300.0f, 0.0f);
+    setpoint_ramp_set_target(&ramp, 310.0f);
+
+    zassert_equal(setpoint_ramp_advance(&ramp, 0.5f), 310.0f);
+}
+
+ZTEST(setpoint_ramp, test_rate_limit)
+{
+    ramp_progress_t p;
+
+    /* 6 K/min at 1 s ticks is 0.1 K per tick */
+    setpoint_ramp_init(&ramp, 300.0f, 6.0f);
+    setpoint_ramp_set_target(&ramp, 301.0f);
+
+    zassert_within(advance_n(5, 1.0f), 300.5f, 1e-4f);
+    setpoint_ramp_get_progress(&ramp, &p);
+    zassert_true(p.ramping);
+    zassert_equal(p.rate_k_per_min, 6.0f);
+
+    /* Lands exactly on the target, never past it */
+    zassert_equal(advance_n(6, 1.0f), 301.0f);
+    setpoint_ramp_get_progress(&ramp, &p);
+    zassert_false(p.ramping);
+
+    /* Downward at a new rate */
+    setpoint_ramp_set_rate(&ramp, 60.0f);
+    setpoint_ramp_set_target(&ramp, 299.0f);
+    zassert_within(advance_n(1, 1.0f), 300.0f, 1e-4f);
+    zassert_equal(advance_n(1, 1.0f), 299.0f);
+
+    /* A negative dt does not move the setpoint */
+    setpoint_ramp_set_target(&ramp, 310.0f);
+    zassert_equal(setpoint_ramp_advance(&ramp, -1.0f), 299.0f);
+}
+
+ZTEST(setpoint_ramp, test_profile_bad_args)
+{
+    ramp_segment_t segs[RAMP_MAX_SEGMENTS + 1] = { 0 };
+
+    setpoint_ramp_init(&ramp, 300.0f, 1.0f);
+    zassert_equal(setpoint_ramp_start_profile(&ramp, NULL, 1), -1);
+    zassert_equal(setpoint_ramp_start_profile(&ramp, segs, 0), -1);
+    zassert_equal(setpoint_ramp_start_profile(&ramp, segs, RAMP_MAX_SEGMENTS + 1), -1);
+    zassert_false(ramp.profile_active);
+}
+
+ZTEST(setpoint_ramp, test_profile_ramp_soak)
+{
+    /* Up 1 K at 60 K/min and soak 3 s, then back at the loop rate */
+    static const ramp_segment_t segs[] = {
+        { .target_kelvin = 301.0f, .rate_k_per_min = 60.0f, .soak_seconds = 3.0f },
+        { .target_kelvin = 300.0f, .rate_k_per_min = 0.0f, .soak_seconds = 0.0f },
+    };
+    ramp_progress_t p;
+
+    setpoint_ramp_init(&ramp, 300.0f, 30.0f);
+    zassert_ok(setpoint_ramp_start_profile(&ramp, segs, ARRAY_SIZE(segs)));
+
+    /* 1 K/s: there at the second tick, which already counts toward the soak */
+    zassert_within(advance_n(1, 0.5f), 300.5f, 1e-4f);
+    zassert_equal(advance_n(1, 0.5f), 301.0f);
+    setpoint_ramp_get_progress(&ramp, &p);
+    zassert_true(p.profile_active);
+    zassert_equal(p.segment, 0);
+    zassert_within(p.soak_remaining_s, 2.5f, 1e-4f);
+
+    /* Five more half-second ticks finish the soak */
+    advance_n(4, 0.5f);
+    zassert_equal(ramp.segment, 0);
+    advance_n(1, 0.5f);
+    setpoint_ramp_get_progress(&ramp, &p);
+    zassert_equal(p.segment, 1);
+    zassert_equal(p.target, 300.0f);
+    zassert_equal(p.rate_k_per_min, 30.0f, "segment rate 0 uses the loop rate");
+
+    /* 30 K/min is 0.25 K per half second: four ticks down, then done */
+    zassert_within(advance_n(3, 0.5f), 300.25f, 1e-4f);
+    zassert_equal(advance_n(1, 0.5f), 300.0f);
+    setpoint_ramp_get_progress(&ramp, &p);
+    zassert_false(p.profile_active);
+    zassert_false(p.ramping);
+    zassert_equal(p.soak_remaining_s, 0.0f);
+    zassert_equal(advance_n(10, 0.5f), 300.0f);
+}
+
+ZTEST(setpoint_ramp, test_profile_cancel)
+{
+    static const ramp_segment_t segs[] = {
+        { .target_kelvin = 310.0f, .rate_k_per_min = 60.0f, .soak_seconds = 10.0f },
+    };
+
+    setpoint_ramp_init(&ramp, 300.0f, 0.0f);
+    zassert_ok(setpoint_ramp_start_profile(&ramp, segs, 1));
+    advance_n(2, 1.0f);
+
+    /* Stop holds where the ramp got to */
+    setpoint_ramp_stop_profile(&ramp);
+    zassert_false(ramp.profile_active);
+    zassert_equal(advance_n(5, 1.0f), 302.0f);
+
+    /* A new target cancels a running profile */
+    zassert_ok(setpoint_ramp_start_profile(&ramp, segs, 1));
+    setpoint_ramp_set_target(&ramp, 305.0f);
+    zassert_false(ramp.profile_active);
+    zassert_equal(advance_n(1, 1.0f), 305.0f);
+}
+
+ZTEST_SUITE(setpoint_ramp, NULL, NULL, NULL, NULL, NULL);
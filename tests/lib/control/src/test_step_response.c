@@ -0,0 +1,84 @@
+/**
+ * @file test_step_response.c
+ * @brief Closed-loop step response regression
+ *
+ * The loop of demo/plant_sim (a two-node RC plant, Kp 6, Ki 0.3,
+ * conditional anti-windup) steps its setpoint by 10 K. Overshoot,
+ * settling time and final error must stay inside the same limits the
+ * demo reports against, so a change to the PID law that degrades control
+ * fails here.
+ */
+
+#include <zephyr/ztest.h>
+#include <coo_commons/pid.h>
+#include "plant.h"
+#include <math.h>
+
+#define AMBIENT_K        293.15f
+#define STEP_K           10.0f
+#define DT_S             0.5f
+#define DURATION_S       900.0f
+#define MAX_POWER_W      40.0f
+#define NOISE_K          0.005f
+
+#define SETTLE_BAND_K    0.1f
+#define MAX_OVERSHOOT_K  0.5f
+#define MAX_SETTLE_S     300.0f
+
+static plant_t plant;
+static uint32_t noise_state = 1;
+
+/* Deterministic uniform noise in [-amplitude, amplitude] */
+static float sim_noise(float amplitude)
+{
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return amplitude * ((float)(noise_state >> 8) / (float)(1u << 23) - 1.0f);
+}
+
+ZTEST(step_response, test_step_response)
+{
+    static const plant_node_params_t nodes[] = {
+        { .heat_capacity = 100.0f, .loss_conductance = 0.2f, .coupling_conductance = 1.0f },
+        { .heat_capacity = 400.0f, .loss_conductance = 0.3f },
+    };
+    const float target_k = AMBIENT_K + STEP_K;
+    struct coo_pid pid;
+    struct coo_pid_options opts;
+
+    zassert_ok(plant_init(&plant, nodes, ARRAY_SIZE(nodes), AMBIENT_K));
+
+    /* As the control loop sets up the demo's loop */
+    coo_pid_init(&pid, 6.0f, 0.3f, 0.0f, 0.0f, MAX_POWER_W);
+    coo_pid_options_default(&opts);
+    opts.derivative_on_measurement = true;
+    opts.derivative_filter_tau = 1.0f;
+    opts.anti_windup = COO_PID_ANTI_WINDUP_CONDITIONAL;
+    coo_pid_set_options(&pid, &opts);
+
+    float peak_k = AMBIENT_K;
+    float settle_s = 0.0f;
+    float temp_k = AMBIENT_K;
+    int ticks = (int)(DURATION_S / DT_S);
+
+    for (int tick = 1; tick <= ticks; tick++) {
+        float watts = coo_pid_update(&pid, target_k, temp_k + sim_noise(NOISE_K), DT_S);
+
+        zassert_ok(plant_set_power(&plant, 0, watts));
+        plant_step(&plant, DT_S);
+
+        temp_k = plant_temperature(&plant, 0);
+        peak_k = MAX(peak_k, temp_k);
+        if (fabsf(temp_k - target_k) > SETTLE_BAND_K) {
+            settle_s = tick * DT_S;
+        }
+    }
+
+    zassert_true(peak_k - target_k <= MAX_OVERSHOOT_K, "overshoot %.3f K, limit %.3f K",
+                 (double)(peak_k - target_k), (double)MAX_OVERSHOOT_K);
+    zassert_true(settle_s <= MAX_SETTLE_S, "settled after %.1f s, limit %.0f s",
+                 (double)settle_s, (double)MAX_SETTLE_S);
+    zassert_within(temp_k, target_k, SETTLE_BAND_K, "final error %+.4f K",
+                   (double)(target_k - temp_k));
+}
+
+ZTEST_SUITE(step_response, NULL, NULL, NULL, NULL, NULL);
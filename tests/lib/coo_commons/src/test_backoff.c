@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <coo_commons/backoff.h>
+
+ZTEST(backoff, test_doubles_up_to_cap)
+{
+	struct coo_backoff b = COO_BACKOFF_INIT(250, 8000);
+	uint32_t ceiling = 250;
+
+	for (int i = 0; i < 12; i++) {
+		uint32_t delay = coo_backoff_next(&b);
+
+		zassert_between_inclusive(delay, ceiling / 2U, ceiling,
+					  "attempt %d: %u outside [%u, %u]", i, delay,
+					  ceiling / 2U, ceiling);
+		ceiling = MIN(ceiling * 2U, 8000U);
+	}
+
+	/* Capped: every further delay is drawn from the top ceiling */
+	for (int i = 0; i < 100; i++) {
+		uint32_t delay = coo_backoff_next(&b);
+
+		zassert_between_inclusive(delay, 4000U, 8000U);
+	}
+}
+
+ZTEST(backoff, test_reset)
+{
+	struct coo_backoff b = COO_BACKOFF_INIT(100, 1000);
+	uint32_t delay;
+
+	for (int i = 0; i < 8; i++) {
+		(void)coo_backoff_next(&b);
+	}
+	zassert_equal(b.next_ms, 1000U);
+
+	coo_backoff_reset(&b);
+	delay = coo_backoff_next(&b);
+	zassert_between_inclusive(delay, 50U, 100U);
+	zassert_equal(b.next_ms, 200U);
+}
+
+ZTEST(backoff, test_jitter)
+{
+	struct coo_backoff b = COO_BACKOFF_INIT(10000, 10000);
+	uint32_t first = coo_backoff_next(&b);
+	bool varied = false;
+
+	/* Devices that fail together must not retry in lockstep */
+	for (int i = 0; i < 64 && !varied; i++) {
+		varied = coo_backoff_next(&b) != first;
+	}
+	zassert_true(varied, "64 delays all equal %u", first);
+}
+
+ZTEST_SUITE(backoff, NULL, NULL, NULL, NULL, NULL);
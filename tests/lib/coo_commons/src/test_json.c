@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <coo_commons/json_utils.h>
+#include <errno.h>
+#include <stdio.h>
+
+static struct coo_json_doc doc;
+
+ZTEST(json_doc, test_tokenizes_top_level)
+{
+	static const char json[] =
+		" { \"a\" : 1.5, \"s\":\"x\\\"y\", \"o\":{\"n\":[1,{}]}, \"arr\":[1, 2 ,3],"
+		"\"t\":true, \"f\":false, \"z\":null } ";
+	static const struct {
+		const char *key;
+		uint8_t type;
+		const char *value;
+	} expect[] = {
+		{ "a", COO_JSON_VALUE_NUMBER, "1.5" },
+		{ "s", COO_JSON_VALUE_STRING, "\"x\\\"y\"" },
+		{ "o", COO_JSON_VALUE_OBJECT, "{\"n\":[1,{}]}" },
+		{ "arr", COO_JSON_VALUE_ARRAY, "[1, 2 ,3]" },
+		{ "t", COO_JSON_VALUE_TRUE, "true" },
+		{ "f", COO_JSON_VALUE_FALSE, "false" },
+		{ "z", COO_JSON_VALUE_NULL, "null" },
+	};
+
+	zassert_ok(coo_json_doc_parse(&doc, json, NULL, NULL, 0));
+	zassert_equal(doc.count, ARRAY_SIZE(expect));
+
+	for (size_t i = 0; i < ARRAY_SIZE(expect); i++) {
+		const struct coo_json_field *f = coo_json_doc_find(&doc, expect[i].key);
+
+		zassert_not_null(f, "%s missing", expect[i].key);
+		zassert_equal(f->type, expect[i].type, "%s type %u", expect[i].key, f->type);
+		zassert_equal(f->value_len, strlen(expect[i].value), "%s length", expect[i].key);
+		zassert_mem_equal(f->value, expect[i].value, f->value_len, "%s value",
+				  expect[i].key);
+	}
+	zassert_is_null(coo_json_doc_find(&doc, "missing"));
+}
+
+ZTEST(json_doc, test_rejects_malformed)
+{
+	static const char *const bad[] = {
+		"",
+		"[1]",
+		"{",
+		"{\"a\"}",
+		"{\"a\":}",
+		"{\"a\":1,}",
+		"{\"a\":1 \"b\":2}",
+		"{\"a\":\"open}",
+		"{\"a\":{\"b\":1}",
+		"{\"a\":[1,2}",
+		"{\"a\":1} x",
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(bad); i++) {
+		zassert_equal(coo_json_doc_parse(&doc, bad[i], NULL, NULL, 0), -EINVAL,
+			      "accepted %s", bad[i]);
+	}
+}
+
+ZTEST(json_doc, test_allowed_keys)
+{
+	char unknown[8];
+
+	zassert_ok(coo_json_doc_parse(&doc, "{\"rate\":1,\"target\":2}", "target,rate",
+				      unknown, sizeof(unknown)));
+	zassert_equal(coo_json_doc_parse(&doc, "{\"rate\":1,\"bogus\":2}", "target,rate",
+					 unknown, sizeof(unknown)),
+		      -ENOENT);
+	zassert_str_equal(unknown, "bogus");
+
+	/* A prefix of an allowed key is not allowed */
+	zassert_equal(coo_json_doc_parse(&doc, "{\"tar\":1}", "target,rate", NULL, 0), -ENOENT);
+}
+
+ZTEST(json_doc, test_field_limit)
+{
+	char json[256];
+	size_t off = 0;
+
+	off += snprintf(&json[off], sizeof(json) - off, "{");
+	for (unsigned int i = 0; i <= COO_JSON_DOC_FIELDS_MAX; i++) {
+		off += snprintf(&json[off], sizeof(json) - off, "%s\"k%u\":%u", i ? "," : "", i, i);
+	}
+	snprintf(&json[off], sizeof(json) - off, "}");
+
+	zassert_equal(coo_json_doc_parse(&doc, json, NULL, NULL, 0), -E2BIG);
+}
+
+ZTEST(json_doc, test_number_grammar)
+{
+	static const struct {
+		const char *text;
+		double value;
+	} good[] = {
+		{ "0", 0.0 }, { "-0", 0.0 }, { "12", 12.0 }, { "-3.25", -3.25 },
+		{ "1e3", 1000.0 }, { "2.5E-1", 0.25 }, { "1e+2", 100.0 },
+	};
+	static const char *const bad[] = {
+		"01", "+1", "1.", ".5", "-", "1e", "1e+", "0x10", "inf", "nan", "1e400",
+	};
+	char json[48];
+	double v;
+
+	for (size_t i = 0; i < ARRAY_SIZE(good); i++) {
+		snprintf(json, sizeof(json), "{\"v\":%s}", good[i].text);
+		zassert_ok(coo_json_doc_parse(&doc, json, NULL, NULL, 0), "%s", good[i].text);
+		zassert_equal(coo_json_doc_get_double(&doc, "v", &v), COO_JSON_EXTRACT_OK, "%s",
+			      good[i].text);
+		zassert_equal(v, good[i].value, "%s parsed as %f", good[i].text, v);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(bad); i++) {
+		snprintf(json, sizeof(json), "{\"v\":%s}", bad[i]);
+		if (coo_json_doc_parse(&doc, json, NULL, NULL, 0) != 0) {
+			continue;
+		}
+		zassert_equal(coo_json_doc_get_double(&doc, "v", &v), COO_JSON_EXTRACT_ERR,
+			      "accepted %s", bad[i]);
+	}
+}
+
+ZTEST(json_doc, test_typed_accessors)
+{
+	static const char json[] = "{\"n\":42,\"big\":4294967296,\"neg\":-1,\"s\":\"abc\","
+				   "\"b\":true,\"arr\":[1.5,-2,3e1]}";
+	uint32_t u32;
+	uint64_t u64;
+	bool b;
+	char s[4];
+	double arr[4];
+	size_t n;
+
+	zassert_ok(coo_json_doc_parse(&doc, json, NULL, NULL, 0));
+
+	zassert_equal(coo_json_doc_get_u32(&doc, "n", &u32), COO_JSON_EXTRACT_OK);
+	zassert_equal(u32, 42U);
+	zassert_equal(coo_json_doc_get_u32(&doc, "big", &u32), COO_JSON_EXTRACT_ERR);
+	zassert_equal(coo_json_doc_get_u32(&doc, "neg", &u32), COO_JSON_EXTRACT_ERR);
+	zassert_equal(coo_json_doc_get_u64(&doc, "big", &u64), COO_JSON_EXTRACT_OK);
+	zassert_equal(u64, 4294967296ULL);
+	zassert_equal(coo_json_doc_get_u32(&doc, "none", &u32), COO_JSON_EXTRACT_MISSING);
+
+	zassert_equal(coo_json_doc_get_bool(&doc, "b", &b), COO_JSON_EXTRACT_OK);
+	zassert_true(b);
+	zassert_equal(coo_json_doc_get_bool(&doc, "n", &b), COO_JSON_EXTRACT_ERR);
+
+	zassert_equal(coo_json_doc_get_string(&doc, "s", s, sizeof(s)), COO_JSON_EXTRACT_OK);
+	zassert_str_equal(s, "abc");
+	zassert_equal(coo_json_doc_get_string(&doc, "s", s, 3), COO_JSON_EXTRACT_ERR);
+
+	zassert_equal(coo_json_doc_get_double_array(&doc, "arr", arr, ARRAY_SIZE(arr), &n),
+		      COO_JSON_EXTRACT_OK);
+	zassert_equal(n, 3U);
+	zassert_equal(arr[0], 1.5);
+	zassert_equal(arr[1], -2.0);
+	zassert_equal(arr[2], 30.0);
+	zassert_equal(coo_json_doc_get_double_array(&doc, "arr", arr, 2, &n),
+		      COO_JSON_EXTRACT_ERR);
+}
+
+ZTEST_SUITE(json_doc, NULL, NULL, NULL, NULL, NULL);
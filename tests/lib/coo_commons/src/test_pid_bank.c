@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <coo_commons/pid.h>
+#include <coo_commons/pid_bank.h>
+#include <errno.h>
+
+#define CHANNELS 4
+#define STEPS    400
+
+COO_PID_BANK_DEFINE(bank, CHANNELS);
+
+/* One option set per channel, so every law variant is compared */
+static void channel_options(int ch, struct coo_pid_options *opts)
+{
+	coo_pid_options_default(opts);
+
+	switch (ch) {
+	case 1:
+		opts->derivative_on_measurement = true;
+		opts->derivative_filter_tau = 1.0f;
+		break;
+	case 2:
+		opts->anti_windup = COO_PID_ANTI_WINDUP_CONDITIONAL;
+		opts->setpoint_weight = 0.5f;
+		break;
+	case 3:
+		opts->anti_windup = COO_PID_ANTI_WINDUP_BACK_CALC;
+		break;
+	default:
+		break;
+	}
+}
+
+static void init_both(struct coo_pid pids[CHANNELS])
+{
+	for (int ch = 0; ch < CHANNELS; ch++) {
+		struct coo_pid_options opts;
+		float kp = 2.0f + ch;
+		float ki = 0.1f * (ch + 1);
+		float kd = 0.5f * ch;
+
+		channel_options(ch, &opts);
+		coo_pid_init(&pids[ch], kp, ki, kd, 0.0f, 40.0f);
+		coo_pid_set_options(&pids[ch], &opts);
+		zassert_ok(coo_pid_bank_init_channel(&bank, ch, kp, ki, kd, 0.0f, 40.0f));
+		zassert_ok(coo_pid_bank_set_options(&bank, ch, &opts));
+	}
+}
+
+/* A setpoint step per channel and a slow, first-order-ish measurement */
+static void inputs(int step, int ch, float *sp, float *meas, float *dt)
+{
+	*sp = 300.0f + 5.0f * ch + ((step >= STEPS / 2) ? -3.0f : 0.0f);
+	*meas = 295.0f + 10.0f * (1.0f - expf(-(float)step / (60.0f + 10.0f * ch)));
+	*dt = 0.5f;
+}
+
+ZTEST(pid_bank, test_channel_range)
+{
+	zassert_equal(coo_pid_bank_init_channel(&bank, -1, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+		      -EINVAL);
+	zassert_equal(coo_pid_bank_init_channel(&bank, CHANNELS, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+		      -EINVAL);
+	zassert_equal(coo_pid_bank_reset(&bank, CHANNELS), -EINVAL);
+	zassert_equal(coo_pid_bank_set_gains(&bank, -1, 1.0f, 0.0f, 0.0f), -EINVAL);
+}
+
+ZTEST(pid_bank, test_matches_single_pid)
+{
+	struct coo_pid pids[CHANNELS];
+	float sp[CHANNELS], meas[CHANNELS], dt[CHANNELS], out[CHANNELS];
+
+	init_both(pids);
+
+	for (int step = 0; step < STEPS; step++) {
+		for (int ch = 0; ch < CHANNELS; ch++) {
+			inputs(step, ch, &sp[ch], &meas[ch], &dt[ch]);
+		}
+
+		coo_pid_bank_update(&bank, CHANNELS, sp, meas, dt, NULL, out);
+
+		for (int ch = 0; ch < CHANNELS; ch++) {
+			float expect = coo_pid_update(&pids[ch], sp[ch], meas[ch], dt[ch]);
+
+			zassert_equal(out[ch], expect, "channel %d step %d: %f != %f", ch, step,
+				      (double)out[ch], (double)expect);
+			zassert_equal(bank.integral[ch], pids[ch].integral,
+				      "channel %d step %d integral", ch, step);
+		}
+	}
+}
+
+ZTEST(pid_bank, test_run_flags_skip_channels)
+{
+	struct coo_pid pids[CHANNELS];
+	float sp[CHANNELS], meas[CHANNELS], dt[CHANNELS], out[CHANNELS];
+	uint8_t run[CHANNELS];
+
+	init_both(pids);
+
+	for (int step = 0; step < 100; step++) {
+		for (int ch = 0; ch < CHANNELS; ch++) {
+			inputs(step, ch, &sp[ch], &meas[ch], &dt[ch]);
+			/* Channel ch runs every (ch + 1)th step */
+			run[ch] = (step % (ch + 1)) == 0;
+			out[ch] = -1.0f;
+		}
+
+		coo_pid_bank_update(&bank, CHANNELS, sp, meas, dt, run, out);
+
+		for (int ch = 0; ch < CHANNELS; ch++) {
+			if (!run[ch]) {
+				zassert_equal(out[ch], -1.0f, "skipped channel %d written", ch);
+				continue;
+			}
+			zassert_equal(out[ch], coo_pid_update(&pids[ch], sp[ch], meas[ch], dt[ch]),
+				      "channel %d step %d", ch, step);
+		}
+	}
+}
+
+ZTEST(pid_bank, test_terms_and_limits)
+{
+	float sp = 310.0f, meas = 300.0f, dt = 1.0f, out;
+
+	zassert_ok(coo_pid_bank_init_channel(&bank, 0, 2.0f, 0.5f, 0.0f, 0.0f, 100.0f));
+	coo_pid_bank_update(&bank, 1, &sp, &meas, &dt, NULL, &out);
+
+	/* Unsaturated: the terms add up to the output */
+	zassert_within(bank.p_term[0], 20.0f, 1e-4f);
+	zassert_within(bank.i_term[0], 5.0f, 1e-4f);
+	zassert_within(bank.p_term[0] + bank.i_term[0] + bank.d_term[0], out, 1e-4f);
+
+	/* A large error saturates at the limits */
+	meas = 0.0f;
+	coo_pid_bank_update(&bank, 1, &sp, &meas, &dt, NULL, &out);
+	zassert_equal(out, 100.0f);
+	meas = 1000.0f;
+	coo_pid_bank_update(&bank, 1, &sp, &meas, &dt, NULL, &out);
+	zassert_equal(out, 0.0f);
+
+	/* Reset clears the integral */
+	zassert_ok(coo_pid_bank_reset(&bank, 0));
+	zassert_equal(bank.integral[0], 0.0f);
+}
+
+ZTEST_SUITE(pid_bank, NULL, NULL, NULL, NULL, NULL);
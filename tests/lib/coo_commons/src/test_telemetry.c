@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026 Caltech Optical Observatories
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <coo_commons/telemetry.h>
+#include <zephyr/sys/byteorder.h>
+#include <errno.h>
+#include <string.h>
+
+#define DEPTH 4
+
+COO_TELEMETRY_DEFINE(tm, DEPTH);
+
+static uint8_t frame[COO_TELEMETRY_FRAME_SIZE(DEPTH)];
+
+static struct coo_telemetry_sample sample_n(uint32_t n)
+{
+	return (struct coo_telemetry_sample){
+		.timestamp_ms = 1000U * n,
+		.channel = (uint8_t)n,
+		.kind = 2,
+		.flags = COO_TELEMETRY_FLAG_PID,
+		.status = -3,
+		.measured = 300.0f + n,
+		.setpoint = 310.0f,
+		.p_term = 1.0f,
+		.i_term = -2.0f,
+		.d_term = 0.25f,
+		.output = 0.5f * n,
+	};
+}
+
+static float get_le_float(const uint8_t *src)
+{
+	uint32_t bits = sys_get_le32(src);
+	float value;
+
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static void check_record(const uint8_t *rec, uint32_t n)
+{
+	const struct coo_telemetry_sample s = sample_n(n);
+
+	zassert_equal(sys_get_le32(&rec[0]), s.timestamp_ms);
+	zassert_equal(rec[4], s.channel);
+	zassert_equal(rec[5], s.flags);
+	zassert_equal((int8_t)rec[6], s.status);
+	zassert_equal(rec[7], s.kind);
+	zassert_equal(get_le_float(&rec[8]), s.measured);
+	zassert_equal(get_le_float(&rec[12]), s.setpoint);
+	zassert_equal(get_le_float(&rec[16]), s.p_term);
+	zassert_equal(get_le_float(&rec[20]), s.i_term);
+	zassert_equal(get_le_float(&rec[24]), s.d_term);
+	zassert_equal(get_le_float(&rec[28]), s.output);
+}
+
+static void reset(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	coo_telemetry_clear(&tm);
+	tm.seq = 0;
+}
+
+ZTEST(telemetry, test_frame_layout)
+{
+	for (uint32_t n = 0; n < 3; n++) {
+		const struct coo_telemetry_sample s = sample_n(n);
+
+		coo_telemetry_record(&tm, &s);
+	}
+	zassert_equal(coo_telemetry_pending(&tm), 3U);
+
+	zassert_equal(coo_telemetry_encode(&tm, frame, sizeof(frame), DEPTH),
+		      (int)COO_TELEMETRY_FRAME_SIZE(3));
+	zassert_equal(sys_get_le16(&frame[0]), COO_TELEMETRY_SCHEMA_ID);
+	zassert_equal(frame[2], COO_TELEMETRY_SCHEMA_VERSION);
+	zassert_equal(frame[3], COO_TELEMETRY_RECORD_SIZE);
+	zassert_equal(sys_get_le16(&frame[4]), 3U);
+	zassert_equal(sys_get_le16(&frame[6]), 0U);
+	zassert_equal(sys_get_le32(&frame[8]), 0U);
+
+	for (uint32_t n = 0; n < 3; n++) {
+		check_record(&frame[COO_TELEMETRY_FRAME_SIZE(n)], n);
+	}
+	zassert_equal(coo_telemetry_pending(&tm), 0U);
+
+	/* Nothing pending: no frame and the sequence number is kept */
+	zassert_equal(coo_telemetry_encode(&tm, frame, sizeof(frame), DEPTH), 0);
+	zassert_equal(tm.seq, 1U);
+}
+
+ZTEST(telemetry, test_overflow_counts_drops)
+{
+	for (uint32_t n = 0; n < DEPTH + 2; n++) {
+		const struct coo_telemetry_sample s = sample_n(n);
+
+		coo_telemetry_record(&tm, &s);
+	}
+
+	zassert_equal(coo_telemetry_encode(&tm, frame, sizeof(frame), DEPTH),
+		      (int)COO_TELEMETRY_FRAME_SIZE(DEPTH));
+	zassert_equal(sys_get_le16(&frame[4]), DEPTH);
+	zassert_equal(sys_get_le16(&frame[6]), 2U);
+
+	/* The oldest two were overwritten */
+	for (uint32_t i = 0; i < DEPTH; i++) {
+		check_record(&frame[COO_TELEMETRY_FRAME_SIZE(i)], i + 2U);
+	}
+}
+
+ZTEST(telemetry, test_batches_fit_buffer)
+{
+	for (uint32_t n = 0; n < 3; n++) {
+		const struct coo_telemetry_sample s = sample_n(n);
+
+		coo_telemetry_record(&tm, &s);
+	}
+
+	zassert_equal(coo_telemetry_encode(&tm, frame, COO_TELEMETRY_FRAME_SIZE(1) - 1U, DEPTH),
+		      -ENOSPC);
+	zassert_equal(coo_telemetry_encode(NULL, frame, sizeof(frame), DEPTH), -EINVAL);
+
+	/* A buffer of two and a half records takes two */
+	zassert_equal(coo_telemetry_encode(&tm, frame, COO_TELEMETRY_FRAME_SIZE(2) + 16U, DEPTH),
+		      (int)COO_TELEMETRY_FRAME_SIZE(2));
+	check_record(&frame[COO_TELEMETRY_HEADER_SIZE], 0);
+
+	zassert_equal(coo_telemetry_encode(&tm, frame, sizeof(frame), 1),
+		      (int)COO_TELEMETRY_FRAME_SIZE(1));
+	zassert_equal(sys_get_le32(&frame[8]), 1U);
+	check_record(&frame[COO_TELEMETRY_HEADER_SIZE], 2);
+}
+
+ZTEST_SUITE(telemetry, NULL, NULL, reset, NULL, NULL);